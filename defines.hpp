@@ -50,6 +50,7 @@ auto constexpr TMP_OFFSETS_EXT = OFFSET_EXT EXTENSION_TMP;
 #define RESTRICTIONS_FILE_TAG "restrictions"
 #define ROUTING_FILE_TAG "routing"
 #define CROSS_MWM_FILE_TAG "cross_mwm"
+#define CONTRACTION_HIERARCHY_FILE_TAG "car_ch"
 #define FEATURE_OFFSETS_FILE_TAG "offs"
 #define RELATION_OFFSETS_FILE_TAG "rel_offs"
 #define SEARCH_RANKS_FILE_TAG "ranks"
@@ -0,0 +1,140 @@
+#include "generator/contraction_hierarchy_generator.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+#include "routing/contraction_hierarchy_builder.hpp"
+#include "routing/edge_estimator.hpp"
+#include "routing/geometry.hpp"
+#include "routing/index_graph.hpp"
+#include "routing/index_graph_loader.hpp"
+#include "routing/road_access.hpp"
+#include "routing/segment.hpp"
+
+#include "routing_common/car_model.hpp"
+
+#include "indexer/mwm_set.hpp"
+
+#include "platform/local_country_file.hpp"
+
+#include "coding/files_container.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "defines.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace routing_builder
+{
+using namespace routing;
+using std::string, std::vector;
+
+namespace
+{
+/// \returns road access which doesn't forbid anything that can be allowed at some time:
+/// unconditional access of the ways and the points with access:conditional is dropped.
+RoadAccess MakeLowerBoundRoadAccess(RoadAccess const & roadAccess)
+{
+  RoadAccess::WayToAccess wayToAccess;
+  for (auto const & [featureId, type] : roadAccess.GetWayToAccess())
+    if (roadAccess.GetWayToAccessConditional().count(featureId) == 0)
+      wayToAccess.emplace(featureId, type);
+
+  RoadAccess::PointToAccess pointToAccess;
+  for (auto const & [point, type] : roadAccess.GetPointToAccess())
+    if (roadAccess.GetPointToAccessConditional().count(point) == 0)
+      pointToAccess.emplace(point, type);
+
+  RoadAccess result;
+  result.SetAccess(std::move(wayToAccess), std::move(pointToAccess));
+  return result;
+}
+}  // namespace
+
+bool BuildContractionHierarchySection(string const & path, string const & mwmFile, string const & country,
+                                      CountryParentNameGetterFn const & countryParentNameGetterFn)
+{
+  LOG(LINFO, ("Building contraction hierarchy for", country));
+  try
+  {
+    base::Timer timer;
+
+    VehicleType const vhType = VehicleType::Car;
+    std::shared_ptr<VehicleModelInterface> vehicleModel =
+        CarModelFactory(countryParentNameGetterFn).GetVehicleModelForCountry(country);
+
+    MwmValue mwmValue(platform::LocalCountryFile(path, platform::CountryFile(country), 0 /* version */));
+    uint32_t const mwmNumRoads = DeserializeIndexGraphNumRoads(mwmValue, vhType);
+    IndexGraph graph(std::make_shared<Geometry>(GeometryLoader::CreateFromFile(mwmFile, vehicleModel), mwmNumRoads),
+                     EdgeEstimator::Create(vhType, *vehicleModel, nullptr /* trafficStash */,
+                                           nullptr /* dataSource */, nullptr /* numMvmIds */));
+    DeserializeIndexGraph(mwmValue, vhType, graph);
+
+    // The hierarchy weights should be a lower bound of the weights at routing time, so everything
+    // which depends on the route (restrictions) or on the time (conditional access) is relaxed here.
+    graph.SetRestrictions({});
+    graph.SetUTurnRestrictions({});
+    graph.SetRoadAccess(MakeLowerBoundRoadAccess(graph.GetData()->m_roadAccess));
+
+    uint32_t maxFeatureId = 0;
+    graph.ForEachRoad([&maxFeatureId](uint32_t featureId, RoadJointIds const &)
+    { maxFeatureId = std::max(maxFeatureId, featureId); });
+
+    vector<uint32_t> featureFirstNode(maxFeatureId + 2, 0);
+    for (uint32_t featureId = 0; featureId <= maxFeatureId; ++featureId)
+    {
+      uint32_t pointsCount = 0;
+      if (graph.IsRoad(featureId))
+      {
+        auto const & road = graph.GetRoadGeometry(featureId);
+        if (road.IsValid())
+          pointsCount = road.GetPointsCount();
+      }
+      featureFirstNode[featureId + 1] =
+          featureFirstNode[featureId] + ContractionHierarchy::GetNumNodesForFeature(pointsCount);
+    }
+
+    // A hierarchy without edges, just to convert segments to nodes and back.
+    uint32_t const numNodes = featureFirstNode.back();
+    ContractionHierarchy const numeration(vector<uint32_t>(featureFirstNode), vector<uint32_t>(numNodes + 1, 0), {});
+    ContractionHierarchyBuilder builder(std::move(featureFirstNode));
+
+    IndexGraph::SegmentEdgeListT edges;
+    for (ContractionHierarchy::NodeId node = 0; node < builder.GetNumNodes(); ++node)
+    {
+      Segment const segment = numeration.GetSegment(node, kGeneratorMwmId);
+      if (!segment.IsForward() && graph.GetRoadGeometry(segment.GetFeatureId()).IsOneWay())
+        continue;
+
+      edges.clear();
+      graph.GetEdgeList(segment, true /* isOutgoing */, false /* useRoutingOptions */, edges);
+      for (auto const & edge : edges)
+      {
+        auto const target = numeration.GetNode(edge.GetTarget());
+        if (target)
+          builder.AddEdge(node, *target, edge.GetWeight().GetIntegratedWeight());
+      }
+    }
+
+    auto const ch = builder.Build();
+
+    FilesContainerW cont(mwmFile, FileWriter::OP_WRITE_EXISTING);
+    auto writer = cont.GetWriter(CONTRACTION_HIERARCHY_FILE_TAG);
+    auto const startPos = writer->Pos();
+    ch.Serialize(*writer);
+
+    LOG(LINFO, (CONTRACTION_HIERARCHY_FILE_TAG, "section is built in", timer.ElapsedSeconds(), "seconds:",
+                writer->Pos() - startPos, "bytes,", ch.GetNumNodes(), "nodes,", ch.GetNumEdges(), "edges"));
+    return true;
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("An exception happened while creating", CONTRACTION_HIERARCHY_FILE_TAG, "section:", e.what()));
+    return false;
+  }
+}
+}  // namespace routing_builder
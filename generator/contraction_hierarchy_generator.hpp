@@ -0,0 +1,15 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace routing_builder
+{
+using CountryParentNameGetterFn = std::function<std::string(std::string const &)>;
+
+/// \brief Builds CONTRACTION_HIERARCHY_FILE_TAG section for car routing inside |country|.
+/// \note Before call of this method ROUTING_FILE_TAG and ROAD_ACCESS_FILE_TAG sections should be built.
+bool BuildContractionHierarchySection(std::string const & path, std::string const & mwmFile,
+                                      std::string const & country,
+                                      CountryParentNameGetterFn const & countryParentNameGetterFn);
+}  // namespace routing_builder
@@ -20,10 +20,76 @@
 #include "geometry/mercator.hpp"
 #include "geometry/region2d/binary_operators.hpp"
 
+#include "base/stl_helpers.hpp"
+#include "base/timer.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+
 namespace generator
 {
 using namespace feature;
 
+namespace
+{
+// Time of the final processing stages, to see which countries and stages make the tail of a build.
+class StagesStats
+{
+public:
+  using Stages = std::vector<std::pair<std::string_view, double>>;
+
+  void AddCountry(std::string const & name, Stages && stages)
+  {
+    double total = 0.0;
+    for (auto const & [stage, seconds] : stages)
+      total += seconds;
+    LOG(LINFO, ("Country", name, "is processed in", total, "seconds:", stages));
+
+    std::lock_guard lock(m_mutex);
+    m_countries.push_back({name, total, std::move(stages)});
+  }
+
+  void Log(double wallSeconds)
+  {
+    std::lock_guard lock(m_mutex);
+
+    std::vector<std::pair<std::string_view, double>> stagesTotal;
+    for (auto const & country : m_countries)
+    {
+      for (auto const & [stage, seconds] : country.m_stages)
+      {
+        auto it = std::find_if(stagesTotal.begin(), stagesTotal.end(), [&](auto const & p) { return p.first == stage; });
+        if (it == stagesTotal.end())
+          it = stagesTotal.emplace(stagesTotal.end(), stage, 0.0);
+        it->second += seconds;
+      }
+    }
+    LOG(LINFO, ("Countries final processing took", wallSeconds, "seconds. Stages total:", stagesTotal));
+
+    size_t constexpr kSlowestCount = 10;
+    auto const count = std::min(kSlowestCount, m_countries.size());
+    std::partial_sort(m_countries.begin(), m_countries.begin() + count, m_countries.end(),
+                      [](auto const & l, auto const & r) { return l.m_seconds > r.m_seconds; });
+    for (size_t i = 0; i < count; ++i)
+      LOG(LINFO, ("Slowest country", m_countries[i].m_name, m_countries[i].m_seconds, "seconds"));
+  }
+
+private:
+  struct CountryStats
+  {
+    std::string m_name;
+    double m_seconds;
+    Stages m_stages;
+  };
+
+  std::mutex m_mutex;
+  std::vector<CountryStats> m_countries;
+};
+}  // namespace
+
 CountryFinalProcessor::CountryFinalProcessor(AffiliationInterfacePtr affiliations, std::string const & temporaryMwmPath,
                                              size_t threadsCount)
   : FinalProcessorIntermediateMwmInterface(FinalProcessorPriority::CountriesOrWorld)
@@ -46,33 +112,105 @@ void CountryFinalProcessor::Process()
   /// @todo Make "straight-way" processing. There is no need to make many functions and
   /// many read-write FeatureBuilder ops here.
 
-  LOG(LINFO, ("Processing coastline..."));
-  if (!m_coastlineGeomFilename.empty())
-    ProcessCoastline();
-
-  // 1. Process roundabouts and addr:interpolation first.
-  LOG(LINFO, ("Processing roundabouts..."));
-  if (!m_miniRoundaboutsFilename.empty() || !m_addrInterpolFilename.empty())
-    ProcessRoundabouts();
+  base::Timer const timer;
 
-  // 2. Process additional addresses then.
-  LOG(LINFO, ("Adding addresses..."));
-  if (!m_addressPath.empty())
-    AddAddresses();
+  // Planet-wide stages, which are split by countries and appended to them later.
+  CountriesFeatures coastlines;
+  if (!m_coastlineGeomFilename.empty())
+  {
+    LOG(LINFO, ("Processing coastline..."));
+    coastlines = ProcessCoastline();
+  }
 
-  LOG(LINFO, ("Adding fake nodes..."));
+  CountriesFeatures fakeNodes;
   if (!m_fakeNodesFilename.empty())
-    AddFakeNodes();
+  {
+    LOG(LINFO, ("Making fake nodes..."));
+    fakeNodes = MakeFakeNodes();
+  }
 
-  LOG(LINFO, ("Adding isolines..."));
+  bool const needRoundabouts = !m_miniRoundaboutsFilename.empty() || !m_addrInterpolFilename.empty();
+  std::optional<MiniRoundaboutData> roundabouts;
+  AddressesHolder addresses;
+  if (needRoundabouts)
+  {
+    roundabouts = ReadMiniRoundabouts(m_miniRoundaboutsFilename);
+    addresses.Deserialize(m_addrInterpolFilename);
+  }
+
+  std::optional<IsolineFeaturesGenerator> isolinesGenerator;
   if (!m_isolinesPath.empty())
-    AddIsolines();
+    isolinesGenerator.emplace(m_isolinesPath);
+
+  // Every country goes through all the stages in one task, so that a small country doesn't wait
+  // for the biggest one between the stages. Stages keep their order inside a country:
+  // 0. Coastlines and fake nodes, they are appended to every affiliation.
+  // 1. Roundabouts and addr:interpolation.
+  // 2. Additional addresses.
+  // 3. Isolines and building parts.
+  LOG(LINFO, ("Processing countries..."));
+  std::mutex addressesStatsMutex;
+  AddressEnricher::Stats addressesStats;
+  StagesStats stats;
+  auto const processCountry = [&](std::string const & name, std::string const & path)
+  {
+    StagesStats::Stages stages;
+    auto const runStage = [&stages](std::string_view stage, auto && fn)
+    {
+      base::Timer const stageTimer;
+      fn();
+      stages.emplace_back(stage, stageTimer.ElapsedSeconds());
+    };
+
+    if (auto const it = coastlines.m_countryToIndexes.find(name); it != coastlines.m_countryToIndexes.cend())
+      runStage("coastline", [&] { AppendToMwmTmp(coastlines.m_features, it->second, path); });
+
+    if (auto const it = fakeNodes.m_countryToIndexes.find(name); it != fakeNodes.m_countryToIndexes.cend())
+      runStage("fake nodes", [&] { AppendToMwmTmp(fakeNodes.m_features, it->second, path); });
+
+    // The stages below rewrite the file, which is still missing when there was nothing to append.
+    if (!IsCountry(name) || !Platform::IsFileExistsByFullPath(path))
+      return;
+
+    if (needRoundabouts)
+      runStage("roundabouts", [&] { ProcessRoundabouts(name, path, *roundabouts, addresses); });
+
+    if (!m_addressPath.empty())
+    {
+      runStage("addresses", [&]
+      {
+        auto const countryStats = AddAddresses(name, path);
+        std::lock_guard lock(addressesStatsMutex);
+        addressesStats.Add(countryStats);
+      });
+    }
 
-  // DropProhibitedSpeedCameras();
-  LOG(LINFO, ("Processing building parts..."));
-  ProcessBuildingParts();
+    if (isolinesGenerator)
+      runStage("isolines", [&] { AddIsolines(name, path, *isolinesGenerator); });
 
-  // Finish();
+    // DropProhibitedSpeedCameras();
+    runStage("building parts", [&] { ProcessBuildingParts(path); });
+
+    stats.AddCountry(name, std::move(stages));
+  };
+
+  // Coastlines and fake nodes may belong to a country without features yet.
+  std::vector<std::string> extraCountries;
+  for (auto const * countriesFeatures : {&coastlines, &fakeNodes})
+  {
+    for (auto const & [name, _] : countriesFeatures->m_countryToIndexes)
+    {
+      if (!Platform::IsFileExistsByFullPath(base::JoinPath(m_temporaryMwmPath, name + DATA_FILE_EXTENSION_TMP)))
+        extraCountries.push_back(name);
+    }
+  }
+  base::SortUnique(extraCountries);
+
+  ForEachMwmTmpLargestFirst(m_temporaryMwmPath, extraCountries, processCountry, m_threadsCount);
+
+  if (!m_addressPath.empty())
+    LOG(LINFO, ("Total addresses:", addressesStats));
+  stats.Log(timer.ElapsedSeconds());
 }
 
 /*
@@ -94,52 +232,43 @@ void CountryFinalProcessor::Order()
 }
 */
 
-void CountryFinalProcessor::ProcessRoundabouts()
+void CountryFinalProcessor::ProcessRoundabouts(std::string const & name, std::string const & path,
+                                               MiniRoundaboutData const & roundabouts,
+                                               AddressesHolder const & addresses)
 {
-  auto const roundabouts = ReadMiniRoundabouts(m_miniRoundaboutsFilename);
+  MiniRoundaboutTransformer transformer(roundabouts.GetData(), *m_affiliations);
 
-  AddressesHolder addresses;
-  addresses.Deserialize(m_addrInterpolFilename);
+  RegionData data;
+  if (ReadRegionData(name, data))
+    transformer.SetLeftHandTraffic(data.Get(RegionData::Type::RD_DRIVING) == "l");
 
-  ForEachMwmTmp(m_temporaryMwmPath, [&](auto const & name, auto const & path)
+  FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, true /* mangleName */);
+  ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
   {
-    if (!IsCountry(name))
-      return;
-
-    MiniRoundaboutTransformer transformer(roundabouts.GetData(), *m_affiliations);
-
-    RegionData data;
-    if (ReadRegionData(name, data))
-      transformer.SetLeftHandTraffic(data.Get(RegionData::Type::RD_DRIVING) == "l");
-
-    FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, true /* mangleName */);
-    ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
+    if (roundabouts.IsRoadExists(fb))
+      transformer.AddRoad(std::move(fb));
+    else
     {
-      if (roundabouts.IsRoadExists(fb))
-        transformer.AddRoad(std::move(fb));
-      else
+      auto const & checker = ftypes::IsAddressInterpolChecker::Instance();
+      // Check HasOsmIds() because we have non-OSM addr:interpolation FBs (Tiger).
+      if (fb.IsLine() && fb.HasOsmIds() && checker(fb.GetTypes()))
       {
-        auto const & checker = ftypes::IsAddressInterpolChecker::Instance();
-        // Check HasOsmIds() because we have non-OSM addr:interpolation FBs (Tiger).
-        if (fb.IsLine() && fb.HasOsmIds() && checker(fb.GetTypes()))
+        if (!addresses.Update(fb))
         {
-          if (!addresses.Update(fb))
-          {
-            // Not only invalid interpolation ways, but fancy buildings with interpolation type like here:
-            // https://www.openstreetmap.org/#map=18/39.45672/-77.97516
-            if (fb.RemoveTypesIf(checker))
-              return;
-          }
+          // Not only invalid interpolation ways, but fancy buildings with interpolation type like here:
+          // https://www.openstreetmap.org/#map=18/39.45672/-77.97516
+          if (fb.RemoveTypesIf(checker))
+            return;
         }
-
-        writer.Write(fb);
       }
-    });
 
-    // Adds new way features generated from mini-roundabout nodes with those nodes ids.
-    // Transforms points on roads to connect them with these new roundabout junctions.
-    transformer.ProcessRoundabouts([&writer](FeatureBuilder const & fb) { writer.Write(fb); });
-  }, m_threadsCount);
+      writer.Write(fb);
+    }
+  });
+
+  // Adds new way features generated from mini-roundabout nodes with those nodes ids.
+  // Transforms points on roads to connect them with these new roundabout junctions.
+  transformer.ProcessRoundabouts([&writer](FeatureBuilder const & fb) { writer.Write(fb); });
 }
 
 bool DoesBuildingConsistOfParts(FeatureBuilder const & fbBuilding, m4::Tree<m2::RegionI> const & buildingPartsKDTree)
@@ -212,102 +341,93 @@ bool DoesBuildingConsistOfParts(FeatureBuilder const & fbBuilding, m4::Tree<m2::
 }
 
 void CountryFinalProcessor::ProcessBuildingParts()
+{
+  ForEachMwmTmp(m_temporaryMwmPath, [&](auto const & name, auto const & path)
+  {
+    if (IsCountry(name))
+      ProcessBuildingParts(path);
+  }, m_threadsCount);
+}
+
+void CountryFinalProcessor::ProcessBuildingParts(std::string const & path)
 {
   auto const & buildingChecker = ftypes::IsBuildingChecker::Instance();
   auto const & buildingPartChecker = ftypes::IsBuildingPartChecker::Instance();
   auto const & buildingHasPartsChecker = ftypes::IsBuildingHasPartsChecker::Instance();
 
-  ForEachMwmTmp(m_temporaryMwmPath, [&](auto const & name, auto const & path)
-  {
-    if (!IsCountry(name))
-      return;
-
-    // All "building:part" regions in MWM
-    m4::Tree<m2::RegionI> buildingPartsKDTree;
+  // All "building:part" regions in MWM
+  m4::Tree<m2::RegionI> buildingPartsKDTree;
 
-    ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
+  ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
+  {
+    if (fb.IsArea() && buildingPartChecker(fb.GetTypes()))
     {
-      if (fb.IsArea() && buildingPartChecker(fb.GetTypes()))
-      {
-        // Important trick! Add region by FeatureBuilder's native rect, to make search queries also by FB rects.
-        buildingPartsKDTree.Add(coastlines_generator::CreateRegionI(fb.GetOuterGeometry()), fb.GetLimitRect());
-      }
-    });
+      // Important trick! Add region by FeatureBuilder's native rect, to make search queries also by FB rects.
+      buildingPartsKDTree.Add(coastlines_generator::CreateRegionI(fb.GetOuterGeometry()), fb.GetLimitRect());
+    }
+  });
 
-    FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, true /* mangleName */);
-    ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
+  FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, true /* mangleName */);
+  ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(path, [&](FeatureBuilder && fb, uint64_t)
+  {
+    if (fb.IsArea() && buildingChecker(fb.GetTypes()) && DoesBuildingConsistOfParts(fb, buildingPartsKDTree))
     {
-      if (fb.IsArea() && buildingChecker(fb.GetTypes()) && DoesBuildingConsistOfParts(fb, buildingPartsKDTree))
-      {
-        fb.AddType(buildingHasPartsChecker.GetType());
-        fb.GetParams().FinishAddingTypes();
-      }
+      fb.AddType(buildingHasPartsChecker.GetType());
+      fb.GetParams().FinishAddingTypes();
+    }
 
-      writer.Write(fb);
-    });
-  }, m_threadsCount);
+    writer.Write(fb);
+  });
 }
 
-void CountryFinalProcessor::AddIsolines()
+void CountryFinalProcessor::AddIsolines(std::string const & name, std::string const & path,
+                                        IsolineFeaturesGenerator const & generator)
 {
   // For generated isolines must be built isolines_info section based on the same
   // binary isolines file.
-  IsolineFeaturesGenerator isolineFeaturesGenerator(m_isolinesPath);
-  ForEachMwmTmp(m_temporaryMwmPath, [&](auto const & name, auto const & path)
-  {
-    if (!IsCountry(name))
-      return;
-
-    FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, FileWriter::Op::OP_APPEND);
-    isolineFeaturesGenerator.GenerateIsolines(name, [&](auto const & fb) { writer.Write(fb); });
-  }, m_threadsCount);
+  FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, FileWriter::Op::OP_APPEND);
+  generator.GenerateIsolines(name, [&](auto const & fb) { writer.Write(fb); });
 }
 
-void CountryFinalProcessor::AddAddresses()
+AddressEnricher::Stats CountryFinalProcessor::AddAddresses(std::string const & name, std::string const & path)
 {
-  AddressEnricher::Stats totalStats;
-
-  ForEachMwmTmp(m_temporaryMwmPath, [&](auto const & name, auto const & path)
-  {
-    if (!IsCountry(name))
-      return;
+  auto const addrPath = base::JoinPath(m_addressPath, name) + TEMP_ADDR_EXTENSION;
+  if (!Platform::IsFileExistsByFullPath(addrPath))
+    return {};
 
-    auto const addrPath = base::JoinPath(m_addressPath, name) + TEMP_ADDR_EXTENSION;
-    if (!Platform::IsFileExistsByFullPath(addrPath))
-      return;
+  AddressEnricher enricher;
 
-    AddressEnricher enricher;
+  // Collect existing addresses and streets.
+  ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(
+      path, [&](FeatureBuilder && fb, uint64_t) { enricher.AddSrc(std::move(fb)); });
 
-    // Collect existing addresses and streets.
-    ForEachFeatureRawFormat<serialization_policy::MaxAccuracy>(
-        path, [&](FeatureBuilder && fb, uint64_t) { enricher.AddSrc(std::move(fb)); });
-
-    // Append new addresses.
-    FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, FileWriter::Op::OP_APPEND);
-    enricher.ProcessRawEntries(addrPath, [&writer](FeatureBuilder const & fb) { writer.Write(fb); });
-
-    LOG(LINFO, (name, enricher.m_stats));
-    totalStats.Add(enricher.m_stats);
-  });
+  // Append new addresses.
+  FeatureBuilderWriter<serialization_policy::MaxAccuracy> writer(path, FileWriter::Op::OP_APPEND);
+  enricher.ProcessRawEntries(addrPath, [&writer](FeatureBuilder const & fb) { writer.Write(fb); });
 
-  LOG(LINFO, ("Total addresses:", totalStats));
+  LOG(LINFO, (name, enricher.m_stats));
+  return enricher.m_stats;
 }
 
-void CountryFinalProcessor::ProcessCoastline()
+CountryFinalProcessor::CountriesFeatures CountryFinalProcessor::ProcessCoastline()
 {
   /// @todo We can remove MinSize at all.
   auto fbs = ReadAllDatRawFormat<serialization_policy::MaxAccuracy>(m_coastlineGeomFilename);
 
-  auto const affiliations = AppendToMwmTmp(fbs, *m_affiliations, m_temporaryMwmPath, m_threadsCount);
+  auto const affiliations = GetAffiliations(fbs, *m_affiliations, m_threadsCount);
   FeatureBuilderWriter<> collector(m_worldCoastsFilename);
   for (size_t i = 0; i < fbs.size(); ++i)
   {
-    fbs[i].SetName(StringUtf8Multilang::kDefaultCode, strings::JoinStrings(affiliations[i], ';'));
-    collector.Write(fbs[i]);
+    // Countries get coastlines without names.
+    auto fb = fbs[i];
+    fb.SetName(StringUtf8Multilang::kDefaultCode, strings::JoinStrings(affiliations[i], ';'));
+    collector.Write(fb);
   }
+
+  return SplitByCountries(std::move(fbs), affiliations);
 }
 
-void CountryFinalProcessor::AddFakeNodes()
+CountryFinalProcessor::CountriesFeatures CountryFinalProcessor::MakeFakeNodes()
 {
   std::vector<FeatureBuilder> fbs;
   MixFakeNodes(m_fakeNodesFilename, [&](auto & element)
@@ -318,7 +438,22 @@ void CountryFinalProcessor::AddFakeNodes()
     ftype::GetNameAndType(&element, fb.GetParams());
     fbs.emplace_back(std::move(fb));
   });
-  AppendToMwmTmp(fbs, *m_affiliations, m_temporaryMwmPath, m_threadsCount);
+
+  auto const affiliations = GetAffiliations(fbs, *m_affiliations, m_threadsCount);
+  return SplitByCountries(std::move(fbs), affiliations);
+}
+
+// static
+CountryFinalProcessor::CountriesFeatures CountryFinalProcessor::SplitByCountries(
+    std::vector<FeatureBuilder> && fbs, std::vector<std::vector<std::string>> const & affiliations)
+{
+  CountriesFeatures countriesFeatures;
+  for (size_t i = 0; i < fbs.size(); ++i)
+    for (auto const & country : affiliations[i])
+      countriesFeatures.m_countryToIndexes[country].emplace_back(i);
+
+  countriesFeatures.m_features = std::move(fbs);
+  return countriesFeatures;
 }
 
 void CountryFinalProcessor::DropProhibitedSpeedCameras()
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "generator/address_enricher.hpp"
 #include "generator/affiliation.hpp"
+#include "generator/feature_builder.hpp"
 #include "generator/final_processor_interface.hpp"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace generator
 {
+class AddressesHolder;
+class IsolineFeaturesGenerator;
+class MiniRoundaboutData;
+
 class CountryFinalProcessor : public FinalProcessorIntermediateMwmInterface
 {
 public:
@@ -33,12 +41,27 @@ public:
   void ProcessBuildingParts();
 
 private:
+  // Features which are distributed among countries by the affiliations.
+  struct CountriesFeatures
+  {
+    std::vector<feature::FeatureBuilder> m_features;
+    std::unordered_map<std::string, std::vector<size_t>> m_countryToIndexes;
+  };
+
+  static CountriesFeatures SplitByCountries(std::vector<feature::FeatureBuilder> && fbs,
+                                            std::vector<std::vector<std::string>> const & affiliations);
+
   // void Order();
-  void ProcessCoastline();
-  void ProcessRoundabouts();
-  void AddFakeNodes();
-  void AddIsolines();
-  void AddAddresses();
+  // Stages over the whole planet, which distribute features among countries.
+  CountriesFeatures ProcessCoastline();
+  CountriesFeatures MakeFakeNodes();
+
+  // Stages of one country. All of them for a country run one after another in one task.
+  void ProcessRoundabouts(std::string const & name, std::string const & path, MiniRoundaboutData const & roundabouts,
+                          AddressesHolder const & addresses);
+  AddressEnricher::Stats AddAddresses(std::string const & name, std::string const & path);
+  void AddIsolines(std::string const & name, std::string const & path, IsolineFeaturesGenerator const & generator);
+  void ProcessBuildingParts(std::string const & path);
   void DropProhibitedSpeedCameras();
   // void Finish();
 
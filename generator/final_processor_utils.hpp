@@ -11,9 +11,12 @@
 
 #include "defines.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace generator
@@ -33,10 +36,51 @@ void ForEachMwmTmp(std::string const & temporaryMwmPath, ToDo && toDo, size_t th
   }
 }
 
+// Same as ForEachMwmTmp, but also runs |toDo| for |extraCountries|, which files don't exist yet,
+// and starts with the largest files. Countries take very different time, and a big country, which is
+// started last, makes a long tail with one busy thread, while a thread takes the next task as soon
+// as it's free.
+template <typename ToDo>
+void ForEachMwmTmpLargestFirst(std::string const & temporaryMwmPath, std::vector<std::string> const & extraCountries,
+                               ToDo && toDo, size_t threadsCount = 1)
+{
+  Platform::FilesList fileList;
+  Platform::GetFilesByExt(temporaryMwmPath, DATA_FILE_EXTENSION_TMP, fileList);
+
+  std::vector<std::pair<uint64_t, std::string>> countries;
+  for (auto const & filename : fileList)
+  {
+    auto countryName = filename;
+    strings::ReplaceLast(countryName, DATA_FILE_EXTENSION_TMP, "");
+
+    uint64_t size = 0;
+    Platform::GetFileSizeByFullPath(base::JoinPath(temporaryMwmPath, filename), size);
+    countries.emplace_back(size, std::move(countryName));
+  }
+  for (auto const & country : extraCountries)
+    countries.emplace_back(0, country);
+
+  std::sort(countries.begin(), countries.end(), std::greater<>());
+
+  base::ComputationalThreadPool pool(threadsCount);
+  for (auto const & [_, country] : countries)
+    pool.SubmitWork(toDo, country, base::JoinPath(temporaryMwmPath, country + DATA_FILE_EXTENSION_TMP));
+}
+
 std::vector<std::vector<std::string>> GetAffiliations(std::vector<feature::FeatureBuilder> const & fbs,
                                                       feature::AffiliationInterface const & affiliation,
                                                       size_t threadsCount);
 
+// Writes |fbs| with |indexes| to the mwm.tmp file by |path|.
+template <class SerializationPolicy = feature::serialization_policy::MaxAccuracy>
+void AppendToMwmTmp(std::vector<feature::FeatureBuilder> const & fbs, std::vector<size_t> const & indexes,
+                    std::string const & path)
+{
+  feature::FeatureBuilderWriter<SerializationPolicy> collector(path, FileWriter::Op::OP_APPEND);
+  for (auto const index : indexes)
+    collector.Write(fbs[index]);
+}
+
 // Writes |fbs| to countries mwm.tmp files. Returns affiliations - country matches for |fbs|.
 template <class SerializationPolicy = feature::serialization_policy::MaxAccuracy>
 std::vector<std::vector<std::string>> AppendToMwmTmp(std::vector<feature::FeatureBuilder> const & fbs,
@@ -55,9 +99,7 @@ std::vector<std::vector<std::string>> AppendToMwmTmp(std::vector<feature::Featur
     pool.SubmitWork([&, country = std::move(p.first), indexes = std::move(p.second)]()
     {
       auto const path = base::JoinPath(temporaryMwmPath, country + DATA_FILE_EXTENSION_TMP);
-      feature::FeatureBuilderWriter<SerializationPolicy> collector(path, FileWriter::Op::OP_APPEND);
-      for (auto const index : indexes)
-        collector.Write(fbs[index]);
+      AppendToMwmTmp<SerializationPolicy>(fbs, indexes, path);
     });
   }
 
@@ -19,13 +19,15 @@ struct GenerateInfo
   {
     Memory,
     Index,
-    File
+    File,
+    Compact
   };
 
   enum class OsmSourceType
   {
     XML,
-    O5M
+    O5M,
+    PBF
   };
 
   // Directory for .mwm.tmp files.
@@ -62,6 +64,10 @@ struct GenerateInfo
 
   uint32_t m_versionDate = 0;
 
+  // Memory limit in bytes for <key, value> pairs of the search index build, 0 means no limit.
+  // Pairs beyond the limit are spilled to disk as sorted runs.
+  uint64_t m_searchIndexMemoryLimit = 0;
+
   std::vector<std::string> m_bucketNames;
 
   bool m_createWorld = false;
@@ -80,6 +86,8 @@ struct GenerateInfo
       m_osmFileType = OsmSourceType::XML;
     else if (type == "o5m")
       m_osmFileType = OsmSourceType::O5M;
+    else if (type == "pbf")
+      m_osmFileType = OsmSourceType::PBF;
     else
       LOG(LCRITICAL, ("Unknown source type:", type));
   }
@@ -92,6 +100,8 @@ struct GenerateInfo
       m_nodeStorageType = NodeStorageType::Index;
     else if (type == "mem")
       m_nodeStorageType = NodeStorageType::Memory;
+    else if (type == "compact")
+      m_nodeStorageType = NodeStorageType::Compact;
     else
       LOG(LCRITICAL, ("Incorrect node_storage type:", type));
   }
@@ -8,11 +8,17 @@
 
 #include "testing/testing.hpp"
 
+#include "generator/generate_info.hpp"
+#include "generator/intermediate_data.hpp"
 #include "generator/intermediate_elements.hpp"
 
+#include "platform/platform_tests_support/scoped_file.hpp"
+
 #include "coding/reader.hpp"
 #include "coding/writer.hpp"
 
+#include "base/logging.hpp"
+
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -106,4 +112,120 @@ UNIT_TEST(Intermediate_Data_relation_element_save_load_test)
   TEST_NOT_EQUAL(e2.m_tags["key1old"], "value1old", ());
   TEST_NOT_EQUAL(e2.m_tags["key2old"], "value2old", ());
 }
+
+UNIT_TEST(Intermediate_Data_compact_point_storage_test)
+{
+  using platform::tests_support::ScopedFile;
+  using NodeStorageType = feature::GenerateInfo::NodeStorageType;
+
+  std::string const kName = "compact_point_storage_test";
+  ScopedFile const dataFile(kName + ".compact", ScopedFile::Mode::DoNotCreate);
+  ScopedFile const indexFile(kName + ".compact.idx", ScopedFile::Mode::DoNotCreate);
+  auto const fullName = dataFile.GetFullPath().substr(0, dataFile.GetFullPath().size() - std::string(".compact").size());
+
+  // More than one shard, sparse ids and a duplicate.
+  uint64_t constexpr kPointsCount = 2500000;
+  auto const getId = [](uint64_t i) { return 3 * i + 5; };
+  auto const getLat = [](uint64_t i) { return static_cast<double>(i % 1700000) * 1e-4 - 85.0; };
+  auto const getLon = [](uint64_t i) { return static_cast<double>((i * 7919) % 3500000) * 1e-4 - 175.0; };
+  {
+    auto writer = generator::cache::CreatePointStorageWriter(NodeStorageType::Compact, fullName, 4 /* threadsCount */);
+    writer->AddPoint(getId(0), 1.0, 1.0);
+    for (uint64_t i = 0; i < kPointsCount; ++i)
+      writer->AddPoint(getId(i), getLat(i), getLon(i));
+    TEST_EQUAL(writer->GetNumProcessedPoints(), kPointsCount + 1, ());
+  }
+
+  auto reader = generator::cache::CreatePointStorageReader(NodeStorageType::Compact, fullName);
+  double lat = 0.0;
+  double lon = 0.0;
+  for (uint64_t i = 0; i < kPointsCount; i += 997)
+  {
+    TEST(reader->GetPoint(getId(i), lat, lon), (i));
+    TEST_ALMOST_EQUAL_ABS(lat, getLat(i), 1e-6, (i));
+    TEST_ALMOST_EQUAL_ABS(lon, getLon(i), 1e-6, (i));
+  }
+
+  TEST(reader->GetPoint(getId(kPointsCount - 1), lat, lon), ());
+  TEST_ALMOST_EQUAL_ABS(lat, getLat(kPointsCount - 1), 1e-6, ());
+
+  TEST(!reader->GetPoint(0, lat, lon), ());
+  TEST(!reader->GetPoint(getId(0) + 1, lat, lon), ());
+  TEST(!reader->GetPoint(getId(1000) + 2, lat, lon), ());
+  TEST(!reader->GetPoint(getId(kPointsCount), lat, lon), ());
+}
+
+UNIT_TEST(Intermediate_Data_point_storage_batch_test)
+{
+  using platform::tests_support::ScopedFile;
+  using NodeStorageType = feature::GenerateInfo::NodeStorageType;
+
+  std::string const kName = "point_storage_batch_test";
+  std::vector<uint64_t> writtenIds = {1, 2, 5, 100};
+  for (uint64_t id = 1000; id < 50000; id += 3)
+    writtenIds.push_back(id);
+  auto const getLat = [](uint64_t id) { return static_cast<double>(id % 1000) * 0.01 + 1.0; };
+  auto const getLon = [](uint64_t id) { return static_cast<double>(id % 777) * -0.1 - 1.0; };
+
+  // Written ids interleaved with missing ones.
+  std::vector<uint64_t> ids;
+  for (uint64_t id = 0; id < 50000; id += 7)
+    ids.push_back(id);
+  ids.push_back(100);
+
+  for (auto const type : {NodeStorageType::File, NodeStorageType::Index, NodeStorageType::Memory,
+                          NodeStorageType::Compact})
+  {
+    // Memory writer reserves a huge buffer, it writes the same file as the File one.
+    auto const writerType = type == NodeStorageType::Memory ? NodeStorageType::File : type;
+
+    std::vector<std::unique_ptr<ScopedFile>> files;
+    auto const addFile = [&](std::string const & ext)
+    { files.emplace_back(std::make_unique<ScopedFile>(kName + ext, ScopedFile::Mode::DoNotCreate)); };
+    switch (type)
+    {
+    case NodeStorageType::File:
+    case NodeStorageType::Memory: addFile(""); break;
+    case NodeStorageType::Index: addFile(".short"); break;
+    case NodeStorageType::Compact:
+      addFile(".compact");
+      addFile(".compact.idx");
+      break;
+    }
+    auto const fullName = files.front()->GetFullPath().substr(0, files.front()->GetFullPath().find(kName)) + kName;
+
+    {
+      auto writer = generator::cache::CreatePointStorageWriter(writerType, fullName);
+      for (auto const id : writtenIds)
+        writer->AddPoint(id, getLat(id), getLon(id));
+    }
+
+    // Raw storages log errors for missing nodes.
+    base::ScopedLogAbortLevelChanger const ignoreErrors;
+    auto reader = generator::cache::CreatePointStorageReader(type, fullName);
+    std::vector<uint64_t> sortedIds = ids;
+    std::sort(sortedIds.begin(), sortedIds.end());
+    sortedIds.erase(std::unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+
+    std::vector<generator::cache::NodePoint> points;
+    reader->GetPoints(sortedIds, points);
+    TEST_EQUAL(points.size(), sortedIds.size(), ());
+    for (size_t i = 0; i < sortedIds.size(); ++i)
+    {
+      auto const id = sortedIds[i];
+      bool const written = std::binary_search(writtenIds.begin(), writtenIds.end(), id);
+      TEST_EQUAL(points[i].m_found, written, (id));
+
+      double lat = 0.0;
+      double lon = 0.0;
+      TEST_EQUAL(reader->GetPoint(id, lat, lon), written, (id));
+      if (!written)
+        continue;
+      TEST_ALMOST_EQUAL_ABS(points[i].m_lat, getLat(id), 1e-6, (id));
+      TEST_ALMOST_EQUAL_ABS(points[i].m_lon, getLon(id), 1e-6, (id));
+      TEST_EQUAL(points[i].m_lat, lat, (id));
+      TEST_EQUAL(points[i].m_lon, lon, (id));
+    }
+  }
+}
 }  // namespace intermediate_data_test
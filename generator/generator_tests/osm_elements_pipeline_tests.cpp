@@ -0,0 +1,122 @@
+#include "testing/testing.hpp"
+
+#include "generator/osm_element.hpp"
+#include "generator/osm_elements_pipeline.hpp"
+#include "generator/osm_source.hpp"
+
+#include "base/thread_pool_computational.hpp"
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace osm_elements_pipeline_tests
+{
+using namespace generator;
+
+class ProcessorOsmElementsCounter : public ProcessorOsmElementsInterface
+{
+public:
+  ProcessorOsmElementsCounter(uint64_t count, bool throwAtEnd) : m_count(count), m_throwAtEnd(throwAtEnd) {}
+
+  // ProcessorOsmElementsInterface overrides:
+  bool TryRead(OsmElement & element) override
+  {
+    if (m_current == m_count)
+    {
+      if (m_throwAtEnd)
+        throw std::runtime_error("Broken source");
+      return false;
+    }
+
+    // The pipeline must pass a cleared element even when the chunk is reused.
+    TEST_EQUAL(element.m_id, 0, ());
+    TEST(element.Tags().empty(), ());
+
+    element.m_type = OsmElement::EntityType::Node;
+    element.m_id = ++m_current;
+    element.AddTag("id", std::to_string(m_current));
+    return true;
+  }
+
+private:
+  uint64_t const m_count;
+  bool const m_throwAtEnd;
+  uint64_t m_current = 0;
+};
+
+void CheckPipeline(uint64_t elementsCount, size_t chunkSize, size_t chunksCount)
+{
+  std::istringstream ss;
+  SourceReader reader(ss);
+  ProcessorOsmElementsCounter source(elementsCount, false /* throwAtEnd */);
+  OsmElementsPipeline pipeline(source, reader, chunkSize, chunksCount);
+
+  std::atomic<uint64_t> sum = 0;
+  uint64_t expectedId = 0;
+  {
+    base::ComputationalThreadPool consumers(3);
+    std::vector<OsmElement> elements;
+    while (pipeline.Pop(elements))
+    {
+      TEST_LESS_OR_EQUAL(elements.size(), chunkSize, ());
+      for (auto const & e : elements)
+        TEST_EQUAL(e.m_id, ++expectedId, ());
+
+      consumers.SubmitWork([&pipeline, &sum, elements = std::move(elements)]() mutable
+      {
+        for (auto const & e : elements)
+          sum += e.m_id;
+        pipeline.Recycle(std::move(elements));
+      });
+    }
+  }
+
+  TEST_EQUAL(expectedId, elementsCount, ());
+  TEST_EQUAL(sum, elementsCount * (elementsCount + 1) / 2, ());
+  TEST_EQUAL(pipeline.GetCounters().m_readElements, elementsCount, ());
+  TEST_EQUAL(pipeline.GetCounters().m_processedElements, elementsCount, ());
+}
+
+UNIT_TEST(OsmElementsPipeline_Smoke)
+{
+  CheckPipeline(0 /* elementsCount */, 10 /* chunkSize */, 1 /* chunksCount */);
+  CheckPipeline(10 /* elementsCount */, 10 /* chunkSize */, 1 /* chunksCount */);
+  CheckPipeline(1000 /* elementsCount */, 7 /* chunkSize */, 1 /* chunksCount */);
+  CheckPipeline(10000 /* elementsCount */, 64 /* chunkSize */, 5 /* chunksCount */);
+}
+
+UNIT_TEST(OsmElementsPipeline_SourceException)
+{
+  std::istringstream ss;
+  SourceReader reader(ss);
+  ProcessorOsmElementsCounter source(25 /* count */, true /* throwAtEnd */);
+  OsmElementsPipeline pipeline(source, reader, 10 /* chunkSize */, 4 /* chunksCount */);
+
+  size_t count = 0;
+  std::vector<OsmElement> elements;
+  TEST_ANY_THROW(
+      {
+        while (pipeline.Pop(elements))
+        {
+          count += elements.size();
+          pipeline.Recycle(std::move(elements));
+        }
+      },
+      ());
+  // Chunks decoded before the failure are still delivered.
+  TEST_EQUAL(count, 20, ());
+}
+
+UNIT_TEST(OsmElementsPipeline_StopWithoutConsuming)
+{
+  std::istringstream ss;
+  SourceReader reader(ss);
+  ProcessorOsmElementsCounter source(1000 /* count */, false /* throwAtEnd */);
+  // The reader is blocked on the free list and must be stopped by the destructor.
+  OsmElementsPipeline pipeline(source, reader, 10 /* chunkSize */, 2 /* chunksCount */);
+  std::vector<OsmElement> elements;
+  TEST(pipeline.Pop(elements), ());
+}
+}  // namespace osm_elements_pipeline_tests
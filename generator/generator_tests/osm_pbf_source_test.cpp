@@ -0,0 +1,290 @@
+#include "testing/testing.hpp"
+
+#include "generator/osm_element.hpp"
+#include "generator/osm_pbf_source.hpp"
+#include "generator/osm_source.hpp"
+
+#include "coding/zlib.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace osm_pbf_source_test
+{
+using namespace generator;
+using std::string, std::string_view, std::vector;
+
+// Tiny protobuf encoder to produce test PBF streams in place.
+class ProtobufWriter
+{
+public:
+  void VarUInt(uint32_t tag, uint64_t v)
+  {
+    Raw((uint64_t{tag} << 3) | 0);
+    Raw(v);
+  }
+
+  void VarSInt(uint32_t tag, int64_t v) { VarUInt(tag, ZigZag(v)); }
+
+  void Bytes(uint32_t tag, string_view s)
+  {
+    Raw((uint64_t{tag} << 3) | 2);
+    Raw(s.size());
+    m_buffer.append(s);
+  }
+
+  void PackedUInt(uint32_t tag, vector<uint64_t> const & values)
+  {
+    ProtobufWriter packed;
+    for (auto const v : values)
+      packed.Raw(v);
+    Bytes(tag, packed.Data());
+  }
+
+  void PackedSInt(uint32_t tag, vector<int64_t> const & values)
+  {
+    ProtobufWriter packed;
+    for (auto const v : values)
+      packed.Raw(ZigZag(v));
+    Bytes(tag, packed.Data());
+  }
+
+  string const & Data() const { return m_buffer; }
+
+private:
+  static uint64_t ZigZag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+
+  void Raw(uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      m_buffer.push_back(static_cast<char>((v & 0x7F) | 0x80));
+      v >>= 7;
+    }
+    m_buffer.push_back(static_cast<char>(v));
+  }
+
+  string m_buffer;
+};
+
+void AppendBlob(string & file, string_view type, string const & block, bool compress)
+{
+  ProtobufWriter blob;
+  if (compress)
+  {
+    string compressed;
+    coding::ZLib::Deflate const deflate(coding::ZLib::Deflate::Format::ZLib,
+                                        coding::ZLib::Deflate::Level::BestCompression);
+    TEST(deflate(block, std::back_inserter(compressed)), ());
+    blob.VarUInt(2 /* raw_size */, block.size());
+    blob.Bytes(3 /* zlib_data */, compressed);
+  }
+  else
+  {
+    blob.Bytes(1 /* raw */, block);
+  }
+
+  ProtobufWriter header;
+  header.Bytes(1 /* type */, type);
+  header.VarUInt(3 /* datasize */, blob.Data().size());
+
+  auto const size = static_cast<uint32_t>(header.Data().size());
+  file.push_back(static_cast<char>(size >> 24));
+  file.push_back(static_cast<char>(size >> 16));
+  file.push_back(static_cast<char>(size >> 8));
+  file.push_back(static_cast<char>(size));
+  file += header.Data();
+  file += blob.Data();
+}
+
+string MakeHeaderBlock(vector<string> const & requiredFeatures)
+{
+  ProtobufWriter header;
+  for (auto const & feature : requiredFeatures)
+    header.Bytes(4 /* required_features */, feature);
+  header.Bytes(16 /* writingprogram */, "test");
+  return header.Data();
+}
+
+string MakeStringTable(vector<string> const & strings)
+{
+  ProtobufWriter table;
+  for (auto const & s : strings)
+    table.Bytes(1 /* s */, s);
+  return table.Data();
+}
+
+// 0: "", 1: "amenity", 2: "cafe", 3: "name", 4: "Foo", 5: "highway", 6: "residential", 7: "outer",
+// 8: "type", 9: "multipolygon".
+string MakeDataBlock()
+{
+  ProtobufWriter dense;
+  dense.PackedSInt(1 /* id */, {1, 1, 1});
+  // 55.75, 55.76, 55.74 with default granularity 100 nanodegrees.
+  dense.PackedSInt(8 /* lat */, {557500000, 100000, -200000});
+  // 37.61, 37.62, 37.63.
+  dense.PackedSInt(9 /* lon */, {376100000, 100000, 100000});
+  dense.PackedUInt(10 /* keys_vals */, {0, 1, 2, 3, 4, 0, 0});
+
+  ProtobufWriter denseGroup;
+  denseGroup.Bytes(2 /* dense */, dense.Data());
+
+  ProtobufWriter way;
+  way.VarUInt(1 /* id */, 10);
+  way.PackedUInt(2 /* keys */, {5});
+  way.PackedUInt(3 /* vals */, {6});
+  way.PackedSInt(8 /* refs */, {1, 1, 1, -2});
+
+  ProtobufWriter wayGroup;
+  wayGroup.Bytes(3 /* ways */, way.Data());
+
+  ProtobufWriter relation;
+  relation.VarUInt(1 /* id */, 20);
+  relation.PackedUInt(2 /* keys */, {8});
+  relation.PackedUInt(3 /* vals */, {9});
+  relation.PackedUInt(8 /* roles_sid */, {7, 0});
+  relation.PackedSInt(9 /* memids */, {10, -9});
+  relation.PackedUInt(10 /* types */, {1, 0});
+
+  ProtobufWriter relationGroup;
+  relationGroup.Bytes(4 /* relations */, relation.Data());
+
+  ProtobufWriter block;
+  block.Bytes(1 /* stringtable */,
+              MakeStringTable({"", "amenity", "cafe", "name", "Foo", "highway", "residential", "outer", "type",
+                               "multipolygon"}));
+  block.Bytes(2 /* primitivegroup */, denseGroup.Data());
+  block.Bytes(2 /* primitivegroup */, wayGroup.Data());
+  block.Bytes(2 /* primitivegroup */, relationGroup.Data());
+  return block.Data();
+}
+
+// Non-dense node with a custom granularity and offsets.
+string MakeNodeBlock()
+{
+  ProtobufWriter node;
+  node.VarSInt(1 /* id */, 4);
+  node.PackedUInt(2 /* keys */, {1});
+  node.PackedUInt(3 /* vals */, {2});
+  node.VarSInt(8 /* lat */, 1000000);
+  node.VarSInt(9 /* lon */, -1000000);
+
+  ProtobufWriter group;
+  group.Bytes(1 /* nodes */, node.Data());
+
+  ProtobufWriter block;
+  block.Bytes(1 /* stringtable */, MakeStringTable({"", "place", "city"}));
+  block.Bytes(2 /* primitivegroup */, group.Data());
+  block.VarUInt(17 /* granularity */, 1000);
+  block.VarUInt(19 /* lat_offset */, 10000000000);
+  block.VarUInt(20 /* lon_offset */, 20000000000);
+  return block.Data();
+}
+
+vector<OsmElement> ReadPbf(string const & data, size_t threadsCount)
+{
+  std::istringstream ss(data);
+  SourceReader reader(ss);
+
+  vector<OsmElement> elements;
+  ProcessOsmElementsFromPbf(reader, threadsCount, [&elements](OsmElement && e) { elements.push_back(std::move(e)); });
+  return elements;
+}
+
+UNIT_TEST(OSM_PBF_Source_ReadAllEntities)
+{
+  string file;
+  AppendBlob(file, "OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6", "DenseNodes"}), false /* compress */);
+  AppendBlob(file, "OSMData", MakeDataBlock(), true /* compress */);
+  AppendBlob(file, "OSMData", MakeNodeBlock(), false /* compress */);
+
+  for (size_t threadsCount : {1, 2, 4})
+  {
+    auto const elements = ReadPbf(file, threadsCount);
+    TEST_EQUAL(elements.size(), 6, (elements));
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+      TEST(elements[i].IsNode(), (elements[i]));
+      TEST_EQUAL(elements[i].m_id, i + 1, ());
+    }
+    TEST_ALMOST_EQUAL_ABS(elements[0].m_lat, 55.75, 1e-9, ());
+    TEST_ALMOST_EQUAL_ABS(elements[0].m_lon, 37.61, 1e-9, ());
+    TEST_ALMOST_EQUAL_ABS(elements[1].m_lat, 55.76, 1e-9, ());
+    TEST_ALMOST_EQUAL_ABS(elements[2].m_lat, 55.74, 1e-9, ());
+    TEST_ALMOST_EQUAL_ABS(elements[2].m_lon, 37.63, 1e-9, ());
+    TEST(elements[0].Tags().empty(), ());
+    TEST_EQUAL(elements[1].Tags().size(), 2, ());
+    TEST(elements[1].HasTag("amenity", "cafe"), ());
+    TEST(elements[1].HasTag("name", "Foo"), ());
+    TEST(elements[2].Tags().empty(), ());
+
+    auto const & way = elements[3];
+    TEST(way.IsWay(), (way));
+    TEST_EQUAL(way.m_id, 10, ());
+    TEST_EQUAL(way.Nodes(), vector<uint64_t>({1, 2, 3, 1}), ());
+    TEST(way.HasTag("highway", "residential"), ());
+
+    auto const & relation = elements[4];
+    TEST(relation.IsRelation(), (relation));
+    TEST_EQUAL(relation.m_id, 20, ());
+    TEST(relation.HasTag("type", "multipolygon"), ());
+    TEST_EQUAL(relation.Members().size(), 2, ());
+    TEST(relation.Members()[0] == OsmElement::Member(10, OsmElement::EntityType::Way, "outer"), ());
+    TEST(relation.Members()[1] == OsmElement::Member(1, OsmElement::EntityType::Node, ""), ());
+
+    auto const & node = elements[5];
+    TEST(node.IsNode(), (node));
+    TEST_EQUAL(node.m_id, 4, ());
+    TEST_ALMOST_EQUAL_ABS(node.m_lat, 11.0, 1e-9, ());
+    TEST_ALMOST_EQUAL_ABS(node.m_lon, 19.0, 1e-9, ());
+    TEST(node.HasTag("place", "city"), ());
+  }
+}
+
+UNIT_TEST(OSM_PBF_Source_ManyBlocksKeepOrder)
+{
+  string file;
+  AppendBlob(file, "OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6"}), true /* compress */);
+  size_t constexpr kBlocksCount = 50;
+  for (size_t i = 0; i < kBlocksCount; ++i)
+  {
+    ProtobufWriter dense;
+    dense.PackedSInt(1 /* id */, {static_cast<int64_t>(i) + 1});
+    dense.PackedSInt(8 /* lat */, {0});
+    dense.PackedSInt(9 /* lon */, {0});
+
+    ProtobufWriter group;
+    group.Bytes(2 /* dense */, dense.Data());
+
+    ProtobufWriter block;
+    block.Bytes(1 /* stringtable */, MakeStringTable({""}));
+    block.Bytes(2 /* primitivegroup */, group.Data());
+    AppendBlob(file, "OSMData", block.Data(), i % 2 == 0 /* compress */);
+  }
+
+  auto const elements = ReadPbf(file, 3 /* threadsCount */);
+  TEST_EQUAL(elements.size(), kBlocksCount, ());
+  for (size_t i = 0; i < elements.size(); ++i)
+    TEST_EQUAL(elements[i].m_id, i + 1, ());
+}
+
+UNIT_TEST(OSM_PBF_Source_Errors)
+{
+  {
+    string file;
+    AppendBlob(file, "OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6", "HistoricalInformation"}), false /* compress */);
+    TEST_ANY_THROW(ReadPbf(file, 2 /* threadsCount */), ());
+  }
+  {
+    string file;
+    AppendBlob(file, "OSMData", MakeDataBlock(), true /* compress */);
+    file.resize(file.size() - 10);
+    TEST_ANY_THROW(ReadPbf(file, 2 /* threadsCount */), ());
+  }
+}
+}  // namespace osm_pbf_source_test
@@ -6,6 +6,7 @@
 #include "generator/cities_boundaries_builder.hpp"
 #include "generator/cities_ids_builder.hpp"
 #include "generator/city_roads_generator.hpp"
+#include "generator/contraction_hierarchy_generator.hpp"
 #include "generator/descriptions_section_builder.hpp"
 #include "generator/dumper.hpp"
 #include "generator/feature_builder.hpp"
@@ -73,7 +74,7 @@ DEFINE_bool(emit_coasts, false, "Push coasts features from intermediate file to
 
 // Generator settings and paths.
 DEFINE_string(osm_file_name, "", "Input osm area file.");
-DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m].");
+DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m, pbf].");
 DEFINE_string(data_path, "", GetDataPathHelp());
 DEFINE_string(user_resource_path, "", "User defined resource path for classificator.txt and etc.");
 DEFINE_string(intermediate_data_path, "", "Path to stored intermediate data.");
@@ -82,7 +83,7 @@ DEFINE_string(cache_path, "",
               "If 'cache_path' is empty, caches are stored to 'intermediate_data_path'.");
 DEFINE_string(output, "", "File name for process (without 'mwm' ext).");
 DEFINE_bool(preload_cache, false, "Preload all ways and relations cache.");
-DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem.");
+DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem, compact.");
 DEFINE_uint64(planet_version, base::SecondsSinceEpoch(), "Version as seconds since epoch, by default - now.");
 
 // Preprocessing and feature generator.
@@ -91,6 +92,8 @@ DEFINE_bool(generate_features, false, "2nd pass - generate intermediate features
 DEFINE_bool(generate_geometry, false, "3rd pass - split and simplify geometry and triangles for features.");
 DEFINE_bool(generate_index, false, "4rd pass - generate index.");
 DEFINE_bool(generate_search_index, false, "5th pass - generate search index.");
+DEFINE_uint64(search_index_memory_limit_mb, 2048,
+              "Memory limit for search index tokens, the rest is sorted on disk. Zero means no limit.");
 DEFINE_bool(generate_cities_boundaries, false, "Generate the cities boundaries section");
 DEFINE_string(cities_boundaries_data, "", "File with cities boundaries");
 
@@ -111,6 +114,8 @@ DEFINE_string(addresses_path, "", "Path to addresses directory. If set, adds add
 // Routing.
 DEFINE_bool(make_routing_index, false, "Make sections with the routing information.");
 DEFINE_bool(make_cross_mwm, false, "Make section for cross mwm routing (for dynamic indexed routing).");
+DEFINE_bool(make_contraction_hierarchy, false,
+            "Make section with contraction hierarchy for fast car routing inside one mwm.");
 DEFINE_bool(make_transit_cross_mwm, false, "Make section for cross mwm transit routing.");
 DEFINE_bool(make_transit_cross_mwm_experimental, false,
             "Experimental parameter. If set the new version of transit cross-mwm section will be "
@@ -243,6 +248,7 @@ MAIN_WITH_ERROR_HANDLING([](int argc, char ** argv)
   genInfo.m_complexHierarchyFilename = FLAGS_complex_hierarchy_data;
   genInfo.m_isolinesDir = FLAGS_isolines_path;
   genInfo.m_addressesDir = FLAGS_addresses_path;
+  genInfo.m_searchIndexMemoryLimit = FLAGS_search_index_memory_limit_mb * 1024 * 1024;
 
   // Use merged style.
   GetStyleReader().SetCurrentStyle(MapStyleMerged);
@@ -253,7 +259,7 @@ MAIN_WITH_ERROR_HANDLING([](int argc, char ** argv)
   if (FLAGS_preprocess)
   {
     LOG(LINFO, ("Generating intermediate data ...."));
-    if (!GenerateIntermediateData(genInfo))
+    if (!GenerateIntermediateData(genInfo, threadsCount))
       return EXIT_FAILURE;
   }
 
@@ -283,9 +289,9 @@ MAIN_WITH_ERROR_HANDLING([](int argc, char ** argv)
 
   // Load mwm tree only if we need it
   std::unique_ptr<storage::CountryParentGetter> countryParentGetter;
-  if (FLAGS_make_routing_index || FLAGS_make_cross_mwm || FLAGS_make_transit_cross_mwm ||
-      FLAGS_make_transit_cross_mwm_experimental || !FLAGS_uk_postcodes_dataset.empty() ||
-      !FLAGS_us_postcodes_dataset.empty())
+  if (FLAGS_make_routing_index || FLAGS_make_cross_mwm || FLAGS_make_contraction_hierarchy ||
+      FLAGS_make_transit_cross_mwm || FLAGS_make_transit_cross_mwm_experimental ||
+      !FLAGS_uk_postcodes_dataset.empty() || !FLAGS_us_postcodes_dataset.empty())
   {
     countryParentGetter = std::make_unique<storage::CountryParentGetter>();
   }
@@ -522,6 +528,20 @@ MAIN_WITH_ERROR_HANDLING([](int argc, char ** argv)
       }
     }
 
+    if (FLAGS_make_contraction_hierarchy)
+    {
+      if (!countryParentGetter)
+      {
+        // All the mwms should use proper VehicleModels.
+        LOG(LCRITICAL, ("Countries file is needed. Please set countries file name (countries.txt). "
+                        "File must be located in data directory."));
+        return EXIT_FAILURE;
+      }
+
+      if (!BuildContractionHierarchySection(path, dataFile, country, *countryParentGetter))
+        LOG(LCRITICAL, ("Error generating contraction hierarchy section for", dataFile));
+    }
+
     // Check !generate_popular_places to avoid mixing, generate_popular_places stage uses the same wiki flags.
     if (!FLAGS_generate_popular_places && !FLAGS_wikipedia_pages.empty())
     {
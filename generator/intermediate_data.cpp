@@ -1,7 +1,14 @@
 #include "generator/intermediate_data.hpp"
 
+#include "coding/byte_stream.hpp"
+#include "coding/varint.hpp"
+
 #include "base/checked_cast.hpp"
+#include "base/stl_helpers.hpp"
+#include "base/timer.hpp"
+#include "base/thread_pool_computational.hpp"
 
+#include <deque>
 #include <execution>
 #include <future>
 
@@ -14,6 +21,29 @@ namespace
 size_t const kFlushCount = 1024;
 double const kValueOrder = 1e7;
 string const kShortExtension = ".short";
+string const kCompactExtension = ".compact";
+string const kCompactIndexExtension = ".compact.idx";
+
+// Points count in one block of the compact storage. A lookup decodes half of a block on average.
+size_t constexpr kCompactBlockSize = 128;
+// Points count in one shard of the compact storage, which is sorted and encoded by one worker.
+size_t constexpr kCompactShardSize = 1 << 20;
+
+struct CompactStorageHeader
+{
+  uint64_t m_pointsCount = 0;
+  uint64_t m_blocksCount = 0;
+};
+static_assert(std::is_trivially_copyable<CompactStorageHeader>::value, "");
+
+struct CompactBlock
+{
+  uint64_t m_firstId = 0;
+  // Offset of the block in the data file. The block ends where the next one starts.
+  uint64_t m_offset = 0;
+};
+static_assert(sizeof(CompactBlock) == 16, "Invalid structure size");
+static_assert(std::is_trivially_copyable<CompactBlock>::value, "");
 
 void ToLatLon(double lat, double lon, LatLon & ll)
 {
@@ -76,6 +106,37 @@ public:
     return ret;
   }
 
+  void GetPoints(std::vector<uint64_t> const & sortedIds, std::vector<NodePoint> & points) const override
+  {
+    ASSERT(std::is_sorted(sortedIds.begin(), sortedIds.end()), ());
+    points.assign(sortedIds.size(), {});
+
+    // The file is advised as random, so the kernel doesn't read ahead on faults. Request all the pages
+    // of the batch in advance, merging close ranges, to let the kernel issue the reads in parallel
+    // instead of faulting them one by one.
+    uint64_t constexpr kMaxGap = 64 * 1024;
+    for (size_t begin = 0; begin < sortedIds.size();)
+    {
+      size_t end = begin + 1;
+      while (end < sortedIds.size() && (sortedIds[end] - sortedIds[end - 1]) * sizeof(LatLon) <= kMaxGap)
+        ++end;
+
+      uint64_t const pos = sortedIds[begin] * sizeof(LatLon);
+      uint64_t const size = (sortedIds[end - 1] - sortedIds[begin] + 1) * sizeof(LatLon);
+      if (pos + size <= m_mmapReader.Size())
+        m_mmapReader.Prefetch(pos, size);
+      begin = end;
+    }
+
+    auto const * data = reinterpret_cast<LatLon const *>(m_mmapReader.Data());
+    uint64_t const count = m_mmapReader.Size() / sizeof(LatLon);
+    for (size_t i = 0; i < sortedIds.size(); ++i)
+    {
+      if (sortedIds[i] < count)
+        points[i].m_found = FromLatLon(data[sortedIds[i]], points[i].m_lat, points[i].m_lon);
+    }
+  }
+
 private:
   MmapReader m_mmapReader;
 };
@@ -284,8 +345,286 @@ public:
 private:
   FileWriter m_fileWriter;
 };
+
+// Stores points sorted by id in blocks of kCompactBlockSize. The first point of a block is stored
+// as {id, lat, lon} varints, the rest as varint deltas from the previous point. Consecutive OSM nodes
+// usually have close ids and coordinates, so a point takes a few bytes instead of 8 bytes per every
+// id up to the max one in the raw storage or a hash map entry in the map storage.
+// Shards of kCompactShardSize points are sorted and encoded on worker threads and appended
+// to the data file in the input order. Input must be sorted by node id between shards,
+// which holds for planet dumps and extracts.
+class CompactPointStorageWriter : public PointStorageWriterBase
+{
+public:
+  CompactPointStorageWriter(string const & name, size_t threadsCount)
+    : m_dataWriter(name + kCompactExtension)
+    , m_indexWriter(name + kCompactIndexExtension)
+    , m_maxPendingShards(2 * std::max<size_t>(threadsCount, 1))
+    , m_pool(std::max<size_t>(threadsCount, 1))
+  {
+    m_shard.reserve(kCompactShardSize);
+    // Placeholder, the header is rewritten in the destructor.
+    CompactStorageHeader const header;
+    m_indexWriter.Write(&header, sizeof(header));
+  }
+
+  ~CompactPointStorageWriter() noexcept(false) override
+  {
+    SubmitShard();
+    while (!m_pendingShards.empty())
+      WritePendingShard();
+
+    CompactStorageHeader header;
+    header.m_pointsCount = m_pointsCount;
+    header.m_blocksCount = m_blocksCount;
+    m_indexWriter.Seek(0);
+    m_indexWriter.Write(&header, sizeof(header));
+  }
+
+  // PointStorageWriterInterface overrides:
+  void AddPoint(uint64_t id, double lat, double lon) override
+  {
+    LatLonPos llp;
+    llp.m_pos = id;
+    ToLatLon(lat, lon, llp.m_ll);
+    m_shard.push_back(llp);
+
+    ++m_numProcessedPoints;
+    if (m_shard.size() == kCompactShardSize)
+      SubmitShard();
+  }
+
+private:
+  struct EncodedShard
+  {
+    std::vector<uint8_t> m_data;
+    // Offsets are relative to the shard begin.
+    std::vector<CompactBlock> m_blocks;
+    uint64_t m_pointsCount = 0;
+    uint64_t m_minId = 0;
+    uint64_t m_maxId = 0;
+  };
+
+  static EncodedShard EncodeShard(std::vector<LatLonPos> & points)
+  {
+    // Duplicates are not expected, the last one wins like in the other storages.
+    std::stable_sort(points.begin(), points.end(),
+                     [](LatLonPos const & l, LatLonPos const & r) { return l.m_pos < r.m_pos; });
+    auto const last = std::unique(points.rbegin(), points.rend(),
+                                  [](LatLonPos const & l, LatLonPos const & r) { return l.m_pos == r.m_pos; });
+    points.erase(points.begin(), last.base());
+
+    EncodedShard shard;
+    shard.m_pointsCount = points.size();
+    shard.m_minId = points.front().m_pos;
+    shard.m_maxId = points.back().m_pos;
+    // Good estimation for the real data.
+    shard.m_data.reserve(points.size() * 6);
+
+    PushBackByteSink<std::vector<uint8_t>> sink(shard.m_data);
+    for (size_t begin = 0; begin < points.size(); begin += kCompactBlockSize)
+    {
+      size_t const end = std::min(begin + kCompactBlockSize, points.size());
+      shard.m_blocks.push_back({points[begin].m_pos, shard.m_data.size()});
+
+      WriteVarUint(sink, static_cast<uint32_t>(end - begin));
+      WriteVarUint(sink, points[begin].m_pos);
+      WriteVarInt(sink, points[begin].m_ll.m_lat);
+      WriteVarInt(sink, points[begin].m_ll.m_lon);
+      for (size_t i = begin + 1; i < end; ++i)
+      {
+        WriteVarUint(sink, points[i].m_pos - points[i - 1].m_pos);
+        WriteVarInt(sink, static_cast<int64_t>(points[i].m_ll.m_lat) - points[i - 1].m_ll.m_lat);
+        WriteVarInt(sink, static_cast<int64_t>(points[i].m_ll.m_lon) - points[i - 1].m_ll.m_lon);
+      }
+    }
+
+    return shard;
+  }
+
+  void SubmitShard()
+  {
+    if (m_shard.empty())
+      return;
+
+    while (m_pendingShards.size() >= m_maxPendingShards)
+      WritePendingShard();
+
+    m_pendingShards.emplace_back(
+        m_pool.Submit([points = std::move(m_shard)]() mutable { return EncodeShard(points); }));
+    m_shard = {};
+    m_shard.reserve(kCompactShardSize);
+  }
+
+  void WritePendingShard()
+  {
+    auto const shard = m_pendingShards.front().get();
+    m_pendingShards.pop_front();
+
+    CHECK(m_blocksCount == 0 || shard.m_minId > m_maxId,
+          ("Compact nodes storage requires input sorted by node id. Shard [", shard.m_minId, ",", shard.m_maxId,
+           "] follows node", m_maxId, ". Use raw or map nodes storage for unsorted input."));
+    m_maxId = shard.m_maxId;
+
+    uint64_t const shardOffset = m_dataWriter.Pos();
+    m_dataWriter.Write(shard.m_data.data(), shard.m_data.size());
+    for (auto block : shard.m_blocks)
+    {
+      block.m_offset += shardOffset;
+      m_indexWriter.Write(&block, sizeof(block));
+    }
+
+    m_pointsCount += shard.m_pointsCount;
+    m_blocksCount += shard.m_blocks.size();
+  }
+
+  FileWriter m_dataWriter;
+  FileWriter m_indexWriter;
+  std::vector<LatLonPos> m_shard;
+  size_t const m_maxPendingShards;
+  std::deque<std::future<EncodedShard>> m_pendingShards;
+  uint64_t m_pointsCount = 0;
+  uint64_t m_blocksCount = 0;
+  uint64_t m_maxId = 0;
+  // Should be the last member to join the workers before the rest is destroyed.
+  base::ComputationalThreadPool m_pool;
+};
+
+class CompactPointStorageReader : public PointStorageReaderInterface
+{
+public:
+  explicit CompactPointStorageReader(string const & name) : m_indexReader(name + kCompactIndexExtension)
+  {
+    CHECK_GREATER_OR_EQUAL(m_indexReader.Size(), sizeof(CompactStorageHeader), ("Compact nodes index is broken"));
+    m_indexReader.Read(0, &m_header, sizeof(m_header));
+    CHECK_EQUAL(m_indexReader.Size(), sizeof(m_header) + m_header.m_blocksCount * sizeof(CompactBlock),
+                ("Compact nodes index is broken"));
+
+    // An empty file can't be mapped.
+    if (m_header.m_blocksCount != 0)
+    {
+      m_dataReader = std::make_unique<MmapReader>(name + kCompactExtension, MmapReader::Advice::Random);
+      m_blocks = reinterpret_cast<CompactBlock const *>(m_indexReader.Data() + sizeof(m_header));
+    }
+
+    LOG(LINFO, ("Compact nodes storage:", m_header.m_pointsCount, "points in", m_header.m_blocksCount, "blocks,",
+                m_dataReader ? m_dataReader->Size() : 0, "bytes"));
+  }
+
+  // PointStorageReaderInterface overrides:
+  bool GetPoint(uint64_t id, double & lat, double & lon) const override
+  {
+    LatLon ll;
+    if (!FindPoint(id, ll))
+      return false;
+
+    bool const ret = FromLatLon(ll, lat, lon);
+    if (!ret)
+      LOG(LERROR, ("Inconsistent CompactPointStorageReader. Node with id =", id, "must exist but was not found"));
+    return ret;
+  }
+
+  void GetPoints(std::vector<uint64_t> const & sortedIds, std::vector<NodePoint> & points) const override
+  {
+    ASSERT(std::is_sorted(sortedIds.begin(), sortedIds.end()), ());
+    points.assign(sortedIds.size(), {});
+
+    // Every block is decoded once for all the ids it contains.
+    size_t i = 0;
+    while (i < sortedIds.size())
+    {
+      auto const block = FindBlock(sortedIds[i]);
+      if (block == nullptr)
+      {
+        ++i;
+        continue;
+      }
+
+      BlockDecoder decoder(m_dataReader->Data() + block->m_offset);
+      uint64_t const nextBlockId =
+          block + 1 == m_blocks + m_header.m_blocksCount ? std::numeric_limits<uint64_t>::max() : (block + 1)->m_firstId;
+      for (; i < sortedIds.size() && sortedIds[i] < nextBlockId; ++i)
+      {
+        LatLon ll;
+        if (decoder.Find(sortedIds[i], ll))
+          points[i].m_found = FromLatLon(ll, points[i].m_lat, points[i].m_lon);
+      }
+    }
+  }
+
+private:
+  // Sequential decoder of a block, which can look up ascending ids.
+  class BlockDecoder
+  {
+  public:
+    explicit BlockDecoder(uint8_t const * data) : m_src(data)
+    {
+      m_count = ReadVarUint<uint32_t>(m_src);
+      m_id = ReadVarUint<uint64_t>(m_src);
+      m_lat = ReadVarInt<int64_t>(m_src);
+      m_lon = ReadVarInt<int64_t>(m_src);
+      m_decoded = 1;
+    }
+
+    bool Find(uint64_t id, LatLon & ll)
+    {
+      while (m_id < id && m_decoded < m_count)
+      {
+        m_id += ReadVarUint<uint64_t>(m_src);
+        m_lat += ReadVarInt<int64_t>(m_src);
+        m_lon += ReadVarInt<int64_t>(m_src);
+        ++m_decoded;
+      }
+
+      if (m_id != id)
+        return false;
+
+      ll.m_lat = static_cast<int32_t>(m_lat);
+      ll.m_lon = static_cast<int32_t>(m_lon);
+      return true;
+    }
+
+  private:
+    ArrayByteSource m_src;
+    uint32_t m_count = 0;
+    uint32_t m_decoded = 0;
+    uint64_t m_id = 0;
+    int64_t m_lat = 0;
+    int64_t m_lon = 0;
+  };
+
+  // Returns the block, which may contain |id|, or nullptr.
+  CompactBlock const * FindBlock(uint64_t id) const
+  {
+    auto const blocksEnd = m_blocks + m_header.m_blocksCount;
+    auto const it = std::upper_bound(m_blocks, blocksEnd, id,
+                                     [](uint64_t id, CompactBlock const & block) { return id < block.m_firstId; });
+    return it == m_blocks ? nullptr : it - 1;
+  }
+
+  bool FindPoint(uint64_t id, LatLon & ll) const
+  {
+    auto const block = FindBlock(id);
+    return block != nullptr && BlockDecoder(m_dataReader->Data() + block->m_offset).Find(id, ll);
+  }
+
+  MmapReader m_indexReader;
+  std::unique_ptr<MmapReader> m_dataReader;
+  CompactStorageHeader m_header;
+  CompactBlock const * m_blocks = nullptr;
+};
 }  // namespace
 
+// PointStorageReaderInterface ---------------------------------------------------------------------
+void PointStorageReaderInterface::GetPoints(std::vector<uint64_t> const & sortedIds,
+                                            std::vector<NodePoint> & points) const
+{
+  ASSERT(std::is_sorted(sortedIds.begin(), sortedIds.end()), ());
+  points.assign(sortedIds.size(), {});
+  for (size_t i = 0; i < sortedIds.size(); ++i)
+    points[i].m_found = GetPoint(sortedIds[i], points[i].m_lat, points[i].m_lon);
+}
+
 // IndexFileReader ---------------------------------------------------------------------------------
 IndexFileReader::IndexFileReader(string const & name)
 {
@@ -418,6 +757,47 @@ IntermediateDataReader::IntermediateDataReader(IntermediateDataObjectsCache::All
   , m_relationToRelations(objs.GetOrCreateIndexReader(info.GetCacheFileName(RELATIONS_FILE, ID2REL_EXT)))
 {}
 
+bool IntermediateDataReader::GetNode(Key id, double & y, double & x) const
+{
+  auto const it = std::lower_bound(m_prefetchedIds.begin(), m_prefetchedIds.end(), id);
+  if (it != m_prefetchedIds.end() && *it == id)
+  {
+    auto const & point = m_prefetchedPoints[std::distance(m_prefetchedIds.begin(), it)];
+    if (point.m_found)
+    {
+      y = point.m_lat;
+      x = point.m_lon;
+      return true;
+    }
+  }
+
+  // Not prefetched ids and missing nodes (to log them) go to the storage.
+  return m_nodes.GetPoint(id, y, x);
+}
+
+void IntermediateDataReader::PrefetchNodes(std::vector<uint64_t> ids)
+{
+  // A batch pays off when the nodes storage is read from disk. When the storage turns out to be in memory,
+  // sorting and searching the batch cost more than the single lookups, so only every kProbeInterval-th
+  // batch is resolved to notice when it gets out of memory.
+  uint32_t constexpr kProbeInterval = 64;
+  uint64_t constexpr kInMemoryNsPerNode = 250;
+
+  m_prefetchedIds.clear();
+  if (m_prefetchesToSkip != 0)
+  {
+    --m_prefetchesToSkip;
+    return;
+  }
+
+  base::SortUnique(ids);
+  base::Timer const timer;
+  m_nodes.GetPoints(ids, m_prefetchedPoints);
+  if (!ids.empty() && timer.ElapsedNanoseconds() < kInMemoryNsPerNode * ids.size())
+    m_prefetchesToSkip = kProbeInterval - 1;
+  m_prefetchedIds = std::move(ids);
+}
+
 // IntermediateDataWriter --------------------------------------------------------------------------
 IntermediateDataWriter::IntermediateDataWriter(PointStorageWriterInterface & nodes, feature::GenerateInfo const & info)
   : m_nodes(nodes)
@@ -461,18 +841,21 @@ std::unique_ptr<PointStorageReaderInterface> CreatePointStorageReader(feature::G
   case feature::GenerateInfo::NodeStorageType::File: return std::make_unique<RawFilePointStorageMmapReader>(name);
   case feature::GenerateInfo::NodeStorageType::Index: return std::make_unique<MapFilePointStorageReader>(name);
   case feature::GenerateInfo::NodeStorageType::Memory: return std::make_unique<RawMemPointStorageReader>(name);
+  case feature::GenerateInfo::NodeStorageType::Compact: return std::make_unique<CompactPointStorageReader>(name);
   }
   UNREACHABLE();
 }
 
 std::unique_ptr<PointStorageWriterInterface> CreatePointStorageWriter(feature::GenerateInfo::NodeStorageType type,
-                                                                      string const & name)
+                                                                      string const & name, size_t threadsCount)
 {
   switch (type)
   {
   case feature::GenerateInfo::NodeStorageType::File: return std::make_unique<RawFilePointStorageWriter>(name);
   case feature::GenerateInfo::NodeStorageType::Index: return std::make_unique<MapFilePointStorageWriter>(name);
   case feature::GenerateInfo::NodeStorageType::Memory: return std::make_unique<RawMemPointStorageWriter>(name);
+  case feature::GenerateInfo::NodeStorageType::Compact:
+    return std::make_unique<CompactPointStorageWriter>(name, threadsCount);
   }
   UNREACHABLE();
 }
@@ -58,11 +58,24 @@ public:
   virtual uint64_t GetNumProcessedPoints() const = 0;
 };
 
+// A node resolved by PointStorageReaderInterface::GetPoints.
+struct NodePoint
+{
+  double m_lat = 0.0;
+  double m_lon = 0.0;
+  bool m_found = false;
+};
+
 class PointStorageReaderInterface
 {
 public:
   virtual ~PointStorageReaderInterface() = default;
   virtual bool GetPoint(uint64_t id, double & lat, double & lon) const = 0;
+
+  // Resolves a batch of nodes: |points|[i] is set for |sortedIds|[i]. |sortedIds| must be sorted and unique,
+  // so that the storage is swept once in the order of its layout instead of jumping to a random place
+  // for every node. The default implementation only calls GetPoint() in that order.
+  virtual void GetPoints(std::vector<uint64_t> const & sortedIds, std::vector<NodePoint> & points) const;
 };
 
 class IndexFileReader
@@ -255,7 +268,12 @@ public:
   IntermediateDataReader(IntermediateDataObjectsCache::AllocatedObjects & objs, feature::GenerateInfo const & info);
 
   /// \a x \a y are in mercator projection coordinates. @see IntermediateDataWriter::AddNode.
-  bool GetNode(Key id, double & y, double & x) const override { return m_nodes.GetPoint(id, y, x); }
+  bool GetNode(Key id, double & y, double & x) const override;
+
+  // Resolves |ids| with one PointStorageReaderInterface::GetPoints call and keeps the result
+  // until the next call, so that GetNode() for these ids doesn't touch the nodes storage.
+  // Skips most of the batches while the storage is fast enough to be read node by node.
+  void PrefetchNodes(std::vector<uint64_t> ids);
 
   bool GetWay(Key id, WayElement & e) override { return m_ways.Read(id, e); }
   bool GetRelation(Key id, RelationElement & e) override { return m_relations.Read(id, e); }
@@ -309,6 +327,9 @@ private:
   };
 
   PointStorageReaderInterface const & m_nodes;
+  std::vector<uint64_t> m_prefetchedIds;
+  std::vector<NodePoint> m_prefetchedPoints;
+  uint32_t m_prefetchesToSkip = 0;
   cache::OSMElementCacheReader m_ways;
   cache::OSMElementCacheReader m_relations;
   cache::IndexFileReader const & m_nodeToRelations;
@@ -354,7 +375,8 @@ std::unique_ptr<PointStorageReaderInterface> CreatePointStorageReader(feature::G
                                                                       std::string const & name);
 
 std::unique_ptr<PointStorageWriterInterface> CreatePointStorageWriter(feature::GenerateInfo::NodeStorageType type,
-                                                                      std::string const & name);
+                                                                      std::string const & name,
+                                                                      size_t threadsCount = 1);
 
 class IntermediateData
 {
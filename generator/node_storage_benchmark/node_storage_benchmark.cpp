@@ -0,0 +1,184 @@
+#include "generator/generate_info.hpp"
+#include "generator/intermediate_data.hpp"
+
+#include "base/logging.hpp"
+#include "base/stl_helpers.hpp"
+#include "base/timer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+DEFINE_string(path, "", "Nodes storage file name, as generator_tool makes it: <intermediate_dir>/nodes.dat");
+DEFINE_string(node_storage, "raw", "Nodes storage type: raw, map, mem, compact.");
+DEFINE_uint64(generate_nodes_count, 0,
+              "Write a synthetic storage with nodes 1..N before the benchmark. The planet has about 1.2e10 node ids.");
+DEFINE_uint64(max_node_id, 0, "Max node id of an existing storage to lay synthetic ways over.");
+DEFINE_uint64(ways_count, 1000000, "Synthetic ways count.");
+DEFINE_uint64(way_nodes, 10, "Nodes count of a synthetic way.");
+DEFINE_uint64(chunk_size, 1024, "Ways count resolved with one batch, the same as elements chunk of the generator.");
+DEFINE_string(mode, "both", "single: GetPoint() per node, batch: GetPoints() per chunk, both: single then batch. "
+                            "Drop the page cache before a run to measure cold reads.");
+DEFINE_uint64(seed, 42, "Seed of synthetic ways.");
+
+namespace node_storage_benchmark
+{
+using generator::cache::NodePoint;
+using generator::cache::PointStorageReaderInterface;
+using Way = std::vector<uint64_t>;
+
+double GetLat(uint64_t id)
+{
+  return static_cast<double>(id % 1700000) * 1e-4 - 85.0;
+}
+
+double GetLon(uint64_t id)
+{
+  return static_cast<double>(id % 3500000) * 1e-4 - 175.0 + 1e-7;
+}
+
+void GenerateStorage(feature::GenerateInfo::NodeStorageType type, uint64_t nodesCount)
+{
+  LOG(LINFO, ("Writing", nodesCount, "nodes to", FLAGS_path));
+  base::Timer const timer;
+  auto writer =
+      generator::cache::CreatePointStorageWriter(type, FLAGS_path, std::thread::hardware_concurrency());
+  for (uint64_t id = 1; id <= nodesCount; ++id)
+    writer->AddPoint(id, GetLat(id), GetLon(id));
+  writer.reset();
+  LOG(LINFO, ("Nodes are written in", timer.ElapsedSeconds(), "seconds"));
+}
+
+// Nodes of a way are close to each other, but ways of a chunk are spread over the whole storage.
+std::vector<Way> MakeWays(uint64_t nodesCount)
+{
+  CHECK_GREATER(nodesCount, FLAGS_way_nodes * 3, ());
+  std::mt19937_64 rnd(FLAGS_seed);
+  std::uniform_int_distribution<uint64_t> first(1, nodesCount - FLAGS_way_nodes * 3);
+  std::uniform_int_distribution<uint64_t> step(1, 3);
+
+  std::vector<Way> ways(FLAGS_ways_count);
+  for (auto & way : ways)
+  {
+    uint64_t id = first(rnd);
+    for (uint64_t i = 0; i < FLAGS_way_nodes; ++i)
+    {
+      way.push_back(id);
+      id += step(rnd);
+    }
+  }
+  return ways;
+}
+
+struct Result
+{
+  double m_seconds = 0.0;
+  uint64_t m_found = 0;
+  // Keeps the reads from being optimized out.
+  double m_checksum = 0.0;
+};
+
+Result RunSingle(PointStorageReaderInterface const & reader, std::vector<Way> const & ways)
+{
+  Result result;
+  base::Timer const timer;
+  for (auto const & way : ways)
+  {
+    for (auto const id : way)
+    {
+      double lat = 0.0;
+      double lon = 0.0;
+      if (reader.GetPoint(id, lat, lon))
+      {
+        ++result.m_found;
+        result.m_checksum += lat + lon;
+      }
+    }
+  }
+  result.m_seconds = timer.ElapsedSeconds();
+  return result;
+}
+
+Result RunBatch(PointStorageReaderInterface const & reader, std::vector<Way> const & ways)
+{
+  Result result;
+  base::Timer const timer;
+  std::vector<uint64_t> ids;
+  std::vector<NodePoint> points;
+  for (size_t begin = 0; begin < ways.size(); begin += FLAGS_chunk_size)
+  {
+    size_t const end = std::min(ways.size(), begin + static_cast<size_t>(FLAGS_chunk_size));
+    ids.clear();
+    for (size_t i = begin; i < end; ++i)
+      ids.insert(ids.end(), ways[i].begin(), ways[i].end());
+    base::SortUnique(ids);
+
+    reader.GetPoints(ids, points);
+
+    // Scatter back to the ways like IntermediateDataReader::GetNode() does.
+    for (size_t i = begin; i < end; ++i)
+    {
+      for (auto const id : ways[i])
+      {
+        auto const & point = points[std::distance(ids.begin(), std::lower_bound(ids.begin(), ids.end(), id))];
+        if (point.m_found)
+        {
+          ++result.m_found;
+          result.m_checksum += point.m_lat + point.m_lon;
+        }
+      }
+    }
+  }
+  result.m_seconds = timer.ElapsedSeconds();
+  return result;
+}
+
+void Print(std::string const & mode, Result const & result, uint64_t nodesCount)
+{
+  LOG(LINFO, (mode, ":", result.m_seconds, "seconds,", result.m_seconds * 1e9 / nodesCount, "ns per node,",
+              result.m_found, "of", nodesCount, "found, checksum", result.m_checksum));
+}
+}  // namespace node_storage_benchmark
+
+int main(int argc, char ** argv)
+{
+  using namespace node_storage_benchmark;
+
+  gflags::SetUsageMessage(
+      "Measures resolution of way nodes coordinates with one GetPoint() per node against batched GetPoints().");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_path.empty())
+  {
+    LOG_SHORT(LERROR, ("Nodes storage path is not specified."));
+    return -1;
+  }
+
+  feature::GenerateInfo info;
+  info.SetNodeStorageType(FLAGS_node_storage);
+
+  if (FLAGS_generate_nodes_count != 0)
+    GenerateStorage(info.m_nodeStorageType, FLAGS_generate_nodes_count);
+
+  uint64_t const maxId = FLAGS_generate_nodes_count != 0 ? FLAGS_generate_nodes_count : FLAGS_max_node_id;
+  if (maxId == 0)
+  {
+    LOG_SHORT(LERROR, ("Either generate_nodes_count or max_node_id should be specified."));
+    return -1;
+  }
+
+  auto const reader = generator::cache::CreatePointStorageReader(info.m_nodeStorageType, FLAGS_path);
+  auto const ways = MakeWays(maxId);
+  uint64_t const nodesCount = ways.size() * FLAGS_way_nodes;
+
+  if (FLAGS_mode == "single" || FLAGS_mode == "both")
+    Print("single", RunSingle(*reader, ways), nodesCount);
+  if (FLAGS_mode == "batch" || FLAGS_mode == "both")
+    Print("batch", RunBatch(*reader, ways), nodesCount);
+  return 0;
+}
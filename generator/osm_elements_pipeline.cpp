@@ -0,0 +1,127 @@
+#include "generator/osm_elements_pipeline.hpp"
+
+#include "base/assert.hpp"
+#include "base/timer.hpp"
+
+#include <utility>
+
+namespace generator
+{
+OsmElementsPipeline::OsmElementsPipeline(ProcessorOsmElementsInterface & source, SourceReader const & stream,
+                                         size_t chunkSize, size_t chunksCount)
+  : m_source(source)
+  , m_stream(stream)
+  , m_chunkSize(chunkSize)
+  , m_chunksCount(chunksCount)
+{
+  CHECK_GREATER(m_chunkSize, 0, ());
+  CHECK_GREATER(m_chunksCount, 0, ());
+
+  for (size_t i = 0; i < m_chunksCount; ++i)
+    m_freeChunks.emplace_back(m_chunkSize);
+
+  m_thread = std::thread(&OsmElementsPipeline::Read, this);
+}
+
+OsmElementsPipeline::~OsmElementsPipeline()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_isStopped = true;
+  }
+  m_freeCondition.notify_all();
+  m_thread.join();
+}
+
+bool OsmElementsPipeline::Pop(std::vector<OsmElement> & elements)
+{
+  std::unique_lock lock(m_mutex);
+  base::Timer const timer;
+  m_readyCondition.wait(lock, [this] { return !m_readyChunks.empty() || m_isSourceOver; });
+  m_counters.m_consumerStallNs += timer.ElapsedNanoseconds();
+
+  if (!m_readyChunks.empty())
+  {
+    elements = std::move(m_readyChunks.front());
+    m_readyChunks.pop_front();
+    return true;
+  }
+
+  if (m_exception)
+    std::rethrow_exception(std::exchange(m_exception, nullptr));
+  return false;
+}
+
+void OsmElementsPipeline::Recycle(std::vector<OsmElement> && elements)
+{
+  m_counters.m_processedElements += elements.size();
+  {
+    std::lock_guard lock(m_mutex);
+    m_freeChunks.emplace_back(std::move(elements));
+  }
+  m_freeCondition.notify_one();
+}
+
+size_t OsmElementsPipeline::GetReadyChunksCount() const
+{
+  std::lock_guard lock(m_mutex);
+  return m_readyChunks.size();
+}
+
+void OsmElementsPipeline::Read()
+{
+  try
+  {
+    bool isEnd = false;
+    while (!isEnd)
+    {
+      std::vector<OsmElement> chunk;
+      {
+        std::unique_lock lock(m_mutex);
+        base::Timer const timer;
+        m_freeCondition.wait(lock, [this] { return !m_freeChunks.empty() || m_isStopped; });
+        m_counters.m_readerStallNs += timer.ElapsedNanoseconds();
+
+        if (m_isStopped)
+          return;
+
+        chunk = std::move(m_freeChunks.front());
+        m_freeChunks.pop_front();
+      }
+
+      // Only the last chunk is shorter than m_chunkSize, but a consumer may return any buffer.
+      chunk.resize(m_chunkSize);
+      size_t size = 0;
+      for (; size < m_chunkSize; ++size)
+      {
+        // Keeps capacity of the element vectors from the previous use.
+        chunk[size].Clear();
+        if (!m_source.TryRead(chunk[size]))
+          break;
+      }
+
+      isEnd = size < m_chunkSize;
+      chunk.resize(size);
+      m_counters.m_readElements += size;
+      m_sourcePos = m_stream.Pos();
+
+      {
+        std::lock_guard lock(m_mutex);
+        if (!chunk.empty())
+          m_readyChunks.emplace_back(std::move(chunk));
+        m_isSourceOver = isEnd;
+      }
+      m_readyCondition.notify_one();
+    }
+  }
+  catch (...)
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_exception = std::current_exception();
+      m_isSourceOver = true;
+    }
+    m_readyCondition.notify_one();
+  }
+}
+}  // namespace generator
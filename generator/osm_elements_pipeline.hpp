@@ -0,0 +1,73 @@
+#pragma once
+
+#include "generator/osm_element.hpp"
+#include "generator/osm_source.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace generator
+{
+// Reads and decodes OSM source on a dedicated thread, so that decoding runs concurrently
+// with the consumers (translators).
+// A fixed number of chunks circulates between the reader and the consumers: the reader fills
+// chunks taken from the free list and consumers return them back with Recycle(). It bounds memory
+// and lets elements keep capacity of their nodes/members/tags vectors between reuses.
+class OsmElementsPipeline
+{
+public:
+  struct Counters
+  {
+    std::atomic<uint64_t> m_readElements{0};
+    std::atomic<uint64_t> m_processedElements{0};
+    // Time the reader waited for a free chunk, i.e. consumers are the bottleneck.
+    std::atomic<uint64_t> m_readerStallNs{0};
+    // Time the consumer waited for a decoded chunk, i.e. the reader is the bottleneck.
+    std::atomic<uint64_t> m_consumerStallNs{0};
+  };
+
+  OsmElementsPipeline(ProcessorOsmElementsInterface & source, SourceReader const & stream, size_t chunkSize,
+                      size_t chunksCount);
+  ~OsmElementsPipeline();
+
+  // Blocks until the next decoded chunk is ready and moves it to |elements|.
+  // Returns false when the source is over. Rethrows exceptions of the reader thread.
+  bool Pop(std::vector<OsmElement> & elements);
+  // Returns processed chunk to the free list. Can be called from any thread.
+  void Recycle(std::vector<OsmElement> && elements);
+
+  Counters const & GetCounters() const { return m_counters; }
+  uint64_t GetSourcePos() const { return m_sourcePos; }
+  size_t GetChunksCount() const { return m_chunksCount; }
+  size_t GetReadyChunksCount() const;
+
+private:
+  void Read();
+
+  ProcessorOsmElementsInterface & m_source;
+  SourceReader const & m_stream;
+  size_t const m_chunkSize;
+  size_t const m_chunksCount;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_freeCondition;
+  std::condition_variable m_readyCondition;
+  std::deque<std::vector<OsmElement>> m_freeChunks;
+  std::deque<std::vector<OsmElement>> m_readyChunks;
+  bool m_isSourceOver = false;
+  bool m_isStopped = false;
+  std::exception_ptr m_exception;
+
+  Counters m_counters;
+  std::atomic<uint64_t> m_sourcePos{0};
+
+  std::thread m_thread;
+};
+}  // namespace generator
@@ -0,0 +1,495 @@
+#include "generator/osm_pbf_source.hpp"
+
+#include "coding/zlib.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+
+#include <iterator>
+
+namespace osm
+{
+namespace
+{
+// Hard limits from the format specification.
+uint32_t constexpr kMaxBlobHeaderSize = 64 * 1024;
+uint32_t constexpr kMaxBlobSize = 32 * 1024 * 1024;
+
+// Field numbers from fileformat.proto and osmformat.proto.
+namespace field
+{
+uint32_t constexpr kBlobHeaderType = 1;
+uint32_t constexpr kBlobHeaderDataSize = 3;
+
+uint32_t constexpr kBlobRaw = 1;
+uint32_t constexpr kBlobRawSize = 2;
+uint32_t constexpr kBlobZlibData = 3;
+uint32_t constexpr kBlobLzmaData = 4;
+uint32_t constexpr kBlobLz4Data = 6;
+uint32_t constexpr kBlobZstdData = 7;
+
+uint32_t constexpr kHeaderRequiredFeatures = 4;
+
+uint32_t constexpr kBlockStringTable = 1;
+uint32_t constexpr kBlockPrimitiveGroup = 2;
+uint32_t constexpr kBlockGranularity = 17;
+uint32_t constexpr kBlockLatOffset = 19;
+uint32_t constexpr kBlockLonOffset = 20;
+
+uint32_t constexpr kStringTableString = 1;
+
+uint32_t constexpr kGroupNodes = 1;
+uint32_t constexpr kGroupDense = 2;
+uint32_t constexpr kGroupWays = 3;
+uint32_t constexpr kGroupRelations = 4;
+
+// Node, Way and Relation share the first three field numbers.
+uint32_t constexpr kId = 1;
+uint32_t constexpr kKeys = 2;
+uint32_t constexpr kVals = 3;
+
+uint32_t constexpr kNodeLat = 8;
+uint32_t constexpr kNodeLon = 9;
+
+uint32_t constexpr kDenseId = 1;
+uint32_t constexpr kDenseLat = 8;
+uint32_t constexpr kDenseLon = 9;
+uint32_t constexpr kDenseKeysVals = 10;
+
+uint32_t constexpr kWayRefs = 8;
+
+uint32_t constexpr kRelationRolesSid = 8;
+uint32_t constexpr kRelationMemIds = 9;
+uint32_t constexpr kRelationTypes = 10;
+}  // namespace field
+
+std::string DecompressBlob(std::string_view blob)
+{
+  std::string_view raw;
+  std::string_view zlibData;
+  uint64_t rawSize = 0;
+
+  ProtobufReader reader(blob);
+  while (reader.Next())
+  {
+    switch (reader.Tag())
+    {
+    case field::kBlobRaw: raw = reader.ReadBytes(); break;
+    case field::kBlobRawSize: rawSize = reader.ReadVarUInt(); break;
+    case field::kBlobZlibData: zlibData = reader.ReadBytes(); break;
+    case field::kBlobLzmaData:
+    case field::kBlobLz4Data:
+    case field::kBlobZstdData:
+      MYTHROW(PbfFormatException, ("Only raw and zlib compressed blobs are supported, field:", reader.Tag()));
+    default: reader.Skip();
+    }
+  }
+
+  if (!raw.empty())
+    return std::string(raw);
+
+  if (zlibData.empty())
+    MYTHROW(PbfFormatException, ("Blob has no raw or zlib data. Only zlib compression is supported."));
+  if (rawSize > kMaxBlobSize)
+    MYTHROW(PbfFormatException, ("Blob raw size is too big:", rawSize));
+
+  std::string result;
+  result.reserve(rawSize);
+  coding::ZLib::Inflate const inflate(coding::ZLib::Inflate::Format::ZLib);
+  if (!inflate(zlibData.data(), zlibData.size(), std::back_inserter(result)))
+    MYTHROW(PbfFormatException, ("Can't inflate zlib blob."));
+  if (result.size() != rawSize)
+    MYTHROW(PbfFormatException, ("Inflated blob size", result.size(), "doesn't match raw_size", rawSize));
+  return result;
+}
+
+void CheckHeaderBlock(std::string_view block)
+{
+  ProtobufReader reader(block);
+  while (reader.Next())
+  {
+    if (reader.Tag() != field::kHeaderRequiredFeatures)
+    {
+      reader.Skip();
+      continue;
+    }
+
+    auto const feature = reader.ReadBytes();
+    if (feature != "OsmSchema-V0.6" && feature != "DenseNodes")
+      MYTHROW(PbfFormatException, ("Unsupported required feature:", std::string(feature)));
+  }
+}
+
+class PrimitiveBlockDecoder
+{
+public:
+  explicit PrimitiveBlockDecoder(std::string_view block)
+  {
+    ProtobufReader reader(block);
+    while (reader.Next())
+    {
+      switch (reader.Tag())
+      {
+      case field::kBlockStringTable: ReadStringTable(reader.ReadBytes()); break;
+      case field::kBlockPrimitiveGroup: m_groups.push_back(reader.ReadBytes()); break;
+      case field::kBlockGranularity: m_granularity = reader.ReadVarInt(); break;
+      case field::kBlockLatOffset: m_latOffset = reader.ReadVarInt(); break;
+      case field::kBlockLonOffset: m_lonOffset = reader.ReadVarInt(); break;
+      default: reader.Skip();
+      }
+    }
+  }
+
+  void Decode(std::vector<OsmElement> & elements)
+  {
+    for (auto const group : m_groups)
+    {
+      ProtobufReader reader(group);
+      while (reader.Next())
+      {
+        switch (reader.Tag())
+        {
+        case field::kGroupNodes: DecodeNode(reader.ReadBytes(), elements.emplace_back()); break;
+        case field::kGroupDense: DecodeDenseNodes(reader.ReadBytes(), elements); break;
+        case field::kGroupWays: DecodeWay(reader.ReadBytes(), elements.emplace_back()); break;
+        case field::kGroupRelations: DecodeRelation(reader.ReadBytes(), elements.emplace_back()); break;
+        default: reader.Skip();
+        }
+      }
+    }
+  }
+
+private:
+  void ReadStringTable(std::string_view table)
+  {
+    ProtobufReader reader(table);
+    while (reader.Next())
+    {
+      if (reader.Tag() == field::kStringTableString)
+        m_strings.push_back(reader.ReadBytes());
+      else
+        reader.Skip();
+    }
+  }
+
+  std::string_view GetString(uint64_t index) const
+  {
+    if (index >= m_strings.size())
+      MYTHROW(PbfFormatException, ("String index", index, "is out of string table of size", m_strings.size()));
+    return m_strings[index];
+  }
+
+  double GetLat(int64_t lat) const { return 1e-9 * static_cast<double>(m_latOffset + m_granularity * lat); }
+  double GetLon(int64_t lon) const { return 1e-9 * static_cast<double>(m_lonOffset + m_granularity * lon); }
+
+  void AddTags(std::vector<uint64_t> const & keys, std::vector<uint64_t> const & vals, OsmElement & element) const
+  {
+    if (keys.size() != vals.size())
+      MYTHROW(PbfFormatException, ("Keys and values count mismatch for", element.m_id));
+
+    for (size_t i = 0; i < keys.size(); ++i)
+      element.AddTag(GetString(keys[i]), GetString(vals[i]));
+  }
+
+  void DecodeNode(std::string_view data, OsmElement & element) const
+  {
+    element.m_type = OsmElement::EntityType::Node;
+
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> vals;
+    ProtobufReader reader(data);
+    while (reader.Next())
+    {
+      switch (reader.Tag())
+      {
+      case field::kId: element.m_id = static_cast<uint64_t>(reader.ReadVarSInt()); break;
+      case field::kKeys: reader.ForEachVarUInt([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case field::kVals: reader.ForEachVarUInt([&vals](uint64_t v) { vals.push_back(v); }); break;
+      case field::kNodeLat: element.m_lat = GetLat(reader.ReadVarSInt()); break;
+      case field::kNodeLon: element.m_lon = GetLon(reader.ReadVarSInt()); break;
+      default: reader.Skip();
+      }
+    }
+
+    AddTags(keys, vals, element);
+    element.Validate();
+  }
+
+  void DecodeDenseNodes(std::string_view data, std::vector<OsmElement> & elements) const
+  {
+    std::vector<int64_t> ids;
+    std::vector<int64_t> lats;
+    std::vector<int64_t> lons;
+    std::vector<uint64_t> keysVals;
+    ProtobufReader reader(data);
+    while (reader.Next())
+    {
+      switch (reader.Tag())
+      {
+      case field::kDenseId: reader.ForEachVarSInt([&ids](int64_t v) { ids.push_back(v); }); break;
+      case field::kDenseLat: reader.ForEachVarSInt([&lats](int64_t v) { lats.push_back(v); }); break;
+      case field::kDenseLon: reader.ForEachVarSInt([&lons](int64_t v) { lons.push_back(v); }); break;
+      case field::kDenseKeysVals: reader.ForEachVarUInt([&keysVals](uint64_t v) { keysVals.push_back(v); }); break;
+      default: reader.Skip();
+      }
+    }
+
+    if (ids.size() != lats.size() || ids.size() != lons.size())
+      MYTHROW(PbfFormatException, ("Dense nodes arrays size mismatch:", ids.size(), lats.size(), lons.size()));
+
+    int64_t id = 0;
+    int64_t lat = 0;
+    int64_t lon = 0;
+    size_t kv = 0;
+    elements.reserve(elements.size() + ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      id += ids[i];
+      lat += lats[i];
+      lon += lons[i];
+
+      auto & element = elements.emplace_back();
+      element.m_type = OsmElement::EntityType::Node;
+      element.m_id = static_cast<uint64_t>(id);
+      element.m_lat = GetLat(lat);
+      element.m_lon = GetLon(lon);
+
+      // keys_vals is empty when none of the block nodes has tags. Otherwise tags of each node
+      // are stored as (key, value) pairs and are terminated by 0.
+      while (kv < keysVals.size() && keysVals[kv] != 0)
+      {
+        if (kv + 1 == keysVals.size())
+          MYTHROW(PbfFormatException, ("Truncated dense nodes keys_vals for", id));
+        element.AddTag(GetString(keysVals[kv]), GetString(keysVals[kv + 1]));
+        kv += 2;
+      }
+      ++kv;
+
+      element.Validate();
+    }
+  }
+
+  void DecodeWay(std::string_view data, OsmElement & element) const
+  {
+    element.m_type = OsmElement::EntityType::Way;
+
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> vals;
+    ProtobufReader reader(data);
+    while (reader.Next())
+    {
+      switch (reader.Tag())
+      {
+      case field::kId: element.m_id = reader.ReadVarUInt(); break;
+      case field::kKeys: reader.ForEachVarUInt([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case field::kVals: reader.ForEachVarUInt([&vals](uint64_t v) { vals.push_back(v); }); break;
+      case field::kWayRefs:
+      {
+        int64_t ref = 0;
+        reader.ForEachVarSInt([&](int64_t delta)
+        {
+          ref += delta;
+          element.AddNd(static_cast<uint64_t>(ref));
+        });
+        break;
+      }
+      default: reader.Skip();
+      }
+    }
+
+    AddTags(keys, vals, element);
+    element.Validate();
+  }
+
+  void DecodeRelation(std::string_view data, OsmElement & element) const
+  {
+    element.m_type = OsmElement::EntityType::Relation;
+
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> vals;
+    std::vector<uint64_t> roles;
+    std::vector<int64_t> memIds;
+    std::vector<uint64_t> types;
+    ProtobufReader reader(data);
+    while (reader.Next())
+    {
+      switch (reader.Tag())
+      {
+      case field::kId: element.m_id = reader.ReadVarUInt(); break;
+      case field::kKeys: reader.ForEachVarUInt([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case field::kVals: reader.ForEachVarUInt([&vals](uint64_t v) { vals.push_back(v); }); break;
+      case field::kRelationRolesSid: reader.ForEachVarUInt([&roles](uint64_t v) { roles.push_back(v); }); break;
+      case field::kRelationMemIds: reader.ForEachVarSInt([&memIds](int64_t v) { memIds.push_back(v); }); break;
+      case field::kRelationTypes: reader.ForEachVarUInt([&types](uint64_t v) { types.push_back(v); }); break;
+      default: reader.Skip();
+      }
+    }
+
+    if (roles.size() != memIds.size() || roles.size() != types.size())
+      MYTHROW(PbfFormatException, ("Relation", element.m_id, "members arrays size mismatch"));
+
+    int64_t ref = 0;
+    for (size_t i = 0; i < memIds.size(); ++i)
+    {
+      ref += memIds[i];
+
+      OsmElement::EntityType type;
+      switch (types[i])
+      {
+      case 0: type = OsmElement::EntityType::Node; break;
+      case 1: type = OsmElement::EntityType::Way; break;
+      case 2: type = OsmElement::EntityType::Relation; break;
+      default: MYTHROW(PbfFormatException, ("Unknown member type", types[i], "in relation", element.m_id));
+      }
+      element.AddMember(static_cast<uint64_t>(ref), type, std::string(GetString(roles[i])));
+    }
+
+    AddTags(keys, vals, element);
+    element.Validate();
+  }
+
+  std::vector<std::string_view> m_strings;
+  std::vector<std::string_view> m_groups;
+  int64_t m_granularity = 100;
+  int64_t m_latOffset = 0;
+  int64_t m_lonOffset = 0;
+};
+}  // namespace
+
+// ProtobufReader ----------------------------------------------------------------------------------
+bool ProtobufReader::Next()
+{
+  if (IsEnd())
+    return false;
+
+  uint64_t const key = ReadVarUInt();
+  m_tag = static_cast<uint32_t>(key >> 3);
+  m_type = static_cast<WireType>(key & 0x7);
+  return true;
+}
+
+uint64_t ProtobufReader::ReadVarUInt()
+{
+  uint64_t result = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+  {
+    if (IsEnd())
+      MYTHROW(PbfFormatException, ("Unexpected end of message while reading varint."));
+
+    auto const b = static_cast<uint8_t>(m_data[m_pos++]);
+    result |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0)
+      return result;
+  }
+  MYTHROW(PbfFormatException, ("Varint is too long."));
+}
+
+std::string_view ProtobufReader::ReadBytes()
+{
+  if (m_type != WireType::LengthDelimited)
+    MYTHROW(PbfFormatException, ("Field", m_tag, "is not length delimited."));
+
+  uint64_t const size = ReadVarUInt();
+  if (size > m_data.size() - m_pos)
+    MYTHROW(PbfFormatException, ("Field", m_tag, "of size", size, "is out of message bounds."));
+
+  auto const result = m_data.substr(m_pos, size);
+  m_pos += size;
+  return result;
+}
+
+void ProtobufReader::Skip()
+{
+  auto const skipBytes = [this](size_t size)
+  {
+    if (size > m_data.size() - m_pos)
+      MYTHROW(PbfFormatException, ("Unexpected end of message while skipping field", m_tag));
+    m_pos += size;
+  };
+
+  switch (m_type)
+  {
+  case WireType::VarInt: ReadVarUInt(); break;
+  case WireType::Fixed64: skipBytes(8); break;
+  case WireType::LengthDelimited: ReadBytes(); break;
+  case WireType::Fixed32: skipBytes(4); break;
+  default: MYTHROW(PbfFormatException, ("Unsupported wire type", static_cast<int>(m_type), "of field", m_tag));
+  }
+}
+
+// PbfBlobReader -----------------------------------------------------------------------------------
+bool PbfBlobReader::ReadExactly(uint8_t * buffer, size_t size)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    size_t const read = m_reader(buffer + done, size - done);
+    if (read == 0)
+      break;
+    done += read;
+  }
+
+  if (done == 0)
+    return false;
+  if (done != size)
+    MYTHROW(PbfFormatException, ("Unexpected end of stream:", done, "of", size, "bytes were read."));
+  return true;
+}
+
+bool PbfBlobReader::Read(PbfBlob & blob)
+{
+  uint8_t sizeBuffer[4];
+  if (!ReadExactly(sizeBuffer, sizeof(sizeBuffer)))
+    return false;
+
+  // BlobHeader size is stored in network byte order.
+  uint32_t const headerSize = (uint32_t{sizeBuffer[0]} << 24) | (uint32_t{sizeBuffer[1]} << 16) |
+                              (uint32_t{sizeBuffer[2]} << 8) | uint32_t{sizeBuffer[3]};
+  if (headerSize > kMaxBlobHeaderSize)
+    MYTHROW(PbfFormatException, ("BlobHeader size is too big:", headerSize));
+
+  std::string header(headerSize, '\0');
+  if (!ReadExactly(reinterpret_cast<uint8_t *>(header.data()), header.size()))
+    MYTHROW(PbfFormatException, ("Unexpected end of stream in BlobHeader."));
+
+  blob.m_type.clear();
+  uint64_t dataSize = 0;
+  ProtobufReader reader(header);
+  while (reader.Next())
+  {
+    switch (reader.Tag())
+    {
+    case field::kBlobHeaderType: blob.m_type = reader.ReadBytes(); break;
+    case field::kBlobHeaderDataSize: dataSize = reader.ReadVarUInt(); break;
+    default: reader.Skip();
+    }
+  }
+
+  if (dataSize > kMaxBlobSize)
+    MYTHROW(PbfFormatException, ("Blob size is too big:", dataSize));
+
+  blob.m_data.resize(dataSize);
+  if (dataSize != 0 && !ReadExactly(reinterpret_cast<uint8_t *>(blob.m_data.data()), blob.m_data.size()))
+    MYTHROW(PbfFormatException, ("Unexpected end of stream in Blob."));
+  return true;
+}
+
+// Functions ---------------------------------------------------------------------------------------
+void DecodePbfBlob(PbfBlob const & blob, std::vector<OsmElement> & elements)
+{
+  if (blob.m_type == "OSMHeader")
+  {
+    CheckHeaderBlock(DecompressBlob(blob.m_data));
+    return;
+  }
+
+  if (blob.m_type != "OSMData")
+  {
+    LOG(LWARNING, ("Skip unknown PBF blob type:", blob.m_type));
+    return;
+  }
+
+  auto const block = DecompressBlob(blob.m_data);
+  PrimitiveBlockDecoder(block).Decode(elements);
+}
+}  // namespace osm
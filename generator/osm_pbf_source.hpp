@@ -0,0 +1,110 @@
+// See PBF Format definition at https://wiki.openstreetmap.org/wiki/PBF_Format
+#pragma once
+
+#include "generator/osm_element.hpp"
+
+#include "base/exception.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace osm
+{
+DECLARE_EXCEPTION(PbfFormatException, RootException);
+
+// Minimal reader of the protobuf wire format. It is enough to decode messages from
+// fileformat.proto and osmformat.proto without linking libprotobuf and generated code.
+class ProtobufReader
+{
+public:
+  enum class WireType : uint8_t
+  {
+    VarInt = 0,
+    Fixed64 = 1,
+    LengthDelimited = 2,
+    Fixed32 = 5
+  };
+
+  explicit ProtobufReader(std::string_view data) : m_data(data) {}
+
+  // Moves to the next field. Returns false when the message is over.
+  bool Next();
+
+  uint32_t Tag() const { return m_tag; }
+  WireType Type() const { return m_type; }
+
+  uint64_t ReadVarUInt();
+  int64_t ReadVarInt() { return static_cast<int64_t>(ReadVarUInt()); }
+  int64_t ReadVarSInt()
+  {
+    uint64_t const v = ReadVarUInt();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+  std::string_view ReadBytes();
+  void Skip();
+
+  // Calls |fn| for each varint value of a repeated field. Both packed and unpacked encodings are accepted.
+  template <typename Fn>
+  void ForEachVarUInt(Fn && fn)
+  {
+    if (m_type != WireType::LengthDelimited)
+    {
+      fn(ReadVarUInt());
+      return;
+    }
+
+    ProtobufReader packed(ReadBytes());
+    while (!packed.IsEnd())
+      fn(packed.ReadVarUInt());
+  }
+
+  template <typename Fn>
+  void ForEachVarSInt(Fn && fn)
+  {
+    ForEachVarUInt([&fn](uint64_t v) { fn(static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1)); });
+  }
+
+private:
+  bool IsEnd() const { return m_pos == m_data.size(); }
+
+  std::string_view m_data;
+  size_t m_pos = 0;
+  uint32_t m_tag = 0;
+  WireType m_type = WireType::VarInt;
+};
+
+struct PbfBlob
+{
+  // "OSMHeader" or "OSMData".
+  std::string m_type;
+  // Serialized Blob message, i.e. still compressed data.
+  std::string m_data;
+};
+
+// Splits a PBF stream into blobs. Reading is cheap and sequential, while decoding
+// of the blobs is independent and can be done on any thread with DecodePbfBlob().
+class PbfBlobReader
+{
+public:
+  using ReadFn = std::function<size_t(uint8_t *, size_t)>;
+
+  explicit PbfBlobReader(ReadFn const & reader) : m_reader(reader) {}
+
+  // Returns false when the stream is over.
+  bool Read(PbfBlob & blob);
+
+private:
+  bool ReadExactly(uint8_t * buffer, size_t size);
+
+  ReadFn m_reader;
+};
+
+// Decompresses |blob| and appends all entities of an OSMData block to |elements|.
+// OSMHeader blobs are validated and produce no elements.
+// Throws PbfFormatException on malformed or unsupported data.
+void DecodePbfBlob(PbfBlob const & blob, std::vector<OsmElement> & elements);
+}  // namespace osm
@@ -10,6 +10,7 @@
 #include "base/assert.hpp"
 #include "base/stl_helpers.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 
@@ -118,6 +119,19 @@ void ProcessOsmElementsFromO5M(SourceReader & stream, std::function<void(OsmElem
   }
 }
 
+void ProcessOsmElementsFromPbf(SourceReader & stream, size_t threadsCount,
+                               std::function<void(OsmElement &&)> const & processor)
+{
+  ProcessorOsmElementsFromPbf processorOsmElementsFromPbf(stream, threadsCount);
+  OsmElement element;
+  while (processorOsmElementsFromPbf.TryRead(element))
+  {
+    processor(std::move(element));
+    // It is safe to use `element` here as `Clear` will restore the state after the move.
+    element.Clear();
+  }
+}
+
 ProcessorOsmElementsFromO5M::ProcessorOsmElementsFromO5M(SourceReader & stream)
   : m_stream(stream)
   , m_dataset([&](uint8_t * buffer, size_t size) { return m_stream.Read(reinterpret_cast<char *>(buffer), size); })
@@ -182,6 +196,52 @@ bool ProcessorOsmElementsFromO5M::TryRead(OsmElement & element)
   return true;
 }
 
+ProcessorOsmElementsFromPbf::ProcessorOsmElementsFromPbf(SourceReader & stream, size_t threadsCount)
+  : m_stream(stream)
+  , m_blobReader([&](uint8_t * buffer, size_t size) { return m_stream.Read(reinterpret_cast<char *>(buffer), size); })
+  // Keep a couple of blobs per worker in flight so that workers don't wait for the reader.
+  , m_maxPendingBlobs(2 * std::max<size_t>(threadsCount, 1))
+  , m_pool(std::max<size_t>(threadsCount, 1))
+{}
+
+void ProcessorOsmElementsFromPbf::ScheduleBlobs()
+{
+  while (!m_isStreamOver && m_pendingBlocks.size() < m_maxPendingBlobs)
+  {
+    osm::PbfBlob blob;
+    if (!m_blobReader.Read(blob))
+    {
+      m_isStreamOver = true;
+      break;
+    }
+
+    m_pendingBlocks.emplace_back(m_pool.Submit([blob = std::move(blob)]()
+    {
+      std::vector<OsmElement> elements;
+      osm::DecodePbfBlob(blob, elements);
+      return elements;
+    }));
+  }
+}
+
+bool ProcessorOsmElementsFromPbf::TryRead(OsmElement & element)
+{
+  while (m_blockPos == m_block.size())
+  {
+    ScheduleBlobs();
+    if (m_pendingBlocks.empty())
+      return false;
+
+    // get() rethrows decoding exceptions from the worker thread.
+    m_block = m_pendingBlocks.front().get();
+    m_pendingBlocks.pop_front();
+    m_blockPos = 0;
+  }
+
+  element = std::move(m_block[m_blockPos++]);
+  return true;
+}
+
 ProcessorOsmElementsFromXml::ProcessorOsmElementsFromXml(SourceReader & stream)
   : m_xmlSource([&, this](OsmElement && e) { m_queue.emplace(std::move(e)); })
   , m_parser(stream, m_xmlSource)
@@ -215,9 +275,10 @@ bool ProcessorOsmElementsFromXml::TryRead(OsmElement & element)
 // Generate functions implementations.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool GenerateIntermediateData(feature::GenerateInfo & info)
+bool GenerateIntermediateData(feature::GenerateInfo & info, size_t threadsCount)
 {
-  auto nodes = cache::CreatePointStorageWriter(info.m_nodeStorageType, info.GetCacheFileName(NODES_FILE));
+  auto nodes =
+      cache::CreatePointStorageWriter(info.m_nodeStorageType, info.GetCacheFileName(NODES_FILE), threadsCount);
   cache::IntermediateDataWriter cache(*nodes, info);
   TownsDumper towns;
   SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
@@ -234,6 +295,7 @@ bool GenerateIntermediateData(feature::GenerateInfo & info)
   {
   case feature::GenerateInfo::OsmSourceType::XML: ProcessOsmElementsFromXML(reader, processor); break;
   case feature::GenerateInfo::OsmSourceType::O5M: ProcessOsmElementsFromO5M(reader, processor); break;
+  case feature::GenerateInfo::OsmSourceType::PBF: ProcessOsmElementsFromPbf(reader, threadsCount, processor); break;
   }
 
   cache.SaveIndex();
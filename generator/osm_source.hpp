@@ -3,12 +3,17 @@
 #include "generator/generate_info.hpp"
 #include "generator/intermediate_data.hpp"
 #include "generator/osm_o5m_source.hpp"
+#include "generator/osm_pbf_source.hpp"
 #include "generator/osm_xml_source.hpp"
 #include "generator/translator_interface.hpp"
 
 #include "coding/parse_xml.hpp"
 
+#include "base/thread_pool_computational.hpp"
+
+#include <deque>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <queue>
@@ -45,10 +50,12 @@ public:
   uint64_t Pos() const { return m_pos; }
 };
 
-bool GenerateIntermediateData(feature::GenerateInfo & info);
+bool GenerateIntermediateData(feature::GenerateInfo & info, size_t threadsCount = 1);
 
 void ProcessOsmElementsFromO5M(SourceReader & stream, std::function<void(OsmElement &&)> const & processor);
 void ProcessOsmElementsFromXML(SourceReader & stream, std::function<void(OsmElement &&)> const & processor);
+void ProcessOsmElementsFromPbf(SourceReader & stream, size_t threadsCount,
+                               std::function<void(OsmElement &&)> const & processor);
 
 class ProcessorOsmElementsInterface
 {
@@ -72,6 +79,30 @@ private:
   osm::O5MSource::Iterator m_pos;
 };
 
+// Reads PBF blobs on the calling thread and decodes them (inflate + protobuf) on |threadsCount|
+// worker threads. Decoded blocks are returned strictly in the file order.
+class ProcessorOsmElementsFromPbf : public ProcessorOsmElementsInterface
+{
+public:
+  ProcessorOsmElementsFromPbf(SourceReader & stream, size_t threadsCount);
+
+  // ProcessorOsmElementsInterface overrides:
+  bool TryRead(OsmElement & element) override;
+
+private:
+  void ScheduleBlobs();
+
+  SourceReader & m_stream;
+  osm::PbfBlobReader m_blobReader;
+  size_t const m_maxPendingBlobs;
+  bool m_isStreamOver = false;
+  std::deque<std::future<std::vector<OsmElement>>> m_pendingBlocks;
+  std::vector<OsmElement> m_block;
+  size_t m_blockPos = 0;
+  // Should be the last member to join the workers before the rest is destroyed.
+  base::ComputationalThreadPool m_pool;
+};
+
 class ProcessorOsmElementsFromXml : public ProcessorOsmElementsInterface
 {
 public:
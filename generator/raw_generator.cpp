@@ -6,6 +6,7 @@
 #include "generator/final_processor_coastline.hpp"
 #include "generator/final_processor_country.hpp"
 #include "generator/final_processor_world.hpp"
+#include "generator/osm_elements_pipeline.hpp"
 #include "generator/osm_source.hpp"
 #include "generator/processor_factory.hpp"
 #include "generator/raw_generator_writer.hpp"
@@ -25,7 +26,7 @@ class Stats
 public:
   Stats(size_t logCallCountThreshold) : m_timer(true /* start */), m_logCallCountThreshold(logCallCountThreshold) {}
 
-  void Log(std::vector<OsmElement> const & elements, uint64_t pos, bool forcePrint = false)
+  void Log(std::vector<OsmElement> const & elements, OsmElementsPipeline const & pipeline, bool forcePrint = false)
   {
     for (auto const & e : elements)
       if (e.IsNode())
@@ -43,17 +44,36 @@ public:
     }
 
     auto static constexpr kBytesInMiB = 1024.0 * 1024.0;
+    auto static constexpr kNsInSec = 1e9;
+    auto const pos = pipeline.GetSourcePos();
     auto const posMiB = pos / kBytesInMiB;
     auto const elapsedSeconds = m_timer.ElapsedSeconds();
+    auto const intervalSeconds = elapsedSeconds - m_prevElapsedSeconds;
     auto const avgSpeedMiBPerSec = posMiB / elapsedSeconds;
-    auto const speedMiBPerSec = (pos - m_prevFilePos) / (elapsedSeconds - m_prevElapsedSeconds) / kBytesInMiB;
+    auto const speedMiBPerSec = (pos - m_prevFilePos) / intervalSeconds / kBytesInMiB;
+
+    auto const & counters = pipeline.GetCounters();
+    uint64_t const readElements = counters.m_readElements;
+    uint64_t const processedElements = counters.m_processedElements;
+    uint64_t const readerStallNs = counters.m_readerStallNs;
+    uint64_t const consumerStallNs = counters.m_consumerStallNs;
 
     LOG(LINFO, ("Read", m_element_counter, "elements [pos:", posMiB, "MiB, avg read speed:", avgSpeedMiBPerSec,
                 " MiB/s, read speed:", speedMiBPerSec, "MiB/s [n:", m_nodeCounter, ", w:", m_wayCounter,
                 ", r:", m_relationCounter, "]]"));
+    // Reader stalls mean that translators are the bottleneck, translator stalls mean the opposite.
+    LOG(LINFO, ("Pipeline [decode:", (readElements - m_prevReadElements) / intervalSeconds,
+                "el/s, translate:", (processedElements - m_prevProcessedElements) / intervalSeconds,
+                "el/s, ready chunks:", pipeline.GetReadyChunksCount(), "of", pipeline.GetChunksCount(),
+                ", reader stall:", (readerStallNs - m_prevReaderStallNs) / kNsInSec,
+                "s, translators stall:", (consumerStallNs - m_prevConsumerStallNs) / kNsInSec, "s]"));
 
     m_prevFilePos = pos;
     m_prevElapsedSeconds = elapsedSeconds;
+    m_prevReadElements = readElements;
+    m_prevProcessedElements = processedElements;
+    m_prevReaderStallNs = readerStallNs;
+    m_prevConsumerStallNs = consumerStallNs;
     m_nodeCounter = 0;
     m_wayCounter = 0;
     m_relationCounter = 0;
@@ -66,6 +86,10 @@ private:
   size_t m_callCount = 0;
   uint64_t m_prevFilePos = 0;
   double m_prevElapsedSeconds = 0.0;
+  uint64_t m_prevReadElements = 0;
+  uint64_t m_prevProcessedElements = 0;
+  uint64_t m_prevReaderStallNs = 0;
+  uint64_t m_prevConsumerStallNs = 0;
   size_t m_element_counter = 0;
   size_t m_nodeCounter = 0;
   size_t m_wayCounter = 0;
@@ -232,9 +256,16 @@ bool RawGenerator::GenerateFilteredFeatures()
   case feature::GenerateInfo::OsmSourceType::XML:
     sourceProcessor = std::make_unique<ProcessorOsmElementsFromXml>(reader);
     break;
+  case feature::GenerateInfo::OsmSourceType::PBF:
+    sourceProcessor = std::make_unique<ProcessorOsmElementsFromPbf>(reader, m_threadsCount);
+    break;
   }
   CHECK(sourceProcessor, ());
 
+  // Decode the source on a dedicated thread into a bounded set of recycled chunks.
+  // Each translator holds one chunk at most, the rest are buffered for the next free translator.
+  OsmElementsPipeline pipeline(*sourceProcessor, reader, m_chunkSize, 2 * m_threadsCount + 2 /* chunksCount */);
+
   // Create translators threads.
   // Each thread may contain separate translators for countries and World
   // They process chunks of source data and pass features to a chain of processors.
@@ -247,22 +278,14 @@ bool RawGenerator::GenerateFilteredFeatures()
 
   Stats stats(100 * m_threadsCount /* logCallCountThreshold */);
 
-  bool isEnd = false;
-  do
+  std::vector<OsmElement> elements;
+  while (pipeline.Pop(elements))
   {
-    std::vector<OsmElement> elements(m_chunkSize);
-    size_t idx = 0;
-    while (idx < m_chunkSize && sourceProcessor->TryRead(elements[idx]))
-      ++idx;
-
-    isEnd = idx < m_chunkSize;
-    stats.Log(elements, reader.Pos(), isEnd /* forcePrint */);
-
-    if (isEnd)
-      elements.resize(idx);
-    translators.Emit(std::move(elements));
+    stats.Log(elements, pipeline);
+    translators.Emit(std::move(elements), [&pipeline](std::vector<OsmElement> && processed)
+    { pipeline.Recycle(std::move(processed)); });
   }
-  while (!isEnd);
+  stats.Log({} /* elements */, pipeline, true /* forcePrint */);
 
   LOG(LINFO, ("OSM source input was processed."));
   LOG(LINFO, ("Finishing translators..."));
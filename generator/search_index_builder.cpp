@@ -24,8 +24,10 @@
 
 #include "platform/platform.hpp"
 
+#include "coding/file_reader.hpp"
 #include "coding/reader_writer_ops.hpp"
 #include "coding/succinct_mapper.hpp"
+#include "coding/varint.hpp"
 #include "coding/writer.hpp"
 
 #include "base/assert.hpp"
@@ -34,14 +36,19 @@
 #include "base/logging.hpp"
 #include "base/scope_guard.hpp"
 #include "base/stats.hpp"
+#include "base/stl_helpers.hpp"
 #include "base/string_utils.hpp"
+#include "base/thread_pool_computational.hpp"
 #include "base/timer.hpp"
 
 #include "defines.hpp"
 
 #include <algorithm>
 #include <fstream>
+#include <future>
+#include <limits>
 #include <memory>
+#include <queue>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -365,18 +372,160 @@ private:
   FeatureNameInserter<ContT> m_inserter;
 };
 
-template <class ContT>
-void AddFeatureNameIndexPairs(FeaturesVectorTest const & features, CategoriesHolder const & categoriesHolder,
-                              ContT & keyValuePairs)
+using SearchKey = strings::UniString;
+using SearchValue = Uint64IndexValue;
+using SearchKeyValuePair = std::pair<SearchKey, SearchValue>;
+
+// Collects <key, value> pairs of one features range. When |maxPairsInMemory| is reached, pairs are
+// sorted and spilled to disk as a run, so the memory of the search index build is bounded.
+class KeyValueRuns
 {
-  feature::DataHeader const & header = features.GetHeader();
+public:
+  KeyValueRuns(std::string const & runPathPrefix, size_t maxPairsInMemory)
+    : m_runPathPrefix(runPathPrefix)
+    , m_maxPairsInMemory(maxPairsInMemory)
+  {}
 
-  std::unique_ptr<SynonymsHolder> synonyms;
-  if (header.GetType() == feature::DataHeader::MapType::World)
-    synonyms = std::make_unique<SynonymsHolder>();
+  KeyValueRuns(KeyValueRuns &&) = default;
+
+  ~KeyValueRuns()
+  {
+    for (auto const & path : m_runPaths)
+      FileWriter::DeleteFileX(path);
+  }
+
+  // Called by FeatureNameInserter.
+  void emplace_back(SearchKey const & key, uint32_t value)
+  {
+    if (m_pairs.size() == m_maxPairsInMemory)
+      Spill();
+    // Do not let the vector grow beyond the limit.
+    if (m_pairs.size() == m_pairs.capacity() && m_maxPairsInMemory < 2 * m_pairs.capacity())
+      m_pairs.reserve(m_maxPairsInMemory);
+    m_pairs.emplace_back(key, SearchValue(value));
+  }
+
+  // Sorts the pairs left in memory, they are the last run.
+  void Finish() { base::SortUnique(m_pairs); }
+
+  std::vector<std::string> const & GetRunPaths() const { return m_runPaths; }
+  std::vector<SearchKeyValuePair> const & GetPairs() const { return m_pairs; }
+
+private:
+  void Spill()
+  {
+    base::SortUnique(m_pairs);
+
+    m_runPaths.push_back(m_runPathPrefix + "." + std::to_string(m_runPaths.size()));
+    FileWriter writer(m_runPaths.back());
+    for (auto const & [key, value] : m_pairs)
+    {
+      WriteVarUint(writer, base::asserted_cast<uint32_t>(key.size()));
+      for (auto const c : key)
+        WriteVarUint(writer, static_cast<uint32_t>(c));
+      WriteVarUint(writer, value.m_featureId);
+    }
+
+    m_pairs.clear();
+  }
+
+  std::string m_runPathPrefix;
+  size_t m_maxPairsInMemory;
+  std::vector<SearchKeyValuePair> m_pairs;
+  std::vector<std::string> m_runPaths;
+};
+
+// Reads a sorted run either from disk or from memory.
+class RunCursor
+{
+public:
+  explicit RunCursor(std::string const & path)
+    : m_source(std::make_unique<ReaderSource<FileReader>>(
+          FileReader(path, 16 /* logPageSize */, 2 /* logPageCount */)))
+  {}
+
+  explicit RunCursor(std::vector<SearchKeyValuePair> const & pairs) : m_pairs(&pairs) {}
+
+  bool Next(SearchKeyValuePair & pair)
+  {
+    if (m_pairs)
+    {
+      if (m_index == m_pairs->size())
+        return false;
+      pair = (*m_pairs)[m_index++];
+      return true;
+    }
+
+    if (m_source->Size() == 0)
+      return false;
+
+    auto & [key, value] = pair;
+    key.resize(ReadVarUint<uint32_t>(*m_source));
+    for (auto & c : key)
+      c = static_cast<UniChar>(ReadVarUint<uint32_t>(*m_source));
+    value.m_featureId = ReadVarUint<uint64_t>(*m_source);
+    return true;
+  }
+
+private:
+  std::unique_ptr<ReaderSource<FileReader>> m_source;
+  std::vector<SearchKeyValuePair> const * m_pairs = nullptr;
+  size_t m_index = 0;
+};
+
+// Merges sorted runs and passes pairs to |toDo| in the sorted order.
+template <typename ToDo>
+void MergeRuns(std::vector<KeyValueRuns> const & runs, ToDo && toDo)
+{
+  std::vector<RunCursor> cursors;
+  for (auto const & r : runs)
+  {
+    for (auto const & path : r.GetRunPaths())
+      cursors.emplace_back(path);
+    cursors.emplace_back(r.GetPairs());
+  }
+
+  using Item = std::pair<SearchKeyValuePair, size_t>;
+  auto const greater = [](Item const & lhs, Item const & rhs) { return rhs.first < lhs.first; };
+  std::priority_queue<Item, std::vector<Item>, decltype(greater)> queue(greater);
+
+  Item item;
+  for (size_t i = 0; i < cursors.size(); ++i)
+  {
+    if (cursors[i].Next(item.first))
+    {
+      item.second = i;
+      queue.push(item);
+    }
+  }
+
+  while (!queue.empty())
+  {
+    item = queue.top();
+    queue.pop();
+    toDo(item.first.first, item.first.second);
+    if (cursors[item.second].Next(item.first))
+      queue.push(item);
+  }
+}
 
-  features.GetVector().ForEach(
-      FeatureInserter(synonyms.get(), keyValuePairs, categoriesHolder, header.GetScaleRange()));
+// Generates pairs of the features [beg, end). Every thread uses its own features vector,
+// because FeaturesVector is not thread-safe.
+void AddFeatureNameIndexPairs(std::string const & mwmPath, uint32_t beg, uint32_t end,
+                              CategoriesHolder const & categoriesHolder, SynonymsHolder * synonyms,
+                              KeyValueRuns & keyValuePairs)
+{
+  FeaturesVectorTest features(mwmPath);
+  auto const & vector = features.GetVector();
+  FeatureInserter inserter(synonyms, keyValuePairs, categoriesHolder, features.GetHeader().GetScaleRange());
+  for (uint32_t index = beg; index < end; ++index)
+  {
+    auto ft = vector.GetByIndex(index);
+    // Feature's index is used for metadata loading, see FeaturesVector::ForEach.
+    ft->SetID(FeatureID(MwmSet::MwmId(), index));
+    inserter(*ft, index);
+  }
+  keyValuePairs.Finish();
 }
 
 void ReadAddressData(std::string const & filename, std::vector<feature::AddressData> & addrs)
@@ -565,7 +714,8 @@ void BuildAddressTable(FilesContainerR & container, std::string const & addressD
 }
 }  // namespace
 
-void BuildSearchIndex(FilesContainerR & container, Writer & indexWriter);
+void BuildSearchIndex(FilesContainerR & container, Writer & indexWriter, std::string const & runPathPrefix,
+                      uint32_t threadsCount, uint64_t memoryLimit);
 
 bool BuildSearchIndexFromDataFile(std::string const & country, feature::GenerateInfo const & info, bool forceRebuild,
                                   uint32_t threadsCount)
@@ -588,7 +738,7 @@ bool BuildSearchIndexFromDataFile(std::string const & country, feature::Generate
   {
     {
       FileWriter writer(indexFilePath);
-      BuildSearchIndex(readContainer, writer);
+      BuildSearchIndex(readContainer, writer, indexFilePath, threadsCount, info.m_searchIndexMemoryLimit);
       LOG(LINFO, ("Search index size =", writer.Size()));
     }
 
@@ -649,9 +799,9 @@ bool BuildSearchIndexFromDataFile(std::string const & country, feature::Generate
   return true;
 }
 
-void BuildSearchIndex(FilesContainerR & container, Writer & indexWriter)
+void BuildSearchIndex(FilesContainerR & container, Writer & indexWriter, std::string const & runPathPrefix,
+                      uint32_t threadsCount, uint64_t memoryLimit)
 {
-  using Key = strings::UniString;
   using Value = Uint64IndexValue;
 
   LOG(LINFO, ("Start building search index for", container.GetFileName()));
@@ -659,17 +809,52 @@ void BuildSearchIndex(FilesContainerR & container, Writer & indexWriter)
 
   auto const & categoriesHolder = GetDefaultCategories();
 
-  FeaturesVectorTest features(container);
-  SingleValueSerializer<Value> serializer;
+  uint32_t featuresCount = 0;
+  std::unique_ptr<SynonymsHolder> synonyms;
+  {
+    FeaturesVectorTest features(container);
+    featuresCount = base::asserted_cast<uint32_t>(features.GetVector().GetNumFeatures());
+    if (features.GetHeader().GetType() == feature::DataHeader::MapType::World)
+      synonyms = std::make_unique<SynonymsHolder>();
+  }
 
-  std::vector<std::pair<Key, Value>> searchIndexKeyValuePairs;
-  AddFeatureNameIndexPairs(features, categoriesHolder, searchIndexKeyValuePairs);
+  threadsCount = std::max(1U, std::min(threadsCount, featuresCount));
+  size_t maxPairsInMemory = std::numeric_limits<size_t>::max();
+  if (memoryLimit != 0)
+    maxPairsInMemory = std::max(uint64_t{1}, memoryLimit / threadsCount / sizeof(SearchKeyValuePair));
 
-  std::sort(searchIndexKeyValuePairs.begin(), searchIndexKeyValuePairs.end());
-  LOG(LINFO, ("End sorting strings:", timer.ElapsedSeconds()));
+  std::vector<KeyValueRuns> runs;
+  runs.reserve(threadsCount);
+  for (uint32_t i = 0; i < threadsCount; ++i)
+    runs.emplace_back(runPathPrefix + "." + std::to_string(i), maxPairsInMemory);
 
-  trie::Build<Writer, Key, ValueList<Value>, SingleValueSerializer<Value>>(indexWriter, serializer,
-                                                                           searchIndexKeyValuePairs);
+  {
+    base::ComputationalThreadPool pool(threadsCount);
+    std::vector<std::future<void>> results;
+    for (uint32_t i = 0; i < threadsCount; ++i)
+    {
+      auto const beg = static_cast<uint32_t>(uint64_t{featuresCount} * i / threadsCount);
+      auto const end = static_cast<uint32_t>(uint64_t{featuresCount} * (i + 1) / threadsCount);
+      results.emplace_back(pool.Submit([&, i, beg, end]
+      {
+        AddFeatureNameIndexPairs(container.GetFileName(), beg, end, categoriesHolder, synonyms.get(), runs[i]);
+      }));
+    }
+    // Rethrows exceptions of the workers.
+    for (auto & r : results)
+      r.get();
+  }
+
+  size_t spilledRunsCount = 0;
+  for (auto const & r : runs)
+    spilledRunsCount += r.GetRunPaths().size();
+  LOG(LINFO, ("End sorting strings:", timer.ElapsedSeconds(), "threads:", threadsCount,
+              "runs spilled to disk:", spilledRunsCount));
+
+  SingleValueSerializer<Value> serializer;
+  trie::Builder<Writer, SearchKey, ValueList<Value>, SingleValueSerializer<Value>> builder(indexWriter, serializer);
+  MergeRuns(runs, [&builder](SearchKey const & key, Value const & value) { builder.Add(key, value); });
+  builder.Finish();
 
   LOG(LINFO, ("End building search index, elapsed seconds:", timer.ElapsedSeconds()));
 }
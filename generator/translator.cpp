@@ -36,6 +36,21 @@ void Translator::SetFilter(std::shared_ptr<FilterInterface> const & filter)
   m_filter = filter;
 }
 
+void Translator::Prefetch(std::vector<OsmElement> const & elements)
+{
+  // Ways are built from their nodes coordinates, which are the most of random reads of the nodes storage.
+  // The filter is checked before Preprocess() here, so it's only a hint: a way which is missed
+  // is resolved node by node in Emit().
+  std::vector<uint64_t> ids;
+  for (auto const & element : elements)
+  {
+    if (element.IsWay() && !element.Tags().empty() && m_filter->IsAccepted(element))
+      ids.insert(ids.end(), element.Nodes().begin(), element.Nodes().end());
+  }
+
+  m_cache->GetCache()->PrefetchNodes(std::move(ids));
+}
+
 void Translator::Emit(OsmElement const & src)
 {
   // Make a copy because it will be modified below.
@@ -38,6 +38,7 @@ public:
   void SetFilter(std::shared_ptr<FilterInterface> const & filter);
 
   // TranslatorInterface overrides:
+  void Prefetch(std::vector<OsmElement> const & elements) override;
   void Emit(OsmElement const & element) override;
   void Finish() override;
   bool Save() override;
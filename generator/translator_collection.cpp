@@ -14,6 +14,12 @@ std::shared_ptr<TranslatorInterface> TranslatorCollection::Clone() const
   return p;
 }
 
+void TranslatorCollection::Prefetch(std::vector<OsmElement> const & elements)
+{
+  for (auto & t : m_collection)
+    t->Prefetch(elements);
+}
+
 void TranslatorCollection::Emit(OsmElement const & element)
 {
   for (auto & t : m_collection)
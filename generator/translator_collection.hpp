@@ -16,6 +16,7 @@ public:
   // TranslatorInterface overrides:
   std::shared_ptr<TranslatorInterface> Clone() const override;
 
+  void Prefetch(std::vector<OsmElement> const & elements) override;
   void Emit(OsmElement const & element) override;
 
   void Finish() override;
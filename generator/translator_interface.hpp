@@ -30,6 +30,8 @@ public:
   virtual std::shared_ptr<TranslatorInterface> Clone() const = 0;
 
   virtual void Preprocess(OsmElement &) {}
+  // Called with the whole chunk before Emit() of its elements to load the data they need in one go.
+  virtual void Prefetch(std::vector<OsmElement> const &) {}
   virtual void Emit(OsmElement const & element) = 0;
   virtual void Finish() = 0;
   virtual bool Save() = 0;
@@ -15,15 +15,23 @@ TranslatorsPool::TranslatorsPool(std::shared_ptr<TranslatorInterface> const & or
 }
 
 void TranslatorsPool::Emit(std::vector<OsmElement> && elements)
+{
+  Emit(std::move(elements), nullptr /* onProcessed */);
+}
+
+void TranslatorsPool::Emit(std::vector<OsmElement> && elements, ProcessedFn const & onProcessed)
 {
   std::shared_ptr<TranslatorInterface> translator;
   m_translators.WaitAndPop(translator);
-  m_threadPool.SubmitWork([&, translator, elements = std::move(elements)]() mutable
+  m_threadPool.SubmitWork([&, translator, onProcessed, elements = std::move(elements)]() mutable
   {
+    translator->Prefetch(elements);
     for (auto const & element : elements)
       translator->Emit(element);
 
     m_translators.Push(translator);
+    if (onProcessed)
+      onProcessed(std::move(elements));
   });
 }
 
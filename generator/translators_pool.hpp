@@ -7,6 +7,7 @@
 #include "base/thread_pool_computational.hpp"
 #include "base/thread_safe_queue.hpp"
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -17,7 +18,11 @@ class TranslatorsPool
 public:
   explicit TranslatorsPool(std::shared_ptr<TranslatorInterface> const & original, size_t threadCount);
 
+  using ProcessedFn = std::function<void(std::vector<OsmElement> &&)>;
+
   void Emit(std::vector<OsmElement> && elements);
+  // Passes |elements| to |onProcessed| after translation to let the caller reuse the buffer.
+  void Emit(std::vector<OsmElement> && elements, ProcessedFn const & onProcessed);
   bool Finish();
 
 private:
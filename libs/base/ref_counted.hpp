@@ -2,24 +2,27 @@
 
 #include "base/macros.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
 namespace base
 {
+// The counter is atomic, so RefCountPtrs to the same object may be copied and
+// destroyed on different threads, e.g. when the object is shared via a cache.
 class RefCounted
 {
 public:
   virtual ~RefCounted() = default;
 
-  void IncRef() noexcept { ++m_refs; }
-  uint64_t DecRef() noexcept { return --m_refs; }
-  uint64_t NumRefs() const noexcept { return m_refs; }
+  void IncRef() noexcept { m_refs.fetch_add(1, std::memory_order_relaxed); }
+  uint64_t DecRef() noexcept { return m_refs.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+  uint64_t NumRefs() const noexcept { return m_refs.load(std::memory_order_relaxed); }
 
 protected:
   RefCounted() noexcept = default;
 
-  uint64_t m_refs = 0;
+  std::atomic<uint64_t> m_refs = 0;
 
   DISALLOW_COPY_AND_MOVE(RefCounted);
 };
@@ -3,10 +3,14 @@
 #include "coding/compressed_bit_vector.hpp"
 #include "coding/writer.hpp"
 
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <random>
 #include <set>
 #include <vector>
 
@@ -79,6 +83,31 @@ void CheckUnion(vector<uint64_t> & setBits1, coding::CompressedBitVector::Storag
   TEST_EQUAL(resultStrategy, cbv3->GetStorageStrategy(), ());
   CheckUnion(setBits1, setBits2, *cbv3);
 }
+
+vector<uint64_t> GetPositions(coding::CompressedBitVector const & cbv)
+{
+  vector<uint64_t> positions;
+  coding::CompressedBitVectorEnumerator::ForEach(cbv, [&positions](uint64_t pos) { positions.push_back(pos); });
+  return positions;
+}
+
+// Returns |size| distinct sorted positions less than |range|.
+vector<uint64_t> GenerateRandomPositions(mt19937 & rng, uint64_t range, size_t size)
+{
+  set<uint64_t> positions;
+  uniform_int_distribution<uint64_t> distribution(0, range - 1);
+  while (positions.size() < size)
+    positions.insert(distribution(rng));
+  return vector<uint64_t>(positions.begin(), positions.end());
+}
+
+unique_ptr<coding::CompressedBitVector> MakeCBV(vector<uint64_t> const & setBits, bool roaring)
+{
+  auto cbv = coding::CompressedBitVectorBuilder::FromBitPositions(setBits);
+  if (roaring)
+    return coding::RoaringCBV::BuildFromCBV(*cbv);
+  return cbv;
+}
 }  // namespace
 
 UNIT_TEST(CompressedBitVector_Intersect1)
@@ -453,3 +482,177 @@ UNIT_TEST(CompressedBitVector_SparseLeaveFirstNBits)
   for (uint64_t bit = 0; bit < (1 << 10); ++bit)
     TEST(!cbv->GetBit(bit), (bit));
 }
+
+UNIT_TEST(CompressedBitVector_RandomSetOperations)
+{
+  mt19937 rng(0);
+  // Sizes are chosen to get all the storage strategies and both merging and galloping through
+  // sorted positions.
+  vector<pair<uint64_t, size_t>> const params = {{100, 0},    {100, 5},     {100, 60},     {1000, 10},
+                                                 {1000, 500}, {5000, 4000}, {100000, 100}, {100000, 5000}};
+  for (auto const & [range1, size1] : params)
+  {
+    for (auto const & [range2, size2] : params)
+    {
+      auto setBits1 = GenerateRandomPositions(rng, range1, size1);
+      auto setBits2 = GenerateRandomPositions(rng, range2, size2);
+      // Every pair of strategies is checked with roaring bit vectors as well.
+      for (bool const roaring1 : {false, true})
+      {
+        for (bool const roaring2 : {false, true})
+        {
+          auto const cbv1 = MakeCBV(setBits1, roaring1);
+          auto const cbv2 = MakeCBV(setBits2, roaring2);
+
+          vector<uint64_t> expected;
+          Intersect(setBits1, setBits2, expected);
+          auto const intersection = coding::CompressedBitVector::Intersect(*cbv1, *cbv2);
+          TEST_EQUAL(GetPositions(*intersection), expected, (range1, size1, roaring1, range2, size2, roaring2));
+          TEST_EQUAL(intersection->PopCount(), expected.size(), ());
+
+          expected.clear();
+          Subtract(setBits1, setBits2, expected);
+          auto const difference = coding::CompressedBitVector::Subtract(*cbv1, *cbv2);
+          TEST_EQUAL(GetPositions(*difference), expected, (range1, size1, roaring1, range2, size2, roaring2));
+          TEST_EQUAL(difference->PopCount(), expected.size(), ());
+
+          expected.clear();
+          Union(setBits1, setBits2, expected);
+          auto const united = coding::CompressedBitVector::Union(*cbv1, *cbv2);
+          TEST_EQUAL(GetPositions(*united), expected, (range1, size1, roaring1, range2, size2, roaring2));
+          TEST_EQUAL(united->PopCount(), expected.size(), ());
+        }
+      }
+    }
+  }
+}
+
+UNIT_TEST(CompressedBitVector_RoaringContainers)
+{
+  vector<uint64_t> setBits;
+  // A few positions are kept in an array.
+  for (uint64_t i = 0; i < 100; ++i)
+    setBits.push_back(i * 300);
+  // Every other bit of the second block needs a bitmap.
+  for (uint64_t i = 0; i < coding::RoaringCBV::kContainerSize; i += 2)
+    setBits.push_back(coding::RoaringCBV::kContainerSize + i);
+  // Long runs of set bits in the fourth block.
+  for (uint64_t i = 0; i < 20000; ++i)
+    setBits.push_back(3 * coding::RoaringCBV::kContainerSize + 1000 + i);
+
+  coding::RoaringCBV const cbv(setBits);
+  using Type = coding::RoaringCBV::ContainerType;
+  TEST_EQUAL(cbv.GetStorageStrategy(), coding::CompressedBitVector::StorageStrategy::Roaring, ());
+  TEST_EQUAL(cbv.NumContainers(), 3, ());
+  TEST_EQUAL(cbv.GetKeys(), vector<uint64_t>({0, 1, 3}), ());
+  TEST_EQUAL(cbv.GetContainerType(0), Type::Array, ());
+  TEST_EQUAL(cbv.GetContainerType(1), Type::Bitmap, ());
+  TEST_EQUAL(cbv.GetContainerType(2), Type::Run, ());
+  TEST_EQUAL(cbv.PopCount(), setBits.size(), ());
+  TEST_EQUAL(GetPositions(cbv), setBits, ());
+
+  for (uint64_t pos = 0; pos < 5 * coding::RoaringCBV::kContainerSize; pos += 7)
+    TEST_EQUAL(cbv.GetBit(pos), binary_search(setBits.begin(), setBits.end(), pos), (pos));
+
+  // An intersection of the runs with an array is an array.
+  coding::RoaringCBV const shifted(vector<uint64_t>({3 * coding::RoaringCBV::kContainerSize + 1000,
+                                                     3 * coding::RoaringCBV::kContainerSize + 1001,
+                                                     3 * coding::RoaringCBV::kContainerSize + 1003}));
+  auto const intersection = coding::CompressedBitVector::Intersect(cbv, shifted);
+  TEST_EQUAL(intersection->GetStorageStrategy(), coding::CompressedBitVector::StorageStrategy::Roaring, ());
+  TEST_EQUAL(static_cast<coding::RoaringCBV const &>(*intersection).GetContainerType(0), Type::Array, ());
+  TEST_EQUAL(GetPositions(*intersection), GetPositions(shifted), ());
+
+  auto const firstBits = cbv.LeaveFirstSetNBits(150);
+  TEST_EQUAL(GetPositions(*firstBits), vector<uint64_t>(setBits.begin(), setBits.begin() + 150), ());
+}
+
+UNIT_TEST(CompressedBitVector_RoaringSerialization)
+{
+  mt19937 rng(0);
+  // Roaring bit vectors are written in the same format as the ones which are built from their positions.
+  vector<pair<uint64_t, size_t>> const params = {{100, 0}, {1000, 10}, {100000, 60000}, {300000, 5000}};
+  for (auto const & [range, size] : params)
+  {
+    auto const setBits = GenerateRandomPositions(rng, range, size);
+    auto const expected = coding::CompressedBitVectorBuilder::FromBitPositions(setBits);
+    auto const roaring = coding::RoaringCBV::BuildFromCBV(*expected);
+
+    vector<uint8_t> expectedBuf;
+    vector<uint8_t> roaringBuf;
+    {
+      MemWriter<vector<uint8_t>> writer(expectedBuf);
+      expected->Serialize(writer);
+    }
+    {
+      MemWriter<vector<uint8_t>> writer(roaringBuf);
+      roaring->Serialize(writer);
+    }
+    TEST_EQUAL(roaringBuf, expectedBuf, (range, size));
+
+    MemReader reader(roaringBuf.data(), roaringBuf.size());
+    auto const cbv = coding::CompressedBitVectorBuilder::DeserializeFromReader(reader);
+    TEST_EQUAL(cbv->GetStorageStrategy(), expected->GetStorageStrategy(), ());
+    TEST_EQUAL(GetPositions(*cbv), setBits, ());
+  }
+}
+
+// Intersections which are typical for search: large category sets with small sets of features
+// from a rect and with dense sets. Compares the time with the plain std::set_intersection and
+// the time of the category in roaring containers.
+UNIT_TEST(CompressedBitVector_IntersectBenchmark)
+{
+  uint64_t constexpr kNumFeatures = 2000000;
+  size_t constexpr kNumIterations = 20;
+
+  mt19937 rng(0);
+  auto const category = GenerateRandomPositions(rng, kNumFeatures, 200000);
+  auto const rect = GenerateRandomPositions(rng, kNumFeatures, 3000);
+  auto const few = GenerateRandomPositions(rng, kNumFeatures, 50);
+  auto const similar = GenerateRandomPositions(rng, kNumFeatures, 150000);
+  auto const dense = GenerateRandomPositions(rng, kNumFeatures, 900000);
+
+  auto const categoryCBV = coding::CompressedBitVectorBuilder::FromBitPositions(category);
+  TEST_EQUAL(categoryCBV->GetStorageStrategy(), coding::CompressedBitVector::StorageStrategy::Sparse, ());
+  auto const denseCBV = coding::CompressedBitVectorBuilder::FromBitPositions(dense);
+  TEST_EQUAL(denseCBV->GetStorageStrategy(), coding::CompressedBitVector::StorageStrategy::Dense, ());
+  auto const roaringCategoryCBV = coding::RoaringCBV::BuildFromCBV(*categoryCBV);
+
+  auto const run = [&](vector<uint64_t> const & other, char const * name)
+  {
+    auto const otherCBV = coding::CompressedBitVectorBuilder::FromBitPositions(other);
+
+    uint64_t popCount = 0;
+    base::Timer timer;
+    for (size_t i = 0; i < kNumIterations; ++i)
+      popCount += coding::CompressedBitVector::Intersect(*categoryCBV, *otherCBV)->PopCount();
+    double const cbvSeconds = timer.ElapsedSeconds();
+
+    uint64_t roaringPopCount = 0;
+    timer.Reset();
+    for (size_t i = 0; i < kNumIterations; ++i)
+      roaringPopCount += coding::CompressedBitVector::Intersect(*roaringCategoryCBV, *otherCBV)->PopCount();
+    double const roaringSeconds = timer.ElapsedSeconds();
+
+    uint64_t expectedPopCount = 0;
+    timer.Reset();
+    for (size_t i = 0; i < kNumIterations; ++i)
+    {
+      vector<uint64_t> result;
+      set_intersection(category.begin(), category.end(), other.begin(), other.end(), back_inserter(result));
+      expectedPopCount += result.size();
+    }
+    double const plainSeconds = timer.ElapsedSeconds();
+
+    TEST_EQUAL(popCount, expectedPopCount, (name));
+    TEST_EQUAL(roaringPopCount, expectedPopCount, (name));
+    LOG(LINFO, (name, ": CBV", cbvSeconds, "s, roaring CBV", roaringSeconds, "s, set_intersection", plainSeconds,
+                "s, speedup", plainSeconds / max(cbvSeconds, 1e-9), "roaring speedup",
+                plainSeconds / max(roaringSeconds, 1e-9)));
+  };
+
+  run(rect, "Category and rect");
+  run(few, "Category and a few features");
+  run(similar, "Category and a set of the same size");
+  run(dense, "Category and dense set");
+}
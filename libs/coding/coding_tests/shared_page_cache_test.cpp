@@ -0,0 +1,167 @@
+#include "testing/testing.hpp"
+
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+#include "coding/shared_page_cache.hpp"
+
+#include "base/scope_guard.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace shared_page_cache_test
+{
+using namespace std;
+
+string const kFileName = "shared_page_cache_test.file";
+
+vector<char> MakeData(size_t size, uint32_t seed)
+{
+  vector<char> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>((i * 31 + seed) % 251);
+  return data;
+}
+
+void WriteData(vector<char> const & data)
+{
+  FileWriter writer(kFileName);
+  writer.Write(data.data(), data.size());
+}
+
+void ReadRandomly(vector<char> const & data, size_t readsCount, uint32_t seed)
+{
+  FileReader const reader(kFileName);
+  mt19937 rng(seed);
+  vector<char> buffer;
+  for (size_t i = 0; i < readsCount; ++i)
+  {
+    size_t const pos = rng() % data.size();
+    size_t const size = rng() % min<size_t>(data.size() - pos, 5000);
+    buffer.resize(size);
+    reader.Read(pos, buffer.data(), size);
+    TEST(equal(buffer.begin(), buffer.end(), data.begin() + pos), (pos, size));
+  }
+}
+
+// Restores the disabled cache after the test.
+class ScopedSharedPageCache
+{
+public:
+  explicit ScopedSharedPageCache(uint64_t budget)
+  {
+    auto & cache = SharedPageCache::Instance();
+    cache.Clear();
+    cache.ResetStats();
+    cache.SetBudget(budget);
+  }
+
+  ~ScopedSharedPageCache()
+  {
+    SharedPageCache::Instance().SetBudget(0);
+    FileWriter::DeleteFileX(kFileName);
+  }
+};
+
+UNIT_TEST(SharedPageCache_ConcurrentReaders)
+{
+  ScopedSharedPageCache scopedCache(1024 * 1024);
+  auto const data = MakeData(200 * 1024, 0 /* seed */);
+  WriteData(data);
+
+  size_t constexpr kThreadsCount = 8;
+  size_t constexpr kReadsCount = 2000;
+  vector<thread> threads;
+  for (size_t i = 0; i < kThreadsCount; ++i)
+    threads.emplace_back([&data, i]() { ReadRandomly(data, kReadsCount, static_cast<uint32_t>(i)); });
+  for (auto & t : threads)
+    t.join();
+
+  auto const stats = SharedPageCache::Instance().GetStats();
+  uint64_t const pagesCount = data.size() >> FileReader::kDefaultLogPageSize;
+  // Every page is read once, unless several threads miss it at the same time.
+  TEST_LESS_OR_EQUAL(stats.m_misses, pagesCount * kThreadsCount, (stats));
+  TEST_GREATER(stats.m_hits, stats.m_misses, (stats));
+  TEST_LESS_OR_EQUAL(stats.m_bytes, data.size(), (stats));
+  TEST_EQUAL(stats.m_evictions, 0, (stats));
+}
+
+UNIT_TEST(SharedPageCache_Budget)
+{
+  uint64_t constexpr kBudget = 256 * 1024;
+  ScopedSharedPageCache scopedCache(kBudget);
+  auto const data = MakeData(1024 * 1024, 1 /* seed */);
+  WriteData(data);
+
+  ReadRandomly(data, 1000 /* readsCount */, 0 /* seed */);
+  {
+    FileReader const reader(kFileName);
+    vector<char> buffer(data.size());
+    reader.Read(0, buffer.data(), buffer.size());
+    TEST(buffer == data, ());
+  }
+
+  auto stats = SharedPageCache::Instance().GetStats();
+  TEST_LESS_OR_EQUAL(stats.m_bytes, kBudget, (stats));
+  TEST_GREATER(stats.m_evictions, 0, (stats));
+
+  SharedPageCache::Instance().SetBudget(kBudget / 2);
+  stats = SharedPageCache::Instance().GetStats();
+  TEST_LESS_OR_EQUAL(stats.m_bytes, kBudget / 2, (stats));
+}
+
+UNIT_TEST(SharedPageCache_RewrittenFile)
+{
+  ScopedSharedPageCache scopedCache(1024 * 1024);
+  auto const data1 = MakeData(10000, 1 /* seed */);
+  auto const data2 = MakeData(10000, 2 /* seed */);
+
+  WriteData(data1);
+  ReadRandomly(data1, 100 /* readsCount */, 0 /* seed */);
+
+  // The file is not read while it's rewritten, so the next reader must not see the old pages.
+  WriteData(data2);
+  ReadRandomly(data2, 100 /* readsCount */, 0 /* seed */);
+}
+
+UNIT_TEST(SharedPageCache_LastReader)
+{
+  ScopedSharedPageCache scopedCache(1024 * 1024);
+  auto const data = MakeData(10000, 4 /* seed */);
+  WriteData(data);
+
+  vector<char> buffer(data.size());
+  {
+    FileReader const reader(kFileName);
+    {
+      FileReader const other(kFileName);
+      other.Read(0, buffer.data(), buffer.size());
+    }
+    // The file still has a reader.
+    TEST_GREATER(SharedPageCache::Instance().GetStats().m_pages, 0, ());
+    reader.Read(0, buffer.data(), buffer.size());
+    TEST(buffer == data, ());
+  }
+
+  // Pages of a file without readers are dropped, they are not evicted by other files.
+  auto const stats = SharedPageCache::Instance().GetStats();
+  TEST_EQUAL(stats.m_pages, 0, (stats));
+  TEST_EQUAL(stats.m_bytes, 0, (stats));
+  TEST_EQUAL(stats.m_evictions, 0, (stats));
+}
+
+UNIT_TEST(SharedPageCache_Disabled)
+{
+  ScopedSharedPageCache scopedCache(0);
+  auto const data = MakeData(10000, 3 /* seed */);
+  WriteData(data);
+  ReadRandomly(data, 100 /* readsCount */, 0 /* seed */);
+
+  auto const stats = SharedPageCache::Instance().GetStats();
+  TEST_EQUAL(stats.m_hits + stats.m_misses, 0, (stats));
+  TEST_EQUAL(stats.m_pages, 0, (stats));
+}
+}  // namespace shared_page_cache_test
@@ -6,6 +6,13 @@
 
 #include <algorithm>
 #include <bit>
+#include <optional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace coding
 {
@@ -13,28 +20,673 @@ using std::make_unique, std::max, std::min, std::unique_ptr, std::vector;
 
 namespace
 {
+// When one of the sorted position lists is this many times longer than the other one, the elements
+// of the shorter list are looked up in the longer one instead of merging the lists.
+size_t constexpr kLookupRatio = 16;
+
+// Returns the first element of the sorted range [first, last) which is not less than |value|.
+// Steps grow exponentially, so consecutive lookups of increasing values cost O(log(distance)) each
+// instead of O(log(last - first)).
+template <typename It>
+It Gallop(It first, It last, uint64_t value)
+{
+  if (first == last || *first >= value)
+    return first;
+
+  // Invariant: *lo < value.
+  It lo = first;
+  size_t step = 1;
+  while (static_cast<size_t>(last - lo) > step)
+  {
+    It const probe = lo + step;
+    if (*probe >= value)
+      return std::lower_bound(lo + 1, probe, value);
+    lo = probe;
+    step *= 2;
+  }
+  return std::lower_bound(lo + 1, last, value);
+}
+
+// Returns the first element of the sorted range [first, last) which is not less than |value|.
+// The range is scanned by blocks of a few elements, comparisons inside a block have no branches
+// and are vectorized. It's faster than galloping when the element is expected to be close.
+template <typename It>
+It ScanByBlocks(It first, It last, uint64_t value)
+{
+  size_t constexpr kBlock = 8;
+  while (static_cast<size_t>(last - first) >= kBlock && first[kBlock - 1] < value)
+    first += kBlock;
+
+  size_t const size = min(static_cast<size_t>(last - first), kBlock);
+  size_t numLess = 0;
+  for (size_t i = 0; i < size; ++i)
+    numLess += static_cast<size_t>(first[i] < value);
+  return first + numLess;
+}
+
+// Returns the first element of the sorted range [first, last) which is not less than |value| when
+// about |expectedStep| elements are expected to be skipped.
+template <typename It>
+It Advance(It first, It last, uint64_t value, size_t expectedStep)
+{
+  size_t constexpr kMaxStepToScan = 256;
+  return expectedStep <= kMaxStepToScan ? ScanByBlocks(first, last, value) : Gallop(first, last, value);
+}
+
+// Intersects sorted position lists.
+vector<uint64_t> IntersectPositions(SparseCBV::TIterator aBegin, SparseCBV::TIterator aEnd,
+                                    SparseCBV::TIterator bBegin, SparseCBV::TIterator bEnd)
+{
+  size_t const sizeA = static_cast<size_t>(aEnd - aBegin);
+  size_t const sizeB = static_cast<size_t>(bEnd - bBegin);
+  if (sizeA > sizeB)
+    return IntersectPositions(bBegin, bEnd, aBegin, aEnd);
+
+  vector<uint64_t> resPos;
+  resPos.reserve(sizeA);
+  if (sizeA != 0 && sizeA * kLookupRatio < sizeB)
+  {
+    size_t const expectedStep = sizeB / sizeA;
+    for (auto it = aBegin; it != aEnd; ++it)
+    {
+      bBegin = Advance(bBegin, bEnd, *it, expectedStep);
+      if (bBegin == bEnd)
+        break;
+      if (*bBegin == *it)
+        resPos.push_back(*it);
+    }
+    return resPos;
+  }
+
+  std::set_intersection(aBegin, aEnd, bBegin, bEnd, back_inserter(resPos));
+  return resPos;
+}
+
+// Calls |fn| for positions of the set bits of |group| which is the |i|-th group of a dense bit vector.
+template <typename Fn>
+void ForEachSetBit(uint64_t group, size_t i, Fn && fn)
+{
+  for (; group != 0; group &= group - 1)
+    fn(DenseCBV::kBlockSize * i + std::countr_zero(group));
+}
+
+// Roaring containers ------------------------------------------------------------------------------
+using Container = RoaringCBV::Container;
+using ContainerType = RoaringCBV::ContainerType;
+
+size_t constexpr kBitmapWords = RoaringCBV::kBitmapWords;
+// Number of 16-bit values which are compared with one SIMD instruction.
+size_t constexpr kSimdBlock = 8;
+
+// SSE2 and NEON are available on all the x86-64 and arm64 targets, so the kernels don't need
+// special build flags. Other targets use loops which are vectorized by the compiler if possible.
+
+// Returns true if one of kSimdBlock values of |block| equals |value|.
+bool ContainsInBlock(uint16_t const * block, uint16_t value)
+{
+#if defined(__SSE2__)
+  __m128i const values = _mm_loadu_si128(reinterpret_cast<__m128i const *>(block));
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(values, _mm_set1_epi16(static_cast<short>(value)))) != 0;
+#elif defined(__ARM_NEON)
+  uint64x2_t const equal = vreinterpretq_u64_u16(vceqq_u16(vld1q_u16(block), vdupq_n_u16(value)));
+  return (vgetq_lane_u64(equal, 0) | vgetq_lane_u64(equal, 1)) != 0;
+#else
+  bool found = false;
+  for (size_t i = 0; i < kSimdBlock; ++i)
+    found |= block[i] == value;
+  return found;
+#endif
+}
+
+// Intersects sorted arrays, |sizeA| <= |sizeB|. Writes the result to |out| and returns its size.
+size_t IntersectArrays(uint16_t const * a, size_t sizeA, uint16_t const * b, size_t sizeB, uint16_t * out)
+{
+  size_t count = 0;
+  if (sizeA * kLookupRatio < sizeB)
+  {
+    uint16_t const * it = b;
+    uint16_t const * const end = b + sizeB;
+    for (size_t i = 0; i < sizeA && it != end; ++i)
+    {
+      it = Gallop(it, end, a[i]);
+      if (it != end && *it == a[i])
+        out[count++] = a[i];
+    }
+    return count;
+  }
+
+  size_t j = 0;
+  for (size_t i = 0; i < sizeA; ++i)
+  {
+    uint16_t const value = a[i];
+    while (j + kSimdBlock <= sizeB && b[j + kSimdBlock - 1] < value)
+      j += kSimdBlock;
+
+    // All the values before the block are less than |value|, so it may be in the block only.
+    if (j + kSimdBlock <= sizeB)
+    {
+      if (ContainsInBlock(b + j, value))
+        out[count++] = value;
+      continue;
+    }
+
+    while (j < sizeB && b[j] < value)
+      ++j;
+    if (j == sizeB)
+      break;
+    if (b[j] == value)
+      out[count++] = value;
+  }
+  return count;
+}
+
+struct AndWords
+{
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a & b; }
+#if defined(__SSE2__)
+  __m128i operator()(__m128i a, __m128i b) const { return _mm_and_si128(a, b); }
+#elif defined(__ARM_NEON)
+  uint64x2_t operator()(uint64x2_t a, uint64x2_t b) const { return vandq_u64(a, b); }
+#endif
+};
+
+struct OrWords
+{
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a | b; }
+#if defined(__SSE2__)
+  __m128i operator()(__m128i a, __m128i b) const { return _mm_or_si128(a, b); }
+#elif defined(__ARM_NEON)
+  uint64x2_t operator()(uint64x2_t a, uint64x2_t b) const { return vorrq_u64(a, b); }
+#endif
+};
+
+struct AndNotWords
+{
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a & ~b; }
+#if defined(__SSE2__)
+  __m128i operator()(__m128i a, __m128i b) const { return _mm_andnot_si128(b, a); }
+#elif defined(__ARM_NEON)
+  uint64x2_t operator()(uint64x2_t a, uint64x2_t b) const { return vbicq_u64(a, b); }
+#endif
+};
+
+// Writes |op| of the bitmaps |a| and |b| to |out|, which may be one of them. Returns the number
+// of set bits of the result.
+template <typename Op>
+uint32_t CombineWords(uint64_t const * a, uint64_t const * b, uint64_t * out, Op const & op)
+{
+#if defined(__SSE2__)
+  for (size_t i = 0; i < kBitmapWords; i += 2)
+  {
+    __m128i const wa = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i));
+    __m128i const wb = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), op(wa, wb));
+  }
+#elif defined(__ARM_NEON)
+  for (size_t i = 0; i < kBitmapWords; i += 2)
+    vst1q_u64(out + i, op(vld1q_u64(a + i), vld1q_u64(b + i)));
+#else
+  for (size_t i = 0; i < kBitmapWords; ++i)
+    out[i] = op(a[i], b[i]);
+#endif
+
+  uint32_t popCount = 0;
+  for (size_t i = 0; i < kBitmapWords; ++i)
+    popCount += std::popcount(out[i]);
+  return popCount;
+}
+
+uint32_t RunFirst(vector<uint16_t> const & runs, size_t i)
+{
+  return runs[i];
+}
+
+uint32_t RunLast(vector<uint16_t> const & runs, size_t i)
+{
+  return static_cast<uint32_t>(runs[i]) + runs[i + 1];
+}
+
+// Appends the run [first, last] to |runs|, it's merged with the last run if they overlap or touch.
+// Runs are appended in the order of their first values.
+void AppendRun(vector<uint16_t> & runs, uint32_t first, uint32_t last)
+{
+  if (!runs.empty())
+  {
+    size_t const i = runs.size() - 2;
+    if (first <= RunLast(runs, i) + 1)
+    {
+      if (last > RunLast(runs, i))
+        runs[i + 1] = static_cast<uint16_t>(last - RunFirst(runs, i));
+      return;
+    }
+  }
+  runs.push_back(static_cast<uint16_t>(first));
+  runs.push_back(static_cast<uint16_t>(last - first));
+}
+
+uint32_t RunsPopCount(vector<uint16_t> const & runs)
+{
+  uint32_t popCount = 0;
+  for (size_t i = 0; i < runs.size(); i += 2)
+    popCount += static_cast<uint32_t>(runs[i + 1]) + 1;
+  return popCount;
+}
+
+// Sets the bits [first, last] of the bitmap.
+void SetRange(uint64_t * words, uint32_t first, uint32_t last)
+{
+  size_t const firstWord = first / 64;
+  size_t const lastWord = last / 64;
+  uint64_t const firstMask = ~static_cast<uint64_t>(0) << (first % 64);
+  uint64_t const lastMask = ~static_cast<uint64_t>(0) >> (63 - last % 64);
+  if (firstWord == lastWord)
+  {
+    words[firstWord] |= firstMask & lastMask;
+    return;
+  }
+
+  words[firstWord] |= firstMask;
+  for (size_t i = firstWord + 1; i < lastWord; ++i)
+    words[i] = ~static_cast<uint64_t>(0);
+  words[lastWord] |= lastMask;
+}
+
+// Writes the bitmap of |c| to |words|.
+void ToWords(Container const & c, vector<uint64_t> & words)
+{
+  if (c.m_type == ContainerType::Bitmap)
+  {
+    words = c.m_words;
+    return;
+  }
+
+  words.assign(kBitmapWords, 0);
+  if (c.m_type == ContainerType::Array)
+  {
+    for (uint16_t const value : c.m_values)
+      words[value / 64] |= static_cast<uint64_t>(1) << (value % 64);
+    return;
+  }
+
+  for (size_t i = 0; i < c.m_values.size(); i += 2)
+    SetRange(words.data(), RunFirst(c.m_values, i), RunLast(c.m_values, i));
+}
+
+// Returns the bitmap of |c|, |buffer| keeps it if |c| isn't a bitmap.
+uint64_t const * GetWords(Container const & c, vector<uint64_t> & buffer)
+{
+  if (c.m_type == ContainerType::Bitmap)
+    return c.m_words.data();
+  ToWords(c, buffer);
+  return buffer.data();
+}
+
+bool Contains(Container const & c, uint16_t value)
+{
+  switch (c.m_type)
+  {
+  case ContainerType::Array: return std::binary_search(c.m_values.begin(), c.m_values.end(), value);
+  case ContainerType::Bitmap: return (c.m_words[value / 64] >> (value % 64)) & 1;
+  case ContainerType::Run:
+  {
+    // Looks for the last run which begins not after |value|.
+    size_t lo = 0;
+    size_t hi = c.m_values.size() / 2;
+    while (lo < hi)
+    {
+      size_t const mid = (lo + hi) / 2;
+      if (c.m_values[2 * mid] <= value)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo != 0 && value <= RunLast(c.m_values, 2 * (lo - 1));
+  }
+  }
+  UNREACHABLE();
+}
+
+size_t CountRuns(Container const & c)
+{
+  switch (c.m_type)
+  {
+  case ContainerType::Array:
+  {
+    size_t runs = 0;
+    for (size_t i = 0; i < c.m_values.size(); ++i)
+      runs += static_cast<size_t>(i == 0 || c.m_values[i] != c.m_values[i - 1] + 1);
+    return runs;
+  }
+  case ContainerType::Bitmap:
+  {
+    // A run begins at a set bit which follows an unset one.
+    size_t runs = 0;
+    uint64_t carry = 0;
+    for (uint64_t const word : c.m_words)
+    {
+      runs += std::popcount(word & ~((word << 1) | carry));
+      carry = word >> 63;
+    }
+    return runs;
+  }
+  case ContainerType::Run: return c.m_values.size() / 2;
+  }
+  UNREACHABLE();
+}
+
+void Convert(Container & c, ContainerType type)
+{
+  Container res;
+  res.m_type = type;
+  res.m_popCount = c.m_popCount;
+  switch (type)
+  {
+  case ContainerType::Array:
+    res.m_values.reserve(c.m_popCount);
+    c.ForEach(0 /* offset */, [&res](uint64_t value) { res.m_values.push_back(static_cast<uint16_t>(value)); });
+    break;
+  case ContainerType::Bitmap: ToWords(c, res.m_words); break;
+  case ContainerType::Run:
+    c.ForEach(0 /* offset */, [&res](uint64_t value)
+    { AppendRun(res.m_values, static_cast<uint32_t>(value), static_cast<uint32_t>(value)); });
+    break;
+  }
+  c = std::move(res);
+}
+
+// Converts |c| to the container which takes the least memory.
+void Optimize(Container & c)
+{
+  size_t const arrayBytes = c.m_popCount * sizeof(uint16_t);
+  size_t const bitmapBytes = kBitmapWords * sizeof(uint64_t);
+  size_t const runBytes = CountRuns(c) * 2 * sizeof(uint16_t);
+
+  auto type = c.m_popCount <= RoaringCBV::kMaxArraySize ? ContainerType::Array : ContainerType::Bitmap;
+  if (runBytes < min(arrayBytes, bitmapBytes))
+    type = ContainerType::Run;
+  if (type != c.m_type)
+    Convert(c, type);
+}
+
+// Makes a container of the sorted positions [begin, end) which have the same high bits.
+template <typename It>
+Container MakeContainer(It begin, It end)
+{
+  Container c;
+  c.m_popCount = static_cast<uint32_t>(end - begin);
+  if (c.m_popCount <= RoaringCBV::kMaxArraySize)
+  {
+    c.m_values.reserve(c.m_popCount);
+    for (auto it = begin; it != end; ++it)
+      c.m_values.push_back(static_cast<uint16_t>(*it));
+  }
+  else
+  {
+    c.m_type = ContainerType::Bitmap;
+    c.m_words.assign(kBitmapWords, 0);
+    for (auto it = begin; it != end; ++it)
+    {
+      auto const value = static_cast<uint16_t>(*it);
+      c.m_words[value / 64] |= static_cast<uint64_t>(1) << (value % 64);
+    }
+  }
+  Optimize(c);
+  return c;
+}
+
+// Splits the sorted positions [begin, end) into containers.
+template <typename It>
+void AppendContainers(It begin, It end, vector<uint64_t> & keys, vector<Container> & containers)
+{
+  while (begin != end)
+  {
+    uint64_t const key = *begin >> RoaringCBV::kContainerBits;
+    auto const next =
+        std::find_if(begin, end, [key](uint64_t pos) { return pos >> RoaringCBV::kContainerBits != key; });
+    keys.push_back(key);
+    containers.push_back(MakeContainer(begin, next));
+    begin = next;
+  }
+}
+
+Container IntersectContainers(Container const & a, Container const & b)
+{
+  Container res;
+  if (a.m_type == ContainerType::Array && b.m_type == ContainerType::Array)
+  {
+    auto const & shorter = a.m_values.size() <= b.m_values.size() ? a.m_values : b.m_values;
+    auto const & longer = a.m_values.size() <= b.m_values.size() ? b.m_values : a.m_values;
+    res.m_values.resize(shorter.size());
+    res.m_values.resize(
+        IntersectArrays(shorter.data(), shorter.size(), longer.data(), longer.size(), res.m_values.data()));
+    res.m_popCount = static_cast<uint32_t>(res.m_values.size());
+  }
+  else if (a.m_type == ContainerType::Array || b.m_type == ContainerType::Array)
+  {
+    auto const & array = a.m_type == ContainerType::Array ? a : b;
+    auto const & other = a.m_type == ContainerType::Array ? b : a;
+    for (uint16_t const value : array.m_values)
+      if (Contains(other, value))
+        res.m_values.push_back(value);
+    res.m_popCount = static_cast<uint32_t>(res.m_values.size());
+  }
+  else if (a.m_type == ContainerType::Run && b.m_type == ContainerType::Run)
+  {
+    res.m_type = ContainerType::Run;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.m_values.size() && j < b.m_values.size())
+    {
+      uint32_t const first = max(RunFirst(a.m_values, i), RunFirst(b.m_values, j));
+      uint32_t const last = min(RunLast(a.m_values, i), RunLast(b.m_values, j));
+      if (first <= last)
+        AppendRun(res.m_values, first, last);
+      if (RunLast(a.m_values, i) < RunLast(b.m_values, j))
+        i += 2;
+      else
+        j += 2;
+    }
+    res.m_popCount = RunsPopCount(res.m_values);
+  }
+  else
+  {
+    res.m_type = ContainerType::Bitmap;
+    res.m_words.resize(kBitmapWords);
+    vector<uint64_t> bufferA;
+    vector<uint64_t> bufferB;
+    res.m_popCount = CombineWords(GetWords(a, bufferA), GetWords(b, bufferB), res.m_words.data(), AndWords());
+  }
+  Optimize(res);
+  return res;
+}
+
+Container UniteContainers(Container const & a, Container const & b)
+{
+  Container res;
+  if (a.m_type == ContainerType::Array && b.m_type == ContainerType::Array &&
+      a.m_values.size() + b.m_values.size() <= RoaringCBV::kMaxArraySize)
+  {
+    res.m_values.reserve(a.m_values.size() + b.m_values.size());
+    std::set_union(a.m_values.begin(), a.m_values.end(), b.m_values.begin(), b.m_values.end(),
+                   back_inserter(res.m_values));
+    res.m_popCount = static_cast<uint32_t>(res.m_values.size());
+  }
+  else if (a.m_type == ContainerType::Run && b.m_type == ContainerType::Run)
+  {
+    res.m_type = ContainerType::Run;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.m_values.size() || j < b.m_values.size())
+    {
+      bool const takeA = j == b.m_values.size() ||
+                         (i < a.m_values.size() && RunFirst(a.m_values, i) <= RunFirst(b.m_values, j));
+      auto const & runs = takeA ? a.m_values : b.m_values;
+      size_t & k = takeA ? i : j;
+      AppendRun(res.m_values, RunFirst(runs, k), RunLast(runs, k));
+      k += 2;
+    }
+    res.m_popCount = RunsPopCount(res.m_values);
+  }
+  else
+  {
+    // The array is added to the bitmap of the other container, other containers are combined as bitmaps.
+    bool const aIsArray = a.m_type == ContainerType::Array;
+    auto const & wider = aIsArray ? b : a;
+    auto const & other = aIsArray ? a : b;
+    res.m_type = ContainerType::Bitmap;
+    ToWords(wider, res.m_words);
+    if (other.m_type == ContainerType::Array)
+    {
+      for (uint16_t const value : other.m_values)
+        res.m_words[value / 64] |= static_cast<uint64_t>(1) << (value % 64);
+      for (uint64_t const word : res.m_words)
+        res.m_popCount += std::popcount(word);
+    }
+    else
+    {
+      vector<uint64_t> buffer;
+      res.m_popCount = CombineWords(res.m_words.data(), GetWords(other, buffer), res.m_words.data(), OrWords());
+    }
+  }
+  Optimize(res);
+  return res;
+}
+
+Container SubtractContainers(Container const & a, Container const & b)
+{
+  Container res;
+  if (a.m_type == ContainerType::Array)
+  {
+    if (b.m_type == ContainerType::Array)
+    {
+      std::set_difference(a.m_values.begin(), a.m_values.end(), b.m_values.begin(), b.m_values.end(),
+                          back_inserter(res.m_values));
+    }
+    else
+    {
+      for (uint16_t const value : a.m_values)
+        if (!Contains(b, value))
+          res.m_values.push_back(value);
+    }
+    res.m_popCount = static_cast<uint32_t>(res.m_values.size());
+  }
+  else
+  {
+    res.m_type = ContainerType::Bitmap;
+    ToWords(a, res.m_words);
+    if (b.m_type == ContainerType::Array)
+    {
+      for (uint16_t const value : b.m_values)
+        res.m_words[value / 64] &= ~(static_cast<uint64_t>(1) << (value % 64));
+      for (uint64_t const word : res.m_words)
+        res.m_popCount += std::popcount(word);
+    }
+    else
+    {
+      vector<uint64_t> buffer;
+      res.m_popCount = CombineWords(res.m_words.data(), GetWords(b, buffer), res.m_words.data(), AndNotWords());
+    }
+  }
+  Optimize(res);
+  return res;
+}
+
+// Calls |fn| for the containers which are present in both bit vectors, |onlyA| and |onlyB| for
+// the containers which are present in one of them. Returns the bit vector of the non-empty
+// resulting containers.
+template <typename Fn, typename OnlyAFn, typename OnlyBFn>
+unique_ptr<RoaringCBV> CombineContainers(RoaringCBV const & a, RoaringCBV const & b, Fn && fn, OnlyAFn && onlyA,
+                                         OnlyBFn && onlyB)
+{
+  auto const & keysA = a.GetKeys();
+  auto const & keysB = b.GetKeys();
+  auto const & containersA = a.GetContainers();
+  auto const & containersB = b.GetContainers();
+
+  vector<uint64_t> keys;
+  vector<Container> containers;
+  auto const append = [&keys, &containers](uint64_t key, std::optional<Container> && c)
+  {
+    if (!c || c->m_popCount == 0)
+      return;
+    keys.push_back(key);
+    containers.push_back(std::move(*c));
+  };
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < keysA.size() || j < keysB.size())
+  {
+    if (j == keysB.size() || (i < keysA.size() && keysA[i] < keysB[j]))
+    {
+      append(keysA[i], onlyA(containersA[i]));
+      ++i;
+    }
+    else if (i == keysA.size() || keysB[j] < keysA[i])
+    {
+      append(keysB[j], onlyB(containersB[j]));
+      ++j;
+    }
+    else
+    {
+      append(keysA[i], fn(containersA[i], containersB[j]));
+      ++i;
+      ++j;
+    }
+  }
+  return RoaringCBV::BuildFromContainers(std::move(keys), std::move(containers));
+}
+
+std::optional<Container> Skip(Container const & /* c */)
+{
+  return {};
+}
+
+std::optional<Container> Copy(Container const & c)
+{
+  return c;
+}
+
+// Returns |cbv| as a roaring bit vector, |holder| keeps it if it's converted.
+RoaringCBV const & AsRoaring(CompressedBitVector const & cbv, unique_ptr<RoaringCBV> & holder)
+{
+  if (cbv.GetStorageStrategy() == CompressedBitVector::StorageStrategy::Roaring)
+    return static_cast<RoaringCBV const &>(cbv);
+  holder = RoaringCBV::BuildFromCBV(cbv);
+  return *holder;
+}
+
 struct IntersectOp
 {
   IntersectOp() {}
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::DenseCBV const & a, coding::DenseCBV const & b) const
   {
-    size_t const sizeA = a.NumBitGroups();
-    size_t const sizeB = b.NumBitGroups();
-    vector<uint64_t> resGroups(min(sizeA, sizeB));
+    auto const & groupsA = a.GetBitGroups();
+    auto const & groupsB = b.GetBitGroups();
+    vector<uint64_t> resGroups(min(groupsA.size(), groupsB.size()));
+    // Plain loops over raw words are vectorized by the compiler.
+    uint64_t const * ga = groupsA.data();
+    uint64_t const * gb = groupsB.data();
+    uint64_t * res = resGroups.data();
     for (size_t i = 0; i < resGroups.size(); ++i)
-      resGroups[i] = a.GetBitGroup(i) & b.GetBitGroup(i);
+      res[i] = ga[i] & gb[i];
     return coding::CompressedBitVectorBuilder::FromBitGroups(std::move(resGroups));
   }
 
   // The intersection of dense and sparse is always sparse.
   unique_ptr<coding::CompressedBitVector> operator()(coding::DenseCBV const & a, coding::SparseCBV const & b) const
   {
+    auto const & groups = a.GetBitGroups();
+    uint64_t const numBits = groups.size() * DenseCBV::kBlockSize;
+
     vector<uint64_t> resPos;
-    for (size_t i = 0; i < b.PopCount(); ++i)
+    resPos.reserve(static_cast<size_t>(min(a.PopCount(), b.PopCount())));
+    // Positions of |b| are sorted, the ones past the end of |a| can't be set in |a|.
+    for (auto it = b.Begin(); it != b.End() && *it < numBits; ++it)
     {
-      auto pos = b.Select(i);
-      if (a.GetBit(pos))
+      uint64_t const pos = *it;
+      if ((groups[static_cast<size_t>(pos / DenseCBV::kBlockSize)] >> (pos % DenseCBV::kBlockSize)) & 1)
         resPos.push_back(pos);
     }
     return make_unique<coding::SparseCBV>(std::move(resPos));
@@ -47,10 +699,39 @@ struct IntersectOp
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::SparseCBV const & b) const
   {
+    return make_unique<coding::SparseCBV>(IntersectPositions(a.Begin(), a.End(), b.Begin(), b.End()));
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return CombineContainers(a, b, &IntersectContainers, &Skip, &Skip);
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::SparseCBV const & b) const
+  {
+    if (b.PopCount() * kLookupRatio >= a.PopCount())
+      return operator()(a, *RoaringCBV::BuildFromCBV(b));
+
+    // A few positions are looked up in the containers, the intersection is sparse as well.
+    auto const & keys = a.GetKeys();
     vector<uint64_t> resPos;
-    set_intersection(a.Begin(), a.End(), b.Begin(), b.End(), back_inserter(resPos));
+    auto keyIt = keys.begin();
+    for (auto it = b.Begin(); it != b.End(); ++it)
+    {
+      uint64_t const key = *it >> RoaringCBV::kContainerBits;
+      keyIt = Gallop(keyIt, keys.end(), key);
+      if (keyIt == keys.end())
+        break;
+      if (*keyIt == key && Contains(a.GetContainers()[keyIt - keys.begin()], static_cast<uint16_t>(*it)))
+        resPos.push_back(*it);
+    }
     return make_unique<coding::SparseCBV>(std::move(resPos));
   }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return operator()(b, a);
+  }
 };
 
 struct SubtractOp
@@ -59,11 +740,15 @@ struct SubtractOp
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::DenseCBV const & a, coding::DenseCBV const & b) const
   {
-    size_t const sizeA = a.NumBitGroups();
-    size_t const sizeB = b.NumBitGroups();
-    vector<uint64_t> resGroups(min(sizeA, sizeB));
-    for (size_t i = 0; i < resGroups.size(); ++i)
-      resGroups[i] = a.GetBitGroup(i) & ~b.GetBitGroup(i);
+    auto const & groupsA = a.GetBitGroups();
+    auto const & groupsB = b.GetBitGroups();
+    size_t const commonSize = min(groupsA.size(), groupsB.size());
+    // Groups of |a| past the end of |b| stay as is.
+    vector<uint64_t> resGroups(groupsA);
+    uint64_t const * gb = groupsB.data();
+    uint64_t * res = resGroups.data();
+    for (size_t i = 0; i < commonSize; ++i)
+      res[i] &= ~gb[i];
     return CompressedBitVectorBuilder::FromBitGroups(std::move(resGroups));
   }
 
@@ -96,17 +781,58 @@ struct SubtractOp
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::DenseCBV const & b) const
   {
+    auto const & groups = b.GetBitGroups();
+    uint64_t const numBits = groups.size() * DenseCBV::kBlockSize;
+
     vector<uint64_t> resPos;
-    copy_if(a.Begin(), a.End(), back_inserter(resPos), [&](uint64_t bit) { return !b.GetBit(bit); });
+    resPos.reserve(static_cast<size_t>(a.PopCount()));
+    auto it = a.Begin();
+    for (; it != a.End() && *it < numBits; ++it)
+    {
+      uint64_t const pos = *it;
+      if (((groups[static_cast<size_t>(pos / DenseCBV::kBlockSize)] >> (pos % DenseCBV::kBlockSize)) & 1) == 0)
+        resPos.push_back(pos);
+    }
+    resPos.insert(resPos.end(), it, a.End());
     return CompressedBitVectorBuilder::FromBitPositions(std::move(resPos));
   }
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::SparseCBV const & b) const
   {
     vector<uint64_t> resPos;
-    set_difference(a.Begin(), a.End(), b.Begin(), b.End(), back_inserter(resPos));
+    resPos.reserve(static_cast<size_t>(a.PopCount()));
+    if (a.PopCount() != 0 && a.PopCount() * kLookupRatio < b.PopCount())
+    {
+      auto const expectedStep = static_cast<size_t>(b.PopCount() / a.PopCount());
+      auto j = b.Begin();
+      for (auto it = a.Begin(); it != a.End(); ++it)
+      {
+        j = Advance(j, b.End(), *it, expectedStep);
+        if (j == b.End() || *j != *it)
+          resPos.push_back(*it);
+      }
+    }
+    else
+    {
+      set_difference(a.Begin(), a.End(), b.Begin(), b.End(), back_inserter(resPos));
+    }
     return CompressedBitVectorBuilder::FromBitPositions(std::move(resPos));
   }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return CombineContainers(a, b, &SubtractContainers, &Copy, &Skip);
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::SparseCBV const & b) const
+  {
+    return operator()(a, *RoaringCBV::BuildFromCBV(b));
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return operator()(*RoaringCBV::BuildFromCBV(a), b);
+  }
 };
 
 struct UnionOp
@@ -115,20 +841,16 @@ struct UnionOp
 
   unique_ptr<coding::CompressedBitVector> operator()(coding::DenseCBV const & a, coding::DenseCBV const & b) const
   {
-    size_t const sizeA = a.NumBitGroups();
-    size_t const sizeB = b.NumBitGroups();
-
-    size_t commonSize = min(sizeA, sizeB);
-    size_t resultSize = max(sizeA, sizeB);
-    vector<uint64_t> resGroups(resultSize);
-    for (size_t i = 0; i < commonSize; ++i)
-      resGroups[i] = a.GetBitGroup(i) | b.GetBitGroup(i);
-    if (a.NumBitGroups() == resultSize)
-      for (size_t i = commonSize; i < resultSize; ++i)
-        resGroups[i] = a.GetBitGroup(i);
-    else
-      for (size_t i = commonSize; i < resultSize; ++i)
-        resGroups[i] = b.GetBitGroup(i);
+    auto const & groupsA = a.GetBitGroups();
+    auto const & groupsB = b.GetBitGroups();
+    auto const & longer = groupsA.size() >= groupsB.size() ? groupsA : groupsB;
+    auto const & shorter = groupsA.size() >= groupsB.size() ? groupsB : groupsA;
+
+    vector<uint64_t> resGroups(longer);
+    uint64_t const * gs = shorter.data();
+    uint64_t * res = resGroups.data();
+    for (size_t i = 0; i < shorter.size(); ++i)
+      res[i] |= gs[i];
     return CompressedBitVectorBuilder::FromBitGroups(std::move(resGroups));
   }
 
@@ -151,6 +873,8 @@ struct UnionOp
           resPos.push_back(*j);
           ++j;
         }
+        if (j < b.End() && *j == va)
+          ++j;
         resPos.push_back(va);
       };
       a.ForEach(merge);
@@ -189,9 +913,25 @@ struct UnionOp
   unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::SparseCBV const & b) const
   {
     vector<uint64_t> resPos;
+    resPos.reserve(static_cast<size_t>(a.PopCount() + b.PopCount()));
     set_union(a.Begin(), a.End(), b.Begin(), b.End(), back_inserter(resPos));
     return CompressedBitVectorBuilder::FromBitPositions(std::move(resPos));
   }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return CombineContainers(a, b, &UniteContainers, &Copy, &Copy);
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::RoaringCBV const & a, coding::SparseCBV const & b) const
+  {
+    return operator()(a, *RoaringCBV::BuildFromCBV(b));
+  }
+
+  unique_ptr<coding::CompressedBitVector> operator()(coding::SparseCBV const & a, coding::RoaringCBV const & b) const
+  {
+    return operator()(b, a);
+  }
 };
 
 template <typename TBinaryOp>
@@ -201,6 +941,25 @@ unique_ptr<coding::CompressedBitVector> Apply(TBinaryOp const & op, CompressedBi
   using strat = CompressedBitVector::StorageStrategy;
   auto const stratA = lhs.GetStorageStrategy();
   auto const stratB = rhs.GetStorageStrategy();
+  if (stratA == strat::Roaring && stratB == strat::Sparse)
+  {
+    RoaringCBV const & a = static_cast<RoaringCBV const &>(lhs);
+    SparseCBV const & b = static_cast<SparseCBV const &>(rhs);
+    return op(a, b);
+  }
+  if (stratA == strat::Sparse && stratB == strat::Roaring)
+  {
+    SparseCBV const & a = static_cast<SparseCBV const &>(lhs);
+    RoaringCBV const & b = static_cast<RoaringCBV const &>(rhs);
+    return op(a, b);
+  }
+  if (stratA == strat::Roaring || stratB == strat::Roaring)
+  {
+    // A dense bit vector is converted, it takes about the same time as the operation itself.
+    unique_ptr<RoaringCBV> holderA;
+    unique_ptr<RoaringCBV> holderB;
+    return op(AsRoaring(lhs, holderA), AsRoaring(rhs, holderB));
+  }
   if (stratA == strat::Dense && stratB == strat::Dense)
   {
     DenseCBV const & a = static_cast<DenseCBV const &>(lhs);
@@ -399,6 +1158,136 @@ unique_ptr<CompressedBitVector> SparseCBV::Clone() const
   return unique_ptr<CompressedBitVector>(cbv);
 }
 
+RoaringCBV::RoaringCBV(vector<uint64_t> const & setBits) : m_popCount(setBits.size())
+{
+  ASSERT(is_sorted(setBits.begin(), setBits.end()), ());
+  AppendContainers(setBits.begin(), setBits.end(), m_keys, m_containers);
+}
+
+// static
+unique_ptr<RoaringCBV> RoaringCBV::BuildFromCBV(CompressedBitVector const & cbv)
+{
+  switch (cbv.GetStorageStrategy())
+  {
+  case StorageStrategy::Dense:
+  {
+    auto const & groups = static_cast<DenseCBV const &>(cbv).GetBitGroups();
+    vector<uint64_t> keys;
+    vector<Container> containers;
+    for (size_t begin = 0; begin < groups.size(); begin += kBitmapWords)
+    {
+      size_t const end = min(begin + kBitmapWords, groups.size());
+      Container c;
+      c.m_type = ContainerType::Bitmap;
+      c.m_words.assign(groups.begin() + begin, groups.begin() + end);
+      c.m_words.resize(kBitmapWords);
+      for (uint64_t const word : c.m_words)
+        c.m_popCount += std::popcount(word);
+      if (c.m_popCount == 0)
+        continue;
+
+      Optimize(c);
+      keys.push_back(begin / kBitmapWords);
+      containers.push_back(std::move(c));
+    }
+    return BuildFromContainers(std::move(keys), std::move(containers));
+  }
+  case StorageStrategy::Sparse:
+  {
+    auto const & sparse = static_cast<SparseCBV const &>(cbv);
+    vector<uint64_t> keys;
+    vector<Container> containers;
+    AppendContainers(sparse.Begin(), sparse.End(), keys, containers);
+    return BuildFromContainers(std::move(keys), std::move(containers));
+  }
+  case StorageStrategy::Roaring:
+  {
+    auto const & roaring = static_cast<RoaringCBV const &>(cbv);
+    return BuildFromContainers(vector<uint64_t>(roaring.m_keys), vector<Container>(roaring.m_containers));
+  }
+  }
+  UNREACHABLE();
+}
+
+// static
+unique_ptr<RoaringCBV> RoaringCBV::BuildFromContainers(vector<uint64_t> && keys, vector<Container> && containers)
+{
+  ASSERT_EQUAL(keys.size(), containers.size(), ());
+  ASSERT(is_sorted(keys.begin(), keys.end()), ());
+
+  auto cbv = make_unique<RoaringCBV>();
+  for (auto const & c : containers)
+  {
+    ASSERT_NOT_EQUAL(c.m_popCount, 0, ());
+    cbv->m_popCount += c.m_popCount;
+  }
+  cbv->m_keys = std::move(keys);
+  cbv->m_containers = std::move(containers);
+  return cbv;
+}
+
+uint64_t RoaringCBV::PopCount() const
+{
+  return m_popCount;
+}
+
+bool RoaringCBV::GetBit(uint64_t pos) const
+{
+  auto const it = lower_bound(m_keys.begin(), m_keys.end(), pos >> kContainerBits);
+  if (it == m_keys.end() || *it != pos >> kContainerBits)
+    return false;
+  return Contains(m_containers[it - m_keys.begin()], static_cast<uint16_t>(pos));
+}
+
+unique_ptr<CompressedBitVector> RoaringCBV::LeaveFirstSetNBits(uint64_t n) const
+{
+  if (PopCount() <= n)
+    return Clone();
+
+  vector<uint64_t> keys;
+  vector<Container> containers;
+  for (size_t i = 0; i < m_keys.size() && n != 0; ++i)
+  {
+    auto const & c = m_containers[i];
+    keys.push_back(m_keys[i]);
+    if (c.m_popCount <= n)
+    {
+      n -= c.m_popCount;
+      containers.push_back(c);
+      continue;
+    }
+
+    vector<uint16_t> values;
+    c.ForEach(0 /* offset */, [&values, n](uint64_t value)
+    {
+      values.push_back(static_cast<uint16_t>(value));
+      return values.size() < n ? base::ControlFlow::Continue : base::ControlFlow::Break;
+    });
+    containers.push_back(MakeContainer(values.begin(), values.end()));
+    n = 0;
+  }
+  return BuildFromContainers(std::move(keys), std::move(containers));
+}
+
+CompressedBitVector::StorageStrategy RoaringCBV::GetStorageStrategy() const
+{
+  return CompressedBitVector::StorageStrategy::Roaring;
+}
+
+void RoaringCBV::Serialize(Writer & writer) const
+{
+  // The same format as the one of the bit vector which is built from the same positions.
+  vector<uint64_t> setBits;
+  setBits.reserve(static_cast<size_t>(m_popCount));
+  ForEach([&setBits](uint64_t pos) { setBits.push_back(pos); });
+  BuildFromBitPositions(std::move(setBits))->Serialize(writer);
+}
+
+unique_ptr<CompressedBitVector> RoaringCBV::Clone() const
+{
+  return BuildFromCBV(*this);
+}
+
 // static
 unique_ptr<CompressedBitVector> CompressedBitVectorBuilder::FromBitPositions(vector<uint64_t> const & setBits)
 {
@@ -430,13 +1319,10 @@ unique_ptr<CompressedBitVector> CompressedBitVectorBuilder::FromBitGroups(vector
     return DenseCBV::BuildFromBitGroups(std::move(bitGroups));
 
   vector<uint64_t> setBits;
+  setBits.reserve(static_cast<size_t>(popCount));
   for (size_t i = 0; i < bitGroups.size(); ++i)
-  {
-    for (size_t j = 0; j < kBlockSize; ++j)
-      if (((bitGroups[i] >> j) & 1) > 0)
-        setBits.push_back(kBlockSize * i + j);
-  }
-  return make_unique<SparseCBV>(setBits);
+    ForEachSetBit(bitGroups[i], i, [&setBits](uint64_t pos) { setBits.push_back(pos); });
+  return make_unique<SparseCBV>(std::move(setBits));
 }
 
 std::string DebugPrint(CompressedBitVector::StorageStrategy strat)
@@ -445,6 +1331,18 @@ std::string DebugPrint(CompressedBitVector::StorageStrategy strat)
   {
   case CompressedBitVector::StorageStrategy::Dense: return "Dense";
   case CompressedBitVector::StorageStrategy::Sparse: return "Sparse";
+  case CompressedBitVector::StorageStrategy::Roaring: return "Roaring";
+  }
+  UNREACHABLE();
+}
+
+std::string DebugPrint(RoaringCBV::ContainerType type)
+{
+  switch (type)
+  {
+  case RoaringCBV::ContainerType::Array: return "Array";
+  case RoaringCBV::ContainerType::Bitmap: return "Bitmap";
+  case RoaringCBV::ContainerType::Run: return "Run";
   }
   UNREACHABLE();
 }
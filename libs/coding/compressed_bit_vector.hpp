@@ -8,6 +8,7 @@
 #include "base/control_flow.hpp"
 #include "base/ref_counted.hpp"
 
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -23,7 +24,9 @@ public:
   enum class StorageStrategy
   {
     Dense,
-    Sparse
+    Sparse,
+    // In-memory only, such bit vectors are serialized as Dense or Sparse.
+    Roaring
   };
 
   virtual ~CompressedBitVector() = default;
@@ -70,7 +73,8 @@ public:
 
   // Writes the contents of a bit vector to writer.
   // The first byte is always the header that defines the format.
-  // Currently the header is 0 or 1 for Dense and Sparse strategies respectively.
+  // Currently the header is 0 or 1 for Dense and Sparse strategies respectively,
+  // Roaring bit vectors are written in one of these formats.
   // It is easier to dispatch via virtual method calls and not bother
   // with template TWriters here as we do in similar places in our code.
   // This should not pose too much a problem because commonly
@@ -108,20 +112,18 @@ public:
     base::ControlFlowWrapper<Fn> wrapper(std::forward<Fn>(f));
     for (size_t i = 0; i < m_bitGroups.size(); ++i)
     {
-      for (size_t j = 0; j < kBlockSize; ++j)
-      {
-        if (((m_bitGroups[i] >> j) & 1) > 0)
-        {
-          if (wrapper(kBlockSize * i + j) == base::ControlFlow::Break)
-            return;
-        }
-      }
+      // Jumps from one set bit to another, sparse groups are skipped fast.
+      for (uint64_t group = m_bitGroups[i]; group != 0; group &= group - 1)
+        if (wrapper(kBlockSize * i + std::countr_zero(group)) == base::ControlFlow::Break)
+          return;
     }
   }
 
   // Returns 0 if the group number is too large to be contained in m_bits.
   uint64_t GetBitGroup(size_t i) const;
 
+  std::vector<uint64_t> const & GetBitGroups() const { return m_bitGroups; }
+
   // CompressedBitVector overrides:
   uint64_t PopCount() const override;
   bool GetBit(uint64_t pos) const override;
@@ -175,6 +177,116 @@ private:
   std::vector<uint64_t> m_positions;
 };
 
+// Bit vector which is split into blocks of 2^16 bits like a Roaring bitmap. Every non-empty block
+// is kept in the container which takes the least memory: a sorted array of the low bits of the
+// positions, a bitmap or a list of runs of set bits. Set operations process only the blocks which
+// are present in both vectors, arrays and bitmaps are combined with SIMD kernels.
+// It's an in-memory representation for bit vectors which are intersected many times, e.g. the
+// features of a category in an mwm. It's serialized in the Dense or Sparse format.
+class RoaringCBV : public CompressedBitVector
+{
+public:
+  static uint8_t constexpr kContainerBits = 16;
+  static uint64_t constexpr kContainerSize = static_cast<uint64_t>(1) << kContainerBits;
+  static size_t constexpr kBitmapWords = kContainerSize / 64;
+  // Arrays of more values take more memory than bitmaps.
+  static size_t constexpr kMaxArraySize = kContainerSize / 16;
+
+  enum class ContainerType : uint8_t
+  {
+    Array,
+    Bitmap,
+    Run
+  };
+
+  struct Container
+  {
+    // Calls |fn| for the positions of the set bits, |offset| is the position of the first bit of the block.
+    template <typename Fn>
+    base::ControlFlow ForEach(uint64_t offset, Fn && fn) const
+    {
+      base::ControlFlowWrapper<Fn> wrapper(std::forward<Fn>(fn));
+      switch (m_type)
+      {
+      case ContainerType::Array:
+        for (uint16_t const value : m_values)
+          if (wrapper(offset + value) == base::ControlFlow::Break)
+            return base::ControlFlow::Break;
+        break;
+      case ContainerType::Bitmap:
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+          for (uint64_t word = m_words[i]; word != 0; word &= word - 1)
+            if (wrapper(offset + 64 * i + std::countr_zero(word)) == base::ControlFlow::Break)
+              return base::ControlFlow::Break;
+        }
+        break;
+      case ContainerType::Run:
+        for (size_t i = 0; i < m_values.size(); i += 2)
+        {
+          uint32_t const last = static_cast<uint32_t>(m_values[i]) + m_values[i + 1];
+          for (uint32_t value = m_values[i]; value <= last; ++value)
+            if (wrapper(offset + value) == base::ControlFlow::Break)
+              return base::ControlFlow::Break;
+        }
+        break;
+      }
+      return base::ControlFlow::Continue;
+    }
+
+    ContainerType m_type = ContainerType::Array;
+    uint32_t m_popCount = 0;
+    // Sorted low bits of the positions for Array. Starts and lengths minus one of the runs, one after
+    // another, for Run.
+    std::vector<uint16_t> m_values;
+    // kBitmapWords words for Bitmap.
+    std::vector<uint64_t> m_words;
+  };
+
+  RoaringCBV() = default;
+
+  // Builds a roaring CBV from a sorted list of positions of set bits.
+  explicit RoaringCBV(std::vector<uint64_t> const & setBits);
+
+  // Converts a bit vector of any strategy.
+  static std::unique_ptr<RoaringCBV> BuildFromCBV(CompressedBitVector const & cbv);
+
+  // |keys| are the sorted high bits of the positions which are kept in non-empty |containers|.
+  static std::unique_ptr<RoaringCBV> BuildFromContainers(std::vector<uint64_t> && keys,
+                                                         std::vector<Container> && containers);
+
+  size_t NumContainers() const { return m_keys.size(); }
+  ContainerType GetContainerType(size_t i) const { return m_containers[i].m_type; }
+
+  std::vector<uint64_t> const & GetKeys() const { return m_keys; }
+  std::vector<Container> const & GetContainers() const { return m_containers; }
+
+  template <typename Fn>
+  void ForEach(Fn && f) const
+  {
+    base::ControlFlowWrapper<Fn> wrapper(std::forward<Fn>(f));
+    for (size_t i = 0; i < m_keys.size(); ++i)
+      if (m_containers[i].ForEach(m_keys[i] << kContainerBits, wrapper) == base::ControlFlow::Break)
+        return;
+  }
+
+  // CompressedBitVector overrides:
+  uint64_t PopCount() const override;
+  bool GetBit(uint64_t pos) const override;
+  std::unique_ptr<CompressedBitVector> LeaveFirstSetNBits(uint64_t n) const override;
+  StorageStrategy GetStorageStrategy() const override;
+  void Serialize(Writer & writer) const override;
+  std::unique_ptr<CompressedBitVector> Clone() const override;
+
+private:
+  // High bits of the positions, the low bits are kept in the container with the same index.
+  std::vector<uint64_t> m_keys;
+  std::vector<Container> m_containers;
+  uint64_t m_popCount = 0;
+};
+
+std::string DebugPrint(RoaringCBV::ContainerType type);
+
 class CompressedBitVectorBuilder
 {
 public:
@@ -218,6 +330,7 @@ public:
       rw::ReadVectorOfPOD(src, setBits);
       return std::make_unique<SparseCBV>(std::move(setBits));
     }
+    case CompressedBitVector::StorageStrategy::Roaring: break;
     }
     return std::unique_ptr<CompressedBitVector>();
   }
@@ -247,6 +360,12 @@ public:
       sparseCBV.ForEach(f);
       return;
     }
+    case CompressedBitVector::StorageStrategy::Roaring:
+    {
+      RoaringCBV const & roaringCBV = static_cast<RoaringCBV const &>(cbv);
+      roaringCBV.ForEach(f);
+      return;
+    }
     }
   }
 };
@@ -2,6 +2,7 @@
 
 #include "coding/internal/file_data.hpp"
 #include "coding/reader_cache.hpp"
+#include "coding/shared_page_cache.hpp"
 
 #include "base/logging.hpp"
 
@@ -24,7 +25,12 @@ public:
   FileReaderData(std::string const & fileName, uint32_t logPageSize, uint32_t logPageCount)
     : m_fileData(fileName)
     , m_readerCache(logPageSize, logPageCount)
+    , m_logPageSize(logPageSize)
   {
+    auto & sharedCache = SharedPageCache::Instance();
+    if (sharedCache.IsEnabled())
+      m_sharedFileId = sharedCache.RegisterFile(fileName, m_fileData.Size());
+
 #if LOG_FILE_READER_STATS
     m_readCallCount = 0;
 #endif
@@ -32,6 +38,9 @@ public:
 
   ~FileReaderData()
   {
+    if (m_sharedFileId != 0)
+      SharedPageCache::Instance().UnregisterFile(m_sharedFileId);
+
 #if LOG_FILE_READER_STATS
     LOG(LINFO, ("FileReader", m_fileData.GetName(), m_readerCache.GetStatsStr()));
 #endif
@@ -46,6 +55,13 @@ public:
       LOG(LINFO, ("FileReader", m_fileData.GetName(), m_readerCache.GetStatsStr()));
 #endif
 
+    if (m_sharedFileId != 0)
+    {
+      SharedPageCache::Instance().Read(m_sharedFileId, m_fileData.Size(), m_logPageSize, pos, p, size,
+                                       [this](uint64_t pos, char * p, size_t size) { m_fileData.Read(pos, p, size); });
+      return;
+    }
+
     return m_readerCache.Read(m_fileData, pos, p, size);
   }
 
@@ -66,6 +82,9 @@ private:
 
   FileDataWithCachedSize m_fileData;
   ReaderCache<FileDataWithCachedSize, LOG_FILE_READER_STATS> m_readerCache;
+  uint32_t const m_logPageSize;
+  // Non-zero when pages are read through the SharedPageCache.
+  uint64_t m_sharedFileId = 0;
 
 #if LOG_FILE_READER_STATS
   uint32_t m_readCallCount;
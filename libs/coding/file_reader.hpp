@@ -12,6 +12,7 @@
 // FileReader, cheap to copy, not thread safe.
 // It is assumed that file is not modified during FireReader lifetime,
 // because of caching and assumption that Size() is constant.
+// Pages are cached by the process-wide SharedPageCache when it's enabled, otherwise by the reader itself.
 class FileReader : public ModelReader
 {
 public:
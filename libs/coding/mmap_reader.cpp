@@ -138,6 +138,19 @@ uint8_t * MmapReader::Data() const
   return m_data->m_memory;
 }
 
+void MmapReader::Prefetch(uint64_t pos, uint64_t size) const
+{
+  ASSERT_LESS_OR_EQUAL(pos + size, Size(), (pos, size));
+#ifndef OMIM_OS_WINDOWS
+  static uint64_t const pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  // The mapping is page aligned, so the range is aligned relative to its begin.
+  uint64_t const begin = (m_offset + pos) / pageSize * pageSize;
+  uint64_t const end = m_offset + pos + size;
+  if (madvise(m_data->m_memory + begin, static_cast<size_t>(end - begin), MADV_WILLNEED) != 0)
+    LOG(LWARNING, ("madvise error:", strerror(errno)));
+#endif
+}
+
 void MmapReader::SetOffsetAndSize(uint64_t offset, uint64_t size)
 {
   ASSERT_LESS_OR_EQUAL(offset + size, Size(), (offset, size));
@@ -27,6 +27,10 @@ public:
   /// Direct file/memory access
   uint8_t * Data() const;
 
+  /// Asks the OS to start reading [pos, pos + size) in the background, so that the following
+  /// accesses to the range don't block on page faults. It's a hint and may do nothing.
+  void Prefetch(uint64_t pos, uint64_t size) const;
+
 protected:
   // Used in special derived readers.
   void SetOffsetAndSize(uint64_t offset, uint64_t size);
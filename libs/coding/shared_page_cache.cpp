@@ -0,0 +1,219 @@
+#include "coding/shared_page_cache.hpp"
+
+#include "base/assert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// static
+SharedPageCache & SharedPageCache::Instance()
+{
+  static SharedPageCache instance;
+  return instance;
+}
+
+size_t SharedPageCache::PageKeyHash::operator()(PageKey const & key) const
+{
+  uint64_t h = key.m_fileId * 0x9E3779B97F4A7C15ULL;
+  h ^= key.m_pageNum + 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+  h ^= key.m_logPageSize + (h << 6) + (h >> 2);
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  return static_cast<size_t>(h);
+}
+
+void SharedPageCache::SetBudget(uint64_t bytes)
+{
+  m_budget = bytes;
+  for (auto & shard : m_shards)
+  {
+    std::lock_guard lock(shard.m_mutex);
+    EvictIfNeeded(shard, bytes / kShardsCount);
+  }
+}
+
+uint64_t SharedPageCache::RegisterFile(std::string const & fileName, uint64_t fileSize)
+{
+  FileKey key{fileName, 0 /* device */, 0 /* inode */, fileSize};
+  struct stat s;
+  if (stat(fileName.c_str(), &s) == 0)
+  {
+    key.m_device = static_cast<uint64_t>(s.st_dev);
+    key.m_inode = static_cast<uint64_t>(s.st_ino);
+  }
+
+  std::lock_guard lock(m_filesMutex);
+  auto [it, inserted] = m_files.emplace(std::move(key), FileEntry{m_nextFileId, 0});
+  if (inserted)
+  {
+    m_filesById.emplace(m_nextFileId, it);
+    ++m_nextFileId;
+  }
+  ++it->second.m_readersCount;
+  return it->second.m_id;
+}
+
+void SharedPageCache::UnregisterFile(uint64_t fileId)
+{
+  {
+    std::lock_guard lock(m_filesMutex);
+    auto const it = m_filesById.find(fileId);
+    CHECK(it != m_filesById.end(), (fileId));
+    auto const fileIt = it->second;
+    ASSERT_GREATER(fileIt->second.m_readersCount, 0, ());
+    if (--fileIt->second.m_readersCount != 0)
+      return;
+
+    m_files.erase(fileIt);
+    m_filesById.erase(it);
+  }
+
+  // Pages of the file are never hit again, since the next reader of the file gets a new id.
+  DropFilePages(fileId);
+}
+
+void SharedPageCache::Read(uint64_t fileId, uint64_t fileSize, uint32_t logPageSize, uint64_t pos, void * p,
+                           size_t size, ReadPageFn const & readPage)
+{
+  if (size == 0)
+    return;
+  ASSERT_LESS_OR_EQUAL(pos + size, fileSize, (pos, size, fileSize));
+
+  size_t const pageSize = size_t{1} << logPageSize;
+  char * dst = static_cast<char *>(p);
+  uint64_t pageNum = pos >> logPageSize;
+  size_t offset = static_cast<size_t>(pos - (pageNum << logPageSize));
+  while (size > 0)
+  {
+    size_t const copySize = std::min(size, pageSize - offset);
+    ReadPage({fileId, pageNum, logPageSize}, pageSize, fileSize, offset, dst, copySize, readPage);
+    size -= copySize;
+    dst += copySize;
+    offset = 0;
+    ++pageNum;
+  }
+}
+
+void SharedPageCache::ReadPage(PageKey const & key, size_t pageSize, uint64_t fileSize, size_t offset, char * p,
+                               size_t size, ReadPageFn const & readPage)
+{
+  // High bits for shards, because low bits are used for buckets of the shard's map.
+  auto & shard = m_shards[(PageKeyHash()(key) >> 32) % kShardsCount];
+  {
+    std::lock_guard lock(shard.m_mutex);
+    auto const it = shard.m_pages.find(key);
+    if (it != shard.m_pages.end())
+    {
+      shard.m_lru.splice(shard.m_lru.end(), shard.m_lru, it->second);
+      std::memcpy(p, it->second->m_data.data() + offset, size);
+      ++shard.m_stats.m_hits;
+      return;
+    }
+    ++shard.m_stats.m_misses;
+  }
+
+  // Concurrent readers of a missed page may read it twice, but the file is not read under the lock.
+  uint64_t const pagePos = key.m_pageNum * pageSize;
+  Page page{key, std::vector<char>(static_cast<size_t>(std::min<uint64_t>(pageSize, fileSize - pagePos)))};
+  readPage(pagePos, page.m_data.data(), page.m_data.size());
+  std::memcpy(p, page.m_data.data() + offset, size);
+
+  std::lock_guard lock(shard.m_mutex);
+  if (shard.m_pages.count(key) != 0)
+    return;
+  shard.m_bytes += page.m_data.size();
+  ++shard.m_filePages[key.m_fileId];
+  shard.m_lru.push_back(std::move(page));
+  shard.m_pages.emplace(key, std::prev(shard.m_lru.end()));
+  EvictIfNeeded(shard, m_budget / kShardsCount);
+}
+
+// static
+void SharedPageCache::EvictIfNeeded(Shard & shard, uint64_t shardBudget)
+{
+  while (shard.m_bytes > shardBudget && !shard.m_lru.empty())
+  {
+    ErasePage(shard, shard.m_lru.begin());
+    ++shard.m_stats.m_evictions;
+  }
+}
+
+// static
+void SharedPageCache::ErasePage(Shard & shard, std::list<Page>::iterator it)
+{
+  auto const fileIt = shard.m_filePages.find(it->m_key.m_fileId);
+  ASSERT(fileIt != shard.m_filePages.end(), ());
+  if (--fileIt->second == 0)
+    shard.m_filePages.erase(fileIt);
+
+  shard.m_bytes -= it->m_data.size();
+  shard.m_pages.erase(it->m_key);
+  shard.m_lru.erase(it);
+}
+
+void SharedPageCache::DropFilePages(uint64_t fileId)
+{
+  for (auto & shard : m_shards)
+  {
+    std::lock_guard lock(shard.m_mutex);
+    if (shard.m_filePages.count(fileId) == 0)
+      continue;
+
+    for (auto it = shard.m_lru.begin(); it != shard.m_lru.end();)
+    {
+      auto const next = std::next(it);
+      if (it->m_key.m_fileId == fileId)
+        ErasePage(shard, it);
+      it = next;
+    }
+  }
+}
+
+SharedPageCache::Stats SharedPageCache::GetStats() const
+{
+  Stats stats;
+  for (auto const & shard : m_shards)
+  {
+    std::lock_guard lock(shard.m_mutex);
+    stats.m_hits += shard.m_stats.m_hits;
+    stats.m_misses += shard.m_stats.m_misses;
+    stats.m_evictions += shard.m_stats.m_evictions;
+    stats.m_bytes += shard.m_bytes;
+    stats.m_pages += shard.m_lru.size();
+  }
+  return stats;
+}
+
+void SharedPageCache::ResetStats()
+{
+  for (auto & shard : m_shards)
+  {
+    std::lock_guard lock(shard.m_mutex);
+    shard.m_stats = {};
+  }
+}
+
+void SharedPageCache::Clear()
+{
+  for (auto & shard : m_shards)
+  {
+    std::lock_guard lock(shard.m_mutex);
+    shard.m_lru.clear();
+    shard.m_pages.clear();
+    shard.m_filePages.clear();
+    shard.m_bytes = 0;
+  }
+}
+
+std::string DebugPrint(SharedPageCache::Stats const & stats)
+{
+  std::ostringstream out;
+  out << "SharedPageCache::Stats [hits: " << stats.m_hits << ", misses: " << stats.m_misses
+      << ", evictions: " << stats.m_evictions << ", pages: " << stats.m_pages << ", bytes: " << stats.m_bytes << "]";
+  return out.str();
+}
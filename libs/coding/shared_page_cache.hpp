@@ -0,0 +1,144 @@
+#pragma once
+
+#include "base/macros.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide cache of file pages shared by all FileReaders of the same file, so threads reading
+// the same mwm section don't keep private page copies and don't read the same pages again.
+// The cache is sharded by page, every shard has its own lock and LRU. The sum of shards is limited
+// by a byte budget. The budget is zero by default, which means FileReaders use their private
+// ReaderCache as before.
+//
+// Files are identified by path and inode while at least one FileReader of the file is alive.
+// Pages of a file are dropped when the last reader is destroyed, so the cache follows the FileReader's
+// assumption that a file is not modified while it is read, and dead pages don't take the budget.
+class SharedPageCache
+{
+public:
+  struct Stats
+  {
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    // Bytes of the cached pages.
+    uint64_t m_bytes = 0;
+    uint64_t m_pages = 0;
+  };
+
+  using ReadPageFn = std::function<void(uint64_t pos, char * p, size_t size)>;
+
+  static SharedPageCache & Instance();
+
+  // Changes the budget and evicts pages beyond it. Readers created while the budget is zero
+  // don't use the shared cache for their whole lifetime.
+  void SetBudget(uint64_t bytes);
+  uint64_t GetBudget() const { return m_budget; }
+  bool IsEnabled() const { return m_budget != 0; }
+
+  // Returns the id of the file, which is the same for all readers of the same file alive at the same time.
+  uint64_t RegisterFile(std::string const & fileName, uint64_t fileSize);
+  void UnregisterFile(uint64_t fileId);
+
+  // Copies |size| bytes at |pos| of the file to |p|. Missed pages of 2^|logPageSize| bytes are read
+  // with |readPage|, which is called without locks of the cache.
+  void Read(uint64_t fileId, uint64_t fileSize, uint32_t logPageSize, uint64_t pos, void * p, size_t size,
+            ReadPageFn const & readPage);
+
+  // Works in release builds, counters are kept per shard under its lock.
+  Stats GetStats() const;
+  void ResetStats();
+  // Drops all the pages.
+  void Clear();
+
+private:
+  struct PageKey
+  {
+    bool operator==(PageKey const & rhs) const
+    {
+      return m_fileId == rhs.m_fileId && m_pageNum == rhs.m_pageNum && m_logPageSize == rhs.m_logPageSize;
+    }
+
+    uint64_t m_fileId;
+    uint64_t m_pageNum;
+    uint32_t m_logPageSize;
+  };
+
+  struct PageKeyHash
+  {
+    size_t operator()(PageKey const & key) const;
+  };
+
+  struct Page
+  {
+    PageKey m_key;
+    std::vector<char> m_data;
+  };
+
+  struct Shard
+  {
+    mutable std::mutex m_mutex;
+    // From the least to the most recently used.
+    std::list<Page> m_lru;
+    std::unordered_map<PageKey, std::list<Page>::iterator, PageKeyHash> m_pages;
+    // Number of pages of every file in the shard.
+    std::unordered_map<uint64_t, size_t> m_filePages;
+    uint64_t m_bytes = 0;
+    Stats m_stats;
+  };
+
+  struct FileKey
+  {
+    bool operator<(FileKey const & rhs) const
+    {
+      return std::tie(m_fileName, m_device, m_inode, m_size) <
+             std::tie(rhs.m_fileName, rhs.m_device, rhs.m_inode, rhs.m_size);
+    }
+
+    std::string m_fileName;
+    uint64_t m_device;
+    uint64_t m_inode;
+    uint64_t m_size;
+  };
+
+  struct FileEntry
+  {
+    uint64_t m_id;
+    uint32_t m_readersCount;
+  };
+
+  static size_t constexpr kShardsCount = 64;
+
+  SharedPageCache() = default;
+
+  // Copies [offset, offset + size) of the page to |p|.
+  void ReadPage(PageKey const & key, size_t pageSize, uint64_t fileSize, size_t offset, char * p, size_t size,
+                ReadPageFn const & readPage);
+  static void EvictIfNeeded(Shard & shard, uint64_t shardBudget);
+  static void ErasePage(Shard & shard, std::list<Page>::iterator it);
+  // Drops the pages of the file which has no readers.
+  void DropFilePages(uint64_t fileId);
+
+  std::atomic<uint64_t> m_budget{0};
+  std::array<Shard, kShardsCount> m_shards;
+
+  std::mutex m_filesMutex;
+  std::map<FileKey, FileEntry> m_files;
+  std::unordered_map<uint64_t, std::map<FileKey, FileEntry>::iterator> m_filesById;
+  uint64_t m_nextFileId = 1;
+
+  DISALLOW_COPY_AND_MOVE(SharedPageCache);
+};
+
+std::string DebugPrint(SharedPageCache::Stats const & stats);
@@ -180,6 +180,8 @@ std::unique_ptr<MwmValue> DataSource::CreateValue(MwmInfo & info) const
   auto p = std::make_unique<MwmValue>(localFile);
 
   p->SetTable(dynamic_cast<MwmInfoEx &>(info));
+  if (m_mapFeatures)
+    p->SetMappedFeatures(dynamic_cast<MwmInfoEx &>(info));
 
   p->m_metaDeserializer = indexer::MetadataDeserializer::Load(p->m_cont);
   CHECK(p->m_metaDeserializer, ());
@@ -4,6 +4,7 @@
 #include "indexer/feature_source.hpp"
 #include "indexer/mwm_set.hpp"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -47,6 +48,10 @@ public:
     return (*m_factory)(handle);
   }
 
+  /// Maps features sections of mwms opened after the call, so features are parsed right from
+  /// the mapping without copying their records. Takes address space of the whole sections.
+  void SetMapFeatures(bool mapFeatures) { m_mapFeatures = mapFeatures; }
+
 protected:
   using ReaderCallback =
       std::function<void(MwmSet::MwmHandle const & handle, covering::CoveringGetter & cov, int scale)>;
@@ -64,6 +69,7 @@ protected:
 
 private:
   std::unique_ptr<FeatureSourceFactory> m_factory;
+  std::atomic<bool> m_mapFeatures = false;
 };
 
 // DataSource which operates with features from mwm file and does not support features creation
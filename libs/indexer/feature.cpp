@@ -114,9 +114,9 @@ uint32_t CalcOffset(ArrayByteSource const & source, uint8_t const * start)
   return static_cast<uint32_t>(distance(start, source.PtrUint8()));
 }
 
-uint8_t Header(vector<uint8_t> const & data)
+uint8_t Header(uint8_t const * data)
 {
-  CHECK(!data.empty(), ());
+  CHECK(data, ());
   return data[0];
 }
 
@@ -186,13 +186,25 @@ uint8_t ReadByte(TSource & src)
 
 FeatureType::FeatureType(SharedLoadInfo const * loadInfo, vector<uint8_t> && buffer)
   : m_loadInfo(loadInfo)
-  , m_data(std::move(buffer))
+  , m_buffer(std::move(buffer))
 {
   CHECK(m_loadInfo, ());
+  CHECK(!m_buffer.empty(), ());
 
+  m_data = m_buffer.data();
   m_header = Header(m_data);  // Parse the header and optional name/layer/addinfo.
 }
 
+FeatureType::FeatureType(SharedLoadInfo const * loadInfo, uint8_t const * data, size_t size)
+  : m_loadInfo(loadInfo)
+  , m_data(data)
+{
+  CHECK(m_loadInfo, ());
+  CHECK_GREATER(size, 0, ());
+
+  m_header = Header(m_data);
+}
+
 std::unique_ptr<FeatureType> FeatureType::CreateFromMapObject(osm::MapObject const & emo)
 {
   auto ft = std::unique_ptr<FeatureType>(new FeatureType());
@@ -270,7 +282,7 @@ void FeatureType::ParseTypes()
 
   auto const typesOffset = sizeof(m_header);
   Classificator & c = classif();
-  ArrayByteSource source(m_data.data() + typesOffset);
+  ArrayByteSource source(m_data + typesOffset);
 
   size_t const count = GetTypesCount();
   for (size_t i = 0; i < count; ++i)
@@ -289,7 +301,7 @@ void FeatureType::ParseTypes()
     }
   }
 
-  m_offsets.m_common = CalcOffset(source, m_data.data());
+  m_offsets.m_common = CalcOffset(source, m_data);
   m_parsed.m_types = true;
 }
 
@@ -300,7 +312,7 @@ void FeatureType::ParseCommon()
 
   ParseTypes();
 
-  ArrayByteSource source(m_data.data() + m_offsets.m_common);
+  ArrayByteSource source(m_data + m_offsets.m_common);
   uint8_t const h = Header(m_data);
   m_params.Read(source, h);
 
@@ -320,7 +332,7 @@ void FeatureType::ParseCommon()
     m_limitRect.Add(m_center);
   }
 
-  m_offsets.m_header2 = CalcOffset(source, m_data.data());
+  m_offsets.m_header2 = CalcOffset(source, m_data);
   m_parsed.m_common = true;
 }
 
@@ -357,7 +369,7 @@ void FeatureType::ParseHeader2()
     return;
   }
 
-  BitSource bitSource(m_data.data() + m_offsets.m_header2);
+  BitSource bitSource(m_data + m_offsets.m_header2);
   uint8_t elemsCount = bitSource.Read(4);
   uint8_t geomScalesMask = 0;
 
@@ -436,7 +448,7 @@ void FeatureType::ParseHeader2()
     }
   }
 
-  m_offsets.m_relations = CalcOffset(src, m_data.data());
+  m_offsets.m_relations = CalcOffset(src, m_data);
 }
 
 void FeatureType::ParseRelations()
@@ -446,7 +458,7 @@ void FeatureType::ParseRelations()
 
   ParseHeader2();
 
-  ArrayByteSource src(m_data.data() + m_offsets.m_relations);
+  ArrayByteSource src(m_data + m_offsets.m_relations);
 
   if (m_hasRelations)
     ReadVarUInt32SortedShortArray(src, m_relationIDs);
@@ -454,7 +466,7 @@ void FeatureType::ParseRelations()
   m_parsed.m_relations = true;
 
   // Size of the whole header incl. inner geometry / triangles.
-  m_innerStats.m_size = CalcOffset(src, m_data.data());
+  m_innerStats.m_size = CalcOffset(src, m_data);
 }
 
 void FeatureType::ResetGeometry()
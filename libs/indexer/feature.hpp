@@ -37,6 +37,8 @@ public:
   using GeometryOffsets = buffer_vector<uint32_t, feature::DataHeader::kMaxScalesCount>;
 
   FeatureType(feature::SharedLoadInfo const * loadInfo, std::vector<uint8_t> && buffer);
+  /// Doesn't copy the record, |data| must be alive while the feature is parsed.
+  FeatureType(feature::SharedLoadInfo const * loadInfo, uint8_t const * data, size_t size);
 
   static std::unique_ptr<FeatureType> CreateFromMapObject(osm::MapObject const & emo);
 
@@ -259,7 +261,9 @@ private:
 
   // Non-owning pointer to shared load info. SharedLoadInfo created once per FeaturesVector.
   feature::SharedLoadInfo const * m_loadInfo = nullptr;
-  std::vector<uint8_t> m_data;
+  // Record of the feature, points to |m_buffer| or to the mapped features section.
+  uint8_t const * m_data = nullptr;
+  std::vector<uint8_t> m_buffer;
 
   ParsedFlags m_parsed;
   Offsets m_offsets;
@@ -20,7 +20,8 @@ FeatureSource::FeatureSource(MwmSet::MwmHandle const & handle) : m_handle(handle
 
   auto const & value = *m_handle.GetValue();
   m_vector = std::make_unique<FeaturesVector>(value.m_cont, value.GetHeader(), value.m_ftTable.get(),
-                                              value.m_relTable.get(), value.m_metaDeserializer.get());
+                                              value.m_relTable.get(), value.m_metaDeserializer.get(),
+                                              value.m_mappedFeatures);
 }
 
 size_t FeatureSource::GetNumFeatures() const
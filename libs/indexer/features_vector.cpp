@@ -4,11 +4,43 @@
 
 #include "platform/constants.hpp"
 
+#include "base/logging.hpp"
+
+#include "defines.hpp"
+
+namespace feature
+{
+// static
+std::unique_ptr<MappedFeatures> MappedFeatures::Load(FilesContainerR const & cont)
+{
+  try
+  {
+    ReaderSource src(cont.GetReader(FEATURES_FILE_TAG));
+    DatSectionHeader header;
+    header.Read(src);
+
+    std::unique_ptr<MappedFeatures> features(new MappedFeatures());
+    features->m_file.Open(cont.GetFileName());
+    auto const p = cont.GetAbsoluteOffsetAndSize(FEATURES_FILE_TAG);
+    features->m_handle.Assign(
+        features->m_file.Map(p.first + header.m_featuresOffset, header.m_featuresSize, FEATURES_FILE_TAG));
+    return features;
+  }
+  catch (Reader::Exception const & e)
+  {
+    LOG(LWARNING, ("Can't map features of", cont.GetFileName(), e.Msg()));
+    return nullptr;
+  }
+}
+}  // namespace feature
+
 FeaturesVector::FeaturesVector(FilesContainerR const & cont, feature::DataHeader const & header,
                                feature::FeaturesOffsetsTable const * ftTable,
                                feature::FeaturesOffsetsTable const * relTable,
-                               indexer::MetadataDeserializer * metaDeserializer)
+                               indexer::MetadataDeserializer * metaDeserializer,
+                               std::shared_ptr<feature::MappedFeatures const> mappedFeatures)
   : m_loadInfo(cont, header, relTable, metaDeserializer)
+  , m_mappedFeatures(std::move(mappedFeatures))
   , m_table(ftTable)
 {
   InitRecordsReader();
@@ -30,6 +62,12 @@ void FeaturesVector::InitRecordsReader()
 std::unique_ptr<FeatureType> FeaturesVector::GetByIndex(uint32_t index) const
 {
   auto const ftOffset = m_table ? m_table->GetFeatureOffset(index) : index;
+  if (m_mappedFeatures)
+  {
+    uint32_t size = 0;
+    uint8_t const * data = m_mappedFeatures->GetRecord(ftOffset, size);
+    return std::make_unique<FeatureType>(&m_loadInfo, data, size);
+  }
   return std::make_unique<FeatureType>(&m_loadInfo, m_recordReader->ReadRecord(ftOffset));
 }
 
@@ -45,7 +83,7 @@ FeaturesVectorTest::FeaturesVectorTest(std::string const & filePath)
 FeaturesVectorTest::FeaturesVectorTest(FilesContainerR const & cont)
   : m_cont(cont)
   , m_header(m_cont)
-  , m_vector(m_cont, m_header, nullptr, nullptr, nullptr)
+  , m_vector(m_cont, m_header, nullptr, nullptr, nullptr, feature::MappedFeatures::Load(m_cont))
 {
   m_vector.m_table = feature::FeaturesOffsetsTable::Load(m_cont, FEATURE_OFFSETS_FILE_TAG).release();
 
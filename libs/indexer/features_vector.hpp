@@ -3,7 +3,12 @@
 #include "indexer/feature.hpp"
 #include "indexer/shared_load_info.hpp"
 
+#include "coding/byte_stream.hpp"
+#include "coding/files_container.hpp"
 #include "coding/var_record_reader.hpp"
+#include "coding/varint.hpp"
+
+#include "base/assert.hpp"
 
 #include <memory>
 #include <vector>
@@ -11,7 +16,46 @@
 namespace feature
 {
 class FeaturesOffsetsTable;
-}
+
+/// Memory mapped features records of the DATA section, shared by FeaturesVectors of the same mwm.
+/// Features of a vector with the map point into it instead of owning copies of their records.
+class MappedFeatures
+{
+public:
+  /// @returns nullptr if the section can't be mapped.
+  static std::unique_ptr<MappedFeatures> Load(FilesContainerR const & cont);
+
+  /// @returns the record at |pos| of the features section, |size| is set to its size.
+  uint8_t const * GetRecord(uint32_t pos, uint32_t & size) const
+  {
+    ASSERT_LESS(pos, m_handle.GetSize(), ());
+    ArrayByteSource src(m_handle.GetData<uint8_t>() + pos);
+    size = ReadVarUint<uint32_t>(src);
+    return src.PtrUint8();
+  }
+
+  template <class ToDo>
+  void ForEachRecord(ToDo && toDo) const
+  {
+    uint8_t const * const beg = m_handle.GetData<uint8_t>();
+    uint8_t const * const end = beg + m_handle.GetSize();
+    ArrayByteSource src(beg);
+    while (src.PtrUint8() < end)
+    {
+      auto const pos = static_cast<uint32_t>(src.PtrUint8() - beg);
+      uint32_t const size = ReadVarUint<uint32_t>(src);
+      toDo(pos, src.PtrUint8(), size);
+      src.Advance(size);
+    }
+  }
+
+private:
+  MappedFeatures() = default;
+
+  ::detail::MappedFile m_file;
+  ::detail::MappedFile::Handle m_handle;
+};
+}  // namespace feature
 
 /// Note! This class is NOT Thread-Safe.
 /// You should have separate instance of Vector for every thread.
@@ -20,9 +64,12 @@ class FeaturesVector
   DISALLOW_COPY(FeaturesVector);
 
 public:
+  /// When |mappedFeatures| is set, features are read from it without copying their records,
+  /// so they must not be parsed after the vector is destroyed.
   FeaturesVector(FilesContainerR const & cont, feature::DataHeader const & header,
                  feature::FeaturesOffsetsTable const * ftTable, feature::FeaturesOffsetsTable const * relTable,
-                 indexer::MetadataDeserializer * metaDeserializer);
+                 indexer::MetadataDeserializer * metaDeserializer,
+                 std::shared_ptr<feature::MappedFeatures const> mappedFeatures = {});
 
   std::unique_ptr<FeatureType> GetByIndex(uint32_t index) const;
 
@@ -32,16 +79,30 @@ public:
   void ForEach(ToDo && toDo) const
   {
     uint32_t index = 0;
-    m_recordReader->ForEachRecord([&](uint32_t pos, std::vector<uint8_t> && data)
+    auto const process = [&](FeatureType & ft, uint32_t pos)
     {
-      FeatureType ft(&m_loadInfo, std::move(data));
-
       // We can't properly set MwmId here, because FeaturesVector
       // works with FileContainerR, not with MwmId/MwmHandle/MwmValue.
       // But it's OK to set at least feature's index, because it can
       // be used later for Metadata loading.
       ft.SetID(FeatureID(MwmSet::MwmId(), index));
       toDo(ft, m_table ? index++ : pos);
+    };
+
+    if (m_mappedFeatures)
+    {
+      m_mappedFeatures->ForEachRecord([&](uint32_t pos, uint8_t const * data, uint32_t size)
+      {
+        FeatureType ft(&m_loadInfo, data, size);
+        process(ft, pos);
+      });
+      return;
+    }
+
+    m_recordReader->ForEachRecord([&](uint32_t pos, std::vector<uint8_t> && data)
+    {
+      FeatureType ft(&m_loadInfo, std::move(data));
+      process(ft, pos);
     });
   }
 
@@ -69,6 +130,7 @@ private:
 
   feature::SharedLoadInfo m_loadInfo;
   std::unique_ptr<RecordReader> m_recordReader;
+  std::shared_ptr<feature::MappedFeatures const> m_mappedFeatures;
   feature::FeaturesOffsetsTable const * m_table;
 };
 
@@ -90,4 +152,5 @@ public:
   FilesContainerR const & GetContainer() const { return m_cont; }
   feature::DataHeader const & GetHeader() const { return m_header; }
   FeaturesVector const & GetVector() const { return m_vector; }
+  bool IsMapped() const { return m_vector.m_mappedFeatures != nullptr; }
 };
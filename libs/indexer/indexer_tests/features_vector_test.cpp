@@ -60,4 +60,41 @@ UNIT_TEST(FeaturesVectorTest_ParseMetadata)
   });
   TEST_EQUAL(expected, actual, ());
 }
+
+UNIT_TEST(FeaturesVectorTest_MappedFeatures)
+{
+  LocalCountryFile localFile = LocalCountryFile::MakeForTesting("minsk-pass");
+
+  FrozenDataSource dataSource;
+  dataSource.SetMapFeatures(true);
+  auto result = dataSource.RegisterMap(localFile);
+  TEST_EQUAL(result.second, MwmSet::RegResult::Success, ());
+
+  MwmSet::MwmHandle handle = dataSource.GetMwmHandleById(result.first);
+  TEST(handle.IsAlive(), ());
+  auto const * value = handle.GetValue();
+  TEST(value->m_mappedFeatures, ());
+
+  FeaturesVector copied(value->m_cont, value->GetHeader(), value->m_ftTable.get(), value->m_relTable.get(),
+                        value->m_metaDeserializer.get());
+  FeaturesVector mapped(value->m_cont, value->GetHeader(), value->m_ftTable.get(), value->m_relTable.get(),
+                        value->m_metaDeserializer.get(), value->m_mappedFeatures);
+
+  size_t count = 0;
+  mapped.ForEach([&](FeatureType & ft, uint32_t index)
+  {
+    auto expected = copied.GetByIndex(index);
+    TEST_EQUAL(ft.GetGeomType(), expected->GetGeomType(), (index));
+    TEST_EQUAL(ft.GetTypesCount(), expected->GetTypesCount(), (index));
+    TEST_EQUAL(ft.GetNames(), expected->GetNames(), (index));
+    TEST_EQUAL(ft.GetLimitRect(FeatureType::BEST_GEOMETRY), expected->GetLimitRect(FeatureType::BEST_GEOMETRY),
+               (index));
+    TEST_EQUAL(ft.GetPointsCount(), expected->GetPointsCount(), (index));
+    TEST_EQUAL(ft.GetMetadata(feature::Metadata::FMD_POSTCODE), expected->GetMetadata(feature::Metadata::FMD_POSTCODE),
+               (index));
+    TEST_EQUAL(mapped.GetByIndex(index)->GetNames(), ft.GetNames(), (index));
+    ++count;
+  });
+  TEST_EQUAL(count, mapped.GetNumFeatures(), ());
+}
 }  // namespace features_vector_test
@@ -7,8 +7,12 @@
 
 #include "base/macros.hpp"
 
+#include <atomic>
 #include <initializer_list>
+#include <memory>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace mwm_set_test
 {
@@ -168,4 +172,91 @@ UNIT_TEST(MwmSetLockAndIdTest)
   TEST(!handle.GetId().IsAlive(), ());
   TEST(!handle.GetId().GetInfo().get(), ());
 }
+
+UNIT_TEST(MwmSetConcurrentHandles)
+{
+  size_t constexpr kMwmsCount = 4;
+  size_t constexpr kHandlesPerThread = 2000;
+  size_t constexpr kThreadsCount = 4;
+
+  TestMwmSet mwmSet;
+  vector<unique_ptr<ScopedMwm>> mwms;
+  vector<MwmSet::MwmId> ids;
+  for (size_t i = 0; i < kMwmsCount; ++i)
+  {
+    auto const name = to_string(i);
+    mwms.push_back(make_unique<ScopedMwm>(name + DATA_FILE_EXTENSION));
+    auto const p = mwmSet.Register(LocalCountryFile::MakeForTesting(name));
+    TEST_EQUAL(p.second, MwmSet::RegResult::Success, ());
+    ids.push_back(p.first);
+  }
+
+  // Acquires handles from several threads, like search and routing threads of a server do.
+  vector<thread> threads;
+  for (size_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (size_t i = 0; i < kHandlesPerThread; ++i)
+      {
+        auto const & id = ids[(i + t) % kMwmsCount];
+        auto const handle = mwmSet.GetMwmHandleById(id);
+        TEST(handle.IsAlive(), ());
+        if (i % 16 == 0)
+        {
+          // Nested handle of the same mwm gets another value.
+          auto const nested = mwmSet.GetMwmHandleById(id);
+          TEST(nested.IsAlive(), ());
+          TEST_NOT_EQUAL(nested.GetValue(), handle.GetValue(), ());
+        }
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (auto const & id : ids)
+  {
+    TEST_EQUAL(id.GetInfo()->GetNumRefs(), 0, ());
+    TEST_EQUAL(id.GetInfo()->GetStatus(), MwmInfo::STATUS_REGISTERED, ());
+  }
+}
+
+UNIT_TEST(MwmSetConcurrentDeregister)
+{
+  ScopedMwm mwm("5.mwm");
+  TestMwmSet mwmSet;
+  auto const id = mwmSet.Register(LocalCountryFile::MakeForTesting("5")).first;
+  TEST(id.IsAlive(), ());
+
+  atomic<size_t> aliveCount = 0;
+  vector<thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&]()
+    {
+      while (true)
+      {
+        // Marked mwm is still available, stop when it's observed to let the mwm be deregistered.
+        auto const handle = mwmSet.GetMwmHandleById(id);
+        if (!handle.IsAlive() || handle.GetInfo()->GetStatus() != MwmInfo::STATUS_REGISTERED)
+          break;
+        ++aliveCount;
+      }
+    });
+  }
+
+  while (aliveCount < 1000)
+    this_thread::yield();
+  mwmSet.Deregister(CountryFile("5"));
+
+  for (auto & t : threads)
+    t.join();
+
+  // The last released handle finishes deregistration.
+  TEST(!id.IsAlive(), ());
+  TEST_EQUAL(id.GetInfo()->GetStatus(), MwmInfo::STATUS_DEREGISTERED, ());
+  TEST_EQUAL(id.GetInfo()->GetNumRefs(), 0, ());
+  TEST(!mwmSet.GetMwmHandleByCountryFile(CountryFile("5")).IsAlive(), ());
+}
 }  // namespace mwm_set_test
@@ -282,4 +282,44 @@ UNIT_TEST(TrieBuilder_Build)
   }
 }
 
+UNIT_TEST(TrieBuilder_SkipsDuplicates)
+{
+  using Key = buffer_vector<trie::TrieChar, 8>;
+  using KeyValuePair = pair<Key, uint32_t>;
+  using Sink = PushBackByteSink<vector<uint8_t>>;
+
+  auto makeKey = [](string const & s) { return Key(s.begin(), s.end()); };
+  vector<KeyValuePair> const v = {{makeKey("a"), 1},  {makeKey("ab"), 2},  {makeKey("ab"), 3},
+                                  {makeKey("abc"), 1}, {makeKey("b"), 5}, {makeKey("bcd"), 7}};
+
+  SingleValueSerializer<uint32_t> serializer;
+  vector<uint8_t> expected;
+  {
+    Sink sink(expected);
+    trie::Build<Sink, Key, ValueList<uint32_t>, SingleValueSerializer<uint32_t>>(sink, serializer, v);
+  }
+
+  // The same pairs coming from several sorted runs, e.g. merged external sort of the search index.
+  vector<uint8_t> buf;
+  {
+    Sink sink(buf);
+    trie::Builder<Sink, Key, ValueList<uint32_t>, SingleValueSerializer<uint32_t>> builder(sink, serializer);
+    for (auto const & [key, value] : v)
+    {
+      builder.Add(key, value);
+      builder.Add(key, value);
+    }
+    builder.Finish();
+  }
+  TEST_EQUAL(buf, expected, ());
+
+  reverse(buf.begin(), buf.end());
+  MemReader memReader(buf.data(), buf.size());
+  auto const root = trie::ReadTrie<MemReader, ValueList<uint32_t>>(memReader, serializer);
+  vector<KeyValuePair> res;
+  trie::ForEachRef(*root, [&res](Key const & k, uint32_t v) { res.emplace_back(k, v); }, Key{});
+  sort(res.begin(), res.end());
+  TEST_EQUAL(res, v, ());
+}
+
 }  // namespace trie_test
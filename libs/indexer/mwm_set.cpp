@@ -1,6 +1,7 @@
 #include "indexer/mwm_set.hpp"
 
 #include "indexer/features_offsets_table.hpp"
+#include "indexer/features_vector.hpp"
 #include "indexer/metadata_serdes.hpp"  // needed for MwmValue dtor
 #include "indexer/scales.hpp"
 
@@ -159,23 +160,18 @@ bool MwmSet::DeregisterImpl(MwmId const & id, EventList & events)
     return false;
 
   shared_ptr<MwmInfo> const & info = id.GetInfo();
+
+  // Mark before checking the counter, see LockValue().
+  SetStatus(*info, MwmInfo::STATUS_MARKED_TO_DEREGISTER, events);
   if (info->m_numRefs == 0)
   {
     SetStatus(*info, MwmInfo::STATUS_DEREGISTERED, events);
     vector<shared_ptr<MwmInfo>> & infos = m_info[info->GetCountryName()];
     infos.erase(remove(infos.begin(), infos.end(), info), infos.end());
-    for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
-    {
-      if (it->first == id)
-      {
-        m_cache.erase(it);
-        break;
-      }
-    }
+    m_cache.Erase(id);
     return true;
   }
 
-  SetStatus(*info, MwmInfo::STATUS_MARKED_TO_DEREGISTER, events);
   return false;
 }
 
@@ -242,8 +238,29 @@ void MwmSet::ProcessEventList(EventList & events)
 
 unique_ptr<MwmValue> MwmSet::LockValue(MwmId const & id)
 {
+  if (!id.IsAlive())
+    return nullptr;
+  MwmInfo & info = *id.GetInfo();
+
+  // Fast path: pin the registered mwm and reuse a cached value without |m_lock|.
+  ++info.m_numRefs;
+  if (info.IsRegistered())
+  {
+    if (auto value = m_cache.Take(id))
+      return value;
+
+    unique_ptr<MwmValue> result;
+    WithEventLog([&](EventList & events) { result = CreateValueImpl(id, events); });
+    return result;
+  }
+
+  // The mwm is being deregistered, it's handled under |m_lock|.
   unique_ptr<MwmValue> result;
-  WithEventLog([&](EventList & events) { result = LockValueImpl(id, events); });
+  WithEventLog([&](EventList & events)
+  {
+    --info.m_numRefs;
+    result = LockValueImpl(id, events);
+  });
   return result;
 }
 
@@ -251,26 +268,23 @@ unique_ptr<MwmValue> MwmSet::LockValueImpl(MwmId const & id, EventList & events)
 {
   if (!id.IsAlive())
     return nullptr;
-  shared_ptr<MwmInfo> info = id.GetInfo();
 
   // It's better to return valid "value pointer" even for "out-of-date" files,
   // because they can be locked for a long time by other algos.
   // if (!info->IsUpToDate())
   //  return TMwmValuePtr();
 
-  ++info->m_numRefs;
+  ++id.GetInfo()->m_numRefs;
 
-  // Search in cache.
-  for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
-  {
-    if (it->first == id)
-    {
-      unique_ptr<MwmValue> result = std::move(it->second);
-      m_cache.erase(it);
-      return result;
-    }
-  }
+  if (auto value = m_cache.Take(id))
+    return value;
 
+  return CreateValueImpl(id, events);
+}
+
+unique_ptr<MwmValue> MwmSet::CreateValueImpl(MwmId const & id, EventList & events)
+{
+  shared_ptr<MwmInfo> const & info = id.GetInfo();
   try
   {
     return CreateValue(*info);
@@ -278,7 +292,8 @@ unique_ptr<MwmValue> MwmSet::LockValueImpl(MwmId const & id, EventList & events)
   catch (Reader::TooManyFilesException const & ex)
   {
     LOG(LERROR, ("Too many open files, can't open:", info->GetCountryName()));
-    --info->m_numRefs;
+    if (--info->m_numRefs == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
+      VERIFY(DeregisterImpl(id, events), ());
     return nullptr;
   }
   catch (exception const & ex)
@@ -292,49 +307,41 @@ unique_ptr<MwmValue> MwmSet::LockValueImpl(MwmId const & id, EventList & events)
 }
 
 void MwmSet::UnlockValue(MwmId const & id, unique_ptr<MwmValue> p)
-{
-  WithEventLog([&](EventList & events) { UnlockValueImpl(id, std::move(p), events); });
-}
-
-void MwmSet::UnlockValueImpl(MwmId const & id, unique_ptr<MwmValue> p, EventList & events)
 {
   ASSERT(id.IsAlive(), (id));
   ASSERT(p.get() != nullptr, ());
   if (!id.IsAlive() || !p)
     return;
 
-  shared_ptr<MwmInfo> const & info = id.GetInfo();
-  ASSERT_GREATER(info->m_numRefs, 0, ());
-  --info->m_numRefs;
-  if (info->m_numRefs == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
-    VERIFY(DeregisterImpl(id, events), ());
+  MwmInfo & info = *id.GetInfo();
+  ASSERT_GREATER(info.m_numRefs, 0, ());
 
-  if (info->IsUpToDate())
-  {
-    /// @todo Probably, it's better to store only "unique by id" free caches here.
-    /// But it's no obvious if we have many threads working with the single mwm.
+  /// @todo Probably, it's better to store only "unique by id" free caches here.
+  /// But it's no obvious if we have many threads working with the single mwm.
+  m_cache.Put(id, std::move(p));
 
-    m_cache.push_back(make_pair(id, std::move(p)));
-    if (m_cache.size() > m_cacheSize)
+  // Check the status after releasing the counter, see LockValue().
+  if (--info.m_numRefs == 0 && info.GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
+  {
+    WithEventLog([&](EventList & events)
     {
-      LOG(LDEBUG, ("MwmValue max cache size reached! Added", id, "removed", m_cache.front().first));
-      ASSERT_EQUAL(m_cache.size(), m_cacheSize + 1, ());
-      m_cache.pop_front();
-    }
+      // The mwm could be locked again or deregistered by another thread.
+      if (info.m_numRefs == 0 && info.GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
+        VERIFY(DeregisterImpl(id, events), ());
+    });
   }
 }
 
 void MwmSet::Clear()
 {
   lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  m_cache.Clear();
   m_info.clear();
 }
 
 void MwmSet::ClearCache()
 {
-  lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  m_cache.Clear();
 }
 
 MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) const
@@ -345,36 +352,78 @@ MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) con
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleByCountryFile(CountryFile const & countryFile)
 {
-  MwmSet::MwmHandle handle;
-  WithEventLog([&](EventList & events)
-  { handle = GetMwmHandleByIdImpl(GetMwmIdByCountryFileImpl(countryFile), events); });
-  return handle;
+  return GetMwmHandleById(GetMwmIdByCountryFile(countryFile));
 }
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleById(MwmId const & id)
 {
-  MwmSet::MwmHandle handle;
-  WithEventLog([&](EventList & events) { handle = GetMwmHandleByIdImpl(id, events); });
-  return handle;
+  return MwmHandle(*this, id, LockValue(id));
 }
 
-MwmSet::MwmHandle MwmSet::GetMwmHandleByIdImpl(MwmId const & id, EventList & events)
+void MwmSet::ClearCache(MwmId const & id)
 {
-  unique_ptr<MwmValue> value;
-  if (id.IsAlive())
-    value = LockValueImpl(id, events);
-  return MwmHandle(*this, id, std::move(value));
+  m_cache.Erase(id);
 }
 
-void MwmSet::ClearCacheImpl(Cache::iterator beg, Cache::iterator end)
+// MwmSet::ValuesCache -----------------------------------------------------------------------------
+
+unique_ptr<MwmValue> MwmSet::ValuesCache::Take(MwmId const & id)
 {
-  m_cache.erase(beg, end);
+  lock_guard<mutex> lock(m_mutex);
+  auto const it = m_entries.find(id.GetInfo().get());
+  if (it == m_entries.end())
+    return nullptr;
+
+  auto const entry = it->second.back();
+  auto value = std::move(entry->second);
+  it->second.pop_back();
+  if (it->second.empty())
+    m_entries.erase(it);
+  m_lru.erase(entry);
+  return value;
 }
 
-void MwmSet::ClearCache(MwmId const & id)
+void MwmSet::ValuesCache::Put(MwmId const & id, unique_ptr<MwmValue> value)
 {
-  auto sameId = [&id](pair<MwmSet::MwmId, unique_ptr<MwmValue>> const & p) { return (p.first == id); };
-  ClearCacheImpl(base::RemoveIfKeepValid(m_cache.begin(), m_cache.end(), sameId), m_cache.end());
+  unique_ptr<MwmValue> evicted;
+  lock_guard<mutex> lock(m_mutex);
+  // Deregistration marks the mwm before erasing its values, so the status is checked under the lock.
+  if (!id.GetInfo()->IsUpToDate())
+    return;
+
+  m_lru.emplace_back(id, std::move(value));
+  m_entries[id.GetInfo().get()].push_back(std::prev(m_lru.end()));
+  if (m_lru.size() > m_maxSize)
+  {
+    auto const oldest = m_lru.begin();
+    LOG(LDEBUG, ("MwmValue max cache size reached! Added", id, "removed", oldest->first));
+    // Close files of the evicted value after releasing the lock.
+    evicted = std::move(oldest->second);
+    auto const it = m_entries.find(oldest->first.GetInfo().get());
+    ASSERT(it != m_entries.end() && it->second.front() == oldest, ());
+    it->second.pop_front();
+    if (it->second.empty())
+      m_entries.erase(it);
+    m_lru.erase(oldest);
+  }
+}
+
+void MwmSet::ValuesCache::Erase(MwmId const & id)
+{
+  lock_guard<mutex> lock(m_mutex);
+  auto const it = m_entries.find(id.GetInfo().get());
+  if (it == m_entries.end())
+    return;
+  for (auto const & entry : it->second)
+    m_lru.erase(entry);
+  m_entries.erase(it);
+}
+
+void MwmSet::ValuesCache::Clear()
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_entries.clear();
+  m_lru.clear();
 }
 
 // MwmValue ----------------------------------------------------------------------------------------
@@ -400,6 +449,8 @@ MwmValue::~MwmValue() {}
 
 void MwmValue::SetTable(MwmInfoEx & info)
 {
+  lock_guard<mutex> lock(info.m_tablesMutex);
+
   m_ftTable = info.m_ftTable.lock();
   if (!m_ftTable)
   {
@@ -415,6 +466,18 @@ void MwmValue::SetTable(MwmInfoEx & info)
   }
 }
 
+void MwmValue::SetMappedFeatures(MwmInfoEx & info)
+{
+  lock_guard<mutex> lock(info.m_tablesMutex);
+
+  m_mappedFeatures = info.m_mappedFeatures.lock();
+  if (!m_mappedFeatures)
+  {
+    m_mappedFeatures = feature::MappedFeatures::Load(m_cont);
+    info.m_mappedFeatures = m_mappedFeatures;
+  }
+}
+
 string DebugPrint(MwmSet::RegResult result)
 {
   switch (result)
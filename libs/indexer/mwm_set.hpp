@@ -17,16 +17,19 @@
 
 #include <atomic>
 #include <deque>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace feature
 {
 class FeaturesOffsetsTable;
+class MappedFeatures;
 }
 namespace indexer
 {
@@ -90,7 +93,7 @@ public:
   }
 
   /// Returns the lock counter value for test needs.
-  uint8_t GetNumRefs() const { return m_numRefs; }
+  uint8_t GetNumRefs() const { return static_cast<uint8_t>(m_numRefs.load()); }
 
 protected:
   Status SetStatus(Status status)
@@ -104,7 +107,7 @@ protected:
 
   platform::LocalCountryFile m_file;  ///< Path to the mwm file.
   std::atomic<Status> m_status;       ///< Current country status.
-  uint32_t m_numRefs;                 ///< Number of active handles.
+  std::atomic<uint32_t> m_numRefs;    ///< Number of active handles.
 };
 
 class MwmInfoEx : public MwmInfo
@@ -118,10 +121,12 @@ private:
   // MwmSet's cache. We can't use shared_ptr because of offsets table
   // must be removed as soon as the last corresponding MwmValue is
   // destroyed. Also, note that this value must be used and modified
-  // only in MwmValue::SetTable() method, which, in turn, is called
-  // only in the MwmSet critical section, protected by a lock.  So,
-  // there's an implicit synchronization on this field.
+  // only in MwmValue::SetTable() method. Values are still created
+  // under the MwmSet lock, but cached values are taken and released
+  // without it, so the tables are guarded by |m_tablesMutex| instead.
+  std::mutex m_tablesMutex;
   std::weak_ptr<feature::FeaturesOffsetsTable> m_ftTable, m_relTable;
+  std::weak_ptr<feature::MappedFeatures const> m_mappedFeatures;
 };
 
 class MwmValue;
@@ -154,7 +159,7 @@ public:
   };
 
 public:
-  explicit MwmSet(size_t cacheSize = 64) : m_cacheSize(cacheSize) {}
+  explicit MwmSet(size_t cacheSize = 64) : m_cache(cacheSize) {}
   virtual ~MwmSet() = default;
 
   // Mwm handle, which is used to refer to mwm and prevent it from
@@ -325,7 +330,32 @@ protected:
   virtual std::unique_ptr<MwmValue> CreateValue(MwmInfo & info) const = 0;
 
 private:
-  using Cache = std::deque<std::pair<MwmId, std::unique_ptr<MwmValue>>>;
+  // LRU of free values with O(1) operations. Every handle owns its value, so several values
+  // of the same mwm may be cached. Has its own lock, because it's used on the fast path of
+  // handles acquisition which doesn't take |m_lock|.
+  class ValuesCache
+  {
+  public:
+    explicit ValuesCache(size_t maxSize) : m_maxSize(maxSize) {}
+
+    // Returns the most recently cached value of the mwm or nullptr.
+    std::unique_ptr<MwmValue> Take(MwmId const & id);
+    // Caches the value while the mwm is up to date, otherwise drops it.
+    void Put(MwmId const & id, std::unique_ptr<MwmValue> value);
+    void Erase(MwmId const & id);
+    void Clear();
+
+  private:
+    using Entry = std::pair<MwmId, std::unique_ptr<MwmValue>>;
+    using Lru = std::list<Entry>;
+
+    size_t const m_maxSize;
+    std::mutex m_mutex;
+    // From the least to the most recently used.
+    Lru m_lru;
+    // Entries of |m_lru| grouped by mwm, in the same order. Entries keep MwmInfo alive.
+    std::unordered_map<MwmInfo const *, std::deque<Lru::iterator>> m_entries;
+  };
 
   // This is the only valid way to take |m_lock| and use *Impl()
   // functions. The reason is that event processing requires
@@ -351,20 +381,20 @@ private:
   // Triggers observers on each event in |events|.
   void ProcessEventList(EventList & events);
 
-  /// @precondition This function is always called under mutex m_lock.
-  MwmHandle GetMwmHandleByIdImpl(MwmId const & id, EventList & events);
-
+  // Handles are acquired and released without |m_lock| while the mwm is registered: the handle
+  // pins MwmInfo::m_numRefs and takes a value from |m_cache|. Deregistration marks the mwm first
+  // and then checks the counter, and the fast path increments the counter first and then checks
+  // the status, so at least one of them sees the other. Creation of values, marked and
+  // deregistered mwms go to the slow path under |m_lock|.
   std::unique_ptr<MwmValue> LockValue(MwmId const & id);
+  /// @precondition This function is always called under mutex m_lock.
   std::unique_ptr<MwmValue> LockValueImpl(MwmId const & id, EventList & events);
-  void UnlockValue(MwmId const & id, std::unique_ptr<MwmValue> p);
-  void UnlockValueImpl(MwmId const & id, std::unique_ptr<MwmValue> p, EventList & events);
-
-  /// Do the cleaning for [beg, end) without acquiring the mutex.
+  /// Creates a value for the mwm which is already pinned by the caller.
   /// @precondition This function is always called under mutex m_lock.
-  void ClearCacheImpl(Cache::iterator beg, Cache::iterator end);
+  std::unique_ptr<MwmValue> CreateValueImpl(MwmId const & id, EventList & events);
+  void UnlockValue(MwmId const & id, std::unique_ptr<MwmValue> p);
 
-  Cache m_cache;
-  size_t const m_cacheSize;
+  ValuesCache m_cache;
 
 protected:
   /// @precondition This function is always called under mutex m_lock.
@@ -396,6 +426,8 @@ private:
 public:
   // m_ftTable should always present, m_relTable maybe nullptr.
   std::shared_ptr<feature::FeaturesOffsetsTable> m_ftTable, m_relTable;
+  // Maybe nullptr, when features are read without mapping.
+  std::shared_ptr<feature::MappedFeatures const> m_mappedFeatures;
   std::unique_ptr<indexer::MetadataDeserializer> m_metaDeserializer;
   std::unique_ptr<HouseToStreetTable> m_house2street, m_house2place;
 
@@ -404,6 +436,7 @@ public:
   ~MwmValue();
 
   void SetTable(MwmInfoEx & info);
+  void SetMappedFeatures(MwmInfoEx & info);
 
   feature::DataHeader const & GetHeader() const { return m_header; }
   feature::RegionData const & GetRegionData() const { return m_regionData; }
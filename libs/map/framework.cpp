@@ -404,6 +404,7 @@ void Framework::OnCountryFileDownloaded(storage::CountryId const &, storage::Loc
     if (id.IsAlive())
       rect = id.GetInfo()->m_bordersRect;
   }
+  m_routingManager.ClearRoutingCaches();
 
   m_trafficManager.Invalidate();
   m_transitManager.Invalidate();
@@ -432,6 +433,7 @@ bool Framework::OnCountryFileDelete(storage::CountryId const & countryId, storag
     m_featuresFetcher.DeregisterMap(platform::CountryFile(countryId));
     deferredDelete = true;
   }
+  m_routingManager.ClearRoutingCaches();
   InvalidateRect(rect);
 
   GetSearchAPI().ClearCaches();
@@ -1141,6 +1143,7 @@ void Framework::ClearAllCaches()
   m_featuresFetcher.ClearCaches();
   m_infoGetter->ClearCaches();
   GetSearchAPI().ClearCaches();
+  m_routingManager.ClearRoutingCaches();
 }
 
 void Framework::OnUpdateCurrentCountry(m2::PointD const & pt, int zoomLevel)
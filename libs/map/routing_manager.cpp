@@ -527,9 +527,14 @@ void RoutingManager::SetRouterImpl(RouterType type)
   if (type == RouterType::Ruler)
     router = make_unique<RulerRouter>();
   else
-    router = make_unique<IndexRouter>(
+  {
+    auto indexRouter = make_unique<IndexRouter>(
         vehicleType, m_loadAltitudes, m_callbacks.m_countryParentNameGetterFn, countryFileGetter, getMwmRectByName,
         numMwmIds, MakeNumMwmTree(*numMwmIds, m_callbacks.m_countryInfoGetter()), m_routingSession, dataSource);
+    // Car reroutes are the most frequent and the most expensive ones, the kept waves are capped by size.
+    indexRouter->SetKeepFinishTrees(vehicleType == VehicleType::Car);
+    router = std::move(indexRouter);
+  }
 
   m_routingSession.SetRoutingSettings(GetRoutingSettings(vehicleType));
   m_routingSession.SetRouter(std::move(router), std::move(regionsFinder));
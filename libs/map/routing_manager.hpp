@@ -133,6 +133,8 @@ public:
   void BuildRoute(uint32_t timeoutSec = routing::RouterDelegate::kNoTimeout);
   void SetUserCurrentPosition(m2::PointD const & position);
   void ResetRoutingSession() { m_routingSession.Reset(); }
+  /// Clears the data the router keeps between the routes. Should be called when mwms are changed or memory is low.
+  void ClearRoutingCaches() { m_routingSession.ClearRouterCaches(); }
   // FollowRoute has a bug where the router follows the route even if the method hads't been called.
   // This method was added because we do not want to break the behaviour that is familiar to our
   // users.
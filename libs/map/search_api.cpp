@@ -134,6 +134,16 @@ private:
   SearchAPI::Delegate & m_delegate;
   OnResults m_onResults;
 };
+
+// Queries are posted on every keystroke, and their unchanged tokens are served by the retrieval cache.
+size_t constexpr kRetrievalCacheBytes = 16 * 1024 * 1024;
+
+Engine::Params MakeEngineParams(size_t numThreads)
+{
+  Engine::Params params(languages::GetCurrentMapTwine() /* locale */, numThreads);
+  params.m_retrievalCacheBytes = kRetrievalCacheBytes;
+  return params;
+}
 }  // namespace
 
 SearchAPI::SearchAPI(DataSource & dataSource, storage::Storage const & storage,
@@ -142,8 +152,7 @@ SearchAPI::SearchAPI(DataSource & dataSource, storage::Storage const & storage,
   , m_storage(storage)
   , m_infoGetter(infoGetter)
   , m_delegate(delegate)
-  , m_engine(m_dataSource, GetDefaultCategories(), m_infoGetter,
-             Engine::Params(languages::GetCurrentMapTwine() /* locale */, numThreads))
+  , m_engine(m_dataSource, GetDefaultCategories(), m_infoGetter, MakeEngineParams(numThreads))
 {}
 
 void SearchAPI::OnViewportChanged(m2::RectD const & viewport)
@@ -182,6 +191,8 @@ bool SearchAPI::SearchEverywhere(EverywhereSearchParams params)
   p.m_needAddress = true;
   p.m_needHighlighting = true;
   p.m_categorialRequest = params.m_isCategory;
+  // Typed queries reuse retrievals of the previous keystroke, categories are picked from the list.
+  p.m_typeAhead = !params.m_isCategory;
   if (params.m_timeout)
     p.m_timeout = *params.m_timeout;
 
@@ -206,6 +217,7 @@ bool SearchAPI::SearchInViewport(ViewportSearchParams params)
   p.m_needAddress = false;
   p.m_needHighlighting = false;
   p.m_categorialRequest = params.m_isCategory;
+  p.m_typeAhead = !params.m_isCategory;
 
   if (params.m_timeout)
     p.m_timeout = *params.m_timeout;
@@ -266,6 +278,8 @@ void SearchAPI::PokeSearchInViewport(bool forceSearch)
   SetViewportIfPossible(params);
   params.m_position = m_delegate.GetCurrentPosition();
   params.m_onResults = ViewportSearchCallback(m_viewport, *this, m_viewportParams.m_onCompleted);
+  // The same query is repeated on map moves, it is not typed and bypasses the type-ahead session.
+  params.m_typeAhead = false;
 
   Search(std::move(params), forceSearch);
 }
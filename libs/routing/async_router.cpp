@@ -125,6 +125,7 @@ AsyncRouter::AsyncRouter(PointCheckCallback const & pointCheckCallback)
   : m_threadExit(false)
   , m_hasRequest(false)
   , m_clearState(false)
+  , m_clearCaches(false)
   , m_pointCheckCallback(pointCheckCallback)
 {
   m_thread = threads::SimpleThread(&AsyncRouter::ThreadFunc, this);
@@ -191,6 +192,14 @@ void AsyncRouter::ClearState()
   ResetDelegate();
 }
 
+void AsyncRouter::ClearCaches()
+{
+  unique_lock ul(m_guard);
+
+  m_clearCaches = true;
+  m_threadCondVar.notify_one();
+}
+
 // static
 void AsyncRouter::LogCode(RouterResultCode code, double const elapsedSec)
 {
@@ -240,7 +249,7 @@ void AsyncRouter::ThreadFunc()
   {
     {
       unique_lock ul(m_guard);
-      m_threadCondVar.wait(ul, [this]() { return m_threadExit || m_hasRequest || m_clearState; });
+      m_threadCondVar.wait(ul, [this]() { return m_threadExit || m_hasRequest || m_clearState || m_clearCaches; });
 
       if (m_clearState && m_router)
       {
@@ -248,6 +257,12 @@ void AsyncRouter::ThreadFunc()
         m_clearState = false;
       }
 
+      if (m_clearCaches && m_router)
+      {
+        m_router->ClearCaches();
+        m_clearCaches = false;
+      }
+
       if (m_threadExit)
         break;
 
@@ -55,6 +55,8 @@ public:
   void SetGuidesTracks(GuidesTracks && guides);
   /// Interrupt routing and clear buffers
   void ClearState();
+  /// Clear the data the router keeps between the routes, when the current route is built.
+  void ClearCaches();
 
   bool FindClosestProjectionToRoad(m2::PointD const & point, m2::PointD const & direction, double radius,
                                    EdgeProj & proj);
@@ -110,6 +112,7 @@ private:
 
   /// Current request parameters
   bool m_clearState = false;
+  bool m_clearCaches = false;
   Checkpoints m_checkpoints;
   GuidesTracks m_guides;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "routing/base/astar_graph.hpp"
+#include "routing/base/astar_queue.hpp"
 #include "routing/base/astar_vertex_data.hpp"
 #include "routing/base/astar_weight.hpp"
 #include "routing/base/routing_result.hpp"
@@ -10,11 +11,14 @@
 #include "base/logging.hpp"
 
 #include <algorithm>
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <optional>
-#include <queue>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -43,7 +47,8 @@ struct DefaultLengthChecker
 };
 }  // namespace astar
 
-template <typename Vertex, typename Edge, typename Weight>
+/// |QueuePolicy| chooses the priority queue of the waves, see astar_queue.hpp.
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy = astar::DefaultQueue>
 class AStarAlgorithm
 {
 public:
@@ -85,6 +90,17 @@ public:
     // Used for AdjustRoute.
     base::Cancellable const & m_cancellable;
     std::function<bool(Weight, Weight)> m_badReducedWeight = [](Weight, Weight) { return true; };
+    // Used for FindPathBidirectional, FindPathBidirectionalParallel. If it's set, the parents of the
+    // backward wave are moved there when a path is found, see FinishTree.
+    typename Graph::Parents * m_backwardParents = nullptr;
+  };
+
+  /// \brief Paths to the final vertex from the vertices of a backward wave. Every vertex has the next
+  /// vertex of its path and the weight of the path. It's used to adjust a route to the previous search.
+  struct FinishTree
+  {
+    typename Graph::Parents m_next;
+    ska::bytell_hash_map<Vertex, Weight> m_distances;
   };
 
   // |LengthChecker| callback used to check path length from start/finish to the edge (including the
@@ -196,11 +212,27 @@ public:
     });
   }
 
+  /// \brief The same as FindPathBidirectional() but the backward wave goes on a separate thread.
+  /// Every wave calls only the graph and the callbacks of its own params, so |backwardParams| should
+  /// have its own graph if the graph is not safe for concurrent use. The graphs should give the same
+  /// vertices, |backwardParams| should have the same start and final vertices as |forwardParams|.
+  template <class P>
+  Result FindPathBidirectionalParallel(P & forwardParams, P & backwardParams,
+                                       RoutingResult<Vertex, Weight> & result) const;
+
   // Adjust route to the previous one.
   // Expects |params.m_checkLengthCallback| to check wave propagation limit.
   template <typename P>
-  typename AStarAlgorithm<Vertex, Edge, Weight>::Result AdjustRoute(P & params, std::vector<Edge> const & prevRoute,
-                                                                    RoutingResult<Vertex, Weight> & result) const;
+  Result AdjustRoute(P & params, std::vector<Edge> const & prevRoute, RoutingResult<Vertex, Weight> & result) const;
+
+  // Adjust route to any vertex of |finishTree| the distance of which is known.
+  // Expects |params.m_checkLengthCallback| to check wave propagation limit.
+  template <typename P>
+  Result AdjustRoute(P & params, FinishTree const & finishTree, RoutingResult<Vertex, Weight> & result) const;
+
+  /// \brief Fills |tree.m_distances| by |tree.m_next| with the weights of the outgoing edges of |graph|.
+  /// The vertices which don't lead to |finalVertex| by the edges of |graph| get no distance.
+  static void CalcFinishTreeDistances(Graph & graph, Vertex const & finalVertex, FinishTree & tree);
 
 private:
   // Periodicity of switching a wave of bidirectional algorithm.
@@ -245,6 +277,8 @@ private:
     Weight heuristic;
   };
 
+  using Queue = typename QueuePolicy::template Queue<State>;
+
   // BidirectionalStepContext keeps all the information that is needed to
   // search starting from one of the two directions. Its main
   // purpose is to make the code that changes directions more readable.
@@ -282,11 +316,14 @@ private:
     // which leads to p_f(t) = 0 and p_r(s) = 0.
     // However, with constants set to zero understanding
     // particular routes when debugging turned out to be easier.
-    Weight ConsistentHeuristic(Vertex const & v) const
+    Weight ConsistentHeuristic(Vertex const & v) const { return ConsistentHeuristic(v, forward); }
+
+    // The heuristic of the wave in |forwardWave| direction calculated with the graph of this wave.
+    Weight ConsistentHeuristic(Vertex const & v, bool forwardWave) const
     {
       auto const piF = graph.HeuristicCostEstimate(v, finalVertex);
       auto const piR = graph.HeuristicCostEstimate(v, startVertex);
-      if (forward)
+      if (forwardWave)
       {
         /// @todo careful: with this "return" here and below in the Backward case
         /// the heuristic becomes inconsistent but still seems to work.
@@ -339,7 +376,7 @@ private:
     Vertex const & finalVertex;
     Graph & graph;
 
-    std::priority_queue<State, std::vector<State>, std::greater<State>> queue;
+    Queue queue;
     ska::bytell_hash_map<Vertex, Weight> bestDistance;
     Parents parent;
     Vertex bestVertex;
@@ -355,25 +392,25 @@ private:
                                            std::vector<Vertex> & path);
 };
 
-template <typename Vertex, typename Edge, typename Weight>
-constexpr Weight AStarAlgorithm<Vertex, Edge, Weight>::kInfiniteDistance;
-template <typename Vertex, typename Edge, typename Weight>
-constexpr Weight AStarAlgorithm<Vertex, Edge, Weight>::kZeroDistance;
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+constexpr Weight AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::kInfiniteDistance;
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+constexpr Weight AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::kZeroDistance;
 
-template <typename Vertex, typename Edge, typename Weight>
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
 template <typename VisitVertex, typename AdjustEdgeWeight, typename FilterStates, typename ReducedToFullLength>
-void AStarAlgorithm<Vertex, Edge, Weight>::PropagateWave(Graph & graph, Vertex const & startVertex,
-                                                         VisitVertex && visitVertex,
-                                                         AdjustEdgeWeight && adjustEdgeWeight,
-                                                         FilterStates && filterStates,
-                                                         ReducedToFullLength && reducedToFullLength,
-                                                         AStarAlgorithm<Vertex, Edge, Weight>::Context & context) const
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::PropagateWave(Graph & graph, Vertex const & startVertex,
+                                                                      VisitVertex && visitVertex,
+                                                                      AdjustEdgeWeight && adjustEdgeWeight,
+                                                                      FilterStates && filterStates,
+                                                                      ReducedToFullLength && reducedToFullLength,
+                                                                      Context & context) const
 {
   auto const epsilon = graph.GetAStarWeightEpsilon();
 
   context.Clear();
 
-  std::priority_queue<State, std::vector<State>, std::greater<State>> queue;
+  Queue queue;
 
   context.SetDistance(startVertex, kZeroDistance);
   queue.push(State(startVertex, kZeroDistance));
@@ -417,11 +454,11 @@ void AStarAlgorithm<Vertex, Edge, Weight>::PropagateWave(Graph & graph, Vertex c
   }
 }
 
-template <typename Vertex, typename Edge, typename Weight>
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
 template <typename VisitVertex>
-void AStarAlgorithm<Vertex, Edge, Weight>::PropagateWave(Graph & graph, Vertex const & startVertex,
-                                                         VisitVertex && visitVertex,
-                                                         AStarAlgorithm<Vertex, Edge, Weight>::Context & context) const
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::PropagateWave(Graph & graph, Vertex const & startVertex,
+                                                                      VisitVertex && visitVertex,
+                                                                      Context & context) const
 {
   auto const adjustEdgeWeight = [](Vertex const & /* vertex */, Edge const & edge) { return edge.GetWeight(); };
   auto const filterStates = [](State const & /* state */) { return true; };
@@ -445,9 +482,10 @@ void AStarAlgorithm<Vertex, Edge, Weight>::PropagateWave(Graph & graph, Vertex c
 // http://research.microsoft.com/pubs/154937/soda05.pdf
 // http://www.cs.princeton.edu/courses/archive/spr06/cos423/Handouts/EPP%20shortest%20path%20algorithms.pdf
 
-template <typename Vertex, typename Edge, typename Weight>
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
 template <typename P>
-typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edge, Weight>::FindPath(
+typename AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Result
+AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::FindPath(
     P & params, RoutingResult<Vertex, Weight> & result) const
 {
   auto const epsilon = params.m_weightEpsilon;
@@ -519,9 +557,10 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
   return resultCode;
 }
 
-template <typename Vertex, typename Edge, typename Weight>
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
 template <class P, class Emitter>
-typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edge, Weight>::FindPathBidirectionalEx(
+typename AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Result
+AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::FindPathBidirectionalEx(
     P & params, Emitter && emitter) const
 {
   auto const epsilon = params.m_weightEpsilon;
@@ -567,6 +606,12 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
     return emitter(std::move(result));
   };
 
+  auto const SaveBackwardParents = [&params, &backward]()
+  {
+    if (params.m_backwardParents)
+      *params.m_backwardParents = std::move(backward.parent);
+  };
+
   typename Graph::EdgeListT adj;
 
   // It is not necessary to check emptiness for both queues here
@@ -604,9 +649,11 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
       if (curTop + nxtTop >= bestPathReducedLength - epsilon)
       {
         if (EmitResult())
+        {
+          SaveBackwardParents();
           return Result::OK;
-        else
-          foundAnyPath = false;
+        }
+        foundAnyPath = false;
       }
     }
 
@@ -682,20 +729,234 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
   if (foundAnyPath)
   {
     (void)EmitResult();
+    SaveBackwardParents();
     return Result::OK;
   }
 
   return Result::NoPath;
 }
 
-template <typename Vertex, typename Edge, typename Weight>
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+template <class P>
+typename AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Result
+AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::FindPathBidirectionalParallel(
+    P & forwardParams, P & backwardParams, RoutingResult<Vertex, Weight> & result) const
+{
+  auto const epsilon = forwardParams.m_weightEpsilon;
+  auto const & startVertex = forwardParams.m_startVertex;
+  auto const & finalVertex = forwardParams.m_finalVertex;
+  ASSERT(startVertex == backwardParams.m_startVertex && finalVertex == backwardParams.m_finalVertex, ());
+
+  BidirectionalStepContext forward(true /* forward */, startVertex, finalVertex, forwardParams.m_graph);
+  BidirectionalStepContext backward(false /* forward */, startVertex, finalVertex, backwardParams.m_graph);
+
+  forward.UpdateDistance(State(startVertex, kZeroDistance));
+  forward.queue.push(State(startVertex, kZeroDistance, forward.ConsistentHeuristic(startVertex)));
+
+  backward.UpdateDistance(State(finalVertex, kZeroDistance));
+  backward.queue.push(State(finalVertex, kZeroDistance, backward.ConsistentHeuristic(finalVertex)));
+
+  // The state which is shared by the waves: the queues, the distances and the parents of both waves
+  // and the best path. It's guarded by |mutex|, the graphs are called without the lock.
+  std::mutex mutex;
+  bool stop = false;
+  bool cancelled = false;
+  bool foundAnyPath = false;
+  Weight bestPathReducedLength = kZeroDistance;
+  Weight bestPathRealLength = kZeroDistance;
+  // A wave may have an empty queue while it's expanding a vertex, the distance of the vertex is
+  // a lower bound of the distances of the states it's going to push.
+  std::optional<Weight> expanding[2];
+
+  auto const propagate = [&](BidirectionalStepContext & cur, BidirectionalStepContext & nxt, P & params)
+  {
+    PeriodicPollCancellable periodicCancellable(params.m_cancellable);
+    auto & curExpanding = expanding[cur.forward ? 0 : 1];
+    auto const & nxtExpanding = expanding[nxt.forward ? 0 : 1];
+    auto const endV = cur.forward ? finalVertex : startVertex;
+
+    typename Graph::EdgeListT adj;
+    std::vector<Weight> heuristics;
+    while (true)
+    {
+      if (periodicCancellable.IsCancelled())
+      {
+        std::lock_guard guard(mutex);
+        cancelled = stop = true;
+        return;
+      }
+
+      std::optional<State> stateV;
+      {
+        std::lock_guard guard(mutex);
+        if (stop)
+          return;
+
+        // We can't find a path if one of the waves is exhausted.
+        if (cur.queue.empty() || (nxt.queue.empty() && !nxtExpanding))
+        {
+          stop = true;
+          return;
+        }
+
+        if (foundAnyPath)
+        {
+          // See the stop condition of FindPathBidirectionalEx().
+          auto nxtTop = nxt.queue.empty() ? *nxtExpanding : nxt.TopDistance();
+          if (nxtExpanding && *nxtExpanding < nxtTop)
+            nxtTop = *nxtExpanding;
+
+          if (cur.TopDistance() + nxtTop >= bestPathReducedLength - epsilon)
+          {
+            stop = true;
+            return;
+          }
+        }
+
+        stateV = cur.queue.top();
+        cur.queue.pop();
+
+        if (cur.ExistsStateWithBetterDistance(*stateV))
+          continue;
+
+        curExpanding = stateV->distance;
+        params.m_onVisitedVertexCallback(std::make_pair(*stateV, &cur), endV);
+      }
+
+      cur.GetAdjacencyList(*stateV, adj);
+      heuristics.clear();
+      for (auto const & edge : adj)
+        heuristics.push_back(cur.ConsistentHeuristic(edge.GetTarget()));
+
+      std::lock_guard guard(mutex);
+      auto const & pV = stateV->heuristic;
+      for (size_t i = 0; i < adj.size(); ++i)
+      {
+        auto const & edge = adj[i];
+        State stateW(edge.GetTarget(), kZeroDistance);
+        if (stateV->vertex == stateW.vertex)
+          continue;
+
+        auto const weight = edge.GetWeight();
+        auto const & pW = heuristics[i];
+        auto const reducedWeight = weight + pW - pV;
+
+        if (reducedWeight < -epsilon && params.m_badReducedWeight(reducedWeight, std::max(pW, pV)))
+        {
+          LOG(LERROR, ("Invariant violated for:", "v =", stateV->vertex, "w =", stateW.vertex,
+                       "reduced weight =", reducedWeight));
+        }
+
+        stateW.distance = stateV->distance + std::max(reducedWeight, kZeroDistance);
+
+        auto const fullLength = weight + stateV->distance + cur.pS - pV;
+        if (!params.m_checkLengthCallback(fullLength))
+          continue;
+
+        if (cur.ExistsStateWithBetterDistance(stateW, epsilon))
+          continue;
+
+        stateW.heuristic = pW;
+        cur.UpdateDistance(stateW);
+        cur.UpdateParent(stateW.vertex, stateV->vertex);
+
+        if (auto op = nxt.GetDistance(stateW.vertex); op)
+        {
+          auto const & distW = *op;
+          auto const curPathReducedLength = stateW.distance + distW;
+          if ((!foundAnyPath || bestPathReducedLength > curPathReducedLength) &&
+              cur.graph.AreWavesConnectible(forward.parent, stateW.vertex, backward.parent))
+          {
+            bestPathReducedLength = curPathReducedLength;
+
+            bestPathRealLength = stateV->distance + weight + distW;
+            bestPathRealLength += cur.pS - pV;
+            bestPathRealLength += nxt.pS - cur.ConsistentHeuristic(stateW.vertex, nxt.forward);
+
+            foundAnyPath = true;
+            cur.bestVertex = stateV->vertex;
+            nxt.bestVertex = stateW.vertex;
+          }
+        }
+
+        if (stateW.vertex != endV)
+          cur.queue.push(stateW);
+      }
+      curExpanding.reset();
+    }
+  };
+
+  auto const propagateSafe = [&](BidirectionalStepContext & cur, BidirectionalStepContext & nxt, P & params)
+  {
+    try
+    {
+      propagate(cur, nxt, params);
+      return std::exception_ptr();
+    }
+    catch (...)
+    {
+      std::lock_guard guard(mutex);
+      stop = true;
+      return std::current_exception();
+    }
+  };
+
+  std::exception_ptr backwardException;
+  std::thread backwardThread([&]() { backwardException = propagateSafe(backward, forward, backwardParams); });
+  auto const forwardException = propagateSafe(forward, backward, forwardParams);
+  backwardThread.join();
+
+  if (forwardException)
+    std::rethrow_exception(forwardException);
+  if (backwardException)
+    std::rethrow_exception(backwardException);
+
+  if (cancelled)
+    return Result::Cancelled;
+
+  if (!foundAnyPath)
+    return Result::NoPath;
+
+  result.Clear();
+  ReconstructPathBidirectional(forward.bestVertex, backward.bestVertex, forward.parent, backward.parent,
+                               result.m_path);
+  result.m_distance = bestPathRealLength;
+  if (forwardParams.m_backwardParents)
+    *forwardParams.m_backwardParents = std::move(backward.parent);
+  return Result::OK;
+}
+
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
 template <typename P>
-typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edge, Weight>::AdjustRoute(
+typename AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Result
+AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::AdjustRoute(
     P & params, std::vector<Edge> const & prevRoute, RoutingResult<Vertex, Weight> & result) const
+{
+  CHECK(!prevRoute.empty(), ());
+
+  // If the route passes a vertex several times, the last pass is taken, so the tree has no cycles.
+  FinishTree finishTree;
+  auto remainingDistance = kZeroDistance;
+  for (auto it = prevRoute.crbegin(); it != prevRoute.crend(); ++it)
+  {
+    if (finishTree.m_distances.emplace(it->GetTarget(), remainingDistance).second && it != prevRoute.crbegin())
+      finishTree.m_next.emplace(it->GetTarget(), std::prev(it)->GetTarget());
+
+    remainingDistance += it->GetWeight();
+  }
+
+  return AdjustRoute(params, finishTree, result);
+}
+
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+template <typename P>
+typename AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Result
+AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::AdjustRoute(
+    P & params, FinishTree const & finishTree, RoutingResult<Vertex, Weight> & result) const
 {
   auto & graph = params.m_graph;
   auto const & startVertex = params.m_startVertex;
-  CHECK(!prevRoute.empty(), ());
+  CHECK(!finishTree.m_distances.empty(), ());
 
   result.Clear();
 
@@ -703,15 +964,6 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
   auto minDistance = kInfiniteDistance;
   Vertex returnVertex;
 
-  std::map<Vertex, Weight> remainingDistances;
-  auto remainingDistance = kZeroDistance;
-
-  for (auto it = prevRoute.crbegin(); it != prevRoute.crend(); ++it)
-  {
-    remainingDistances[it->GetTarget()] = remainingDistance;
-    remainingDistance += it->GetWeight();
-  }
-
   Context context(graph);
   PeriodicPollCancellable periodicCancellable(params.m_cancellable);
 
@@ -725,8 +977,8 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
 
     params.m_onVisitedVertexCallback(startVertex, vertex);
 
-    auto it = remainingDistances.find(vertex);
-    if (it != remainingDistances.cend())
+    auto it = finishTree.m_distances.find(vertex);
+    if (it != finishTree.m_distances.cend())
     {
       auto const fullDistance = context.GetDistance(vertex) + it->second;
       if (fullDistance < minDistance)
@@ -755,32 +1007,92 @@ typename AStarAlgorithm<Vertex, Edge, Weight>::Result AStarAlgorithm<Vertex, Edg
   context.ReconstructPath(returnVertex, result.m_path);
 
   // Append remaining route.
-  bool found = false;
-  for (size_t i = 0; i < prevRoute.size(); ++i)
+  size_t remainingCount = 0;
+  for (auto it = finishTree.m_next.find(returnVertex); it != finishTree.m_next.cend();
+       it = finishTree.m_next.find(it->second))
+  {
+    result.m_path.push_back(it->second);
+    CHECK_LESS_OR_EQUAL(++remainingCount, finishTree.m_next.size(), ("Cycle in the finish tree:", returnVertex));
+  }
+
+  result.m_distance = minDistance;
+  return Result::OK;
+}
+
+// static
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::CalcFinishTreeDistances(Graph & graph,
+                                                                                 Vertex const & finalVertex,
+                                                                                 FinishTree & tree)
+{
+  tree.m_distances.clear();
+  tree.m_distances.emplace(finalVertex, kZeroDistance);
+
+  // The weight of the edge with turn penalties, as on the route, or none if the edge is gone.
+  typename Graph::EdgeListT edges;
+  auto const getWeight = [&graph, &edges](Vertex const & from, Vertex const & to) -> std::optional<Weight>
+  {
+    edges.clear();
+    graph.GetOutgoingEdgesList({from, kZeroDistance}, edges);
+    auto const it =
+        std::find_if(edges.cbegin(), edges.cend(), [&to](Edge const & edge) { return edge.GetTarget() == to; });
+    if (it == edges.cend())
+      return {};
+    return it->GetWeight();
+  };
+
+  // Every vertex is walked once: |noPath| keeps the vertices which don't lead to |finalVertex|.
+  std::vector<Vertex> path;
+  ska::bytell_hash_map<Vertex, bool> onPath;
+  ska::bytell_hash_map<Vertex, bool> noPath;
+  for (auto const & item : tree.m_next)
   {
-    if (prevRoute[i].GetTarget() == returnVertex)
+    path.clear();
+    onPath.clear();
+    Vertex vertex = item.first;
+    std::optional<Weight> distance;
+    while (noPath.count(vertex) == 0)
     {
-      for (size_t j = i + 1; j < prevRoute.size(); ++j)
-        result.m_path.push_back(prevRoute[j].GetTarget());
+      if (auto const it = tree.m_distances.find(vertex); it != tree.m_distances.cend())
+      {
+        distance = it->second;
+        break;
+      }
 
-      found = true;
-      break;
+      // No next vertex or a cycle.
+      auto const it = tree.m_next.find(vertex);
+      if (it == tree.m_next.cend() || !onPath.emplace(vertex, true).second)
+        break;
+
+      path.push_back(vertex);
+      vertex = it->second;
     }
-  }
 
-  CHECK(found, ("Can't find", returnVertex, ", prev:", prevRoute.size(), ", adjust:", result.m_path.size()));
+    for (auto it = path.crbegin(); it != path.crend(); ++it)
+    {
+      if (distance)
+      {
+        if (auto const weight = getWeight(*it, tree.m_next.at(*it)))
+          *distance += *weight;
+        else
+          distance.reset();
+      }
+
+      if (!distance)
+      {
+        noPath.emplace(*it, true);
+        continue;
+      }
 
-  auto const & it = remainingDistances.find(returnVertex);
-  CHECK(it != remainingDistances.end(), ());
-  result.m_distance = context.GetDistance(returnVertex) + it->second;
-  return Result::OK;
+      tree.m_distances.emplace(*it, *distance);
+    }
+  }
 }
 
 // static
-template <typename Vertex, typename Edge, typename Weight>
-void AStarAlgorithm<Vertex, Edge, Weight>::ReconstructPath(Vertex const & v,
-                                                           typename BidirectionalStepContext::Parents const & parent,
-                                                           std::vector<Vertex> & path)
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::ReconstructPath(
+    Vertex const & v, typename BidirectionalStepContext::Parents const & parent, std::vector<Vertex> & path)
 {
   path.clear();
   Vertex cur = v;
@@ -797,8 +1109,8 @@ void AStarAlgorithm<Vertex, Edge, Weight>::ReconstructPath(Vertex const & v,
 }
 
 // static
-template <typename Vertex, typename Edge, typename Weight>
-void AStarAlgorithm<Vertex, Edge, Weight>::ReconstructPathBidirectional(
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::ReconstructPathBidirectional(
     Vertex const & v, Vertex const & w, typename BidirectionalStepContext::Parents const & parentV,
     typename BidirectionalStepContext::Parents const & parentW, std::vector<Vertex> & path)
 {
@@ -812,9 +1124,10 @@ void AStarAlgorithm<Vertex, Edge, Weight>::ReconstructPathBidirectional(
   path.insert(path.end(), pathW.rbegin(), pathW.rend());
 }
 
-template <typename Vertex, typename Edge, typename Weight>
-void AStarAlgorithm<Vertex, Edge, Weight>::Context::ReconstructPath(Vertex const & v, std::vector<Vertex> & path) const
+template <typename Vertex, typename Edge, typename Weight, typename QueuePolicy>
+void AStarAlgorithm<Vertex, Edge, Weight, QueuePolicy>::Context::ReconstructPath(Vertex const & v,
+                                                                  std::vector<Vertex> & path) const
 {
-  AStarAlgorithm<Vertex, Edge, Weight>::ReconstructPath(v, m_parents, path);
+  AStarAlgorithm::ReconstructPath(v, m_parents, path);
 }
 }  // namespace routing
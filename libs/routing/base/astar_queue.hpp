@@ -0,0 +1,127 @@
+#pragma once
+
+#include "base/assert.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace routing
+{
+namespace astar
+{
+/// \brief Min-heap where every node has |Arity| children. It has the interface of
+/// std::priority_queue<T, std::vector<T>, std::greater<T>> which is used by AStarAlgorithm.
+/// The heap is lower than the binary one, so pop() touches fewer levels, and the children of a node
+/// are adjacent in memory. The values are moved to a hole while sifting instead of being swapped.
+template <typename T, size_t Arity = 4>
+class DAryHeap
+{
+public:
+  static_assert(Arity >= 2, "");
+
+  bool empty() const { return m_heap.empty(); }
+  size_t size() const { return m_heap.size(); }
+
+  T const & top() const
+  {
+    ASSERT(!empty(), ());
+    return m_heap.front();
+  }
+
+  void push(T const & value) { emplace(value); }
+  void push(T && value) { emplace(std::move(value)); }
+
+  template <typename... Args>
+  void emplace(Args &&... args)
+  {
+    m_heap.emplace_back(std::forward<Args>(args)...);
+    SiftUp(m_heap.size() - 1);
+  }
+
+  void pop()
+  {
+    ASSERT(!empty(), ());
+    if (m_heap.size() > 1)
+    {
+      T last = std::move(m_heap.back());
+      m_heap.pop_back();
+      SiftDown(std::move(last));
+    }
+    else
+    {
+      m_heap.pop_back();
+    }
+  }
+
+  void clear() { m_heap.clear(); }
+
+private:
+  void SiftUp(size_t hole)
+  {
+    T value = std::move(m_heap[hole]);
+    while (hole != 0)
+    {
+      size_t const parent = (hole - 1) / Arity;
+      if (!(m_heap[parent] > value))
+        break;
+
+      m_heap[hole] = std::move(m_heap[parent]);
+      hole = parent;
+    }
+    m_heap[hole] = std::move(value);
+  }
+
+  // Puts |value| to the root and moves it down.
+  void SiftDown(T && value)
+  {
+    size_t const size = m_heap.size();
+    size_t hole = 0;
+    while (true)
+    {
+      size_t const first = hole * Arity + 1;
+      if (first >= size)
+        break;
+
+      size_t const last = std::min(first + Arity, size);
+      size_t best = first;
+      for (size_t child = first + 1; child < last; ++child)
+      {
+        if (m_heap[best] > m_heap[child])
+          best = child;
+      }
+
+      if (!(value > m_heap[best]))
+        break;
+
+      m_heap[hole] = std::move(m_heap[best]);
+      hole = best;
+    }
+    m_heap[hole] = std::move(value);
+  }
+
+  std::vector<T> m_heap;
+};
+
+/// Queue policies of AStarAlgorithm.
+/// @{
+struct BinaryHeapQueue
+{
+  template <typename State>
+  using Queue = std::priority_queue<State, std::vector<State>, std::greater<State>>;
+};
+
+template <size_t Arity>
+struct DAryHeapQueue
+{
+  template <typename State>
+  using Queue = DAryHeap<State, Arity>;
+};
+
+using DefaultQueue = DAryHeapQueue<4>;
+/// @}
+}  // namespace astar
+}  // namespace routing
@@ -0,0 +1,324 @@
+#include "routing/contraction_hierarchy.hpp"
+
+#include "routing/index_graph_starter.hpp"
+
+#include "base/logging.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+namespace routing
+{
+using namespace std;
+
+namespace
+{
+/// \brief Dijkstra over the fake segments of |starter| from |from|. Real segments are reached but
+/// not expanded. |weights| are the weights of the ways between |from| and the reached segments: for
+/// outgoing edges they include the reached segment, for ingoing ones they include the segment after it.
+void FindFakeWays(IndexGraphStarter const & starter, Segment const & from, bool isOutgoing,
+                  map<Segment, double> & weights, map<Segment, Segment> & parents)
+{
+  using State = pair<double, Segment>;
+  priority_queue<State, vector<State>, greater<State>> queue;
+  weights[from] = 0.0;
+  queue.emplace(0.0, from);
+
+  IndexGraphStarter::EdgeListT edges;
+  while (!queue.empty())
+  {
+    auto const [weight, segment] = queue.top();
+    queue.pop();
+    if (weight > weights[segment] || !IndexGraphStarter::IsFakeSegment(segment))
+      continue;
+
+    edges.clear();
+    starter.GetEdgesList(segment, isOutgoing, edges);
+    for (auto const & edge : edges)
+    {
+      double const newWeight = weight + edge.GetWeight().GetIntegratedWeight();
+      auto const [it, inserted] = weights.emplace(edge.GetTarget(), newWeight);
+      if (!inserted)
+      {
+        if (it->second <= newWeight)
+          continue;
+        it->second = newWeight;
+      }
+
+      parents[edge.GetTarget()] = segment;
+      queue.emplace(newWeight, edge.GetTarget());
+    }
+  }
+}
+}  // namespace
+
+ContractionHierarchy::ContractionHierarchy(vector<uint32_t> && featureFirstNode, vector<uint32_t> && firstEdge,
+                                           vector<Edge> && edges)
+  : m_featureFirstNode(std::move(featureFirstNode))
+  , m_firstEdge(std::move(firstEdge))
+  , m_edges(std::move(edges))
+{
+  CHECK(!m_firstEdge.empty() && m_firstEdge.back() == m_edges.size(), ());
+  CHECK(m_featureFirstNode.empty() || m_featureFirstNode.back() == GetNumNodes(), ());
+}
+
+optional<ContractionHierarchy::NodeId> ContractionHierarchy::GetNode(Segment const & segment) const
+{
+  auto const featureId = segment.GetFeatureId();
+  if (featureId + 1 >= m_featureFirstNode.size())
+    return {};
+
+  uint64_t const node = m_featureFirstNode[featureId] + 2 * uint64_t{segment.GetSegmentIdx()} +
+                        (segment.IsForward() ? 0 : 1);
+  if (node >= m_featureFirstNode[featureId + 1])
+    return {};
+  return static_cast<NodeId>(node);
+}
+
+Segment ContractionHierarchy::GetSegment(NodeId node, NumMwmId mwmId) const
+{
+  ASSERT_LESS(node, GetNumNodes(), ());
+  // The first feature whose first node is after |node|, features without segments are skipped.
+  auto const it = upper_bound(m_featureFirstNode.cbegin(), m_featureFirstNode.cend(), node);
+  CHECK(it != m_featureFirstNode.cbegin() && it != m_featureFirstNode.cend(), (node));
+  auto const featureId = static_cast<uint32_t>(distance(m_featureFirstNode.cbegin(), it) - 1);
+  uint32_t const shift = node - m_featureFirstNode[featureId];
+  return Segment(mwmId, featureId, shift / 2 /* segmentIdx */, shift % 2 == 0 /* forward */);
+}
+
+bool ContractionHierarchy::FindPath(vector<Endpoint> const & sources, vector<Endpoint> const & targets,
+                                    Path & path) const
+{
+  using State = pair<double, NodeId>;
+  using Queue = priority_queue<State, vector<State>, greater<State>>;
+
+  struct Wave
+  {
+    Direction m_direction;
+    unordered_map<NodeId, Label> m_labels;
+    Queue m_queue;
+  };
+
+  Wave waves[2] = {{Direction::Forward, {}, {}}, {Direction::Backward, {}, {}}};
+  auto const init = [this](vector<Endpoint> const & endpoints, Wave & wave)
+  {
+    for (auto const & endpoint : endpoints)
+    {
+      CHECK_LESS(endpoint.m_node, GetNumNodes(), ());
+      auto const [it, inserted] = wave.m_labels.emplace(endpoint.m_node, Label{endpoint.m_weight});
+      if (!inserted && it->second.m_weight <= endpoint.m_weight)
+        continue;
+
+      it->second = Label{endpoint.m_weight};
+      wave.m_queue.emplace(endpoint.m_weight, endpoint.m_node);
+    }
+  };
+  init(sources, waves[0]);
+  init(targets, waves[1]);
+
+  double constexpr kInf = numeric_limits<double>::max();
+  double best = kInf;
+  NodeId meet = kInvalidNode;
+  auto const getTop = [](Wave const & wave) { return wave.m_queue.empty() ? kInf : wave.m_queue.top().first; };
+
+  while (true)
+  {
+    double const forwardTop = getTop(waves[0]);
+    double const backwardTop = getTop(waves[1]);
+    // Both waves go up only, so the path can't become lighter when both waves are heavier than it.
+    // It's also the exit when both waves are over.
+    if (min(forwardTop, backwardTop) >= best)
+      break;
+
+    Wave & wave = forwardTop <= backwardTop ? waves[0] : waves[1];
+    Wave const & otherWave = forwardTop <= backwardTop ? waves[1] : waves[0];
+
+    auto const [weight, node] = wave.m_queue.top();
+    wave.m_queue.pop();
+    if (weight > wave.m_labels[node].m_weight)
+      continue;
+
+    auto const otherIt = otherWave.m_labels.find(node);
+    if (otherIt != otherWave.m_labels.cend() && weight + otherIt->second.m_weight < best)
+    {
+      best = weight + otherIt->second.m_weight;
+      meet = node;
+    }
+
+    for (uint32_t i = m_firstEdge[node]; i < m_firstEdge[node + 1]; ++i)
+    {
+      auto const & edge = m_edges[i];
+      if (edge.m_direction != wave.m_direction)
+        continue;
+
+      double const newWeight = weight + edge.m_weight / 1000.0;
+      auto const [it, inserted] = wave.m_labels.emplace(edge.m_target, Label{newWeight, node, i});
+      if (!inserted)
+      {
+        if (it->second.m_weight <= newWeight)
+          continue;
+        it->second = Label{newWeight, node, i};
+      }
+      wave.m_queue.emplace(newWeight, edge.m_target);
+    }
+  }
+
+  if (meet == kInvalidNode)
+    return false;
+
+  path.m_weight = best;
+  path.m_nodes.clear();
+
+  // The forward wave parents lead from |meet| down to a source.
+  vector<pair<NodeId, uint32_t>> forwardEdges;
+  NodeId node = meet;
+  for (auto label = waves[0].m_labels.at(node); label.m_parent != kInvalidNode; label = waves[0].m_labels.at(node))
+  {
+    forwardEdges.emplace_back(label.m_parent, label.m_edge);
+    node = label.m_parent;
+  }
+
+  path.m_nodes.push_back(node);
+  for (auto it = forwardEdges.crbegin(); it != forwardEdges.crend(); ++it)
+    Unpack(it->first, it->second, path.m_nodes);
+
+  node = meet;
+  for (auto label = waves[1].m_labels.at(node); label.m_parent != kInvalidNode; label = waves[1].m_labels.at(node))
+  {
+    Unpack(label.m_parent, label.m_edge, path.m_nodes);
+    node = label.m_parent;
+  }
+
+  return true;
+}
+
+void ContractionHierarchy::Unpack(NodeId node, uint32_t edgeIdx, vector<NodeId> & path) const
+{
+  vector<pair<NodeId, uint32_t>> stack = {{node, edgeIdx}};
+  while (!stack.empty())
+  {
+    auto const [owner, idx] = stack.back();
+    stack.pop_back();
+
+    auto const & edge = m_edges[idx];
+    bool const forward = edge.m_direction == Direction::Forward;
+    NodeId const from = forward ? owner : edge.m_target;
+    NodeId const to = forward ? edge.m_target : owner;
+    if (!edge.IsShortcut())
+    {
+      path.push_back(to);
+      continue;
+    }
+
+    // The middle node is contracted before both ends, so both halves of the shortcut are stored at it.
+    NodeId const middle = edge.m_middle;
+    stack.emplace_back(middle, FindEdge(middle, to, Direction::Forward));
+    stack.emplace_back(middle, FindEdge(middle, from, Direction::Backward));
+  }
+}
+
+uint32_t ContractionHierarchy::FindEdge(NodeId node, NodeId target, Direction direction) const
+{
+  uint32_t result = kInvalidNode;
+  for (uint32_t i = m_firstEdge[node]; i < m_firstEdge[node + 1]; ++i)
+  {
+    auto const & edge = m_edges[i];
+    if (edge.m_target == target && edge.m_direction == direction &&
+        (result == kInvalidNode || edge.m_weight < m_edges[result].m_weight))
+    {
+      result = i;
+    }
+  }
+
+  CHECK_NOT_EQUAL(result, kInvalidNode, ("No half of a shortcut at", node, "to", target));
+  return result;
+}
+
+bool FindContractionHierarchyRoute(ContractionHierarchy const & ch, NumMwmId mwmId, IndexGraphStarter & starter,
+                                   vector<Segment> & route)
+{
+  Segment const & start = starter.GetStartSegment();
+  Segment const & finish = starter.GetFinishSegment();
+
+  map<Segment, double> startWeights;
+  map<Segment, Segment> startParents;
+  FindFakeWays(starter, start, true /* isOutgoing */, startWeights, startParents);
+  map<Segment, double> finishWeights;
+  map<Segment, Segment> finishParents;
+  FindFakeWays(starter, finish, false /* isOutgoing */, finishWeights, finishParents);
+
+  auto const makeEndpoints = [&ch](map<Segment, double> const & weights)
+  {
+    vector<ContractionHierarchy::Endpoint> endpoints;
+    for (auto const & [segment, weight] : weights)
+    {
+      if (IndexGraphStarter::IsFakeSegment(segment))
+        continue;
+      if (auto const node = ch.GetNode(segment))
+        endpoints.push_back({*node, weight});
+    }
+    return endpoints;
+  };
+
+  ContractionHierarchy::Path chPath;
+  bool const found = ch.FindPath(makeEndpoints(startWeights), makeEndpoints(finishWeights), chPath);
+
+  // The fake segments connect the start and the finish directly when they are on the same segment
+  // or on adjacent ones. The hierarchy weight is a lower bound of the ways through the real
+  // segments, so the direct way is the best one if it's not heavier.
+  vector<Segment> path;
+  double expectedWeight = 0.0;
+  auto const direct = startWeights.find(finish);
+  if (direct != startWeights.cend() && (!found || direct->second <= chPath.m_weight))
+  {
+    path.push_back(finish);
+    while (path.back() != start)
+      path.push_back(startParents.at(path.back()));
+    reverse(path.begin(), path.end());
+    expectedWeight = direct->second;
+  }
+  else if (found)
+  {
+    path.reserve(chPath.m_nodes.size() + 4);
+    for (auto segment = ch.GetSegment(chPath.m_nodes.front(), mwmId); segment != start;)
+    {
+      segment = startParents.at(segment);
+      path.push_back(segment);
+    }
+    reverse(path.begin(), path.end());
+    for (auto const node : chPath.m_nodes)
+      path.push_back(ch.GetSegment(node, mwmId));
+    while (path.back() != finish)
+      path.push_back(finishParents.at(path.back()));
+    expectedWeight = chPath.m_weight;
+  }
+  else
+  {
+    return false;
+  }
+
+  // The path is optimal if the real graph allows it and gives almost the same weight. Rounding of
+  // the hierarchy weights to milliseconds is the only difference allowed.
+  auto const weight = CalcPathWeight(starter, path);
+  if (!weight)
+  {
+    LOG(LINFO, ("Contraction hierarchy path is not allowed by the routing graph, using A*."));
+    return false;
+  }
+
+  double const tolerance = 1e-3 * path.size() + 1e-6;
+  if (!starter.CheckLength(*weight) || weight->GetIntegratedWeight() > expectedWeight + tolerance)
+  {
+    LOG(LINFO, ("Contraction hierarchy path weight", expectedWeight, "differs from the real one", *weight,
+                "using A*."));
+    return false;
+  }
+
+  LOG(LDEBUG, ("Result route weight:", *weight));
+  route = std::move(path);
+  return true;
+}
+}  // namespace routing
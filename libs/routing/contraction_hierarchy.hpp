@@ -0,0 +1,155 @@
+#pragma once
+
+#include "routing/segment.hpp"
+
+#include "routing_common/num_mwm_id.hpp"
+
+#include "coding/read_write_utils.hpp"
+#include "coding/reader.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace routing
+{
+/// Contraction hierarchy over the segments of one mwm's car routing graph.
+///
+/// Nodes are directed segments: the segments of feature |f| are numbered from
+/// |m_featureFirstNode[f]|, two nodes (forward and backward) per segment. An edge u -> v has
+/// the weight of the A* edge from segment u to segment v, i.e. the weight of v plus the penalties
+/// of the transition, in milliseconds. Edges are kept at the lower ranked node only, a forward edge
+/// at node u means u -> target and a backward edge means target -> u, so both waves of a query only
+/// go up the hierarchy.
+///
+/// The weights are a lower bound of the weights IndexGraph gives at query time: restrictions,
+/// conditional access and traffic are not taken into account. So a found path should be checked
+/// with the real graph, see FindContractionHierarchyRoute().
+class ContractionHierarchy
+{
+public:
+  using NodeId = uint32_t;
+  // Milliseconds.
+  using Weight = uint32_t;
+
+  static NodeId constexpr kInvalidNode = std::numeric_limits<NodeId>::max();
+  static Weight constexpr kMaxWeight = std::numeric_limits<Weight>::max();
+
+  enum class Direction : uint32_t
+  {
+    Forward = 0,
+    Backward = 1,
+  };
+
+  struct Edge
+  {
+    Edge() = default;
+    Edge(NodeId target, NodeId middle, Weight weight, Direction direction)
+      : m_target(target)
+      , m_middle(middle)
+      , m_weight(weight)
+      , m_direction(direction)
+    {}
+
+    bool IsShortcut() const { return m_middle != kInvalidNode; }
+
+    NodeId m_target = kInvalidNode;
+    // Node the shortcut goes through or kInvalidNode for an edge of the original graph.
+    NodeId m_middle = kInvalidNode;
+    Weight m_weight = 0;
+    Direction m_direction = Direction::Forward;
+  };
+
+  static_assert(sizeof(Edge) == 16, "Edge is written as is.");
+
+  // A node to start or finish the query at. |m_weight| is the weight in seconds of the way from
+  // the start to the source node including the node or from the target node, excluding the node,
+  // to the finish.
+  struct Endpoint
+  {
+    NodeId m_node = kInvalidNode;
+    double m_weight = 0.0;
+  };
+
+  struct Path
+  {
+    // Nodes of the original graph from a source to a target.
+    std::vector<NodeId> m_nodes;
+    // Seconds, including the weights of the endpoints.
+    double m_weight = 0.0;
+  };
+
+  ContractionHierarchy() = default;
+  ContractionHierarchy(std::vector<uint32_t> && featureFirstNode, std::vector<uint32_t> && firstEdge,
+                       std::vector<Edge> && edges);
+
+  uint32_t GetNumNodes() const { return m_firstEdge.empty() ? 0 : static_cast<uint32_t>(m_firstEdge.size() - 1); }
+  uint32_t GetNumEdges() const { return static_cast<uint32_t>(m_edges.size()); }
+
+  static NodeId GetNumNodesForFeature(uint32_t pointsCount) { return pointsCount < 2 ? 0 : 2 * (pointsCount - 1); }
+
+  std::optional<NodeId> GetNode(Segment const & segment) const;
+  Segment GetSegment(NodeId node, NumMwmId mwmId) const;
+
+  /// \brief Finds the lightest path from one of |sources| to one of |targets|.
+  /// \returns false if there is no path.
+  bool FindPath(std::vector<Endpoint> const & sources, std::vector<Endpoint> const & targets, Path & path) const;
+
+  template <typename Sink>
+  void Serialize(Sink & sink) const
+  {
+    WriteToSink(sink, kLastVersion);
+    rw::WriteVectorOfPOD(sink, m_featureFirstNode);
+    rw::WriteVectorOfPOD(sink, m_firstEdge);
+    rw::WriteVectorOfPOD(sink, m_edges);
+  }
+
+  template <typename Source>
+  void Deserialize(Source & src)
+  {
+    auto const version = ReadPrimitiveFromSource<uint16_t>(src);
+    CHECK_EQUAL(version, kLastVersion, ("Unknown contraction hierarchy section version."));
+    rw::ReadVectorOfPOD(src, m_featureFirstNode);
+    rw::ReadVectorOfPOD(src, m_firstEdge);
+    rw::ReadVectorOfPOD(src, m_edges);
+    CHECK(!m_firstEdge.empty() && m_firstEdge.back() == m_edges.size(), ());
+  }
+
+private:
+  static uint16_t constexpr kLastVersion = 0;
+
+  struct Label
+  {
+    double m_weight = 0.0;
+    NodeId m_parent = kInvalidNode;
+    // Index of the edge from |m_parent| in |m_edges|.
+    uint32_t m_edge = 0;
+  };
+
+  // Appends the nodes of the original graph which edge |edgeIdx| stored at |node| goes through,
+  // excluding the first one, to |path|.
+  void Unpack(NodeId node, uint32_t edgeIdx, std::vector<NodeId> & path) const;
+  // Finds an edge stored at |node| to |target| in |direction| with the least weight.
+  uint32_t FindEdge(NodeId node, NodeId target, Direction direction) const;
+
+  std::vector<uint32_t> m_featureFirstNode;
+  std::vector<uint32_t> m_firstEdge;
+  std::vector<Edge> m_edges;
+};
+
+class IndexGraphStarter;
+
+/// \brief Finds |route| between the start and the finish of |starter| with |ch| of mwm |mwmId|.
+/// The route is the fake segments of the start, the hierarchy path and the fake segments of the
+/// finish. If the start and the finish are on the same or adjacent segments, the route may consist
+/// of the fake segments only.
+/// \returns false if there is no route in the hierarchy or if the real graph doesn't allow it or
+/// gives it another weight. A* should be used then.
+bool FindContractionHierarchyRoute(ContractionHierarchy const & ch, NumMwmId mwmId, IndexGraphStarter & starter,
+                                   std::vector<Segment> & route);
+}  // namespace routing
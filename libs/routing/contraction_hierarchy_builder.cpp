@@ -0,0 +1,234 @@
+#include "routing/contraction_hierarchy_builder.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace routing
+{
+using namespace std;
+
+namespace
+{
+// Witness search is bounded to keep contraction of big mwms fast. A missed witness only adds
+// a redundant shortcut.
+size_t constexpr kMaxWitnessSettledNodes = 500;
+uint64_t constexpr kNoWeight = numeric_limits<uint64_t>::max();
+
+ContractionHierarchy::Weight ToWeight(uint64_t weight)
+{
+  return static_cast<ContractionHierarchy::Weight>(min<uint64_t>(weight, ContractionHierarchy::kMaxWeight - 1));
+}
+}  // namespace
+
+ContractionHierarchyBuilder::ContractionHierarchyBuilder(vector<uint32_t> && featureFirstNode)
+  : m_featureFirstNode(std::move(featureFirstNode))
+{
+  uint32_t const numNodes = m_featureFirstNode.empty() ? 0 : m_featureFirstNode.back();
+  m_out.resize(numNodes);
+  m_in.resize(numNodes);
+  m_contracted.resize(numNodes, false);
+  m_contractedNeighbours.resize(numNodes, 0);
+  m_upEdges.resize(numNodes);
+  m_witnessWeights.resize(numNodes, kNoWeight);
+}
+
+void ContractionHierarchyBuilder::AddEdge(NodeId from, NodeId to, double weight)
+{
+  CHECK_LESS(from, GetNumNodes(), ());
+  CHECK_LESS(to, GetNumNodes(), ());
+  CHECK_GREATER_OR_EQUAL(weight, 0.0, ());
+  if (from == to)
+    return;
+
+  // The epsilon keeps whole milliseconds from being rounded down because of the double representation.
+  auto const milliseconds = static_cast<uint64_t>(floor(weight * 1000.0 + 1e-6));
+  UpdateEdge(from, to, ToWeight(milliseconds), ContractionHierarchy::kInvalidNode);
+}
+
+void ContractionHierarchyBuilder::UpdateEdge(NodeId from, NodeId to, Weight weight, NodeId middle)
+{
+  auto & out = m_out[from];
+  auto const outIt = find_if(out.begin(), out.end(), [to](AdjacentEdge const & e) { return e.m_node == to; });
+  if (outIt == out.end())
+  {
+    out.push_back({to, weight, middle});
+    m_in[to].push_back({from, weight, middle});
+    return;
+  }
+
+  if (outIt->m_weight <= weight)
+    return;
+
+  *outIt = {to, weight, middle};
+  auto & in = m_in[to];
+  auto const inIt = find_if(in.begin(), in.end(), [from](AdjacentEdge const & e) { return e.m_node == from; });
+  CHECK(inIt != in.end(), (from, to));
+  *inIt = {from, weight, middle};
+}
+
+void ContractionHierarchyBuilder::FindWitnesses(NodeId source, NodeId skipped, uint64_t maxWeight)
+{
+  for (auto const node : m_touched)
+    m_witnessWeights[node] = kNoWeight;
+  m_touched.clear();
+
+  using State = pair<uint64_t, NodeId>;
+  priority_queue<State, vector<State>, greater<State>> queue;
+  m_witnessWeights[source] = 0;
+  m_touched.push_back(source);
+  queue.emplace(0, source);
+
+  size_t settled = 0;
+  while (!queue.empty())
+  {
+    auto const [weight, node] = queue.top();
+    queue.pop();
+    if (weight > m_witnessWeights[node])
+      continue;
+    if (weight > maxWeight || ++settled > kMaxWitnessSettledNodes)
+      break;
+
+    for (auto const & edge : m_out[node])
+    {
+      if (edge.m_node == skipped)
+        continue;
+
+      uint64_t const newWeight = weight + edge.m_weight;
+      auto & current = m_witnessWeights[edge.m_node];
+      if (newWeight >= current)
+        continue;
+
+      if (current == kNoWeight)
+        m_touched.push_back(edge.m_node);
+      current = newWeight;
+      queue.emplace(newWeight, edge.m_node);
+    }
+  }
+}
+
+void ContractionHierarchyBuilder::FindShortcuts(NodeId node, vector<Shortcut> & shortcuts)
+{
+  shortcuts.clear();
+  auto const & out = m_out[node];
+  for (auto const & in : m_in[node])
+  {
+    uint64_t maxOutWeight = 0;
+    bool hasTargets = false;
+    for (auto const & edge : out)
+    {
+      if (edge.m_node == in.m_node)
+        continue;
+      hasTargets = true;
+      maxOutWeight = max<uint64_t>(maxOutWeight, edge.m_weight);
+    }
+
+    if (!hasTargets)
+      continue;
+
+    FindWitnesses(in.m_node, node, in.m_weight + maxOutWeight);
+    for (auto const & edge : out)
+    {
+      if (edge.m_node == in.m_node)
+        continue;
+
+      uint64_t const weight = uint64_t{in.m_weight} + edge.m_weight;
+      if (m_witnessWeights[edge.m_node] <= weight)
+        continue;
+
+      shortcuts.push_back({in.m_node, edge.m_node, ToWeight(weight)});
+    }
+  }
+}
+
+int64_t ContractionHierarchyBuilder::CalcPriority(NodeId node)
+{
+  FindShortcuts(node, m_shortcuts);
+  int64_t const edgeDifference = static_cast<int64_t>(m_shortcuts.size()) - static_cast<int64_t>(m_in[node].size()) -
+                                 static_cast<int64_t>(m_out[node].size());
+  // Contracted neighbours spread the contraction over the graph evenly.
+  return edgeDifference + m_contractedNeighbours[node];
+}
+
+void ContractionHierarchyBuilder::Contract(NodeId node)
+{
+  FindShortcuts(node, m_shortcuts);
+
+  using Direction = ContractionHierarchy::Direction;
+  auto & upEdges = m_upEdges[node];
+  for (auto const & edge : m_out[node])
+  {
+    upEdges.emplace_back(edge.m_node, edge.m_middle, edge.m_weight, Direction::Forward);
+    auto & in = m_in[edge.m_node];
+    in.erase(remove_if(in.begin(), in.end(), [node](AdjacentEdge const & e) { return e.m_node == node; }), in.end());
+    ++m_contractedNeighbours[edge.m_node];
+  }
+
+  for (auto const & edge : m_in[node])
+  {
+    upEdges.emplace_back(edge.m_node, edge.m_middle, edge.m_weight, Direction::Backward);
+    auto & out = m_out[edge.m_node];
+    out.erase(remove_if(out.begin(), out.end(), [node](AdjacentEdge const & e) { return e.m_node == node; }),
+              out.end());
+    ++m_contractedNeighbours[edge.m_node];
+  }
+
+  vector<AdjacentEdge>().swap(m_out[node]);
+  vector<AdjacentEdge>().swap(m_in[node]);
+  m_contracted[node] = true;
+
+  for (auto const & shortcut : m_shortcuts)
+    UpdateEdge(shortcut.m_from, shortcut.m_to, shortcut.m_weight, node);
+}
+
+ContractionHierarchy ContractionHierarchyBuilder::Build()
+{
+  using State = pair<int64_t, NodeId>;
+  priority_queue<State, vector<State>, greater<State>> queue;
+  for (NodeId node = 0; node < GetNumNodes(); ++node)
+    queue.emplace(CalcPriority(node), node);
+
+  uint32_t contractedCount = 0;
+  size_t shortcutsCount = 0;
+  while (!queue.empty())
+  {
+    NodeId const node = queue.top().second;
+    queue.pop();
+    CHECK(!m_contracted[node], ());
+
+    // Priorities are updated lazily: the node goes back if it became worse than the next one.
+    int64_t const priority = CalcPriority(node);
+    if (!queue.empty() && priority > queue.top().first)
+    {
+      queue.emplace(priority, node);
+      continue;
+    }
+
+    Contract(node);
+    shortcutsCount += m_shortcuts.size();
+    if (++contractedCount % 1000000 == 0)
+      LOG(LINFO, ("Contracted", contractedCount, "of", GetNumNodes(), "nodes, shortcuts:", shortcutsCount));
+  }
+
+  vector<uint32_t> firstEdge;
+  firstEdge.reserve(GetNumNodes() + 1);
+  vector<ContractionHierarchy::Edge> edges;
+  for (auto & upEdges : m_upEdges)
+  {
+    firstEdge.push_back(static_cast<uint32_t>(edges.size()));
+    edges.insert(edges.end(), upEdges.begin(), upEdges.end());
+    vector<ContractionHierarchy::Edge>().swap(upEdges);
+  }
+  firstEdge.push_back(static_cast<uint32_t>(edges.size()));
+
+  LOG(LINFO, ("Contraction hierarchy is built:", GetNumNodes(), "nodes,", edges.size(), "edges,", shortcutsCount,
+              "shortcuts"));
+  return ContractionHierarchy(std::move(m_featureFirstNode), std::move(firstEdge), std::move(edges));
+}
+}  // namespace routing
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "routing/contraction_hierarchy.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace routing
+{
+/// Builds ContractionHierarchy by contracting nodes one by one in the order of the edge difference:
+/// a node which adds fewer shortcuts than it removes edges goes first. A shortcut isn't added if a
+/// bounded local search finds a witness path not heavier than it.
+class ContractionHierarchyBuilder
+{
+public:
+  using NodeId = ContractionHierarchy::NodeId;
+  using Weight = ContractionHierarchy::Weight;
+
+  /// \param featureFirstNode numbering of the nodes, see ContractionHierarchy.
+  explicit ContractionHierarchyBuilder(std::vector<uint32_t> && featureFirstNode);
+
+  uint32_t GetNumNodes() const { return static_cast<uint32_t>(m_out.size()); }
+
+  /// Adds edge |from| -> |to|. |weight| is in seconds, it's rounded down to keep the weights of
+  /// the hierarchy a lower bound of the real ones.
+  void AddEdge(NodeId from, NodeId to, double weight);
+
+  ContractionHierarchy Build();
+
+private:
+  struct AdjacentEdge
+  {
+    NodeId m_node;
+    Weight m_weight;
+    NodeId m_middle;
+  };
+
+  struct Shortcut
+  {
+    NodeId m_from;
+    NodeId m_to;
+    Weight m_weight;
+  };
+
+  // Adds or lightens edge |from| -> |to|.
+  void UpdateEdge(NodeId from, NodeId to, Weight weight, NodeId middle);
+  // Fills |shortcuts| which are needed to contract |node|.
+  void FindShortcuts(NodeId node, std::vector<Shortcut> & shortcuts);
+  // Finds the weights of the lightest paths from |source| to the nodes which are not contracted
+  // yet, not going through |skipped|. Search stops at |maxWeight|, so weights above it are not exact.
+  void FindWitnesses(NodeId source, NodeId skipped, uint64_t maxWeight);
+  int64_t CalcPriority(NodeId node);
+  void Contract(NodeId node);
+
+  std::vector<uint32_t> m_featureFirstNode;
+
+  // Edges between the nodes which are not contracted yet.
+  std::vector<std::vector<AdjacentEdge>> m_out;
+  std::vector<std::vector<AdjacentEdge>> m_in;
+  std::vector<bool> m_contracted;
+  std::vector<uint32_t> m_contractedNeighbours;
+
+  // Edges of contracted nodes to the nodes contracted after them.
+  std::vector<std::vector<ContractionHierarchy::Edge>> m_upEdges;
+
+  // Witness search state, |m_witnessWeights| is reset for |m_touched| nodes only.
+  std::vector<uint64_t> m_witnessWeights;
+  std::vector<NodeId> m_touched;
+  std::vector<Shortcut> m_shortcuts;
+};
+}  // namespace routing
@@ -15,5 +15,16 @@ std::string DebugPrint(WeightsLoadState state)
   }
   UNREACHABLE();
 }
+
+std::string DebugPrint(WeightsLoadMode mode)
+{
+  switch (mode)
+  {
+  case WeightsLoadMode::Lazy: return "Lazy";
+  case WeightsLoadMode::Mapped: return "Mapped";
+  case WeightsLoadMode::Eager: return "Eager";
+  }
+  UNREACHABLE();
+}
 }  // namespace connector
 }  // namespace routing
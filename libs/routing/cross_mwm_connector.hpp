@@ -5,12 +5,15 @@
 
 #include "routing/base/small_list.hpp"
 
+#include "coding/files_container.hpp"
 #include "coding/map_uint32_to_val.hpp"
+#include "coding/reader.hpp"
 #include "coding/sparse_vector.hpp"
 
 #include "base/assert.hpp"
 #include "base/buffer_vector.hpp"
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,7 +37,37 @@ enum class WeightsLoadState
   Loaded
 };
 
+enum class WeightsLoadMode
+{
+  // Blocks of weights are read from the section and decoded on demand.
+  Lazy,
+  // Same as Lazy, but the section is memory mapped and the blocks are read from it in place.
+  Mapped,
+  // All weights are decoded with transitions, the connector isn't changed after that
+  // and may be shared between threads.
+  Eager
+};
+
+/// Memory mapped cross-mwm section, it's kept by the connector which reads weights from it.
+class MappedSection
+{
+public:
+  MappedSection(FilesContainerR const & cont, std::string const & tag)
+  {
+    m_file.Open(cont.GetFileName());
+    auto const [offset, size] = cont.GetAbsoluteOffsetAndSize(tag);
+    m_handle.Assign(m_file.Map(offset, size, tag));
+  }
+
+  MemReader GetReader() const { return MemReader(m_handle.GetData<char>(), m_handle.GetSize()); }
+
+private:
+  ::detail::MappedFile m_file;
+  ::detail::MappedFile::Handle m_handle;
+};
+
 std::string DebugPrint(WeightsLoadState state);
+std::string DebugPrint(WeightsLoadMode mode);
 }  // namespace connector
 
 /// @param CrossMwmId Encoded OSM feature (way) ID that should be equal and unique in all MWMs.
@@ -291,31 +324,26 @@ private:
     WeightT m_granularity = 0;
     uint16_t m_version;
 
+    // Weights of version 1 and eagerly loaded weights of the next versions.
     coding::SparseVector<WeightT> m_v1;
 
+    // Mapping which |m_reader| points to in WeightsLoadMode::Mapped.
+    std::unique_ptr<connector::MappedSection> m_section;
     std::unique_ptr<MapUint32ToValue<WeightT>> m_v2;
     std::unique_ptr<Reader> m_reader;
 
-    bool Empty() const
-    {
-      if (m_version < 2)
-        return m_v1.Empty();
-      else
-        return m_v2 == nullptr;
-    }
+    bool Empty() const { return m_v2 == nullptr && m_v1.Empty(); }
 
     bool Get(uint32_t idx, WeightT & weight) const
     {
-      if (m_version < 2)
-        if (m_v1.Has(idx))
-        {
-          weight = m_v1.Get(idx);
-          return true;
-        }
-        else
-          return false;
-      else
+      if (m_v2)
         return m_v2->Get(idx, weight);
+
+      if (!m_v1.Has(idx))
+        return false;
+
+      weight = m_v1.Get(idx);
+      return true;
     }
 
   } m_weights;
@@ -335,6 +335,45 @@ public:
     m_c.m_weights.m_loadState = connector::WeightsLoadState::Loaded;
   }
 
+  /// Reads weights in place from the memory mapped section, which is kept by the connector.
+  void DeserializeWeights(std::unique_ptr<connector::MappedSection> section)
+  {
+    CHECK(section, ());
+    MemReader reader = section->GetReader();
+    DeserializeWeights(reader);
+    m_c.m_weights.m_section = std::move(section);
+  }
+
+  void DeserializeWeightsEager(FilesContainerR::TReader & reader) { DeserializeWeightsEager(*(reader.GetPtr())); }
+
+  /// Decodes all weights, so the connector isn't changed by the following reads.
+  template <class Reader>
+  void DeserializeWeightsEager(Reader & reader)
+  {
+    DeserializeWeights(reader);
+
+    auto & weights = m_c.m_weights;
+    if (!weights.m_v2)
+      return;
+
+    size_t const amount = m_c.GetNumEnters() * m_c.GetNumExits();
+    coding::SparseVectorBuilder<Weight> builder(amount);
+    size_t next = 0;
+    weights.m_v2->ForEach([&](uint32_t idx, Weight weight)
+    {
+      for (; next < idx; ++next)
+        builder.PushEmpty();
+      builder.PushValue(weight);
+      ++next;
+    });
+    for (; next < amount; ++next)
+      builder.PushEmpty();
+
+    weights.m_v1 = builder.Build();
+    weights.m_v2.reset();
+    weights.m_reader.reset();
+  }
+
 protected:
   bool AddTransition(Transition const & transition, VehicleMask requiredMask)
   {
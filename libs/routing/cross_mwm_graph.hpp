@@ -33,7 +33,9 @@ public:
   };
 
   CrossMwmGraph(std::shared_ptr<NumMwmIds> numMwmIds, std::shared_ptr<m4::Tree<NumMwmId>> numMwmTree,
-                VehicleType vehicleType, CountryRectFn const & countryRectFn, MwmDataSource & dataSource);
+                VehicleType vehicleType, CountryRectFn const & countryRectFn, MwmDataSource & dataSource,
+                connector::WeightsLoadMode loadMode = connector::WeightsLoadMode::Lazy,
+                std::shared_ptr<CrossMwmConnectorCache<base::GeoObjectId>> connectorsCache = nullptr);
 
   /// \brief Transition segment is a segment which is crossed by mwm border. That means
   /// start and finish of such segment have to lie in different mwms. If a segment is
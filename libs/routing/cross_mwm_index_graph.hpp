@@ -21,7 +21,10 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace routing
@@ -29,15 +32,62 @@ namespace routing
 namespace connector
 {
 template <typename CrossMwmId>
-inline FilesContainerR::TReader GetReader(FilesContainerR const & cont)
+inline std::string GetSectionName()
 {
-  return cont.GetReader(CROSS_MWM_FILE_TAG);
+  return CROSS_MWM_FILE_TAG;
 }
 
 template <>
-inline FilesContainerR::TReader GetReader<TransitId>(FilesContainerR const & cont)
+inline std::string GetSectionName<TransitId>()
+{
+  return TRANSIT_CROSS_MWM_FILE_TAG;
+}
+
+template <typename CrossMwmId>
+inline FilesContainerR::TReader GetReader(FilesContainerR const & cont)
 {
-  return cont.GetReader(TRANSIT_CROSS_MWM_FILE_TAG);
+  return cont.GetReader(GetSectionName<CrossMwmId>());
+}
+
+template <typename CrossMwmId>
+void DeserializeWeights(FilesContainerR const & cont, WeightsLoadMode mode,
+                        CrossMwmConnectorBuilder<CrossMwmId> & builder)
+{
+  switch (mode)
+  {
+  case WeightsLoadMode::Lazy:
+  {
+    auto reader = GetReader<CrossMwmId>(cont);
+    builder.DeserializeWeights(reader);
+    return;
+  }
+  case WeightsLoadMode::Mapped:
+    builder.DeserializeWeights(std::make_unique<MappedSection>(cont, GetSectionName<CrossMwmId>()));
+    return;
+  case WeightsLoadMode::Eager:
+  {
+    auto reader = GetReader<CrossMwmId>(cont);
+    builder.DeserializeWeightsEager(reader);
+    return;
+  }
+  }
+  UNREACHABLE();
+}
+
+/// \returns the connector of |numMwmId| with transitions and all weights for |vehicleType|.
+template <typename CrossMwmId>
+std::shared_ptr<CrossMwmConnector<CrossMwmId>> LoadConnector(FilesContainerR const & cont, NumMwmId numMwmId,
+                                                              VehicleType vehicleType)
+{
+  auto c = std::make_shared<CrossMwmConnector<CrossMwmId>>(numMwmId);
+  CrossMwmConnectorBuilder<CrossMwmId> builder(*c);
+  builder.ApplyNumerationOffset();
+
+  auto reader = GetReader<CrossMwmId>(cont);
+  builder.DeserializeTransitions(vehicleType, reader);
+  if (!c->WeightsWereLoaded())
+    builder.DeserializeWeightsEager(reader);
+  return c;
 }
 
 template <typename CrossMwmId>
@@ -51,15 +101,62 @@ inline void AssertConnectorIsFound<TransitId>(NumMwmId /* neighbor */, bool /* i
 {}
 }  // namespace connector
 
+/// Connectors with all weights loaded, shared by cross-mwm graphs of several routes and threads,
+/// so the weights are read once. Graphs must use the same NumMwmIds. It's thread-safe.
+/// Connectors are kept by MwmSet::MwmId, so a replaced mwm is loaded again. Connectors of the replaced
+/// mwms stay until Clear().
+template <typename CrossMwmId>
+class CrossMwmConnectorCache
+{
+public:
+  using ConnectorPtrT = std::shared_ptr<CrossMwmConnector<CrossMwmId>>;
+
+  /// \returns the cached connector or the connector loaded from |handle| without the lock.
+  /// \param numMwmId is the number of the mwm of |handle|.
+  ConnectorPtrT GetOrLoad(VehicleType vehicleType, NumMwmId numMwmId, MwmSet::MwmHandle const & handle)
+  {
+    auto const key = std::make_pair(vehicleType, handle.GetId());
+    {
+      std::lock_guard lock(m_mutex);
+      auto const it = m_connectors.find(key);
+      if (it != m_connectors.end())
+        return it->second;
+    }
+
+    auto c = connector::LoadConnector<CrossMwmId>(handle.GetValue()->m_cont, numMwmId, vehicleType);
+
+    // Threads which miss the same mwm at the same time load it several times, the first one is kept.
+    std::lock_guard lock(m_mutex);
+    return m_connectors.emplace(key, std::move(c)).first->second;
+  }
+
+  void Clear()
+  {
+    std::lock_guard lock(m_mutex);
+    m_connectors.clear();
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<std::pair<VehicleType, MwmSet::MwmId>, ConnectorPtrT> m_connectors;
+};
+
 template <typename CrossMwmId>
 class CrossMwmIndexGraph final
 {
 public:
   using ReaderSourceFile = ReaderSource<FilesContainerR::TReader>;
 
-  CrossMwmIndexGraph(MwmDataSource & dataSource, VehicleType vehicleType)
+  using ConnectorsCacheT = CrossMwmConnectorCache<CrossMwmId>;
+
+  /// \param connectorsCache may be nullptr, it's used in WeightsLoadMode::Eager only.
+  CrossMwmIndexGraph(MwmDataSource & dataSource, VehicleType vehicleType,
+                     connector::WeightsLoadMode loadMode = connector::WeightsLoadMode::Lazy,
+                     std::shared_ptr<ConnectorsCacheT> connectorsCache = nullptr)
     : m_dataSource(dataSource)
     , m_vehicleType(vehicleType)
+    , m_loadMode(loadMode)
+    , m_connectorsCache(std::move(connectorsCache))
   {}
 
   bool IsTransition(Segment const & s, bool isOutgoing)
@@ -94,7 +191,7 @@ public:
       if (it == m_connectors.cend())
         continue;
 
-      CrossMwmConnector<CrossMwmId> const & connector = it->second;
+      CrossMwmConnector<CrossMwmId> const & connector = *it->second;
       // Note. Last parameter in the method below (isEnter) should be set to |isOutgoing|.
       // If |isOutgoing| == true |s| should be an exit transition segment and the method below searches enters
       // and the last parameter (|isEnter|) should be set to true.
@@ -160,10 +257,22 @@ public:
   {
     auto const it = m_connectors.find(numMwmId);
     if (it != m_connectors.cend())
-      return it->second;
+      return *it->second;
 
-    return Deserialize(numMwmId, [this](CrossMwmConnectorBuilder<CrossMwmId> & builder, auto & src)
-    { builder.DeserializeTransitions(m_vehicleType, src); });
+    if (m_loadMode == connector::WeightsLoadMode::Eager)
+    {
+      auto const & handle = m_dataSource.GetHandle(numMwmId);
+      auto c = m_connectorsCache
+                 ? m_connectorsCache->GetOrLoad(m_vehicleType, numMwmId, handle)
+                 : connector::LoadConnector<CrossMwmId>(handle.GetValue()->m_cont, numMwmId, m_vehicleType);
+      return *m_connectors.emplace(numMwmId, std::move(c)).first->second;
+    }
+
+    return Deserialize(numMwmId, [this](CrossMwmConnectorBuilder<CrossMwmId> & builder, FilesContainerR const & cont)
+    {
+      auto reader = connector::GetReader<CrossMwmId>(cont);
+      builder.DeserializeTransitions(m_vehicleType, reader);
+    });
   }
 
   void LoadCrossMwmConnectorWithTransitions(NumMwmId numMwmId) { GetCrossMwmConnectorWithTransitions(numMwmId); }
@@ -234,8 +343,8 @@ private:
     if (c.WeightsWereLoaded())
       return c;
 
-    return Deserialize(
-        numMwmId, [](CrossMwmConnectorBuilder<CrossMwmId> & builder, auto & src) { builder.DeserializeWeights(src); });
+    return Deserialize(numMwmId, [this](CrossMwmConnectorBuilder<CrossMwmId> & builder, FilesContainerR const & cont)
+    { connector::DeserializeWeights(cont, m_loadMode, builder); });
   }
 
   /// \brief Deserializes connectors for an mwm with |numMwmId|.
@@ -248,18 +357,22 @@ private:
   {
     MwmValue const & mwmValue = m_dataSource.GetMwmValue(numMwmId);
 
-    auto it = m_connectors.emplace(numMwmId, CrossMwmConnector<CrossMwmId>(numMwmId)).first;
+    auto & c = m_connectors[numMwmId];
+    if (!c)
+      c = std::make_shared<CrossMwmConnector<CrossMwmId>>(numMwmId);
 
-    CrossMwmConnectorBuilder<CrossMwmId> builder(it->second);
+    CrossMwmConnectorBuilder<CrossMwmId> builder(*c);
     builder.ApplyNumerationOffset();
 
-    auto reader = connector::GetReader<CrossMwmId>(mwmValue.m_cont);
-    fn(builder, reader);
-    return it->second;
+    fn(builder, mwmValue.m_cont);
+    return *c;
   }
 
   MwmDataSource & m_dataSource;
   VehicleType m_vehicleType;
+  connector::WeightsLoadMode m_loadMode;
+  // May be nullptr, when connectors are not shared.
+  std::shared_ptr<ConnectorsCacheT> m_connectorsCache;
 
   /// \note |m_connectors| contains cache with transition segments and leap edges.
   /// Each mwm in |m_connectors| may be in two conditions:
@@ -268,7 +381,8 @@ private:
   /// * with loaded transition segments and with loaded weights
   ///   (after a call to CrossMwmConnectorSerializer::DeserializeTransitions()
   ///   and CrossMwmConnectorSerializer::DeserializeWeights())
-  using ConnectersMapT = std::map<NumMwmId, CrossMwmConnector<CrossMwmId>>;
+  /// In WeightsLoadMode::Eager the connectors are loaded with weights at once and may be shared with other graphs.
+  using ConnectersMapT = std::map<NumMwmId, std::shared_ptr<CrossMwmConnector<CrossMwmId>>>;
   ConnectersMapT m_connectors;
 };
 }  // namespace routing
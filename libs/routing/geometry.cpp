@@ -149,11 +149,11 @@ RoadGeometry::RoadGeometry(bool oneWay, double weightSpeedKMpH, double etaSpeedK
   size_t const count = points.size();
   ASSERT_GREATER(count, 1, ());
 
-  m_junctions.reserve(count);
+  m_points.reserve(count);
   for (auto const & point : points)
-    m_junctions.emplace_back(mercator::ToLatLon(point), geometry::kDefaultAltitudeMeters);
+    m_points.push_back({{mercator::ToLatLon(point), geometry::kDefaultAltitudeMeters}});
 
-  m_distances.resize(count - 1, -1);
+  FillDistances();
 }
 
 void RoadGeometry::Load(VehicleModelInterface const & vehicleModel, FeatureType & feature,
@@ -186,12 +186,12 @@ void RoadGeometry::Load(VehicleModelInterface const & vehicleModel, FeatureType
     if (auto const it = optionsClassfier.Get(type))
       m_routingOptions.Add(*it);
 
-  m_junctions.clear();
-  m_junctions.reserve(count);
+  m_points.clear();
+  m_points.reserve(count);
   for (size_t i = 0; i < count; ++i)
   {
     auto const ll = mercator::ToLatLon(feature.GetPoint(i));
-    m_junctions.emplace_back(ll, altitudes ? (*altitudes)[i] : geometry::kDefaultAltitudeMeters);
+    m_points.push_back({{ll, altitudes ? (*altitudes)[i] : geometry::kDefaultAltitudeMeters}});
 
 #ifdef DEBUG
     // I'd like to check these big jumps manually, if any.
@@ -204,14 +204,16 @@ void RoadGeometry::Load(VehicleModelInterface const & vehicleModel, FeatureType
       auto const absDiff = abs(altDiff) - kError;
       if (absDiff > 0)
       {
-        double const dist = ms::DistanceOnEarth(m_junctions[i - 1].GetLatLon(), m_junctions[i].GetLatLon());
+        auto const & prev = m_points[i - 1].m_junction;
+        auto const & curr = m_points[i].m_junction;
+        double const dist = ms::DistanceOnEarth(prev.GetLatLon(), curr.GetLatLon());
         if (absDiff / dist >= 1.0)
-          LOG(LWARNING, ("Altitudes jump:", altDiff, "/", dist, m_junctions[i - 1], m_junctions[i]));
+          LOG(LWARNING, ("Altitudes jump:", altDiff, "/", dist, prev, curr));
       }
     }
 #endif
   }
-  m_distances.resize(count - 1, -1);
+  FillDistances();
 
   bool const isFerry = m_routingOptions.Has(RoutingOptions::Road::Ferry);
   /// @todo Add RouteShuttleTrain into RoutingOptions?
@@ -241,11 +243,13 @@ void RoadGeometry::Load(VehicleModelInterface const & vehicleModel, FeatureType
     ASSERT(m_forwardSpeed.IsValid() && m_backwardSpeed.IsValid(), (feature.DebugString()));
 }
 
-double RoadGeometry::GetDistance(uint32_t idx) const
+void RoadGeometry::FillDistances()
 {
-  if (m_distances[idx] < 0)
-    m_distances[idx] = ms::DistanceOnEarth(m_junctions[idx].GetLatLon(), m_junctions[idx + 1].GetLatLon());
-  return m_distances[idx];
+  for (size_t i = 0; i + 1 < m_points.size(); ++i)
+  {
+    m_points[i].m_distanceM =
+        ms::DistanceOnEarth(m_points[i].m_junction.GetLatLon(), m_points[i + 1].m_junction.GetLatLon());
+  }
 }
 
 SpeedKMpH const & RoadGeometry::GetSpeed(bool forward) const
@@ -265,21 +269,108 @@ double RoadGeometry::GetRoadLengthM() const
   return lenM;
 }
 
+// RoadGeometryCache -------------------------------------------------------------------------------
+RoadGeometryCache::RoadGeometryCache(size_t maxSizeBytes) : m_shardMaxSizeBytes(maxSizeBytes / kShardsCount)
+{
+  CHECK_GREATER(m_shardMaxSizeBytes, 0, ());
+}
+
+RoadGeometryCache::RoadPtrT RoadGeometryCache::GetOrLoad(uint32_t sourceId, uint32_t featureId,
+                                                         LoaderT const & load)
+{
+  Key const key = (static_cast<Key>(sourceId) << 32) | featureId;
+  auto & shard = m_shards[(featureId ^ sourceId) % kShardsCount];
+  {
+    lock_guard lock(shard.m_mutex);
+    auto const it = shard.m_roads.find(key);
+    if (it != shard.m_roads.end())
+    {
+      shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, it->second);
+      return it->second->second;
+    }
+  }
+
+  // Threads which miss the same road at the same time load it several times, the first loaded road is kept.
+  auto road = make_shared<RoadGeometry>();
+  load(*road);
+
+  lock_guard lock(shard.m_mutex);
+  auto const [it, inserted] = shard.m_roads.emplace(key, shard.m_lru.end());
+  if (!inserted)
+    return it->second->second;
+
+  shard.m_lru.emplace_front(key, std::move(road));
+  it->second = shard.m_lru.begin();
+  shard.m_sizeBytes += GetEntrySize(*shard.m_lru.front().second);
+
+  // The road which has just been loaded is kept even if it's bigger than the shard.
+  while (shard.m_sizeBytes > m_shardMaxSizeBytes && shard.m_lru.size() > 1)
+  {
+    auto const & [lruKey, lruRoad] = shard.m_lru.back();
+    shard.m_sizeBytes -= GetEntrySize(*lruRoad);
+    shard.m_roads.erase(lruKey);
+    shard.m_lru.pop_back();
+  }
+  return shard.m_lru.front().second;
+}
+
+void RoadGeometryCache::Clear()
+{
+  for (auto & shard : m_shards)
+  {
+    lock_guard lock(shard.m_mutex);
+    shard.m_roads.clear();
+    shard.m_lru.clear();
+    shard.m_sizeBytes = 0;
+  }
+}
+
+size_t RoadGeometryCache::GetSizeBytes() const
+{
+  size_t sizeBytes = 0;
+  for (auto const & shard : m_shards)
+  {
+    lock_guard lock(shard.m_mutex);
+    sizeBytes += shard.m_sizeBytes;
+  }
+  return sizeBytes;
+}
+
+// static
+size_t RoadGeometryCache::GetEntrySize(RoadGeometry const & road)
+{
+  // The list node, the hash map slot and the shared pointer control block.
+  size_t constexpr kEntryOverheadBytes = 64;
+  return road.GetMemorySize() + kEntryOverheadBytes;
+}
+
 // Geometry ----------------------------------------------------------------------------------------
 Geometry::Geometry(unique_ptr<GeometryLoader> loader, size_t roadsCacheSize) : m_loader(std::move(loader))
 {
   CHECK(m_loader, ());
 
-  m_featureIdToRoad = make_unique<RoutingCacheT>(
-      roadsCacheSize, [this](uint32_t featureId, RoadGeometry & road) { m_loader->Load(featureId, road); });
+  m_featureIdToRoad = make_unique<RoutingCacheT>(roadsCacheSize, [this](uint32_t featureId, RoadPtrT & road)
+  {
+    auto loaded = make_shared<RoadGeometry>();
+    m_loader->Load(featureId, *loaded);
+    road = std::move(loaded);
+  });
 }
 
-RoadGeometry const & Geometry::GetRoad(uint32_t featureId)
+Geometry::Geometry(unique_ptr<GeometryLoader> loader, shared_ptr<RoadGeometryCache> roadsCache, uint32_t sourceId)
+  : m_loader(std::move(loader))
+  , m_roadsCache(std::move(roadsCache))
+  , m_sourceId(sourceId)
 {
-  ASSERT(m_featureIdToRoad, ());
-  ASSERT(m_loader, ());
+  CHECK(m_loader, ());
+  CHECK(m_roadsCache, ());
 
-  return m_featureIdToRoad->GetValue(featureId);
+  // The local cache keeps the returned roads alive when they are evicted from the shared cache by other threads.
+  m_featureIdToRoad = make_unique<RoutingCacheT>(kRoadsLocalCacheSize, [this](uint32_t featureId, RoadPtrT & road)
+  {
+    road = m_roadsCache->GetOrLoad(m_sourceId, featureId,
+                                   [this, featureId](RoadGeometry & loaded) { m_loader->Load(featureId, loaded); });
+  });
 }
 
 SpeedInUnits GeometryLoader::GetSavedMaxspeed(uint32_t featureId, bool forward)
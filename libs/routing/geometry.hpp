@@ -12,9 +12,16 @@
 
 #include "base/fifo_cache.hpp"
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "3party/skarupke/bytell_hash_map.hpp"
 
@@ -25,6 +32,10 @@ namespace routing
 // @TODO(bykoianko) Consider setting cache size based on available memory.
 // Maximum road geometry cache size in items.
 size_t constexpr kRoadsCacheSize = 10000;
+// Maximum size of the road geometry cache which is shared by several Geometry instances.
+size_t constexpr kRoadsCacheSizeBytes = 64 * 1024 * 1024;
+// Number of roads which are kept by Geometry instance in addition to the shared cache.
+size_t constexpr kRoadsLocalCacheSize = 1024;
 
 class RoadAttrsGetter;
 
@@ -49,16 +60,24 @@ public:
 
   LatLonWithAltitude const & GetJunction(uint32_t junctionId) const
   {
-    ASSERT_LESS(junctionId, m_junctions.size(), ());
-    return m_junctions[junctionId];
+    ASSERT_LESS(junctionId, m_points.size(), ());
+    return m_points[junctionId].m_junction;
+  }
+
+  double GetDistance(uint32_t segmentIdx) const
+  {
+    ASSERT_LESS(segmentIdx + 1, m_points.size(), ());
+    return m_points[segmentIdx].m_distanceM;
   }
 
-  double GetDistance(uint32_t segmendIdx) const;
   double GetRoadLengthM() const;
 
   ms::LatLon const & GetPoint(uint32_t pointId) const { return GetJunction(pointId).GetLatLon(); }
 
-  uint32_t GetPointsCount() const { return static_cast<uint32_t>(m_junctions.size()); }
+  uint32_t GetPointsCount() const { return static_cast<uint32_t>(m_points.size()); }
+
+  /// \returns approximate size of the road in memory in bytes.
+  size_t GetMemorySize() const { return sizeof(RoadGeometry) + m_points.capacity() * sizeof(Point); }
 
   // Note. It's possible that car_model was changed after the map was built.
   // For example, the map from 12.2016 contained highway=pedestrian
@@ -68,7 +87,7 @@ public:
 
   bool IsEndPointId(uint32_t pointId) const
   {
-    ASSERT_LESS(pointId, m_junctions.size(), ());
+    ASSERT_LESS(pointId, m_points.size(), ());
     return pointId == 0 || pointId + 1 == GetPointsCount();
   }
 
@@ -82,8 +101,19 @@ public:
   RoutingOptions GetRoutingOptions() const { return m_routingOptions; }
 
 private:
-  std::vector<LatLonWithAltitude> m_junctions;
-  mutable std::vector<double> m_distances;  ///< as cache, @see GetDistance()
+  /// Junctions and segment lengths are kept in one buffer, so the road is one allocation and the data which
+  /// is used for segment weight calculation is adjacent. The road isn't changed after loading and may be
+  /// shared between threads.
+  struct Point
+  {
+    LatLonWithAltitude m_junction;
+    // Distance to the next point in meters, it's zero for the last point.
+    double m_distanceM = 0.0;
+  };
+
+  void FillDistances();
+
+  std::vector<Point> m_points;
 
   SpeedKMpH m_forwardSpeed;
   SpeedKMpH m_backwardSpeed;
@@ -117,8 +147,50 @@ public:
                                                         VehicleModelPtrT const & vehicleModel);
 };
 
+/// \brief Cache of road geometry which may be shared by Geometry instances of several graphs and threads,
+/// for example by the graphs of the forward and the backward waves or by the routers of different threads.
+/// The cache is limited by the size of the roads in bytes, least recently used roads are evicted first.
+/// It's split into shards with separate locks. It's thread-safe.
+class RoadGeometryCache
+{
+public:
+  using RoadPtrT = std::shared_ptr<RoadGeometry const>;
+  using LoaderT = std::function<void(RoadGeometry & road)>;
+
+  explicit RoadGeometryCache(size_t maxSizeBytes = kRoadsCacheSizeBytes);
+
+  /// \returns the cached road or the road loaded by |load|, which is called without the lock.
+  /// \param sourceId identifies the mwm and the vehicle model of the road, the roads with the same
+  /// |sourceId| and |featureId| should be the same.
+  RoadPtrT GetOrLoad(uint32_t sourceId, uint32_t featureId, LoaderT const & load);
+
+  void Clear();
+  size_t GetSizeBytes() const;
+
+private:
+  static size_t constexpr kShardsCount = 16;
+
+  using Key = uint64_t;
+  using LruListT = std::list<std::pair<Key, RoadPtrT>>;
+
+  struct Shard
+  {
+    mutable std::mutex m_mutex;
+    // The most recently used roads are at the front.
+    LruListT m_lru;
+    ska::bytell_hash_map<Key, LruListT::iterator> m_roads;
+    size_t m_sizeBytes = 0;
+  };
+
+  static size_t GetEntrySize(RoadGeometry const & road);
+
+  size_t const m_shardMaxSizeBytes;
+  std::array<Shard, kShardsCount> m_shards;
+};
+
 /// \brief This class supports loading geometry of roads for routing.
 /// \note Loaded information about road geometry is kept in a fixed-size cache |m_featureIdToRoad|.
+/// If RoadGeometryCache is set, |m_featureIdToRoad| is a small front of it.
 /// On the other hand methods GetRoad() and GetPoint() return geometry information by reference.
 /// The reference may be invalid after the next call of GetRoad() or GetPoint() because the cache
 /// item which is referred by returned reference may be evicted. It's done for performance reasons.
@@ -132,10 +204,16 @@ public:
   /// \brief Geometry constructor
   /// \param roadsCacheSize in-memory geometry elements count limit
   Geometry(std::unique_ptr<GeometryLoader> loader, size_t roadsCacheSize = kRoadsCacheSize);
+  /// \param sourceId identifies the roads of |loader| in |roadsCache|, @see RoadGeometryCache::GetOrLoad().
+  Geometry(std::unique_ptr<GeometryLoader> loader, std::shared_ptr<RoadGeometryCache> roadsCache, uint32_t sourceId);
 
   /// \note The reference returned by the method is valid until the next call of GetRoad()
   /// of GetPoint() methods.
-  RoadGeometry const & GetRoad(uint32_t featureId);
+  RoadGeometry const & GetRoad(uint32_t featureId)
+  {
+    ASSERT(m_featureIdToRoad, ());
+    return *m_featureIdToRoad->GetValue(featureId);
+  }
 
   /// \note The reference returned by the method is valid until the next call of GetRoad()
   /// of GetPoint() methods.
@@ -147,10 +225,13 @@ public:
   }
 
 private:
-  /// @todo Use LRU cache?
-  using RoutingCacheT = FifoCache<uint32_t, RoadGeometry, ska::bytell_hash_map<uint32_t, RoadGeometry>>;
+  using RoadPtrT = RoadGeometryCache::RoadPtrT;
+  using RoutingCacheT = FifoCache<uint32_t, RoadPtrT, ska::bytell_hash_map<uint32_t, RoadPtrT>>;
 
   std::unique_ptr<GeometryLoader> m_loader;
+  // May be nullptr, when the roads are not shared.
+  std::shared_ptr<RoadGeometryCache> m_roadsCache;
+  uint32_t m_sourceId = 0;
   std::unique_ptr<RoutingCacheT> m_featureIdToRoad;
 };
 }  // namespace routing
@@ -35,12 +35,20 @@ bool IsBoarding(bool prevIsFerry, bool nextIsFerry)
 
 IndexGraph::IndexGraph(shared_ptr<Geometry> geometry, shared_ptr<EdgeEstimator> estimator,
                        RoutingOptions routingOptions, feature::RegionData const * regionData)
+  : IndexGraph(std::move(geometry), std::move(estimator), make_shared<Data>(), routingOptions, regionData)
+{}
+
+IndexGraph::IndexGraph(shared_ptr<Geometry> geometry, shared_ptr<EdgeEstimator> estimator,
+                       shared_ptr<Data const> data, RoutingOptions routingOptions,
+                       feature::RegionData const * regionData)
   : m_geometry(std::move(geometry))
   , m_estimator(std::move(estimator))
+  , m_data(std::move(data))
   , m_avoidRoutingOptions(routingOptions)
 {
   CHECK(m_geometry, ());
   CHECK(m_estimator, ());
+  CHECK(m_data, ());
   if (regionData)
   {
     auto const driving_side = regionData->Get(feature::RegionData::RD_DRIVING);
@@ -54,7 +62,7 @@ IndexGraph::IndexGraph(shared_ptr<Geometry> geometry, shared_ptr<EdgeEstimator>
 
 bool IndexGraph::IsJoint(RoadPoint const & roadPoint) const
 {
-  return m_roadIndex.GetJointId(roadPoint) != Joint::kInvalidId;
+  return m_data->m_roadIndex.GetJointId(roadPoint) != Joint::kInvalidId;
 }
 
 bool IndexGraph::IsJointOrEnd(Segment const & segment, bool fromStart) const
@@ -92,11 +100,11 @@ void IndexGraph::GetEdgeListImpl(astar::VertexData<Segment, RouteWeight> const &
   auto const & segment = vertexData.m_vertex;
 
   RoadPoint const roadPoint = segment.GetRoadPoint(isOutgoing);
-  Joint::Id const jointId = m_roadIndex.GetJointId(roadPoint);
+  Joint::Id const jointId = m_data->m_roadIndex.GetJointId(roadPoint);
 
   if (jointId != Joint::kInvalidId)
   {
-    m_jointIndex.ForEachPoint(jointId, [&](RoadPoint const & rp)
+    m_data->m_jointIndex.ForEachPoint(jointId, [&](RoadPoint const & rp)
     { GetNeighboringEdges(vertexData, rp, isOutgoing, useRoutingOptions, edges, parents, useAccessConditional); });
   }
   else
@@ -193,31 +201,33 @@ optional<JointEdge> IndexGraph::GetJointEdgeByLastPoint(Segment const & parent,
 
 void IndexGraph::Build(uint32_t numJoints)
 {
-  m_jointIndex.Build(m_roadIndex, numJoints);
+  auto & data = MutableData();
+  data.m_jointIndex.Build(data.m_roadIndex, numJoints);
 }
 
 void IndexGraph::Import(vector<Joint> const & joints)
 {
-  m_roadIndex.Import(joints);
+  MutableData().m_roadIndex.Import(joints);
   CHECK_LESS_OR_EQUAL(joints.size(), numeric_limits<uint32_t>::max(), ());
   Build(checked_cast<uint32_t>(joints.size()));
 }
 
 void IndexGraph::SetRestrictions(RestrictionVec && restrictions)
 {
-  m_restrictionsForward.clear();
-  m_restrictionsBackward.clear();
+  auto & data = MutableData();
+  data.m_restrictionsForward.clear();
+  data.m_restrictionsBackward.clear();
 
   base::HighResTimer timer;
   for (auto const & restriction : restrictions)
   {
     ASSERT(!restriction.empty(), ());
 
-    auto & forward = m_restrictionsForward[restriction.back()];
+    auto & forward = data.m_restrictionsForward[restriction.back()];
     forward.emplace_back(restriction.begin(), prev(restriction.end()));
     reverse(forward.back().begin(), forward.back().end());
 
-    m_restrictionsBackward[restriction.front()].emplace_back(next(restriction.begin()), restriction.end());
+    data.m_restrictionsBackward[restriction.front()].emplace_back(next(restriction.begin()), restriction.end());
   }
 
   LOG(LDEBUG, ("Restrictions are loaded in:", timer.ElapsedMilliseconds(), "ms"));
@@ -225,22 +235,24 @@ void IndexGraph::SetRestrictions(RestrictionVec && restrictions)
 
 void IndexGraph::SetUTurnRestrictions(vector<RestrictionUTurn> && noUTurnRestrictions)
 {
+  auto & data = MutableData();
+  data.m_noUTurnRestrictions.clear();
   for (auto const & noUTurn : noUTurnRestrictions)
     if (noUTurn.m_viaIsFirstPoint)
-      m_noUTurnRestrictions[noUTurn.m_featureId].m_atTheBegin = true;
+      data.m_noUTurnRestrictions[noUTurn.m_featureId].m_atTheBegin = true;
     else
-      m_noUTurnRestrictions[noUTurn.m_featureId].m_atTheEnd = true;
+      data.m_noUTurnRestrictions[noUTurn.m_featureId].m_atTheEnd = true;
 }
 
 void IndexGraph::SetRoadAccess(RoadAccess && roadAccess)
 {
-  m_roadAccess = std::move(roadAccess);
-  m_roadAccess.SetCurrentTimeGetter(m_currentTimeGetter);
+  // The road access is checked with |m_currentTimeGetter| of the graph, because it may be shared.
+  MutableData().m_roadAccess = std::move(roadAccess);
 }
 
 void IndexGraph::SetRoadPenalty(RoadPenalty && roadPenalty)
 {
-  m_roadPenalty = std::move(roadPenalty);
+  MutableData().m_roadPenalty = std::move(roadPenalty);
 }
 
 void IndexGraph::GetNeighboringEdges(astar::VertexData<Segment, RouteWeight> const & fromVertexData,
@@ -294,12 +306,12 @@ void IndexGraph::GetSegmentCandidateForRoadPoint(RoadPoint const & rp, NumMwmId
 void IndexGraph::GetSegmentCandidateForJoint(Segment const & parent, bool isOutgoing, SegmentListT & children) const
 {
   RoadPoint const roadPoint = parent.GetRoadPoint(isOutgoing);
-  Joint::Id const jointId = m_roadIndex.GetJointId(roadPoint);
+  Joint::Id const jointId = m_data->m_roadIndex.GetJointId(roadPoint);
 
   if (jointId == Joint::kInvalidId)
     return;
 
-  m_jointIndex.ForEachPoint(jointId, [&](RoadPoint const & rp)
+  m_data->m_jointIndex.ForEachPoint(jointId, [&](RoadPoint const & rp)
   { GetSegmentCandidateForRoadPoint(rp, parent.GetMwmId(), isOutgoing, children); });
 }
 
@@ -441,16 +453,19 @@ RouteWeight IndexGraph::GetPenalties(EdgeEstimator::Purpose purpose, Segment con
 
   int8_t accessPenalty = 0;
   int8_t accessConditionalPenalties = 0;
+  auto const & roadAccess = m_data->m_roadAccess;
 
   if (u.GetFeatureId() != v.GetFeatureId())
   {
     // We do not distinguish between RoadAccess::Type::Private and RoadAccess::Type::Destination for
     // now.
-    auto const [fromAccess, fromConfidence] = prevWeight ? m_roadAccess.GetAccess(u.GetFeatureId(), *prevWeight)
-                                                         : m_roadAccess.GetAccessWithoutConditional(u.GetFeatureId());
+    auto const [fromAccess, fromConfidence] = prevWeight
+                                                ? roadAccess.GetAccess(u.GetFeatureId(), *prevWeight, m_currentTimeGetter)
+                                                : roadAccess.GetAccessWithoutConditional(u.GetFeatureId());
 
-    auto const [toAccess, toConfidence] = prevWeight ? m_roadAccess.GetAccess(v.GetFeatureId(), *prevWeight)
-                                                     : m_roadAccess.GetAccessWithoutConditional(v.GetFeatureId());
+    auto const [toAccess, toConfidence] = prevWeight
+                                            ? roadAccess.GetAccess(v.GetFeatureId(), *prevWeight, m_currentTimeGetter)
+                                            : roadAccess.GetAccessWithoutConditional(v.GetFeatureId());
 
     if (fromConfidence == RoadAccess::Confidence::Sure && toConfidence == RoadAccess::Confidence::Sure)
     {
@@ -469,9 +484,9 @@ RouteWeight IndexGraph::GetPenalties(EdgeEstimator::Purpose purpose, Segment con
   // RoadPoint between u and v is front of u.
   auto const rp = u.GetRoadPoint(true /* front */);
   auto const [rpAccessType, rpConfidence] =
-      prevWeight ? m_roadAccess.GetAccess(rp, *prevWeight) : m_roadAccess.GetAccessWithoutConditional(rp);
+      prevWeight ? roadAccess.GetAccess(rp, *prevWeight, m_currentTimeGetter) : roadAccess.GetAccessWithoutConditional(rp);
   // Get penalty from new penalty system if MWM supports it
-  auto penalty = m_roadPenalty.GetPenalty(rp);
+  auto penalty = m_data->m_roadPenalty.GetPenalty(rp);
   uint16_t penaltyTime = 0;
   if (penalty)
     penaltyTime = penalty->m_timeSeconds;
@@ -516,11 +531,11 @@ bool IndexGraph::IsUTurnAndRestricted(Segment const & parent, Segment const & ch
   auto const & roadGeometry = GetRoadGeometry(featureId);
 
   RoadPoint const rp = parent.GetRoadPoint(isOutgoing);
-  if (m_roadIndex.GetJointId(rp) == Joint::kInvalidId && !roadGeometry.IsEndPointId(turnPoint))
+  if (m_data->m_roadIndex.GetJointId(rp) == Joint::kInvalidId && !roadGeometry.IsEndPointId(turnPoint))
     return true;
 
-  auto const it = m_noUTurnRestrictions.find(featureId);
-  if (it == m_noUTurnRestrictions.cend())
+  auto const it = m_data->m_noUTurnRestrictions.find(featureId);
+  if (it == m_data->m_noUTurnRestrictions.cend())
     return false;
 
   auto const & uTurn = it->second;
@@ -20,6 +20,8 @@
 
 #include "geometry/point2d.hpp"
 
+#include "base/assert.hpp"
+
 #include <memory>
 #include <optional>
 #include <unordered_map>
@@ -44,6 +46,31 @@ public:
 
   using Restrictions = std::unordered_map<uint32_t, std::vector<std::vector<uint32_t>>>;
 
+  /// Graph data deserialized from an mwm. It isn't changed after loading, so it may be shared by graphs
+  /// of several threads, while every graph keeps its own geometry cache and time getter.
+  struct Data
+  {
+    // u_turn can be in both sides of feature.
+    struct UTurnEnding
+    {
+      bool m_atTheBegin = false;
+      bool m_atTheEnd = false;
+    };
+
+    RoadIndex m_roadIndex;
+    JointIndex m_jointIndex;
+    Restrictions m_restrictionsForward;
+    Restrictions m_restrictionsBackward;
+    // Stored featureId and it's UTurnEnding, which shows where is
+    // u_turn restriction is placed - at the beginning or at the ending of feature.
+    //
+    // If m_noUTurnRestrictions.count(featureId) == 0, that means, that there are no any
+    // no_u_turn restriction at the feature with id = featureId.
+    std::unordered_map<uint32_t, UTurnEnding> m_noUTurnRestrictions;
+    RoadAccess m_roadAccess;
+    RoadPenalty m_roadPenalty;
+  };
+
   using SegmentEdgeListT = SmallList<SegmentEdge>;
   using JointEdgeListT = SmallList<JointEdge>;
   using WeightListT = SmallList<RouteWeight>;
@@ -53,6 +80,10 @@ public:
   IndexGraph() = default;
   IndexGraph(std::shared_ptr<Geometry> geometry, std::shared_ptr<EdgeEstimator> estimator,
              RoutingOptions routingOptions = RoutingOptions(), feature::RegionData const * regionData = nullptr);
+  /// Makes a graph over already loaded |data|.
+  IndexGraph(std::shared_ptr<Geometry> geometry, std::shared_ptr<EdgeEstimator> estimator,
+             std::shared_ptr<Data const> data, RoutingOptions routingOptions = RoutingOptions(),
+             feature::RegionData const * regionData = nullptr);
 
   // Put outgoing (or ingoing) egdes for segment to the 'edges' vector.
   void GetEdgeList(astar::VertexData<Segment, RouteWeight> const & vertexData, bool isOutgoing, bool useRoutingOptions,
@@ -69,22 +100,22 @@ public:
   std::optional<JointEdge> GetJointEdgeByLastPoint(Segment const & parent, Segment const & firstChild, bool isOutgoing,
                                                    uint32_t lastPoint) const;
 
-  Joint::Id GetJointId(RoadPoint const & rp) const { return m_roadIndex.GetJointId(rp); }
+  Joint::Id GetJointId(RoadPoint const & rp) const { return m_data->m_roadIndex.GetJointId(rp); }
 
-  bool IsRoad(uint32_t featureId) const { return m_roadIndex.IsRoad(featureId); }
-  RoadJointIds const & GetRoad(uint32_t featureId) const { return m_roadIndex.GetRoad(featureId); }
+  bool IsRoad(uint32_t featureId) const { return m_data->m_roadIndex.IsRoad(featureId); }
+  RoadJointIds const & GetRoad(uint32_t featureId) const { return m_data->m_roadIndex.GetRoad(featureId); }
   RoadGeometry const & GetRoadGeometry(uint32_t featureId) const { return m_geometry->GetRoad(featureId); }
 
   Geometry & GetGeometry() const { return *m_geometry; }
 
   RoadAccess::Type GetAccessType(Segment const & segment) const
   {
-    return m_roadAccess.GetAccessWithoutConditional(segment.GetFeatureId()).first;
+    return m_data->m_roadAccess.GetAccessWithoutConditional(segment.GetFeatureId()).first;
   }
 
-  uint32_t GetNumRoads() const { return m_roadIndex.GetSize(); }
-  uint32_t GetNumJoints() const { return m_jointIndex.GetNumJoints(); }
-  uint32_t GetNumPoints() const { return m_jointIndex.GetNumPoints(); }
+  uint32_t GetNumRoads() const { return m_data->m_roadIndex.GetSize(); }
+  uint32_t GetNumJoints() const { return m_data->m_jointIndex.GetNumJoints(); }
+  uint32_t GetNumPoints() const { return m_data->m_jointIndex.GetNumPoints(); }
 
   void Build(uint32_t numJoints);
   void Import(std::vector<Joint> const & joints);
@@ -94,18 +125,23 @@ public:
   void SetRoadAccess(RoadAccess && roadAccess);
   void SetRoadPenalty(RoadPenalty && roadPenalty);
 
-  void PushFromSerializer(Joint::Id jointId, RoadPoint const & rp) { m_roadIndex.PushFromSerializer(jointId, rp); }
+  void PushFromSerializer(Joint::Id jointId, RoadPoint const & rp)
+  {
+    MutableData().m_roadIndex.PushFromSerializer(jointId, rp);
+  }
+
+  std::shared_ptr<Data const> const & GetData() const { return m_data; }
 
   template <typename F>
   void ForEachRoad(F && f) const
   {
-    m_roadIndex.ForEachRoad(std::forward<F>(f));
+    m_data->m_roadIndex.ForEachRoad(std::forward<F>(f));
   }
 
   template <typename F>
   void ForEachPoint(Joint::Id jointId, F && f) const
   {
-    m_jointIndex.ForEachPoint(jointId, std::forward<F>(f));
+    m_data->m_jointIndex.ForEachPoint(jointId, std::forward<F>(f));
   }
 
   bool IsJoint(RoadPoint const & roadPoint) const;
@@ -186,26 +222,16 @@ private:
   bool IsAccessNoForSure(AccessPositionType const & accessPositionType, RouteWeight const & weight,
                          bool useAccessConditional) const;
 
+  // The data is only changed while the graph is loaded, before it's shared.
+  Data & MutableData()
+  {
+    ASSERT_EQUAL(m_data.use_count(), 1, ());
+    return const_cast<Data &>(*m_data);
+  }
+
   std::shared_ptr<Geometry> m_geometry;
   std::shared_ptr<EdgeEstimator> m_estimator;
-  RoadIndex m_roadIndex;
-  JointIndex m_jointIndex;
-  Restrictions m_restrictionsForward;
-  Restrictions m_restrictionsBackward;
-  // u_turn can be in both sides of feature.
-  struct UTurnEnding
-  {
-    bool m_atTheBegin = false;
-    bool m_atTheEnd = false;
-  };
-  // Stored featureId and it's UTurnEnding, which shows where is
-  // u_turn restriction is placed - at the beginning or at the ending of feature.
-  //
-  // If m_noUTurnRestrictions.count(featureId) == 0, that means, that there are no any
-  // no_u_turn restriction at the feature with id = featureId.
-  std::unordered_map<uint32_t, UTurnEnding> m_noUTurnRestrictions;
-  RoadAccess m_roadAccess;
-  RoadPenalty m_roadPenalty;
+  std::shared_ptr<Data const> m_data = std::make_shared<Data>();
   RoutingOptions m_avoidRoutingOptions;
   bool m_isLeftHandTraffic;
 
@@ -217,9 +243,10 @@ template <typename AccessPositionType>
 bool IndexGraph::IsAccessNoForSure(AccessPositionType const & accessPositionType, RouteWeight const & weight,
                                    bool useAccessConditional) const
 {
+  auto const & roadAccess = m_data->m_roadAccess;
   auto const [accessType, confidence] = useAccessConditional
-                                          ? m_roadAccess.GetAccess(accessPositionType, weight)
-                                          : m_roadAccess.GetAccessWithoutConditional(accessPositionType);
+                                          ? roadAccess.GetAccess(accessPositionType, weight, m_currentTimeGetter)
+                                          : roadAccess.GetAccessWithoutConditional(accessPositionType);
   return accessType == RoadAccess::Type::No && confidence == RoadAccess::Confidence::Sure;
 }
 
@@ -230,7 +257,7 @@ bool IndexGraph::IsRestricted(ParentVertex const & parent, uint32_t parentFeatur
   if (parentFeatureId == currentFeatureId)
     return false;
 
-  auto const & restrictions = isOutgoing ? m_restrictionsForward : m_restrictionsBackward;
+  auto const & restrictions = isOutgoing ? m_data->m_restrictionsForward : m_data->m_restrictionsBackward;
   auto const it = restrictions.find(currentFeatureId);
   if (it == restrictions.cend())
     return false;
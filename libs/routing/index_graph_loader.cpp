@@ -31,13 +31,16 @@ public:
   IndexGraphLoaderImpl(VehicleType vehicleType, bool loadAltitudes,
                        shared_ptr<VehicleModelFactoryInterface> vehicleModelFactory,
                        shared_ptr<EdgeEstimator> estimator, MwmDataSource & dataSource,
-                       RoutingOptions routingOptions = RoutingOptions())
+                       RoutingOptions routingOptions, shared_ptr<IndexGraphDataCache> dataCache,
+                       shared_ptr<RoadGeometryCache> roadsCache)
     : m_vehicleType(vehicleType)
     , m_loadAltitudes(loadAltitudes)
     , m_dataSource(dataSource)
     , m_vehicleModelFactory(std::move(vehicleModelFactory))
     , m_estimator(std::move(estimator))
     , m_avoidRoutingOptions(routingOptions)
+    , m_dataCache(std::move(dataCache))
+    , m_roadsCache(std::move(roadsCache))
   {
     CHECK(m_vehicleModelFactory, ());
     CHECK(m_estimator, ());
@@ -52,6 +55,7 @@ public:
 private:
   using GeometryPtrT = shared_ptr<Geometry>;
   GeometryPtrT CreateGeometry(NumMwmId numMwmId);
+  GeometryPtrT CreateGeometry(NumMwmId numMwmId, MwmSet::MwmHandle const & handle);
   using GraphPtrT = unique_ptr<IndexGraph>;
   GraphPtrT CreateIndexGraph(NumMwmId numMwmId, GeometryPtrT & geometry);
 
@@ -74,6 +78,11 @@ private:
 
   RoutingOptions m_avoidRoutingOptions;
   std::function<time_t()> m_currentTimeGetter = [time = GetCurrentTimestamp()]() { return time; };
+
+  // May be nullptr, when graphs are not shared.
+  shared_ptr<IndexGraphDataCache> m_dataCache;
+  // May be nullptr, when roads are not shared.
+  shared_ptr<RoadGeometryCache> m_roadsCache;
 };
 
 IndexGraph & IndexGraphLoaderImpl::GetIndexGraph(NumMwmId numMwmId)
@@ -132,20 +141,25 @@ IndexGraphLoaderImpl::GraphPtrT IndexGraphLoaderImpl::CreateIndexGraph(NumMwmId
 
   try
   {
-    base::Timer timer;
-
     if (!geometry)
-    {
-      auto vehicleModel = m_vehicleModelFactory->GetVehicleModelForCountry(value->GetCountryFileName());
-      geometry = make_shared<Geometry>(GeometryLoader::Create(handle, std::move(vehicleModel), m_loadAltitudes));
-    }
+      geometry = CreateGeometry(numMwmId, handle);
 
-    auto graph = make_unique<IndexGraph>(geometry, m_estimator, m_avoidRoutingOptions, &value->GetRegionData());
+    auto const loadData = [&]()
+    {
+      base::Timer timer;
+      IndexGraph graph(geometry, m_estimator, m_avoidRoutingOptions, &value->GetRegionData());
+      graph.SetCurrentTimeGetter(m_currentTimeGetter);
+      DeserializeIndexGraph(*value, m_vehicleType, graph);
+
+      LOG(LINFO, (ROUTING_FILE_TAG, "section for", value->GetCountryFileName(), "loaded in", timer.ElapsedSeconds(),
+                  "seconds"));
+      return graph.GetData();
+    };
+
+    auto data = m_dataCache ? m_dataCache->GetOrLoad(m_vehicleType, numMwmId, loadData) : loadData();
+    auto graph =
+        make_unique<IndexGraph>(geometry, m_estimator, std::move(data), m_avoidRoutingOptions, &value->GetRegionData());
     graph->SetCurrentTimeGetter(m_currentTimeGetter);
-    DeserializeIndexGraph(*value, m_vehicleType, *graph);
-
-    LOG(LINFO,
-        (ROUTING_FILE_TAG, "section for", value->GetCountryFileName(), "loaded in", timer.ElapsedSeconds(), "seconds"));
     return graph;
   }
   catch (RootException const & ex)
@@ -157,11 +171,22 @@ IndexGraphLoaderImpl::GraphPtrT IndexGraphLoaderImpl::CreateIndexGraph(NumMwmId
 
 IndexGraphLoaderImpl::GeometryPtrT IndexGraphLoaderImpl::CreateGeometry(NumMwmId numMwmId)
 {
-  MwmSet::MwmHandle const & handle = m_dataSource.GetHandle(numMwmId);
-  MwmValue const * value = handle.GetValue();
+  return CreateGeometry(numMwmId, m_dataSource.GetHandle(numMwmId));
+}
 
-  auto vehicleModel = m_vehicleModelFactory->GetVehicleModelForCountry(value->GetCountryFileName());
-  return make_shared<Geometry>(GeometryLoader::Create(handle, std::move(vehicleModel), m_loadAltitudes));
+IndexGraphLoaderImpl::GeometryPtrT IndexGraphLoaderImpl::CreateGeometry(NumMwmId numMwmId,
+                                                                       MwmSet::MwmHandle const & handle)
+{
+  auto vehicleModel = m_vehicleModelFactory->GetVehicleModelForCountry(handle.GetValue()->GetCountryFileName());
+  auto loader = GeometryLoader::Create(handle, std::move(vehicleModel), m_loadAltitudes);
+  if (!m_roadsCache)
+    return make_shared<Geometry>(std::move(loader));
+
+  // Roads of the same mwm are different for different vehicle models and with or without altitudes.
+  static_assert(static_cast<uint32_t>(VehicleType::Count) <= 0x80, "");
+  uint32_t const sourceId = (static_cast<uint32_t>(numMwmId) << 8) | (static_cast<uint32_t>(m_vehicleType) << 1) |
+                            (m_loadAltitudes ? 1 : 0);
+  return make_shared<Geometry>(std::move(loader), m_roadsCache, sourceId);
 }
 
 void IndexGraphLoaderImpl::Clear()
@@ -171,6 +196,36 @@ void IndexGraphLoaderImpl::Clear()
 
 }  // namespace
 
+// IndexGraphDataCache -----------------------------------------------------------------------------
+IndexGraphDataCache::DataPtrT IndexGraphDataCache::GetOrLoad(VehicleType vehicleType, NumMwmId numMwmId,
+                                                             function<DataPtrT()> const & load)
+{
+  auto const key = make_pair(vehicleType, numMwmId);
+  {
+    lock_guard lock(m_mutex);
+    auto const it = m_data.find(key);
+    if (it != m_data.end())
+      return it->second;
+  }
+
+  // Threads which miss the same mwm at the same time load it several times,
+  // but other mwms are not blocked by the load.
+  auto data = load();
+  CHECK(data, ());
+
+  lock_guard lock(m_mutex);
+  return m_data.emplace(key, std::move(data)).first->second;
+}
+
+void IndexGraphDataCache::Clear()
+{
+  {
+    lock_guard lock(m_mutex);
+    m_data.clear();
+  }
+  m_roadsCache->Clear();
+}
+
 bool ReadSpeedCamsFromMwm(MwmValue const & mwmValue, SpeedCamerasMapT & camerasMap)
 {
   try
@@ -249,10 +304,12 @@ bool ReadRoadPenaltyFromMwm(MwmValue const & mwmValue, VehicleType vehicleType,
 unique_ptr<IndexGraphLoader> IndexGraphLoader::Create(VehicleType vehicleType, bool loadAltitudes,
                                                       shared_ptr<VehicleModelFactoryInterface> vehicleModelFactory,
                                                       shared_ptr<EdgeEstimator> estimator, MwmDataSource & dataSource,
-                                                      RoutingOptions routingOptions)
+                                                      RoutingOptions routingOptions,
+                                                      shared_ptr<IndexGraphDataCache> dataCache,
+                                                      shared_ptr<RoadGeometryCache> roadsCache)
 {
   return make_unique<IndexGraphLoaderImpl>(vehicleType, loadAltitudes, vehicleModelFactory, estimator, dataSource,
-                                           routingOptions);
+                                           routingOptions, std::move(dataCache), std::move(roadsCache));
 }
 
 void DeserializeIndexGraph(MwmValue const & mwmValue, VehicleType vehicleType, IndexGraph & graph)
@@ -9,7 +9,11 @@
 #include "routing_common/num_mwm_id.hpp"
 #include "routing_common/vehicle_model.hpp"
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 class MwmValue;
@@ -18,6 +22,26 @@ namespace routing
 {
 class MwmDataSource;
 
+/// Graph data shared by loaders of several routers, so every mwm graph is deserialized once
+/// for all of them. Routers must use the same NumMwmIds. It's thread-safe.
+class IndexGraphDataCache
+{
+public:
+  using DataPtrT = std::shared_ptr<IndexGraph::Data const>;
+
+  /// Returns the cached data or the data made by |load|, which is called without the lock.
+  DataPtrT GetOrLoad(VehicleType vehicleType, NumMwmId numMwmId, std::function<DataPtrT()> const & load);
+  void Clear();
+
+  /// Road geometry shared by the routers in the same way.
+  std::shared_ptr<RoadGeometryCache> const & GetRoadGeometryCache() const { return m_roadsCache; }
+
+private:
+  std::mutex m_mutex;
+  std::map<std::pair<VehicleType, NumMwmId>, DataPtrT> m_data;
+  std::shared_ptr<RoadGeometryCache> const m_roadsCache = std::make_shared<RoadGeometryCache>();
+};
+
 class IndexGraphLoader
 {
 public:
@@ -33,7 +57,9 @@ public:
   static std::unique_ptr<IndexGraphLoader> Create(VehicleType vehicleType, bool loadAltitudes,
                                                   std::shared_ptr<VehicleModelFactoryInterface> vehicleModelFactory,
                                                   std::shared_ptr<EdgeEstimator> estimator, MwmDataSource & dataSource,
-                                                  RoutingOptions routingOptions = RoutingOptions());
+                                                  RoutingOptions routingOptions = RoutingOptions(),
+                                                  std::shared_ptr<IndexGraphDataCache> dataCache = nullptr,
+                                                  std::shared_ptr<RoadGeometryCache> roadsCache = nullptr);
 };
 
 void DeserializeIndexGraph(MwmValue const & mwmValue, VehicleType vehicleType, IndexGraph & graph);
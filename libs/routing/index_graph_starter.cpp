@@ -9,6 +9,8 @@
 
 #include "geometry/distance_on_sphere.hpp"
 
+#include "base/scope_guard.hpp"
+
 #include <algorithm>
 #include <map>
 
@@ -53,6 +55,18 @@ IndexGraphStarter::IndexGraphStarter(FakeEnding const & startEnding, FakeEnding
   m_startToFinishDistanceM = ms::DistanceOnEarth(startPoint, finishPoint);
 }
 
+IndexGraphStarter::IndexGraphStarter(IndexGraphStarter const & starter, WorldGraph & graph)
+  : m_graph(graph)
+  , m_start(starter.m_start)
+  , m_finish(starter.m_finish)
+  , m_startToFinishDistanceM(starter.m_startToFinishDistanceM)
+  , m_fake(starter.m_fake)
+  , m_guides(starter.m_guides)
+  , m_fakeNumerationStart(starter.m_fakeNumerationStart)
+  , m_otherEndings(starter.m_otherEndings)
+  , m_regionsGraph(starter.m_regionsGraph)
+{}
+
 void IndexGraphStarter::Append(FakeEdgesContainer const & container)
 {
   m_finish = container.m_finish;
@@ -595,4 +609,26 @@ RouteWeight IndexGraphStarter::GetAStarWeightEpsilon()
   // mwms with different versions. So let's use such epsilon to maintain the A* invariant.
   return kEps + m_graph.HeuristicCostEstimate(ms::LatLon(0.0, 0.0), ms::LatLon(0.0, kMwmPointAccuracy));
 }
+
+optional<RouteWeight> CalcPathWeight(IndexGraphStarter & starter, vector<Segment> const & path)
+{
+  IndexGraphStarter::Parents<Segment> parents;
+  starter.SetAStarParents(true /* forward */, parents);
+  SCOPE_GUARD(dropParents, [&starter]() { starter.DropAStarParents(); });
+
+  RouteWeight weight = GetAStarWeightZero<RouteWeight>();
+  IndexGraphStarter::EdgeListT edges;
+  for (size_t i = 0; i + 1 < path.size(); ++i)
+  {
+    edges.clear();
+    starter.GetOutgoingEdgesList({path[i], weight}, edges);
+    auto const it = find_if(edges.cbegin(), edges.cend(),
+                            [&path, i](SegmentEdge const & edge) { return edge.GetTarget() == path[i + 1]; });
+    if (it == edges.cend() || !parents.emplace(path[i + 1], path[i]).second)
+      return {};
+
+    weight += it->GetWeight();
+  }
+  return weight;
+}
 }  // namespace routing
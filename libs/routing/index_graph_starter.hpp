@@ -16,6 +16,7 @@
 #include "routing_common/num_mwm_id.hpp"
 
 #include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -63,6 +64,9 @@ public:
   IndexGraphStarter(FakeEnding const & startEnding, FakeEnding const & finishEnding, uint32_t fakeNumerationStart,
                     bool strictForward, WorldGraph & graph);
 
+  /// Makes a copy of |starter| which works over |graph|, e.g. for a wave on another thread.
+  IndexGraphStarter(IndexGraphStarter const & starter, WorldGraph & graph);
+
   void Append(FakeEdgesContainer const & container);
 
   void SetGuides(GuidesGraph const & guides);
@@ -242,4 +246,8 @@ private:
   // Field for routing in mode for finding all route mwms.
   std::shared_ptr<RegionsSparseGraph> m_regionsGraph = nullptr;
 };
+
+/// \returns the weight of |path| if every segment of it is an outgoing edge of the previous one in
+/// |starter|, so the path is allowed by road access, restrictions and routing options.
+std::optional<RouteWeight> CalcPathWeight(IndexGraphStarter & starter, std::vector<Segment> const & path);
 }  // namespace routing
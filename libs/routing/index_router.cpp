@@ -3,6 +3,7 @@
 #include "routing/base/astar_progress.hpp"
 
 #include "routing/car_directions.hpp"
+#include "routing/contraction_hierarchy.hpp"
 #include "routing/fake_ending.hpp"
 #include "routing/index_graph.hpp"
 #include "routing/index_graph_loader.hpp"
@@ -31,8 +32,13 @@
 
 #include "indexer/data_source.hpp"
 
+#include "coding/files_container.hpp"
+#include "coding/point_coding.hpp"
+#include "coding/reader.hpp"
+
 #include "platform/settings.hpp"
 
+#include "geometry/convex_hull.hpp"
 #include "geometry/distance_on_sphere.hpp"
 #include "geometry/mercator.hpp"
 #include "geometry/parametrized_segment.hpp"
@@ -72,6 +78,16 @@ double constexpr kAdjustRangeM = 5000.0;
 double constexpr kMinDistanceToFinishM = 10000;
 // Near MWMs criteria when choosing routing mode.
 double constexpr kCloseMwmPointsDistanceM = 300000;
+// A wave of a matrix row goes up to this factor of the straight line estimate of the farthest target
+// plus the min weight (seconds). The targets which are not reached by then are routed one by one.
+double constexpr kMatrixWaveEstimateFactor = 5.0;
+double constexpr kMatrixWaveMinWeightS = 15 * 60;
+// A segment of a finish tree is an entry in both of its hash maps, which are at least about half full.
+size_t constexpr kFinishTreeSegmentBytes = 2 * (sizeof(pair<Segment, Segment>) + sizeof(pair<Segment, RouteWeight>));
+// The finish trees of all subroutes of a route are kept within this size, bigger backward waves are dropped.
+// See IndexRouter::SetKeepFinishTrees().
+size_t constexpr kMaxFinishTreesBytes = 8 * 1024 * 1024;
+size_t constexpr kMaxFinishTreeSize = kMaxFinishTreesBytes / kFinishTreeSegmentBytes;
 
 double CalcMaxSpeed(NumMwmIds const & numMwmIds, VehicleModelFactoryInterface const & vehicleModelFactory,
                     VehicleType vehicleType)
@@ -182,6 +198,70 @@ bool IsDeadEndCached(Segment const & segment, bool isOutgoing, bool useRoutingOp
 
   return false;
 }
+
+/// \returns the weight of the way from the beginning of |segment| to |origin| through |projection|
+/// on |segment|, the same way IndexGraphStarter weighs the fake segments of a finish.
+RouteWeight CalcWeightToEnding(WorldGraph & graph, Segment const & segment, Projection const & projection,
+                               LatLonWithAltitude const & origin, EdgeEstimator::Purpose purpose)
+{
+  auto const & back = graph.GetPoint(segment, false /* front */);
+  double const fullLen = ms::DistanceOnEarth(back, graph.GetPoint(segment, true /* front */));
+  double const partLen = ms::DistanceOnEarth(back, projection.m_junction.GetLatLon());
+  RouteWeight const weight = graph.CalcSegmentWeight(segment, purpose);
+  RouteWeight const partWeight = fullLen == 0.0 ? 0.0 * weight : (partLen / fullLen) * weight;
+  return partWeight + graph.CalcOffroadWeight(projection.m_junction.GetLatLon(), origin.GetLatLon(), purpose);
+}
+
+/// \brief Converts the parents of a backward wave in Joints mode to the next segments to the finish.
+/// The segments of the adjacent joints are linked the same way as ProcessJoints() does.
+template <typename JointParents>
+void ConvertJointsToSegments(IndexGraphStarterJoints<IndexGraphStarter> & jointStarter, JointParents const & parents,
+                             IndexGraphStarter::Parents<Segment> & next)
+{
+  struct JointEnds
+  {
+    Segment m_first;
+    optional<Segment> m_second;
+    Segment m_last;
+  };
+
+  ska::bytell_hash_map<JointSegment, JointEnds> ends;
+  auto const reconstruct = [&](JointSegment const & joint)
+  {
+    if (ends.count(joint) != 0)
+      return;
+
+    auto const path = jointStarter.ReconstructJoint(joint);
+    if (path.empty())
+      return;
+
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+      next.emplace(path[i], path[i + 1]);
+
+    ends.emplace(joint, JointEnds{path.front(), path.size() > 1 ? optional<Segment>(path[1]) : nullopt, path.back()});
+  };
+
+  for (auto const & [joint, parent] : parents)
+  {
+    reconstruct(joint);
+    reconstruct(parent);
+  }
+
+  for (auto const & [joint, parent] : parents)
+  {
+    auto const jointIt = ends.find(joint);
+    auto const parentIt = ends.find(parent);
+    if (jointIt == ends.cend() || parentIt == ends.cend())
+      continue;
+
+    auto const & last = jointIt->second.m_last;
+    auto const & parentEnds = parentIt->second;
+    if (parentEnds.m_first != last)
+      next.emplace(last, parentEnds.m_first);
+    else if (parentEnds.m_second)
+      next.emplace(last, *parentEnds.m_second);
+  }
+}
 }  // namespace
 
 // IndexRouter::BestEdgeComparator ----------------------------------------------------------------
@@ -238,6 +318,7 @@ IndexRouter::IndexRouter(VehicleType vehicleType, bool loadAltitudes,
   , m_loadAltitudes(loadAltitudes)
   , m_name("astar-bidirectional-" + ToString(m_vehicleType))
   , m_dataSource(dataSource, numMwmIds)
+  , m_backwardWaveDataSource(dataSource, numMwmIds)
   , m_vehicleModelFactory(CreateVehicleModelFactory(m_vehicleType, countryParentNameGetterFn))
   , m_countryFileFn(countryFileFn)
   , m_countryRectFn(countryRectFn)
@@ -252,6 +333,8 @@ IndexRouter::IndexRouter(VehicleType vehicleType, bool loadAltitudes,
   , m_estimator(EdgeEstimator::Create(m_vehicleType, CalcMaxSpeed(*m_numMwmIds, *m_vehicleModelFactory, m_vehicleType),
                                       CalcOffroadSpeed(*m_vehicleModelFactory), m_trafficStash, &dataSource,
                                       m_numMwmIds))
+  , m_roadGeometryCache(make_shared<RoadGeometryCache>())
+  , m_warmUpDataSource(dataSource)
   , m_directionsEngine(CreateDirectionsEngine(m_vehicleType, m_numMwmIds, m_dataSource))
   , m_countryParentNameGetterFn(countryParentNameGetterFn)
 {
@@ -262,6 +345,13 @@ IndexRouter::IndexRouter(VehicleType vehicleType, bool loadAltitudes,
   CHECK(m_directionsEngine, ());
 }
 
+IndexRouter::~IndexRouter()
+{
+  m_warmUpCancelled = true;
+  if (m_warmUpThread.joinable())
+    m_warmUpThread.join();
+}
+
 unique_ptr<WorldGraph> IndexRouter::MakeSingleMwmWorldGraph()
 {
   auto worldGraph = MakeWorldGraph();
@@ -269,11 +359,93 @@ unique_ptr<WorldGraph> IndexRouter::MakeSingleMwmWorldGraph()
   return worldGraph;
 }
 
+void IndexRouter::SetIndexGraphDataCache(shared_ptr<IndexGraphDataCache> dataCache)
+{
+  m_indexGraphDataCache = std::move(dataCache);
+  m_roadGeometryCache = m_indexGraphDataCache ? m_indexGraphDataCache->GetRoadGeometryCache()
+                                              : make_shared<RoadGeometryCache>();
+}
+
+void IndexRouter::SetCrossMwmWeightsLoadMode(connector::WeightsLoadMode mode)
+{
+  m_crossMwmWeightsLoadMode = mode;
+  if (mode != connector::WeightsLoadMode::Eager)
+    m_crossMwmConnectorCache.reset();
+  else if (!m_crossMwmConnectorCache)
+    m_crossMwmConnectorCache = make_shared<CrossMwmConnectorCache<base::GeoObjectId>>();
+}
+
+void IndexRouter::WarmUpCrossMwmConnectors(vector<string> const & countries)
+{
+  if (m_crossMwmWeightsLoadMode != connector::WeightsLoadMode::Eager)
+  {
+    LOG(LWARNING, ("Cross-mwm connectors are not kept in", m_crossMwmWeightsLoadMode, "mode."));
+    return;
+  }
+
+  m_warmUpCancelled = true;
+  if (m_warmUpThread.joinable())
+    m_warmUpThread.join();
+  m_warmUpCancelled = false;
+
+  // The numbers are taken here, the thread doesn't touch the members of the router but the cancel flag.
+  vector<pair<platform::CountryFile, NumMwmId>> mwms;
+  for (auto const & country : countries)
+  {
+    platform::CountryFile file(country);
+    if (m_numMwmIds->ContainsFile(file))
+    {
+      NumMwmId const numMwmId = m_numMwmIds->GetId(file);
+      mwms.emplace_back(std::move(file), numMwmId);
+    }
+  }
+
+  VehicleType const vehicleType = m_vehicleType == VehicleType::Transit ? VehicleType::Pedestrian : m_vehicleType;
+  m_warmUpThread = thread([&dataSource = m_warmUpDataSource, &cancelled = m_warmUpCancelled, mwms = std::move(mwms),
+                           vehicleType, cache = m_crossMwmConnectorCache]()
+  {
+    base::Timer timer;
+    size_t loadedCount = 0;
+    for (auto const & [file, numMwmId] : mwms)
+    {
+      if (cancelled)
+        break;
+
+      auto const handle = dataSource.GetMwmHandleByCountryFile(file);
+      if (!handle.IsAlive() || !handle.GetValue()->m_cont.IsExist(CROSS_MWM_FILE_TAG))
+        continue;
+
+      try
+      {
+        cache->GetOrLoad(vehicleType, numMwmId, handle);
+        ++loadedCount;
+      }
+      catch (RootException const & e)
+      {
+        LOG(LWARNING, ("Can't load cross-mwm connector of", file, ":", e.Msg()));
+      }
+    }
+
+    LOG(LINFO, ("Cross-mwm connectors of", loadedCount, "mwms are loaded in", timer.ElapsedSeconds(), "seconds."));
+  });
+}
+
 void IndexRouter::ClearState()
 {
   m_roadGraph.ClearState();
   m_directionsEngine->Clear();
   m_dataSource.FreeHandles();
+  m_backwardWaveDataSource.FreeHandles();
+}
+
+void IndexRouter::ClearCaches()
+{
+  // The shared cache is cleared by its owner.
+  if (!m_indexGraphDataCache)
+    m_roadGeometryCache->Clear();
+  m_contractionHierarchies.Clear();
+  if (m_crossMwmConnectorCache)
+    m_crossMwmConnectorCache->Clear();
 }
 
 bool IndexRouter::FindClosestProjectionToRoad(m2::PointD const & point, m2::PointD const & direction, double radius,
@@ -374,6 +546,356 @@ bool IndexRouter::GetBestOutgoingEdges(m2::PointD const & checkpoint, WorldGraph
                                 FeaturesRoadGraph::kClosestEdgesRadiusM, edges, dummy);
 }
 
+RouterResultCode IndexRouter::CalculateMatrix(vector<m2::PointD> const & sources, vector<m2::PointD> const & targets,
+                                              RouterDelegate const & delegate, Matrix & matrix)
+{
+  // The cells which are not calculated when the delegate is cancelled stay Cancelled.
+  MatrixCell cancelledCell;
+  cancelledCell.m_code = RouterResultCode::Cancelled;
+  matrix.assign(sources.size(), vector<MatrixCell>(targets.size(), cancelledCell));
+
+  // Pairs which are routed one by one after the waves.
+  vector<pair<size_t, size_t>> rest;
+  try
+  {
+    SCOPE_GUARD(featureRoadGraphClear, [this] { ClearState(); });
+
+    TrafficStash::Guard guard(m_trafficStash);
+    unique_ptr<WorldGraph> graph = MakeWorldGraph();
+    // Leaps are prepared for one finish, so the waves go segment by segment.
+    graph->SetMode(WorldGraphMode::NoLeaps);
+
+    PointsOnEdgesSnapping snapping(*this, *graph);
+    auto const snap = [&](vector<m2::PointD> const & points, bool isOutgoing, vector<RouterResultCode> & codes)
+    {
+      vector<optional<FakeEnding>> endings(points.size());
+      codes.assign(points.size(), RouterResultCode::NoError);
+      for (size_t i = 0; i < points.size(); ++i)
+      {
+        auto const country = platform::CountryFile(m_countryFileFn(points[i]));
+        vector<Segment> segments;
+        bool dummy = false;
+        if (!country.IsEmpty() && !m_dataSource.IsLoaded(country))
+          codes[i] = RouterResultCode::NeedMoreMaps;
+        else if (country.IsEmpty() ||
+                 !snapping.FindBestSegments(points[i], m2::PointD::Zero() /* direction */, isOutgoing, segments, dummy))
+          codes[i] = isOutgoing ? RouterResultCode::StartPointNotFound : RouterResultCode::EndPointNotFound;
+        else
+          endings[i] = MakeFakeEnding(segments, points[i], *graph);
+      }
+      return endings;
+    };
+
+    vector<RouterResultCode> sourceCodes;
+    vector<RouterResultCode> targetCodes;
+    auto const sourceEndings = snap(sources, true /* isOutgoing */, sourceCodes);
+    auto const targetEndings = snap(targets, false /* isOutgoing */, targetCodes);
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+      for (size_t j = 0; j < targets.size(); ++j)
+      {
+        if (sourceCodes[i] != RouterResultCode::NoError)
+          matrix[i][j].m_code = sourceCodes[i];
+        else if (targetCodes[j] != RouterResultCode::NoError)
+          matrix[i][j].m_code = targetCodes[j];
+      }
+    }
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+      if (!sourceEndings[i])
+        continue;
+
+      vector<size_t> rowRest;
+      if (CalculateMatrixRow(*sourceEndings[i], targetEndings, delegate, *graph, matrix[i], rowRest) ==
+          RouterResultCode::Cancelled)
+      {
+        return RouterResultCode::Cancelled;
+      }
+
+      for (auto const j : rowRest)
+        rest.emplace_back(i, j);
+    }
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't calculate", sources.size(), "x", targets.size(), "matrix:", e.what()));
+    return RouterResultCode::InternalError;
+  }
+
+  // The graph of the waves is destroyed here, so CalculateRoute() may free the mwm handles.
+  for (auto const & [i, j] : rest)
+  {
+    if (delegate.IsCancelled())
+      return RouterResultCode::Cancelled;
+
+    Route route("" /* router */, 0 /* routeId */);
+    auto & cell = matrix[i][j];
+    cell.m_code = CalculateRoute(Checkpoints(sources[i], targets[j]), m2::PointD::Zero() /* startDirection */,
+                                 false /* adjustToPrevRoute */, delegate, route);
+    if (cell.m_code == RouterResultCode::NoError)
+    {
+      cell.m_eta = route.GetTotalTimeSec();
+      cell.m_distance = route.GetTotalDistanceMeters();
+    }
+  }
+
+  return RouterResultCode::NoError;
+}
+
+RouterResultCode IndexRouter::CalculateMatrixRow(FakeEnding const & sourceEnding,
+                                                 vector<optional<FakeEnding>> const & targetEndings,
+                                                 RouterDelegate const & delegate, WorldGraph & graph,
+                                                 vector<MatrixCell> & row, vector<size_t> & rest)
+{
+  // The starter has no finish. A target is reached when the wave comes to a real segment the target
+  // is projected to, the rest of the way is weighed as the starter weighs the fake segments of a finish.
+  IndexGraphStarter starter(sourceEnding, FakeEnding() /* finishEnding */, 0 /* fakeNumerationStart */,
+                            false /* strictForward */, graph);
+
+  set<Segment> sourceSegments;
+  for (auto const & projection : sourceEnding.m_projections)
+  {
+    sourceSegments.insert(projection.m_segment);
+    sourceSegments.insert(projection.m_segment.GetReversed());
+  }
+
+  struct Arrival
+  {
+    size_t m_target;
+    Projection const * m_projection;
+  };
+
+  map<Segment, vector<Arrival>> arrivals;
+  for (size_t j = 0; j < targetEndings.size(); ++j)
+  {
+    if (!targetEndings[j])
+      continue;
+
+    auto const & projections = targetEndings[j]->m_projections;
+    // The wave doesn't go along the segments of the source, see IndexGraphStarter::AddEnding().
+    if (any_of(projections.cbegin(), projections.cend(),
+               [&sourceSegments](Projection const & p) { return sourceSegments.count(p.m_segment) != 0; }))
+    {
+      rest.push_back(j);
+      continue;
+    }
+
+    for (auto const & projection : projections)
+    {
+      arrivals[projection.m_segment].push_back({j, &projection});
+      if (!projection.m_isOneWay)
+        arrivals[projection.m_segment.GetReversed()].push_back({j, &projection});
+    }
+  }
+
+  struct Best
+  {
+    double m_weight = numeric_limits<double>::max();
+    Segment m_segment;
+    Projection const * m_projection = nullptr;
+  };
+
+  vector<Best> best(targetEndings.size());
+
+  // An unreachable target would make the wave cover all the maps, so the wave is bounded by the
+  // straight line estimate of the farthest target.
+  double maxEstimate = 0.0;
+  for (auto const & [segment, segmentArrivals] : arrivals)
+  {
+    for (auto const & arrival : segmentArrivals)
+    {
+      auto const & origin = targetEndings[arrival.m_target]->m_originJunction;
+      maxEstimate = max(maxEstimate, graph.HeuristicCostEstimate(sourceEnding.m_originJunction.GetLatLon(),
+                                                                 origin.GetLatLon())
+                                         .GetIntegratedWeight());
+    }
+  }
+  double const maxWeight = kMatrixWaveEstimateFactor * maxEstimate + kMatrixWaveMinWeightS;
+
+  using Algorithm = AStarAlgorithm<Segment, SegmentEdge, RouteWeight>;
+  Algorithm algorithm;
+  Algorithm::Context context(starter);
+  uint32_t visitCount = 0;
+  bool cancelled = false;
+  bool bounded = false;
+  algorithm.PropagateWave(starter, starter.GetStartSegment(), [&](Segment const & segment)
+  {
+    if (++visitCount % kVisitPeriod == 0 && delegate.IsCancelled())
+    {
+      cancelled = true;
+      return false;
+    }
+
+    if (context.GetDistance(segment).GetIntegratedWeight() > maxWeight)
+    {
+      bounded = true;
+      return false;
+    }
+
+    auto const it = arrivals.find(segment);
+    if (it == arrivals.end())
+      return true;
+
+    // Weight of the way to the beginning of |segment|.
+    double const weight = context.GetDistance(segment).GetIntegratedWeight() -
+                          starter.CalcSegmentWeight(segment, EdgeEstimator::Purpose::Weight).GetIntegratedWeight();
+    for (auto const & arrival : it->second)
+    {
+      auto const & origin = targetEndings[arrival.m_target]->m_originJunction;
+      double const arrivalWeight =
+          weight + CalcWeightToEnding(graph, segment, *arrival.m_projection, origin, EdgeEstimator::Purpose::Weight)
+                       .GetIntegratedWeight();
+      auto & targetBest = best[arrival.m_target];
+      if (arrivalWeight < targetBest.m_weight)
+        targetBest = {arrivalWeight, segment, arrival.m_projection};
+    }
+
+    arrivals.erase(it);
+    return !arrivals.empty();
+  }, context);
+
+  if (cancelled)
+    return RouterResultCode::Cancelled;
+
+  // The targets which are out of the bound are routed one by one, an unreachable target is found
+  // by the bidirectional search faster.
+  vector<bool> isRest(targetEndings.size(), false);
+  for (auto const j : rest)
+    isRest[j] = true;
+
+  vector<Segment> path;
+  for (size_t j = 0; j < targetEndings.size(); ++j)
+  {
+    if (!targetEndings[j] || isRest[j])
+      continue;
+
+    auto const & [weight, segment, projection] = best[j];
+    if (!projection)
+    {
+      if (bounded)
+        rest.push_back(j);
+      else
+        row[j].m_code = RouterResultCode::RouteNotFound;
+      continue;
+    }
+
+    context.ReconstructPath(segment, path);
+    CHECK_GREATER(path.size(), 1, ());
+    // The route goes through the fake part of the last segment.
+    path.pop_back();
+
+    auto & cell = row[j];
+    cell.m_code = RouterResultCode::NoError;
+    cell.m_eta = starter.CalculateETAWithoutPenalty(path.front());
+    cell.m_distance = 0.0;
+    for (size_t k = 0; k < path.size(); ++k)
+    {
+      if (k != 0)
+        cell.m_eta += starter.CalculateETA(path[k - 1], path[k]);
+      cell.m_distance += ms::DistanceOnEarth(starter.GetPoint(path[k], false /* front */),
+                                             starter.GetPoint(path[k], true /* front */));
+    }
+
+    // The turn to the last segment is penalized the same way as the turns to the other ones.
+    cell.m_eta += starter.CalculateETA(path.back(), segment) - starter.CalculateETAWithoutPenalty(segment);
+    auto const & origin = targetEndings[j]->m_originJunction;
+    cell.m_eta += CalcWeightToEnding(graph, segment, *projection, origin, EdgeEstimator::Purpose::ETA).GetWeight();
+    auto const & junction = projection->m_junction.GetLatLon();
+    cell.m_distance += ms::DistanceOnEarth(graph.GetPoint(segment, false /* front */), junction) +
+                       ms::DistanceOnEarth(junction, origin.GetLatLon());
+  }
+
+  return RouterResultCode::NoError;
+}
+
+RouterResultCode IndexRouter::CalculateIsochrone(m2::PointD const & start, double maxTimeSec, bool buildHull,
+                                                 RouterDelegate const & delegate, Isochrone & isochrone)
+{
+  CHECK_GREATER_OR_EQUAL(maxTimeSec, 0.0, ());
+  isochrone = {};
+
+  auto const country = platform::CountryFile(m_countryFileFn(start));
+  if (country.IsEmpty())
+    return RouterResultCode::StartPointNotFound;
+  if (!m_dataSource.IsLoaded(country))
+    return RouterResultCode::NeedMoreMaps;
+
+  try
+  {
+    SCOPE_GUARD(featureRoadGraphClear, [this] { ClearState(); });
+
+    TrafficStash::Guard guard(m_trafficStash);
+    unique_ptr<WorldGraph> graph = MakeWorldGraph();
+    // There is no finish to build leaps to, the wave crosses the mwm borders through the transitions.
+    graph->SetMode(WorldGraphMode::NoLeaps);
+
+    vector<Segment> segments;
+    bool dummy = false;
+    PointsOnEdgesSnapping snapping(*this, *graph);
+    if (!snapping.FindBestSegments(start, m2::PointD::Zero() /* direction */, true /* isOutgoing */, segments, dummy))
+      return RouterResultCode::StartPointNotFound;
+
+    IndexGraphStarter starter(MakeFakeEnding(segments, start, *graph), FakeEnding() /* finishEnding */,
+                              0 /* fakeNumerationStart */, false /* strictForward */, *graph);
+
+    using Algorithm = AStarAlgorithm<Segment, SegmentEdge, RouteWeight>;
+    Algorithm algorithm;
+    Algorithm::Context context(starter);
+    // The wave goes in the order of ETA rather than of the route weight, so it's cut by the same metric
+    // the segments are reported with. Distances of the wave are ETAs from the end of the start segment.
+    auto const & startSegment = starter.GetStartSegment();
+    double const startEta = starter.CalculateETAWithoutPenalty(startSegment);
+    auto const adjustEdgeWeight = [&starter](Segment const & from, SegmentEdge const & edge)
+    { return RouteWeight(starter.CalculateETA(from, edge.GetTarget())); };
+    // The states beyond the limit are not queued, the wave stops when the queue is empty.
+    auto const filterStates = [&](auto const & state) { return startEta + state.distance.GetWeight() <= maxTimeSec; };
+    auto const reducedToRealLength = [](auto const & state) { return state.distance; };
+
+    uint32_t visitCount = 0;
+    bool cancelled = false;
+    algorithm.PropagateWave(starter, startSegment, [&](Segment const & segment)
+    {
+      if (++visitCount % kVisitPeriod == 0 && delegate.IsCancelled())
+      {
+        cancelled = true;
+        return false;
+      }
+
+      if (!starter.IsFakeSegment(segment))
+      {
+        double const eta = startEta + context.GetDistance(segment).GetWeight();
+        isochrone.m_segments.push_back({segment, starter.GetPoint(segment, true /* front */), eta});
+      }
+      return true;
+    }, adjustEdgeWeight, filterStates, reducedToRealLength, context);
+
+    if (cancelled)
+      return RouterResultCode::Cancelled;
+
+    if (buildHull)
+    {
+      vector<m2::PointD> points;
+      points.reserve(isochrone.m_segments.size() * 2 + 1);
+      points.push_back(start);
+      for (auto const & reached : isochrone.m_segments)
+      {
+        points.push_back(mercator::FromLatLon(starter.GetPoint(reached.m_segment, false /* front */)));
+        points.push_back(mercator::FromLatLon(reached.m_point));
+      }
+      isochrone.m_hull = m2::ConvexHull(points, kMwmPointAccuracy).Points();
+    }
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't calculate isochrone from", mercator::ToLatLon(start), "for", maxTimeSec, "seconds:", e.what()));
+    return RouterResultCode::InternalError;
+  }
+
+  return RouterResultCode::NoError;
+}
+
 void IndexRouter::AppendPartsOfReal(LatLonWithAltitude const & point1, LatLonWithAltitude const & point2,
                                     uint32_t & startIdx, ConnectionToOsm & link)
 {
@@ -492,6 +1014,7 @@ RouterResultCode IndexRouter::DoCalculateRoute(Checkpoints const & checkpoints,
                                                RouterDelegate const & delegate, Route & route)
 {
   m_lastRoute.reset();
+  DropFinishTrees();
   // MwmId used for guides segments in RedressRoute().
   NumMwmId guidesMwmId = kFakeNumMwmId;
 
@@ -541,6 +1064,8 @@ RouterResultCode IndexRouter::DoCalculateRoute(Checkpoints const & checkpoints,
 
   PointsOnEdgesSnapping snapping(*this, *graph);
   size_t const subroutesCount = checkpoints.GetNumSubroutes();
+  vector<FinishTree> finishTrees(m_keepFinishTrees ? subroutesCount : 0);
+  size_t finishTreesSize = 0;
   for (size_t i = checkpoints.GetPassedIdx(); i < subroutesCount; ++i)
   {
     auto const & startCheckpoint = checkpoints.GetPoint(i);
@@ -594,6 +1119,11 @@ RouterResultCode IndexRouter::DoCalculateRoute(Checkpoints const & checkpoints,
       return result;
 
     IndexGraphStarter::CheckValidRoute(subroute);
+    if (m_keepFinishTrees)
+    {
+      finishTrees[i] = MakeFinishTree(subrouteStarter, subroute, kMaxFinishTreeSize - finishTreesSize);
+      finishTreesSize += finishTrees[i].m_next.size();
+    }
 
     segments.insert(segments.end(), subroute.begin(), subroute.end());
 
@@ -633,10 +1163,40 @@ RouterResultCode IndexRouter::DoCalculateRoute(Checkpoints const & checkpoints,
     m_lastRoute->AddStep(segment, mercator::FromLatLon(starter->GetPoint(segment, true /* front */)));
 
   m_lastFakeEdges = make_unique<FakeEdgesContainer>(std::move(*starter));
+  m_lastFinishTrees = std::move(finishTrees);
+  if (m_trafficStash)
+    m_lastFinishTreesTraffic = m_trafficStash->GetTraffic();
 
   return RouterResultCode::NoError;
 }
 
+void IndexRouter::DropFinishTrees()
+{
+  m_lastFinishTrees.clear();
+  m_lastFinishTreesTraffic.clear();
+}
+
+IndexRouter::FinishTree IndexRouter::MakeFinishTree(IndexGraphStarter & starter, vector<Segment> const & subroute,
+                                                    size_t maxSize)
+{
+  FinishTree tree;
+  tree.m_next.swap(m_subrouteFinishTree);
+  m_subrouteFinishTree.clear();
+  if (tree.m_next.empty() || subroute.empty())
+    return {};
+
+  // The wave doesn't have the part of the subroute before the meeting of the waves. The subroute
+  // goes first where they differ.
+  for (size_t i = 0; i + 1 < subroute.size(); ++i)
+    tree.m_next.insert_or_assign(subroute[i], subroute[i + 1]);
+
+  if (tree.m_next.size() > maxSize)
+    return {};
+
+  AStarAlgorithm<Segment, SegmentEdge, RouteWeight>::CalcFinishTreeDistances(starter, subroute.back(), tree);
+  return tree;
+}
+
 vector<Segment> ProcessJoints(vector<JointSegment> const & jointsPath,
                               IndexGraphStarterJoints<IndexGraphStarter> & jointStarter)
 {
@@ -670,6 +1230,7 @@ RouterResultCode IndexRouter::CalculateSubroute(Checkpoints const & checkpoints,
                                                 vector<Segment> & subroute, bool guidesActive /* = false */)
 {
   subroute.clear();
+  m_subrouteFinishTree.clear();
 
   SetupAlgorithmMode(starter, guidesActive);
 
@@ -677,6 +1238,12 @@ RouterResultCode IndexRouter::CalculateSubroute(Checkpoints const & checkpoints,
   LOG(LINFO, ("Routing in mode:", mode));
 
   base::ScopedTimerWithLog timer("Route build");
+  if (mode == WorldGraphMode::Joints && m_vehicleType == VehicleType::Car && !guidesActive &&
+      CalculateSubrouteContractionMode(starter, subroute))
+  {
+    return RouterResultCode::NoError;
+  }
+
   switch (mode)
   {
   case WorldGraphMode::Joints: return CalculateSubrouteJointsMode(starter, delegate, progress, subroute);
@@ -706,14 +1273,43 @@ RouterResultCode IndexRouter::CalculateSubrouteJointsMode(IndexGraphStarter & st
       jointStarter, jointStarter.GetStartJoint(), jointStarter.GetFinishJoint(), delegate.GetCancellable(),
       std::move(visitor), AStarLengthChecker(starter));
 
+  JointsStarter::Parents backwardParents;
+  bool const keepFinishTree = m_keepFinishTrees && !starter.IsRegionsGraphMode();
+  if (keepFinishTree)
+    params.m_backwardParents = &backwardParents;
+
   RoutingResult<Vertex, Weight> routingResult;
-  RouterResultCode const result = FindPath<Vertex, Edge, Weight>(params, {} /* mwmIds */, routingResult);
+  RouterResultCode result = RouterResultCode::NoError;
+  // The regions graph is shared by the copies of the starter, so it goes on one thread.
+  if (m_parallelWaves && m_vehicleType != VehicleType::Transit && !starter.IsRegionsGraphMode())
+  {
+    // The backward wave gets its own copies of the graphs, the caches of which aren't thread safe.
+    // All fake joints are created on the starter initialization, so both copies have the same vertices.
+    unique_ptr<WorldGraph> backwardGraph = MakeWorldGraph(m_backwardWaveDataSource);
+    backwardGraph->SetMode(starter.GetMode());
+    IndexGraphStarter backwardStarter(starter, *backwardGraph);
+    JointsStarter backwardJointStarter(backwardStarter, backwardStarter.GetStartSegment(),
+                                       backwardStarter.GetFinishSegment());
+
+    AStarAlgorithm<Vertex, Edge, Weight>::Params<Visitor, AStarLengthChecker> backwardParams(
+        backwardJointStarter, backwardJointStarter.GetStartJoint(), backwardJointStarter.GetFinishJoint(),
+        delegate.GetCancellable(), Visitor(backwardJointStarter, delegate, kVisitPeriod, progress),
+        AStarLengthChecker(backwardStarter));
+
+    result = FindPathParallel<Vertex, Edge, Weight>(params, backwardParams, routingResult);
+  }
+  else
+  {
+    result = FindPath<Vertex, Edge, Weight>(params, {} /* mwmIds */, routingResult);
+  }
 
   if (result != RouterResultCode::NoError)
     return result;
 
   LOG(LDEBUG, ("Result route weight:", routingResult.m_distance));
   subroute = ProcessJoints(routingResult.m_path, jointStarter);
+  if (keepFinishTree && backwardParents.size() <= kMaxFinishTreeSize)
+    ConvertJointsToSegments(jointStarter, backwardParents, m_subrouteFinishTree);
   return result;
 }
 
@@ -731,6 +1327,8 @@ RouterResultCode IndexRouter::CalculateSubrouteNoLeapsMode(IndexGraphStarter & s
   AStarAlgorithm<Vertex, Edge, Weight>::Params<Visitor, AStarLengthChecker> params(
       starter, starter.GetStartSegment(), starter.GetFinishSegment(), delegate.GetCancellable(), std::move(visitor),
       AStarLengthChecker(starter));
+  if (m_keepFinishTrees && !starter.IsRegionsGraphMode())
+    params.m_backwardParents = &m_subrouteFinishTree;
 
   RoutingResult<Vertex, Weight> routingResult;
   set<NumMwmId> const mwmIds = starter.GetMwms();
@@ -744,6 +1342,55 @@ RouterResultCode IndexRouter::CalculateSubrouteNoLeapsMode(IndexGraphStarter & s
   return result;
 }
 
+bool IndexRouter::CalculateSubrouteContractionMode(IndexGraphStarter & starter, vector<Segment> & subroute)
+{
+  // The hierarchy is built for one mwm without traffic, restrictions on the road types and other
+  // per-route conditions, see generator/contraction_hierarchy_generator.cpp.
+  auto const mwmIds = starter.GetMwms();
+  if (mwmIds.size() != 1 || starter.IsRegionsGraphMode())
+    return false;
+
+  NumMwmId const mwmId = *mwmIds.begin();
+  if ((m_trafficStash && m_trafficStash->Has(mwmId)) || RoutingOptions::LoadCarOptionsFromSettings().GetOptions() != 0)
+    return false;
+
+  auto const ch = GetContractionHierarchy(mwmId);
+  return ch && FindContractionHierarchyRoute(*ch, mwmId, starter, subroute);
+}
+
+shared_ptr<ContractionHierarchy const> IndexRouter::GetContractionHierarchy(NumMwmId numMwmId)
+{
+  auto const mwmId = m_dataSource.GetMwmId(numMwmId);
+  bool found = false;
+  auto & cached = m_contractionHierarchies.Find(numMwmId, found);
+  if (found && cached.first == mwmId)
+    return cached.second;
+
+  shared_ptr<ContractionHierarchy> ch;
+  if (m_dataSource.GetSectionStatus(numMwmId, CONTRACTION_HIERARCHY_FILE_TAG) == MwmDataSource::SectionExists)
+  {
+    base::Timer timer;
+    ch = make_shared<ContractionHierarchy>();
+    try
+    {
+      FilesContainerR::TReader reader(m_dataSource.GetMwmValue(numMwmId).m_cont.GetReader(
+          CONTRACTION_HIERARCHY_FILE_TAG));
+      ReaderSource<FilesContainerR::TReader> src(reader);
+      ch->Deserialize(src);
+      LOG(LINFO, (CONTRACTION_HIERARCHY_FILE_TAG, "section for", m_numMwmIds->GetFile(numMwmId), "loaded in",
+                  timer.ElapsedSeconds(), "seconds"));
+    }
+    catch (Reader::Exception const & e)
+    {
+      LOG(LERROR, ("Error while reading", CONTRACTION_HIERARCHY_FILE_TAG, "section:", e.Msg()));
+      ch.reset();
+    }
+  }
+
+  cached = {mwmId, ch};
+  return ch;
+}
+
 namespace
 {
 void CollapseForward_ReverseLoops(std::vector<Segment> & path)
@@ -1018,8 +1665,33 @@ RouterResultCode IndexRouter::AdjustRoute(Checkpoints const & checkpoints, m2::P
       starter, starter.GetStartSegment(), {} /* finalVertex */, delegate.GetCancellable(), std::move(visitor),
       AdjustLengthChecker(starter));
 
+  // The finish tree of the previous route lets the route join any road reached by its backward wave.
+  FinishTree const * finishTree = nullptr;
+  size_t const subrouteIdx = checkpoints.GetPassedIdx();
+  if (subrouteIdx < m_lastFinishTrees.size() && !m_lastFinishTrees[subrouteIdx].m_distances.empty())
+  {
+    if (m_trafficStash && m_trafficStash->GetTraffic() != m_lastFinishTreesTraffic)
+    {
+      LOG(LINFO, ("Traffic is changed, finish trees of the previous route are dropped."));
+      DropFinishTrees();
+    }
+    else
+    {
+      finishTree = &m_lastFinishTrees[subrouteIdx];
+    }
+  }
+
   RoutingResult<Segment, RouteWeight> result;
-  auto const resultCode = ConvertResult<Vertex, Edge, Weight>(algorithm.AdjustRoute(params, prevEdges, result));
+  auto resultCode = ConvertResult<Vertex, Edge, Weight>(finishTree ? algorithm.AdjustRoute(params, *finishTree, result)
+                                                                   : algorithm.AdjustRoute(params, prevEdges, result));
+  if (finishTree && resultCode == RouterResultCode::NoError && !CalcPathWeight(starter, result.m_path))
+  {
+    // Road access or restrictions are changed since the previous route.
+    LOG(LINFO, ("Finish trees of the previous route lead to a forbidden road, they are dropped."));
+    DropFinishTrees();
+    resultCode = ConvertResult<Vertex, Edge, Weight>(algorithm.AdjustRoute(params, prevEdges, result));
+  }
+
   if (resultCode != RouterResultCode::NoError)
     return resultCode;
 
@@ -1061,6 +1733,11 @@ RouterResultCode IndexRouter::AdjustRoute(Checkpoints const & checkpoints, m2::P
 }
 
 unique_ptr<WorldGraph> IndexRouter::MakeWorldGraph()
+{
+  return MakeWorldGraph(m_dataSource);
+}
+
+unique_ptr<WorldGraph> IndexRouter::MakeWorldGraph(MwmDataSource & dataSource)
 {
   // Use saved routing options for all types (car, bicycle, pedestrian).
   RoutingOptions const routingOptions = RoutingOptions::LoadCarOptionsFromSettings();
@@ -1071,11 +1748,12 @@ unique_ptr<WorldGraph> IndexRouter::MakeWorldGraph()
 
   auto crossMwmGraph = make_unique<CrossMwmGraph>(
       m_numMwmIds, m_numMwmTree, m_vehicleType == VehicleType::Transit ? VehicleType::Pedestrian : m_vehicleType,
-      m_countryRectFn, m_dataSource);
+      m_countryRectFn, dataSource, m_crossMwmWeightsLoadMode, m_crossMwmConnectorCache);
 
   auto indexGraphLoader =
       IndexGraphLoader::Create(m_vehicleType == VehicleType::Transit ? VehicleType::Pedestrian : m_vehicleType,
-                               m_loadAltitudes, m_vehicleModelFactory, m_estimator, m_dataSource, routingOptions);
+                               m_loadAltitudes, m_vehicleModelFactory, m_estimator, dataSource, routingOptions,
+                               m_indexGraphDataCache, m_roadGeometryCache);
 
   if (m_vehicleType != VehicleType::Transit)
   {
@@ -1086,7 +1764,7 @@ unique_ptr<WorldGraph> IndexRouter::MakeWorldGraph()
     return graph;
   }
 
-  auto transitGraphLoader = TransitGraphLoader::Create(m_dataSource, m_estimator);
+  auto transitGraphLoader = TransitGraphLoader::Create(dataSource, m_estimator);
   return make_unique<TransitWorldGraph>(std::move(crossMwmGraph), std::move(indexGraphLoader),
                                         std::move(transitGraphLoader), m_estimator);
 }
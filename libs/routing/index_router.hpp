@@ -4,6 +4,7 @@
 #include "routing/base/astar_progress.hpp"
 #include "routing/base/routing_result.hpp"
 
+#include "routing/cross_mwm_connector.hpp"
 #include "routing/data_source.hpp"
 #include "routing/directions_engine.hpp"
 #include "routing/edge_estimator.hpp"
@@ -16,19 +17,29 @@
 #include "routing/routing_callbacks.hpp"
 #include "routing/segment.hpp"
 #include "routing/segmented_route.hpp"
+#include "routing/traffic_stash.hpp"
 
 #include "routing_common/num_mwm_id.hpp"
 #include "routing_common/vehicle_model.hpp"
 
 #include "platform/country_file.hpp"
 
+#include "geometry/latlon.hpp"
 #include "geometry/point2d.hpp"
 #include "geometry/tree4d.hpp"
 
+#include "base/geo_object_id.hpp"
+#include "base/lru_cache.hpp"
+
+#include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace traffic
@@ -38,7 +49,12 @@ class TrafficCache;
 
 namespace routing
 {
+class ContractionHierarchy;
+template <typename CrossMwmId>
+class CrossMwmConnectorCache;
 class IndexGraph;
+class IndexGraphDataCache;
+class RoadGeometryCache;
 class IndexGraphStarter;
 
 class IndexRouter : public IRouter
@@ -68,16 +84,47 @@ public:
     m2::PointD const m_direction;
   };
 
+  struct MatrixCell
+  {
+    RouterResultCode m_code = RouterResultCode::RouteNotFound;
+    // Seconds.
+    double m_eta = 0.0;
+    // Meters.
+    double m_distance = 0.0;
+  };
+
+  // |matrix[i][j]| is the route from the i-th source to the j-th target.
+  using Matrix = std::vector<std::vector<MatrixCell>>;
+
+  struct ReachedSegment
+  {
+    Segment m_segment;
+    // End of |m_segment|.
+    ms::LatLon m_point;
+    // Seconds from the start to the end of |m_segment|.
+    double m_eta = 0.0;
+  };
+
+  struct Isochrone
+  {
+    // Real segments reached within the time limit in the order of reaching.
+    std::vector<ReachedSegment> m_segments;
+    // Mercator convex hull of |m_segments| if it's requested.
+    std::vector<m2::PointD> m_hull;
+  };
+
   IndexRouter(VehicleType vehicleType, bool loadAltitudes, CountryParentNameGetterFn const & countryParentNameGetterFn,
               TCountryFileFn const & countryFileFn, CountryRectFn const & countryRectFn,
               std::shared_ptr<NumMwmIds> numMwmIds, std::unique_ptr<m4::Tree<NumMwmId>> numMwmTree,
               traffic::TrafficCache const & trafficCache, DataSource & dataSource);
+  ~IndexRouter() override;
 
   std::unique_ptr<WorldGraph> MakeSingleMwmWorldGraph();
 
   // IRouter overrides:
   std::string GetName() const override { return m_name; }
   void ClearState() override;
+  void ClearCaches() override;
 
   void SetGuides(GuidesTracks && guides) override;
   RouterResultCode CalculateRoute(Checkpoints const & checkpoints, m2::PointD const & startDirection,
@@ -88,9 +135,52 @@ public:
 
   bool GetBestOutgoingEdges(m2::PointD const & checkpoint, WorldGraph & graph, std::vector<Edge> & edges);
 
+  /// \brief Calculates the routes from each of |sources| to each of |targets|. One wave is propagated
+  /// from every source to all the targets, the graph and the snapping of the points to the roads are
+  /// shared by all the pairs.
+  /// \returns NoError if the matrix is calculated, results of the routes are in its cells, or
+  /// Cancelled or InternalError if it's not. The cells which are not calculated because of
+  /// cancellation are Cancelled.
+  RouterResultCode CalculateMatrix(std::vector<m2::PointD> const & sources, std::vector<m2::PointD> const & targets,
+                                   RouterDelegate const & delegate, Matrix & matrix);
+
+  /// \brief Finds the roads which are reachable from |start| within |maxTimeSec| seconds. The wave goes
+  /// segment by segment across the mwm borders in the order of ETA, not of the route weight, and stops
+  /// at |maxTimeSec|. Every segment gets to |isochrone| with its ETA along the fastest way to it.
+  /// \returns NoError, StartPointNotFound, NeedMoreMaps, Cancelled or InternalError.
+  RouterResultCode CalculateIsochrone(m2::PointD const & start, double maxTimeSec, bool buildHull,
+                                      RouterDelegate const & delegate, Isochrone & isochrone);
+
   VehicleType GetVehicleType() const { return m_vehicleType; }
 
+  /// Makes the router take graphs and road geometry from |dataCache| shared with routers of other threads
+  /// instead of deserializing its own ones.
+  void SetIndexGraphDataCache(std::shared_ptr<IndexGraphDataCache> dataCache);
+
+  /// Makes the router propagate the forward and the backward waves of the routes in Joints mode on
+  /// two threads. The backward wave gets its own graph, so the graph sections are deserialized twice
+  /// unless the graph data cache is set. Road geometry is shared by the waves anyway.
+  void SetParallelWaves(bool parallelWaves) { m_parallelWaves = parallelWaves; }
+
+  /// Sets how the weights of cross-mwm connectors are read. In WeightsLoadMode::Eager the connectors
+  /// are kept between the routes, so the weights of every mwm are read once.
+  void SetCrossMwmWeightsLoadMode(connector::WeightsLoadMode mode);
+
+  /// Loads cross-mwm connectors of |countries| on a background thread, so the first long route
+  /// through them doesn't wait for it. It works in WeightsLoadMode::Eager only.
+  /// Should be called on the thread of the routes, as the other setters.
+  void WarmUpCrossMwmConnectors(std::vector<std::string> const & countries);
+
+  /// Makes the router keep the backward waves of the routes, so a route which is adjusted to the previous
+  /// one (see CalculateRoute()) may join any road reached by the wave, not only the previous route.
+  /// The waves of a route are kept within a few megabytes, bigger ones are dropped. They are dropped too
+  /// when traffic changes or they lead to a forbidden road. It's off by default.
+  void SetKeepFinishTrees(bool keepFinishTrees) { m_keepFinishTrees = keepFinishTrees; }
+
 private:
+  using SegmentParents = AStarGraph<Segment, SegmentEdge, RouteWeight>::Parents;
+  using FinishTree = AStarAlgorithm<Segment, SegmentEdge, RouteWeight>::FinishTree;
+
   RouterResultCode CalculateSubrouteJointsMode(IndexGraphStarter & starter, RouterDelegate const & delegate,
                                                std::shared_ptr<AStarProgress> const & progress,
                                                std::vector<Segment> & subroute);
@@ -101,9 +191,22 @@ private:
                                                   IndexGraphStarter & starter, RouterDelegate const & delegate,
                                                   std::shared_ptr<AStarProgress> const & progress,
                                                   std::vector<Segment> & subroute);
+  /// \brief Finds |subroute| with the contraction hierarchy of the only mwm of |starter|.
+  /// \returns false if the hierarchy can't be used for the subroute or the real graph doesn't confirm
+  /// the found path. A* should be used then.
+  bool CalculateSubrouteContractionMode(IndexGraphStarter & starter, std::vector<Segment> & subroute);
+  /// \returns nullptr if the mwm has no contraction hierarchy section.
+  std::shared_ptr<ContractionHierarchy const> GetContractionHierarchy(NumMwmId numMwmId);
 
   RouterResultCode DoCalculateRoute(Checkpoints const & checkpoints, m2::PointD const & startDirection,
                                     RouterDelegate const & delegate, Route & route);
+  /// \brief Fills |row| with the routes from |sourceEnding| to |targetEndings| with one wave.
+  /// The targets which the wave can't reach properly (a target is on a segment of the source) and
+  /// the targets which are out of the bound of the wave are added to |rest| to be routed one by one.
+  RouterResultCode CalculateMatrixRow(FakeEnding const & sourceEnding,
+                                      std::vector<std::optional<FakeEnding>> const & targetEndings,
+                                      RouterDelegate const & delegate, WorldGraph & graph,
+                                      std::vector<MatrixCell> & row, std::vector<size_t> & rest);
   RouterResultCode CalculateSubroute(Checkpoints const & checkpoints, size_t subrouteIdx,
                                      RouterDelegate const & delegate, std::shared_ptr<AStarProgress> const & progress,
                                      IndexGraphStarter & graph, std::vector<Segment> & subroute,
@@ -111,8 +214,14 @@ private:
 
   RouterResultCode AdjustRoute(Checkpoints const & checkpoints, m2::PointD const & startDirection,
                                RouterDelegate const & delegate, Route & route);
+  /// \returns the finish tree of |subroute| made of the backward wave in |m_subrouteFinishTree| and
+  /// the subroute itself, or an empty tree if the wave is not kept or the tree has more than |maxSize| segments.
+  FinishTree MakeFinishTree(IndexGraphStarter & starter, std::vector<Segment> const & subroute, size_t maxSize);
+  /// Drops the finish trees of the previous route and the traffic they are calculated with.
+  void DropFinishTrees();
 
   std::unique_ptr<WorldGraph> MakeWorldGraph();
+  std::unique_ptr<WorldGraph> MakeWorldGraph(MwmDataSource & dataSource);
 
   using EdgeProjectionT = IRoadGraph::EdgeProjectionT;
   class PointsOnEdgesSnapping
@@ -247,6 +356,15 @@ private:
         mwmIds, ConvertResult<Vertex, Edge, Weight>(algorithm.FindPathBidirectional(params, routingResult)));
   }
 
+  template <typename Vertex, typename Edge, typename Weight, typename AStarParams>
+  RouterResultCode FindPathParallel(AStarParams & forwardParams, AStarParams & backwardParams,
+                                    RoutingResult<Vertex, Weight> & routingResult)
+  {
+    AStarAlgorithm<Vertex, Edge, Weight> algorithm;
+    return ConvertResult<Vertex, Edge, Weight>(
+        algorithm.FindPathBidirectionalParallel(forwardParams, backwardParams, routingResult));
+  }
+
   void SetupAlgorithmMode(IndexGraphStarter & starter, bool guidesActive = false) const;
   uint32_t ConnectTracksOnGuidesToOsm(std::vector<m2::PointD> const & checkpoints, WorldGraph & graph);
 
@@ -264,6 +382,8 @@ private:
   bool m_loadAltitudes;
   std::string const m_name;
   MwmDataSource m_dataSource;
+  // Handles of the backward wave graph in the parallel waves mode, MwmDataSource isn't thread safe.
+  MwmDataSource m_backwardWaveDataSource;
   std::shared_ptr<VehicleModelFactoryInterface> m_vehicleModelFactory;
 
   TCountryFileFn const m_countryFileFn;
@@ -274,9 +394,31 @@ private:
   FeaturesRoadGraphBase m_roadGraph;
 
   std::shared_ptr<EdgeEstimator> m_estimator;
+  std::shared_ptr<IndexGraphDataCache> m_indexGraphDataCache;
+  // Road geometry of all mwms and graphs of the router, it's taken from |m_indexGraphDataCache| if it's set.
+  std::shared_ptr<RoadGeometryCache> m_roadGeometryCache;
+  bool m_parallelWaves = false;
+  connector::WeightsLoadMode m_crossMwmWeightsLoadMode = connector::WeightsLoadMode::Lazy;
+  // Connectors of WeightsLoadMode::Eager, they are kept between the routes and cleared by ClearCaches().
+  std::shared_ptr<CrossMwmConnectorCache<base::GeoObjectId>> m_crossMwmConnectorCache;
+  // Mwms of the warm-up thread, MwmDataSource isn't thread safe, DataSource is.
+  DataSource & m_warmUpDataSource;
+  std::thread m_warmUpThread;
+  std::atomic<bool> m_warmUpCancelled = false;
   std::unique_ptr<DirectionsEngine> m_directionsEngine;
   std::unique_ptr<SegmentedRoute> m_lastRoute;
   std::unique_ptr<FakeEdgesContainer> m_lastFakeEdges;
+  bool m_keepFinishTrees = false;
+  // Next segments to the finish of the backward wave of the subroute which is being calculated.
+  SegmentParents m_subrouteFinishTree;
+  // Finish trees of the subroutes of |m_lastRoute| and traffic they are calculated with.
+  std::vector<FinishTree> m_lastFinishTrees;
+  TrafficStash::MwmToTraffic m_lastFinishTreesTraffic;
+  // Loaded lazily, the mwm id detects a replaced mwm. Routes in the contraction mode are within one
+  // mwm, so a few last used hierarchies are kept.
+  using ContractionHierarchyCache =
+      LruCache<NumMwmId, std::pair<MwmSet::MwmId, std::shared_ptr<ContractionHierarchy const>>>;
+  ContractionHierarchyCache m_contractionHierarchies{4 /* maxCacheSize */};
 
   // If a ckeckpoint is near to the guide track we need to build route through this track.
   GuidesConnections m_guides;
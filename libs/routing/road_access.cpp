@@ -36,21 +36,34 @@ RoadAccess::RoadAccess() : m_currentTimeGetter([]() { return GetCurrentTimestamp
 std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(uint32_t featureId,
                                                                           RouteWeight const & weightToFeature) const
 {
-  return GetAccess(featureId, weightToFeature.GetWeight());
+  return GetAccess(featureId, weightToFeature.GetWeight(), m_currentTimeGetter);
 }
 
 std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(RoadPoint const & point,
                                                                           RouteWeight const & weightToPoint) const
 {
-  return GetAccess(point, weightToPoint.GetWeight());
+  return GetAccess(point, weightToPoint.GetWeight(), m_currentTimeGetter);
 }
 
-std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(uint32_t featureId, double weight) const
+std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(
+    uint32_t featureId, RouteWeight const & weightToFeature, std::function<time_t()> const & currentTimeGetter) const
+{
+  return GetAccess(featureId, weightToFeature.GetWeight(), currentTimeGetter);
+}
+
+std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(
+    RoadPoint const & point, RouteWeight const & weightToPoint, std::function<time_t()> const & currentTimeGetter) const
+{
+  return GetAccess(point, weightToPoint.GetWeight(), currentTimeGetter);
+}
+
+std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(
+    uint32_t featureId, double weight, std::function<time_t()> const & currentTimeGetter) const
 {
   auto const itConditional = m_wayToAccessConditional.find(featureId);
   if (itConditional != m_wayToAccessConditional.cend())
   {
-    auto const time = m_currentTimeGetter();
+    auto const time = currentTimeGetter();
     auto const & conditional = itConditional->second;
     for (auto const & access : conditional.GetAccesses())
     {
@@ -63,12 +76,13 @@ std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(uint32
   return GetAccessWithoutConditional(featureId);
 }
 
-std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(RoadPoint const & point, double weight) const
+std::pair<RoadAccess::Type, RoadAccess::Confidence> RoadAccess::GetAccess(
+    RoadPoint const & point, double weight, std::function<time_t()> const & currentTimeGetter) const
 {
   auto const itConditional = m_pointToAccessConditional.find(point);
   if (itConditional != m_pointToAccessConditional.cend())
   {
-    auto const time = m_currentTimeGetter();
+    auto const time = currentTimeGetter();
     auto const & conditional = itConditional->second;
     for (auto const & access : conditional.GetAccesses())
     {
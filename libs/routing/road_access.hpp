@@ -107,6 +107,13 @@ public:
   std::pair<Type, Confidence> GetAccess(uint32_t featureId, RouteWeight const & weightToFeature) const;
   std::pair<Type, Confidence> GetAccess(RoadPoint const & point, RouteWeight const & weightToPoint) const;
 
+  /// Same as above, but with the caller's time getter instead of the one set by SetCurrentTimeGetter(),
+  /// so one RoadAccess may be shared by graphs with different time getters.
+  std::pair<Type, Confidence> GetAccess(uint32_t featureId, RouteWeight const & weightToFeature,
+                                        std::function<time_t()> const & currentTimeGetter) const;
+  std::pair<Type, Confidence> GetAccess(RoadPoint const & point, RouteWeight const & weightToPoint,
+                                        std::function<time_t()> const & currentTimeGetter) const;
+
   std::pair<Type, Confidence> GetAccessWithoutConditional(uint32_t featureId) const;
   std::pair<Type, Confidence> GetAccessWithoutConditional(RoadPoint const & point) const;
 
@@ -159,8 +166,10 @@ private:
   static std::optional<Confidence> GetConfidenceForAccessConditional(time_t momentInTime,
                                                                      osmoh::OpeningHours const & openingHours);
 
-  std::pair<Type, Confidence> GetAccess(uint32_t featureId, double weight) const;
-  std::pair<Type, Confidence> GetAccess(RoadPoint const & point, double weight) const;
+  std::pair<Type, Confidence> GetAccess(uint32_t featureId, double weight,
+                                        std::function<time_t()> const & currentTimeGetter) const;
+  std::pair<Type, Confidence> GetAccess(RoadPoint const & point, double weight,
+                                        std::function<time_t()> const & currentTimeGetter) const;
 
   std::function<time_t()> m_currentTimeGetter;
 
@@ -61,6 +61,9 @@ public:
   /// Clear all temporary buffers.
   virtual void ClearState() {}
 
+  /// Clear the data which is kept between the routes. It's called when mwms are changed or memory is low.
+  virtual void ClearCaches() {}
+
   virtual void SetGuides(GuidesTracks && guides) = 0;
 
   /// Override this function with routing implementation.
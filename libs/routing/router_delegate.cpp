@@ -46,4 +46,9 @@ void RouterDelegate::SetTimeout(uint32_t timeoutSec)
   std::chrono::steady_clock::duration const timeout = std::chrono::seconds(timeoutSec);
   m_cancellable.SetDeadline(std::chrono::steady_clock::now() + timeout);
 }
+
+void RouterDelegate::SetDeadline(std::chrono::steady_clock::time_point const & deadline)
+{
+  m_cancellable.SetDeadline(deadline);
+}
 }  //  namespace routing
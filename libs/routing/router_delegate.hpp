@@ -7,6 +7,7 @@
 #include "base/cancellable.hpp"
 #include "base/timer.hpp"
 
+#include <chrono>
 #include <mutex>
 
 namespace routing
@@ -26,6 +27,7 @@ public:
   void SetPointCheckCallback(PointCheckCallback const & pointCallback);
 
   void SetTimeout(uint32_t timeoutSec);
+  void SetDeadline(std::chrono::steady_clock::time_point const & deadline);
 
   base::Cancellable const & GetCancellable() const { return m_cancellable; }
   void Reset() { return m_cancellable.Reset(); }
@@ -103,10 +103,6 @@ RoutesBuilder::RoutesBuilder(size_t threadsNumber) : m_threadPool(threadsNumber)
   std::vector<platform::LocalCountryFile> localFiles;
   platform::FindAllLocalMapsAndCleanup(std::numeric_limits<int64_t>::max(), localFiles);
 
-  std::vector<std::unique_ptr<FrozenDataSource>> dataSources;
-  for (size_t i = 0; i < threadsNumber; ++i)
-    dataSources.emplace_back(std::make_unique<FrozenDataSource>());
-
   for (auto const & localFile : localFiles)
   {
     auto const & countryFile = localFile.GetCountryFile();
@@ -116,35 +112,87 @@ RoutesBuilder::RoutesBuilder(size_t threadsNumber) : m_threadPool(threadsNumber)
 
     m_numMwmIds->RegisterFile(countryFile);
 
-    for (auto & dataSource : dataSources)
-    {
-      auto const result = dataSource->RegisterMap(localFile);
-      CHECK_EQUAL(result.second, MwmSet::RegResult::Success, ("Can't register mwm:", localFile));
-
-      auto const mwmId = dataSource->GetMwmIdByCountryFile(countryFile);
-      if (!mwmId.IsAlive())
-        continue;
-    }
+    auto const result = m_dataSource.RegisterMap(localFile);
+    CHECK_EQUAL(result.second, MwmSet::RegResult::Success, ("Can't register mwm:", localFile));
   }
-
-  for (auto & dataSource : dataSources)
-    m_dataSourcesStorage.PushDataSource(std::move(dataSource));
 }
 
 RoutesBuilder::Result RoutesBuilder::ProcessTask(Params const & params)
 {
-  Processor processor(m_numMwmIds, m_dataSourcesStorage, m_cpg, m_cig);
-  return processor(params);
+  return Process(params);
 }
 
 std::future<RoutesBuilder::Result> RoutesBuilder::ProcessTaskAsync(Params const & params)
 {
   // Should be copyable to workaround MSVC bug (https://developercommunity.visualstudio.com/t/108672)
-  auto task = [processor = std::make_shared<Processor>(m_numMwmIds, m_dataSourcesStorage, m_cpg, m_cig)](
-                  Params const & params) -> Result { return (*processor)(params); };
+  auto task = [this](Params const & params) -> Result { return Process(params); };
   return m_threadPool.Submit(std::move(task), params);
 }
 
+std::unique_ptr<RoutesBuilder::Processor> RoutesBuilder::TakeProcessor()
+{
+  {
+    std::lock_guard lock(m_processorsMutex);
+    if (!m_freeProcessors.empty())
+    {
+      auto processor = std::move(m_freeProcessors.front());
+      m_freeProcessors.pop_front();
+      return processor;
+    }
+  }
+
+  return std::make_unique<Processor>(m_numMwmIds, m_dataSource, m_indexGraphDataCache, m_cpg, m_cig);
+}
+
+void RoutesBuilder::ReturnProcessor(std::unique_ptr<Processor> && processor)
+{
+  std::lock_guard lock(m_processorsMutex);
+  m_freeProcessors.emplace_back(std::move(processor));
+}
+
+RoutesBuilder::MatrixResult RoutesBuilder::ProcessMatrixTask(MatrixParams const & params)
+{
+  return Process(params);
+}
+
+std::future<RoutesBuilder::MatrixResult> RoutesBuilder::ProcessMatrixTaskAsync(MatrixParams const & params)
+{
+  auto task = [this](MatrixParams const & params) -> MatrixResult { return Process(params); };
+  return m_threadPool.Submit(std::move(task), params);
+}
+
+RoutesBuilder::IsochroneResult RoutesBuilder::ProcessIsochroneTask(IsochroneParams const & params)
+{
+  return Process(params);
+}
+
+std::future<RoutesBuilder::IsochroneResult> RoutesBuilder::ProcessIsochroneTaskAsync(IsochroneParams const & params)
+{
+  auto task = [this](IsochroneParams const & params) -> IsochroneResult { return Process(params); };
+  return m_threadPool.Submit(std::move(task), params);
+}
+
+RoutesBuilder::Result RoutesBuilder::Process(Params const & params)
+{
+  auto processor = TakeProcessor();
+  SCOPE_GUARD(returnProcessor, [&]() { ReturnProcessor(std::move(processor)); });
+  return (*processor)(params);
+}
+
+RoutesBuilder::MatrixResult RoutesBuilder::Process(MatrixParams const & params)
+{
+  auto processor = TakeProcessor();
+  SCOPE_GUARD(returnProcessor, [&]() { ReturnProcessor(std::move(processor)); });
+  return (*processor)(params);
+}
+
+RoutesBuilder::IsochroneResult RoutesBuilder::Process(IsochroneParams const & params)
+{
+  auto processor = TakeProcessor();
+  SCOPE_GUARD(returnProcessor, [&]() { ReturnProcessor(std::move(processor)); });
+  return (*processor)(params);
+}
+
 // RoutesBuilder::Result ---------------------------------------------------------------------------
 
 // static
@@ -228,29 +276,17 @@ std::vector<ms::LatLon> RoutesBuilder::Route::GetWaypoints() const
 
 // RoutesBuilder::Processor ------------------------------------------------------------------------
 
-RoutesBuilder::Processor::Processor(std::shared_ptr<NumMwmIds> numMwmIds, DataSourceStorage & dataSourceStorage,
+RoutesBuilder::Processor::Processor(std::shared_ptr<NumMwmIds> numMwmIds, DataSource & dataSource,
+                                    std::shared_ptr<IndexGraphDataCache> indexGraphDataCache,
                                     std::weak_ptr<storage::CountryParentGetter> cpg,
                                     std::weak_ptr<storage::CountryInfoGetter> cig)
   : m_numMwmIds(std::move(numMwmIds))
-  , m_dataSourceStorage(dataSourceStorage)
+  , m_dataSource(dataSource)
+  , m_indexGraphDataCache(std::move(indexGraphDataCache))
   , m_cpg(std::move(cpg))
   , m_cig(std::move(cig))
 {}
 
-RoutesBuilder::Processor::Processor(Processor && rhs) noexcept : m_dataSourceStorage(rhs.m_dataSourceStorage)
-{
-  m_start = rhs.m_start;
-  m_finish = rhs.m_finish;
-
-  m_router = std::move(rhs.m_router);
-  m_delegate = std::move(rhs.m_delegate);
-  m_numMwmIds = std::move(rhs.m_numMwmIds);
-  m_trafficCache = std::move(rhs.m_trafficCache);
-  m_cpg = std::move(rhs.m_cpg);
-  m_cig = std::move(rhs.m_cig);
-  m_dataSource = std::move(rhs.m_dataSource);
-}
-
 void RoutesBuilder::Processor::InitRouter(VehicleType type)
 {
   if (m_router && m_router->GetVehicleType() == type)
@@ -270,26 +306,23 @@ void RoutesBuilder::Processor::InitRouter(VehicleType type)
   };
 
   bool const loadAltitudes = type != VehicleType::Car;
-  if (!m_dataSource)
-    m_dataSource = m_dataSourceStorage.GetDataSource();
-
   m_router = std::make_unique<IndexRouter>(type, loadAltitudes, *m_cpg.lock(), countryFileGetter, getMwmRectByName,
                                            m_numMwmIds, MakeNumMwmTree(*m_numMwmIds, *m_cig.lock()), *m_trafficCache,
-                                           *m_dataSource);
+                                           m_dataSource);
+  m_router->SetIndexGraphDataCache(m_indexGraphDataCache);
 }
 
 RoutesBuilder::Result RoutesBuilder::Processor::operator()(Params const & params)
 {
   InitRouter(params.m_type);
-  SCOPE_GUARD(returnDataSource, [&]() { m_dataSourceStorage.PushDataSource(std::move(m_dataSource)); });
+  m_router->SetParallelWaves(params.m_parallelWaves);
+  m_router->SetCrossMwmWeightsLoadMode(params.m_crossMwmWeightsLoadMode);
 
   LOG(LINFO, ("Start building route, checkpoints:", params.m_checkpoints));
 
   RouterResultCode resultCode = RouterResultCode::RouteNotFound;
   routing::Route route("" /* router */, 0 /* routeId */);
 
-  CHECK(m_dataSource, ());
-
   double timeSum = 0.0;
   for (size_t i = 0; i < params.m_launchesNumber; ++i)
   {
@@ -319,5 +352,47 @@ RoutesBuilder::Result RoutesBuilder::Processor::operator()(Params const & params
 
   return result;
 }
+
+RoutesBuilder::MatrixResult RoutesBuilder::Processor::operator()(MatrixParams const & params)
+{
+  InitRouter(params.m_type);
+
+  LOG(LINFO, ("Start building", params.m_sources.size(), "x", params.m_targets.size(), "matrix."));
+
+  auto const toPoints = [](std::vector<ms::LatLon> const & latlons)
+  {
+    std::vector<m2::PointD> points;
+    points.reserve(latlons.size());
+    for (auto const & latlon : latlons)
+      points.push_back(mercator::FromLatLon(latlon));
+    return points;
+  };
+
+  MatrixResult result;
+  m_delegate->Reset();
+  if (params.m_deadline)
+    m_delegate->SetDeadline(*params.m_deadline);
+  base::Timer timer;
+  result.m_code =
+      m_router->CalculateMatrix(toPoints(params.m_sources), toPoints(params.m_targets), *m_delegate, result.m_matrix);
+  result.m_buildTimeSeconds = timer.ElapsedSeconds();
+  return result;
+}
+
+RoutesBuilder::IsochroneResult RoutesBuilder::Processor::operator()(IsochroneParams const & params)
+{
+  InitRouter(params.m_type);
+
+  LOG(LINFO, ("Start building isochrone from", params.m_start, "for", params.m_maxTimeSeconds, "seconds."));
+
+  IsochroneResult result;
+  m_delegate->Reset();
+  m_delegate->SetTimeout(params.m_timeoutSeconds);
+  base::Timer timer;
+  result.m_code = m_router->CalculateIsochrone(mercator::FromLatLon(params.m_start), params.m_maxTimeSeconds,
+                                               true /* buildHull */, *m_delegate, result.m_isochrone);
+  result.m_buildTimeSeconds = timer.ElapsedSeconds();
+  return result;
+}
 }  // namespace routes_builder
 }  // namespace routing
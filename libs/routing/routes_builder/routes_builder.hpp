@@ -1,8 +1,7 @@
 #pragma once
 
-#include "routing/routes_builder/data_source_storage.hpp"
-
 #include "routing/checkpoints.hpp"
+#include "routing/index_graph_loader.hpp"
 #include "routing/index_router.hpp"
 #include "routing/router_delegate.hpp"
 #include "routing/routing_callbacks.hpp"
@@ -14,6 +13,8 @@
 #include "storage/country_info_getter.hpp"
 #include "storage/country_parent_getter.hpp"
 
+#include "indexer/data_source.hpp"
+
 #include "routing_common/num_mwm_id.hpp"
 
 #include "routing/base/followed_polyline.hpp"
@@ -29,9 +30,13 @@
 #include "base/macros.hpp"
 #include "base/thread_pool_computational.hpp"
 
+#include <chrono>
 #include <cstddef>
 #include <future>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -41,6 +46,8 @@ namespace routes_builder
 {
 // TODO (@gmoryes)
 //  Reuse this class for routing_integration_tests
+// All the threads share one data source and the graphs loaded from it. Every thread keeps its own
+// router with its own geometry cache and search waves.
 class RoutesBuilder
 {
 public:
@@ -62,6 +69,9 @@ public:
     Checkpoints m_checkpoints;
     uint32_t m_timeoutSeconds = RouterDelegate::kNoTimeout;
     uint32_t m_launchesNumber = 1;
+    /// Propagate the forward and the backward waves on two threads, see IndexRouter::SetParallelWaves().
+    bool m_parallelWaves = false;
+    connector::WeightsLoadMode m_crossMwmWeightsLoadMode = connector::WeightsLoadMode::Lazy;
   };
 
   struct Route
@@ -95,19 +105,57 @@ public:
     double m_buildTimeSeconds = 0.0;
   };
 
+  struct MatrixParams
+  {
+    VehicleType m_type = VehicleType::Car;
+    std::vector<ms::LatLon> m_sources;
+    std::vector<ms::LatLon> m_targets;
+    // A matrix may be split to several tasks, they share the deadline.
+    std::optional<std::chrono::steady_clock::time_point> m_deadline;
+  };
+
+  struct MatrixResult
+  {
+    RouterResultCode m_code = RouterResultCode::RouteNotFound;
+    IndexRouter::Matrix m_matrix;
+    double m_buildTimeSeconds = 0.0;
+  };
+
+  struct IsochroneParams
+  {
+    VehicleType m_type = VehicleType::Car;
+    ms::LatLon m_start;
+    double m_maxTimeSeconds = 0.0;
+    uint32_t m_timeoutSeconds = RouterDelegate::kNoTimeout;
+  };
+
+  struct IsochroneResult
+  {
+    RouterResultCode m_code = RouterResultCode::RouteNotFound;
+    IndexRouter::Isochrone m_isochrone;
+    double m_buildTimeSeconds = 0.0;
+  };
+
   Result ProcessTask(Params const & params);
   std::future<Result> ProcessTaskAsync(Params const & params);
 
+  MatrixResult ProcessMatrixTask(MatrixParams const & params);
+  std::future<MatrixResult> ProcessMatrixTaskAsync(MatrixParams const & params);
+
+  IsochroneResult ProcessIsochroneTask(IsochroneParams const & params);
+  std::future<IsochroneResult> ProcessIsochroneTaskAsync(IsochroneParams const & params);
+
 private:
   class Processor
   {
   public:
-    Processor(std::shared_ptr<NumMwmIds> numMwmIds, DataSourceStorage & dataSourceStorage,
+    Processor(std::shared_ptr<NumMwmIds> numMwmIds, DataSource & dataSource,
+              std::shared_ptr<IndexGraphDataCache> indexGraphDataCache,
               std::weak_ptr<storage::CountryParentGetter> cpg, std::weak_ptr<storage::CountryInfoGetter> cig);
 
-    Processor(Processor && rhs) noexcept;
-
     Result operator()(Params const & params);
+    MatrixResult operator()(MatrixParams const & params);
+    IsochroneResult operator()(IsochroneParams const & params);
 
   private:
     void InitRouter(VehicleType type);
@@ -120,12 +168,20 @@ private:
 
     std::shared_ptr<NumMwmIds> m_numMwmIds;
     std::shared_ptr<traffic::TrafficCache> m_trafficCache = std::make_shared<traffic::TrafficCache>();
-    DataSourceStorage & m_dataSourceStorage;
+    DataSource & m_dataSource;
+    std::shared_ptr<IndexGraphDataCache> m_indexGraphDataCache;
     std::weak_ptr<storage::CountryParentGetter> m_cpg;
     std::weak_ptr<storage::CountryInfoGetter> m_cig;
-    std::unique_ptr<FrozenDataSource> m_dataSource;
   };
 
+  // Processors are reused by the following tasks, so routers are created once per thread
+  // and keep their caches warm.
+  std::unique_ptr<Processor> TakeProcessor();
+  void ReturnProcessor(std::unique_ptr<Processor> && processor);
+  Result Process(Params const & params);
+  MatrixResult Process(MatrixParams const & params);
+  IsochroneResult Process(IsochroneParams const & params);
+
   base::ComputationalThreadPool m_threadPool;
 
   std::shared_ptr<storage::CountryParentGetter> m_cpg = std::make_shared<storage::CountryParentGetter>();
@@ -135,7 +191,11 @@ private:
 
   std::shared_ptr<NumMwmIds> m_numMwmIds = std::make_shared<NumMwmIds>();
 
-  DataSourceStorage m_dataSourcesStorage;
+  FrozenDataSource m_dataSource;
+  std::shared_ptr<IndexGraphDataCache> m_indexGraphDataCache = std::make_shared<IndexGraphDataCache>();
+
+  std::mutex m_processorsMutex;
+  std::list<std::unique_ptr<Processor>> m_freeProcessors;
 };
 }  // namespace routes_builder
 }  // namespace routing
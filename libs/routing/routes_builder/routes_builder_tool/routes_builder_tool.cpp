@@ -22,6 +22,19 @@ DEFINE_string(routes_file, "",
               "second_start_lat second_start_lon second_finish_lat second_finish_lon\n\t"
               "...");
 
+DEFINE_string(matrix_sources_file, "",
+              "Path to file with sources of the matrix in format: \n\t"
+              "first_lat first_lon\n\t"
+              "second_lat second_lon\n\t"
+              "...");
+DEFINE_string(matrix_targets_file, "",
+              "Path to file with targets of the matrix in the same format as --matrix_sources_file. "
+              "The sources are used if it's empty.");
+
+DEFINE_string(isochrone_points_file, "",
+              "Path to file with start points of the isochrones in the same format as --matrix_sources_file.");
+DEFINE_double(isochrone_max_time, 15 * 60, "Time limit of the isochrones in seconds (default: 15 minutes).");
+
 DEFINE_string(dump_path, "",
               "Path where routes will be dumped after building."
               "Useful for intermediate results, because routes building "
@@ -36,12 +49,18 @@ DEFINE_string(api_token, "", "Token for chosen api.");
 DEFINE_uint64(start_from, 0, "The line number from which the tool should start reading.");
 
 DEFINE_int32(timeout, 10 * 60,
-             "Timeout in seconds for each route building. "
+             "Timeout in seconds for each route building or for the whole matrix. "
              "0 means without timeout (default: 10 minutes).");
 
 DEFINE_bool(verbose, false, "Verbose logging (default: false)");
 
 DEFINE_int32(launches_number, 1, "Number of launches of routes buildings. Needs for benchmarking (default: 1)");
+DEFINE_bool(parallel_waves, false,
+            "Propagate the forward and the backward waves of a route on two threads (default: false). "
+            "Only for mapsme.");
+DEFINE_string(cross_mwm_weights, "lazy",
+              "How the weights of cross-mwm connectors are read: lazy|mapped|eager (default: lazy). "
+              "Eager weights are read once per mwm and thread. Only for mapsme.");
 DEFINE_string(vehicle_type, "car", "Vehicle type: car|pedestrian|bicycle|transit. (Only for mapsme).");
 
 using namespace routing;
@@ -55,6 +74,16 @@ bool IsLocalBuild()
   return !FLAGS_routes_file.empty() && FLAGS_api_name.empty() && FLAGS_api_token.empty();
 }
 
+bool IsMatrixBuild()
+{
+  return !FLAGS_matrix_sources_file.empty();
+}
+
+bool IsIsochroneBuild()
+{
+  return !FLAGS_isochrone_points_file.empty();
+}
+
 bool IsApiBuild()
 {
   return !FLAGS_routes_file.empty() && !FLAGS_api_name.empty() && !FLAGS_api_token.empty();
@@ -73,7 +102,9 @@ int Main(int argc, char ** argv)
 
   CHECK_GREATER_OR_EQUAL(FLAGS_timeout, 0, ("Timeout should be greater than zero."));
 
-  CHECK(!FLAGS_routes_file.empty(), ("\n\n\t--routes_file is required.", "\n\nType --help for usage."));
+  CHECK(!FLAGS_routes_file.empty() || IsMatrixBuild() || IsIsochroneBuild(),
+        ("\n\n\t--routes_file, --matrix_sources_file or --isochrone_points_file is required.",
+         "\n\nType --help for usage."));
 
   if (!FLAGS_data_path.empty())
     GetPlatform().SetWritableDirForTests(FLAGS_data_path);
@@ -81,7 +112,7 @@ int Main(int argc, char ** argv)
   if (!FLAGS_resources_path.empty())
     GetPlatform().SetResourceDir(FLAGS_resources_path);
 
-  CHECK(IsLocalBuild() || IsApiBuild(),
+  CHECK(IsLocalBuild() || IsApiBuild() || IsMatrixBuild() || IsIsochroneBuild(),
         ("\n\n\t--routes_file empty is:", FLAGS_routes_file.empty(), "\n\t--api_name empty is:", FLAGS_api_name.empty(),
          "\n\t--api_token empty is:", FLAGS_api_token.empty(), "\n\nType --help for usage."));
 
@@ -103,7 +134,21 @@ int Main(int argc, char ** argv)
       LOG(LINFO, ("Benchmark mode is activated. Each route will be built", launchesNumber, "times."));
 
     BuildRoutes(FLAGS_routes_file, FLAGS_dump_path, FLAGS_start_from, FLAGS_threads, FLAGS_timeout, FLAGS_vehicle_type,
-                FLAGS_verbose, launchesNumber);
+                FLAGS_verbose, launchesNumber, FLAGS_parallel_waves, FLAGS_cross_mwm_weights);
+  }
+
+  if (IsMatrixBuild())
+  {
+    BuildMatrix(FLAGS_matrix_sources_file,
+                FLAGS_matrix_targets_file.empty() ? FLAGS_matrix_sources_file : FLAGS_matrix_targets_file,
+                FLAGS_dump_path, FLAGS_threads, FLAGS_timeout, FLAGS_vehicle_type, FLAGS_verbose);
+  }
+
+  if (IsIsochroneBuild())
+  {
+    CHECK_GREATER(FLAGS_isochrone_max_time, 0.0, ());
+    BuildIsochrones(FLAGS_isochrone_points_file, FLAGS_isochrone_max_time, FLAGS_dump_path, FLAGS_threads,
+                    FLAGS_timeout, FLAGS_vehicle_type, FLAGS_verbose);
   }
 
   if (IsApiBuild())
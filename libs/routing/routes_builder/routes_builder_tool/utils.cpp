@@ -4,6 +4,7 @@
 #include "routing/routing_quality/api/mapbox/mapbox_api.hpp"
 
 #include "routing/checkpoints.hpp"
+#include "routing/cross_mwm_connector.hpp"
 #include "routing/vehicle_mask.hpp"
 
 #include "platform/platform.hpp"
@@ -60,11 +61,46 @@ routing::VehicleType ConvertVehicleTypeFromString(std::string const & str)
   CHECK(false, ("Unknown vehicle type:", str));
   UNREACHABLE();
 }
+
+connector::WeightsLoadMode ConvertWeightsLoadModeFromString(std::string const & str)
+{
+  if (str == "lazy")
+    return connector::WeightsLoadMode::Lazy;
+  if (str == "mapped")
+    return connector::WeightsLoadMode::Mapped;
+  if (str == "eager")
+    return connector::WeightsLoadMode::Eager;
+
+  CHECK(false, ("Unknown cross-mwm weights load mode:", str));
+  UNREACHABLE();
+}
+
+std::vector<ms::LatLon> LoadPoints(std::string const & filename)
+{
+  std::ifstream input(filename);
+  CHECK(input.good(), ("Error during opening:", filename));
+
+  std::vector<ms::LatLon> points;
+  ms::LatLon point;
+  while (input >> point.m_lat >> point.m_lon)
+    points.push_back(point);
+
+  return points;
+}
+
+uint64_t GetThreadsNumber(uint64_t threadsNumber)
+{
+  if (threadsNumber)
+    return threadsNumber;
+
+  auto const hardwareConcurrency = std::thread::hardware_concurrency();
+  return hardwareConcurrency > 0 ? hardwareConcurrency : 2;
+}
 }  // namespace
 
 void BuildRoutes(std::string const & routesPath, std::string const & dumpPath, uint64_t startFrom,
                  uint64_t threadsNumber, uint32_t timeoutPerRouteSeconds, std::string const & vehicleTypeStr,
-                 bool verbose, uint32_t launchesNumber)
+                 bool verbose, uint32_t launchesNumber, bool parallelWaves, std::string const & crossMwmWeights)
 {
   CHECK(Platform::IsFileExistsByFullPath(routesPath), ("Can not find file:", routesPath));
   CHECK(!dumpPath.empty(), ("Empty dumpPath."));
@@ -72,13 +108,7 @@ void BuildRoutes(std::string const & routesPath, std::string const & dumpPath, u
   std::ifstream input(routesPath);
   CHECK(input.good(), ("Error during opening:", routesPath));
 
-  if (!threadsNumber)
-  {
-    auto const hardwareConcurrency = std::thread::hardware_concurrency();
-    threadsNumber = hardwareConcurrency > 0 ? hardwareConcurrency : 2;
-  }
-
-  RoutesBuilder routesBuilder(threadsNumber);
+  RoutesBuilder routesBuilder(GetThreadsNumber(threadsNumber));
 
   std::vector<std::future<RoutesBuilder::Result>> tasks;
   double lastPercent = 0.0;
@@ -89,6 +119,8 @@ void BuildRoutes(std::string const & routesPath, std::string const & dumpPath, u
     params.m_type = vehicleType;
     params.m_timeoutSeconds = timeoutPerRouteSeconds;
     params.m_launchesNumber = launchesNumber;
+    params.m_parallelWaves = parallelWaves;
+    params.m_crossMwmWeightsLoadMode = ConvertWeightsLoadModeFromString(crossMwmWeights);
 
     base::ScopedLogLevelChanger changer(verbose ? base::LogLevel::LINFO : base::LogLevel::LERROR);
     ms::LatLon start;
@@ -138,6 +170,108 @@ void BuildRoutes(std::string const & routesPath, std::string const & dumpPath, u
   }
 }
 
+void BuildMatrix(std::string const & sourcesPath, std::string const & targetsPath, std::string const & dumpPath,
+                 uint64_t threadsNumber, uint32_t timeoutSeconds, std::string const & vehicleTypeStr, bool verbose)
+{
+  RoutesBuilder::MatrixParams params;
+  params.m_type = ConvertVehicleTypeFromString(vehicleTypeStr);
+  params.m_targets = LoadPoints(targetsPath);
+  auto const sources = LoadPoints(sourcesPath);
+  LOG_FORCE(LINFO, ("Matrix:", sources.size(), "sources,", params.m_targets.size(), "targets."));
+
+  threadsNumber = GetThreadsNumber(threadsNumber);
+  RoutesBuilder routesBuilder(threadsNumber);
+
+  // Every task calculates the rows of a chunk of sources, the targets are snapped to the roads once per task.
+  size_t const chunkSize = std::max<size_t>(1, (sources.size() + threadsNumber - 1) / threadsNumber);
+  std::vector<std::future<RoutesBuilder::MatrixResult>> tasks;
+  {
+    base::ScopedLogLevelChanger changer(verbose ? base::LogLevel::LINFO : base::LogLevel::LERROR);
+    base::Timer timer;
+    // The timeout is for the whole matrix, not for a chunk.
+    if (timeoutSeconds != 0)
+      params.m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+
+    for (size_t begin = 0; begin < sources.size(); begin += chunkSize)
+    {
+      auto const end = std::min(sources.size(), begin + chunkSize);
+      params.m_sources.assign(sources.begin() + begin, sources.begin() + end);
+      tasks.emplace_back(routesBuilder.ProcessMatrixTaskAsync(params));
+    }
+
+    std::string const fullPath = base::JoinPath(dumpPath, "matrix.csv");
+    std::ofstream output(fullPath);
+    CHECK(output.good(), ("Error during opening:", fullPath));
+    output << "source,target,code,eta,distance\n";
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+      auto const result = tasks[i].get();
+      for (size_t row = 0; row < result.m_matrix.size(); ++row)
+      {
+        for (size_t target = 0; target < result.m_matrix[row].size(); ++target)
+        {
+          auto const & cell = result.m_matrix[row][target];
+          output << i * chunkSize + row << "," << target << "," << DebugPrint(cell.m_code) << "," << cell.m_eta << ","
+                 << cell.m_distance << "\n";
+        }
+      }
+
+      if (result.m_code != RouterResultCode::NoError)
+        LOG_FORCE(LINFO, ("Rows from", i * chunkSize, "failed:", result.m_code));
+    }
+
+    LOG_FORCE(LINFO, ("BuildMatrix() took:", timer.ElapsedSeconds(), "seconds."));
+  }
+}
+
+void BuildIsochrones(std::string const & pointsPath, double maxTimeSeconds, std::string const & dumpPath,
+                     uint64_t threadsNumber, uint32_t timeoutSeconds, std::string const & vehicleTypeStr, bool verbose)
+{
+  RoutesBuilder::IsochroneParams params;
+  params.m_type = ConvertVehicleTypeFromString(vehicleTypeStr);
+  params.m_maxTimeSeconds = maxTimeSeconds;
+  if (timeoutSeconds != 0)
+    params.m_timeoutSeconds = timeoutSeconds;
+
+  auto const points = LoadPoints(pointsPath);
+  LOG_FORCE(LINFO, ("Isochrones of", maxTimeSeconds, "seconds from", points.size(), "points."));
+
+  RoutesBuilder routesBuilder(GetThreadsNumber(threadsNumber));
+  std::vector<std::future<RoutesBuilder::IsochroneResult>> tasks;
+  {
+    base::ScopedLogLevelChanger changer(verbose ? base::LogLevel::LINFO : base::LogLevel::LERROR);
+    base::Timer timer;
+    for (auto const & point : points)
+    {
+      params.m_start = point;
+      tasks.emplace_back(routesBuilder.ProcessIsochroneTaskAsync(params));
+    }
+
+    std::string const fullPath = base::JoinPath(dumpPath, "isochrones.csv");
+    std::ofstream output(fullPath);
+    CHECK(output.good(), ("Error during opening:", fullPath));
+    // The hull is a list of "lat lon" points separated with ';'.
+    output << "point,code,segments,build_time,hull\n";
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+      auto const result = tasks[i].get();
+      auto const & isochrone = result.m_isochrone;
+      output << i << "," << DebugPrint(result.m_code) << "," << isochrone.m_segments.size() << ","
+             << result.m_buildTimeSeconds << ",";
+      for (size_t j = 0; j < isochrone.m_hull.size(); ++j)
+      {
+        auto const latlon = mercator::ToLatLon(isochrone.m_hull[j]);
+        output << (j == 0 ? "" : ";") << latlon.m_lat << " " << latlon.m_lon;
+      }
+      output << "\n";
+    }
+
+    LOG_FORCE(LINFO, ("BuildIsochrones() took:", timer.ElapsedSeconds(), "seconds."));
+  }
+}
+
 std::optional<std::tuple<ms::LatLon, ms::LatLon, int32_t>> ParseApiLine(std::ifstream & input)
 {
   std::string line;
@@ -15,7 +15,17 @@ namespace routes_builder
 {
 void BuildRoutes(std::string const & routesPath, std::string const & dumpPath, uint64_t startFrom,
                  uint64_t threadsNumber, uint32_t timeoutPerRouteSeconds, std::string const & vehicleType, bool verbose,
-                 uint32_t launchesNumber);
+                 uint32_t launchesNumber, bool parallelWaves, std::string const & crossMwmWeights);
+
+/// \brief Builds the matrix of the routes from every point of |sourcesPath| to every point of
+/// |targetsPath| and saves it to |dumpPath|/matrix.csv. The files have a "lat lon" point per line.
+void BuildMatrix(std::string const & sourcesPath, std::string const & targetsPath, std::string const & dumpPath,
+                 uint64_t threadsNumber, uint32_t timeoutSeconds, std::string const & vehicleType, bool verbose);
+
+/// \brief Builds the isochrones of |maxTimeSeconds| from every point of |pointsPath| and saves their
+/// convex hulls to |dumpPath|/isochrones.csv. The file has a "lat lon" point per line.
+void BuildIsochrones(std::string const & pointsPath, double maxTimeSeconds, std::string const & dumpPath,
+                     uint64_t threadsNumber, uint32_t timeoutSeconds, std::string const & vehicleType, bool verbose);
 
 void BuildRoutesWithApi(std::unique_ptr<routing_quality::api::RoutingApi> routingApi, std::string const & routesPath,
                         std::string const & dumpPath, int64_t startFrom);
@@ -0,0 +1,112 @@
+#include "testing/testing.hpp"
+
+#include "routing/base/astar_algorithm.hpp"
+#include "routing/base/astar_graph.hpp"
+#include "routing/base/astar_queue.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace astar_queue_benchmark
+{
+using namespace routing;
+using namespace std;
+
+struct GridEdge
+{
+  GridEdge() = default;  // needed for buffer_vector only
+  GridEdge(uint32_t target, double weight) : m_target(target), m_weight(weight) {}
+
+  uint32_t GetTarget() const { return m_target; }
+  double GetWeight() const { return m_weight; }
+
+  uint32_t m_target = 0;
+  double m_weight = 0.0;
+};
+
+// Square grid with random weights of the edges, a road network of a city in the first approximation.
+class GridGraph : public AStarGraph<uint32_t, GridEdge, double>
+{
+public:
+  GridGraph(uint32_t side, uint32_t seed) : m_side(side), m_weights(side * side * 4)
+  {
+    mt19937 rng(seed);
+    uniform_real_distribution<double> distribution(1.0, 100.0);
+    for (auto & weight : m_weights)
+      weight = distribution(rng);
+  }
+
+  uint32_t GetNumVertices() const { return m_side * m_side; }
+
+  // AStarGraph overrides:
+  double HeuristicCostEstimate(Vertex const & /* from */, Vertex const & /* to */) override { return 0.0; }
+
+  void GetOutgoingEdgesList(astar::VertexData<Vertex, Weight> const & vertexData, EdgeListT & edges) override
+  {
+    GetEdges(vertexData.m_vertex, edges);
+  }
+
+  void GetIngoingEdgesList(astar::VertexData<Vertex, Weight> const & vertexData, EdgeListT & edges) override
+  {
+    GetEdges(vertexData.m_vertex, edges);
+  }
+
+private:
+  void GetEdges(Vertex v, EdgeListT & edges) const
+  {
+    edges.clear();
+    uint32_t const x = v % m_side;
+    uint32_t const y = v / m_side;
+    double const * weights = &m_weights[v * 4];
+    if (x > 0)
+      edges.emplace_back(v - 1, weights[0]);
+    if (x + 1 < m_side)
+      edges.emplace_back(v + 1, weights[1]);
+    if (y > 0)
+      edges.emplace_back(v - m_side, weights[2]);
+    if (y + 1 < m_side)
+      edges.emplace_back(v + m_side, weights[3]);
+  }
+
+  uint32_t m_side;
+  vector<double> m_weights;
+};
+
+template <typename QueuePolicy>
+double RunWaves(GridGraph & graph, char const * name)
+{
+  using Algorithm = AStarAlgorithm<uint32_t, GridEdge, double, QueuePolicy>;
+  Algorithm algorithm;
+  typename Algorithm::Context context(graph);
+
+  uint64_t settled = 0;
+  base::Timer timer;
+  for (uint32_t start = 0; start < graph.GetNumVertices(); start += graph.GetNumVertices() / 10)
+  {
+    algorithm.PropagateWave(graph, start, [&settled](uint32_t const & /* vertex */)
+    {
+      ++settled;
+      return true;
+    }, context);
+  }
+
+  double const settledPerSecond = settled / timer.ElapsedSeconds();
+  LOG(LINFO, (name, ":", settled, "vertices are settled,", settledPerSecond, "vertices per second."));
+  return settledPerSecond;
+}
+
+// Compares the queues on full Dijkstra waves which are dominated by the queue operations.
+UNIT_TEST(AStarQueue_GridWaves)
+{
+  GridGraph graph(700 /* side */, 0 /* seed */);
+
+  double const binary = RunWaves<astar::BinaryHeapQueue>(graph, "Binary heap");
+  double const fourAry = RunWaves<astar::DAryHeapQueue<4>>(graph, "4-ary heap");
+  double const eightAry = RunWaves<astar::DAryHeapQueue<8>>(graph, "8-ary heap");
+  LOG(LINFO, ("Speedup of 4-ary heap:", fourAry / binary, "8-ary heap:", eightAry / binary));
+}
+}  // namespace astar_queue_benchmark
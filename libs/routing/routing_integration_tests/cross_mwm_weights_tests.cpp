@@ -0,0 +1,70 @@
+#include "testing/testing.hpp"
+
+#include "routing/cross_mwm_connector.hpp"
+#include "routing/index_router.hpp"
+#include "routing/routing_callbacks.hpp"
+
+#include "routing/routing_integration_tests/routing_test_tools.hpp"
+
+#include "storage/country_info_getter.hpp"
+
+#include "geometry/latlon.hpp"
+#include "geometry/mercator.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace cross_mwm_weights_tests
+{
+using namespace routing;
+using namespace integration;
+using namespace std;
+
+// Routes don't depend on how the weights of cross-mwm connectors are read.
+void TestWeightsLoadModes(ms::LatLon const & start, ms::LatLon const & finish)
+{
+  auto & components = GetVehicleComponents(VehicleType::Car);
+  auto & router = dynamic_cast<IndexRouter &>(components.GetRouter());
+  auto const startPoint = mercator::FromLatLon(start);
+  auto const finishPoint = mercator::FromLatLon(finish);
+
+  router.SetCrossMwmWeightsLoadMode(connector::WeightsLoadMode::Lazy);
+  auto const [lazyRoute, lazyCode] = CalculateRoute(components, startPoint, m2::PointD::Zero(), finishPoint);
+  TEST_EQUAL(lazyCode, RouterResultCode::NoError, ());
+
+  set<string> countries;
+  for (auto const & point : lazyRoute->GetPoly().GetPoints())
+    countries.insert(components.GetCountryInfoGetter().GetRegionCountryId(point));
+  TEST_GREATER(countries.size(), 1, ());
+
+  for (auto const mode : {connector::WeightsLoadMode::Mapped, connector::WeightsLoadMode::Eager})
+  {
+    router.SetCrossMwmWeightsLoadMode(mode);
+    // The route is calculated while the connectors are loaded by the warm-up thread.
+    if (mode == connector::WeightsLoadMode::Eager)
+      router.WarmUpCrossMwmConnectors(vector<string>(countries.cbegin(), countries.cend()));
+
+    // The second route takes the connectors which are kept in Eager mode.
+    for (size_t i = 0; i < 2; ++i)
+    {
+      auto const [route, code] = CalculateRoute(components, startPoint, m2::PointD::Zero(), finishPoint);
+      TEST_EQUAL(code, RouterResultCode::NoError, (mode));
+      TEST_ALMOST_EQUAL_ABS(route->GetTotalTimeSec(), lazyRoute->GetTotalTimeSec(), 1e-3, (mode));
+      TEST_ALMOST_EQUAL_ABS(route->GetTotalDistanceMeters(), lazyRoute->GetTotalDistanceMeters(), 1e-3, (mode));
+    }
+  }
+
+  router.SetCrossMwmWeightsLoadMode(connector::WeightsLoadMode::Lazy);
+}
+
+UNIT_TEST(CrossMwmWeights_MoscowToTver)
+{
+  TestWeightsLoadModes({55.75100, 37.61790}, {56.85882, 35.90084});
+}
+
+UNIT_TEST(CrossMwmWeights_AustriaThroughGermany)
+{
+  TestWeightsLoadModes({47.7707543, 13.0557409}, {47.6500734, 12.7291784});
+}
+}  // namespace cross_mwm_weights_tests
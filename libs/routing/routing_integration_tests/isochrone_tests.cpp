@@ -0,0 +1,114 @@
+#include "testing/testing.hpp"
+
+#include "routing/index_router.hpp"
+#include "routing/router_delegate.hpp"
+#include "routing/routing_callbacks.hpp"
+
+#include "routing/routing_integration_tests/routing_test_tools.hpp"
+
+#include "coding/point_coding.hpp"
+
+#include "geometry/mercator.hpp"
+#include "geometry/point2d.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace isochrone_tests
+{
+using namespace routing;
+using namespace integration;
+using namespace std;
+
+// The hull is counterclockwise, so every point is to the left of every edge or on it. The hull is
+// built with the accuracy of the mwm points.
+bool IsInsideConvexHull(vector<m2::PointD> const & hull, m2::PointD const & point)
+{
+  for (size_t i = 0; i < hull.size(); ++i)
+  {
+    auto const & a = hull[i];
+    auto const & b = hull[(i + 1) % hull.size()];
+    if (m2::CrossProduct(b - a, point - a) < -kMwmPointAccuracy * (b - a).Length())
+      return false;
+  }
+  return true;
+}
+
+bool IsConvex(vector<m2::PointD> const & hull)
+{
+  for (size_t i = 0; i < hull.size(); ++i)
+  {
+    auto const & a = hull[i];
+    auto const & b = hull[(i + 1) % hull.size()];
+    auto const & c = hull[(i + 2) % hull.size()];
+    if (m2::CrossProduct(b - a, c - b) <= 0.0)
+      return false;
+  }
+  return true;
+}
+
+void TestIsochrone(ms::LatLon const & start, double maxTimeSec)
+{
+  auto & components = GetVehicleComponents(VehicleType::Car);
+  auto & router = dynamic_cast<IndexRouter &>(components.GetRouter());
+  auto const startPoint = mercator::FromLatLon(start);
+
+  RouterDelegate delegate;
+  IndexRouter::Isochrone isochrone;
+  TEST_EQUAL(router.CalculateIsochrone(startPoint, maxTimeSec, true /* buildHull */, delegate, isochrone),
+             RouterResultCode::NoError, ());
+  TEST(!isochrone.m_segments.empty(), ());
+
+  auto const & hull = isochrone.m_hull;
+  TEST_GREATER_OR_EQUAL(hull.size(), 3, ());
+  TEST(IsConvex(hull), (hull));
+  TEST(IsInsideConvexHull(hull, startPoint), ());
+
+  // The wave goes in the order of ETA.
+  double maxEta = 0.0;
+  for (auto const & reached : isochrone.m_segments)
+  {
+    TEST_LESS_OR_EQUAL(maxEta, reached.m_eta, (reached.m_segment));
+    TEST_LESS_OR_EQUAL(reached.m_eta, maxTimeSec, (reached.m_segment));
+    TEST(IsInsideConvexHull(hull, mercator::FromLatLon(reached.m_point)), (reached.m_point));
+    maxEta = max(maxEta, reached.m_eta);
+  }
+  // The wave stops at the time limit, not much earlier.
+  TEST_GREATER(maxEta, 0.8 * maxTimeSec, ());
+
+  // The routes to the reached points take the same time as the wave. The route may be snapped to
+  // another segment near the point, so some difference is allowed.
+  size_t const step = max<size_t>(1, isochrone.m_segments.size() / 10);
+  for (size_t i = 0; i < isochrone.m_segments.size(); i += step)
+  {
+    auto const & reached = isochrone.m_segments[i];
+    auto const [route, code] =
+        CalculateRoute(components, startPoint, m2::PointD::Zero(), mercator::FromLatLon(reached.m_point));
+    TEST_EQUAL(code, RouterResultCode::NoError, (reached.m_point));
+    TEST_LESS_OR_EQUAL(route->GetTotalTimeSec(), reached.m_eta + max(30.0, 0.1 * reached.m_eta),
+                       (reached.m_point, reached.m_eta));
+  }
+}
+
+UNIT_TEST(Isochrone_MoscowCenter)
+{
+  TestIsochrone({55.75100, 37.61790}, 5 * 60 /* maxTimeSec */);
+}
+
+UNIT_TEST(Isochrone_MoscowOutskirts)
+{
+  TestIsochrone({55.87445, 37.43711}, 10 * 60 /* maxTimeSec */);
+}
+
+UNIT_TEST(Isochrone_ZeroTime)
+{
+  auto & router = dynamic_cast<IndexRouter &>(GetVehicleComponents(VehicleType::Car).GetRouter());
+
+  RouterDelegate delegate;
+  IndexRouter::Isochrone isochrone;
+  TEST_EQUAL(router.CalculateIsochrone(mercator::FromLatLon(55.75100, 37.61790), 0.0 /* maxTimeSec */,
+                                       true /* buildHull */, delegate, isochrone),
+             RouterResultCode::NoError, ());
+  TEST(isochrone.m_segments.empty(), ());
+}
+}  // namespace isochrone_tests
@@ -0,0 +1,91 @@
+#include "testing/testing.hpp"
+
+#include "routing/index_router.hpp"
+#include "routing/router_delegate.hpp"
+#include "routing/routing_callbacks.hpp"
+
+#include "routing/routing_integration_tests/routing_test_tools.hpp"
+
+#include "geometry/latlon.hpp"
+#include "geometry/mercator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace matrix_tests
+{
+using namespace routing;
+using namespace integration;
+using namespace std;
+
+vector<m2::PointD> ToPoints(vector<ms::LatLon> const & latlons)
+{
+  vector<m2::PointD> points;
+  for (auto const & latlon : latlons)
+    points.push_back(mercator::FromLatLon(latlon));
+  return points;
+}
+
+// Checks the cells of the matrix against the routes calculated one by one.
+void TestMatrix(vector<ms::LatLon> const & sources, vector<ms::LatLon> const & targets)
+{
+  auto & components = GetVehicleComponents(VehicleType::Car);
+  auto & router = dynamic_cast<IndexRouter &>(components.GetRouter());
+  auto const sourcePoints = ToPoints(sources);
+  auto const targetPoints = ToPoints(targets);
+
+  RouterDelegate delegate;
+  IndexRouter::Matrix matrix;
+  TEST_EQUAL(router.CalculateMatrix(sourcePoints, targetPoints, delegate, matrix), RouterResultCode::NoError, ());
+  TEST_EQUAL(matrix.size(), sources.size(), ());
+
+  for (size_t i = 0; i < sources.size(); ++i)
+  {
+    TEST_EQUAL(matrix[i].size(), targets.size(), ());
+    for (size_t j = 0; j < targets.size(); ++j)
+    {
+      auto const [route, code] = CalculateRoute(components, sourcePoints[i], m2::PointD::Zero(), targetPoints[j]);
+      auto const & cell = matrix[i][j];
+      TEST_EQUAL(cell.m_code, code, (sources[i], targets[j]));
+      if (code != RouterResultCode::NoError)
+        continue;
+
+      // The routes are the same, the ETA of the matrix also has the penalty of the turn to the last segment.
+      double const eta = route->GetTotalTimeSec();
+      TEST_LESS_OR_EQUAL(fabs(cell.m_eta - eta), max(10.0, 0.01 * eta), (sources[i], targets[j], cell.m_eta));
+      double const distance = route->GetTotalDistanceMeters();
+      TEST_LESS_OR_EQUAL(fabs(cell.m_distance - distance), max(10.0, 0.01 * distance),
+                         (sources[i], targets[j], cell.m_distance));
+    }
+  }
+}
+
+UNIT_TEST(Matrix_Moscow)
+{
+  // The second target is on a segment of the second source, it's routed one by one.
+  TestMatrix({{55.75100, 37.61790}, {55.66216, 37.63259}, {55.87445, 37.43711}},
+             {{55.97310, 37.41460}, {55.66237, 37.63560}, {55.75718, 37.63156}, {55.66151, 37.63320}});
+}
+
+UNIT_TEST(Matrix_SourcesAreTargets)
+{
+  vector<ms::LatLon> const points = {{55.76073, 37.58011}, {55.75718, 37.63156}, {55.67695, 37.56220}};
+  TestMatrix(points, points);
+}
+
+UNIT_TEST(Matrix_Cancelled)
+{
+  auto & router = dynamic_cast<IndexRouter &>(GetVehicleComponents(VehicleType::Car).GetRouter());
+  vector<ms::LatLon> const points = {{55.76073, 37.58011}, {55.75718, 37.63156}};
+
+  RouterDelegate delegate;
+  delegate.Cancel();
+  IndexRouter::Matrix matrix;
+  TEST_EQUAL(router.CalculateMatrix(ToPoints(points), ToPoints(points), delegate, matrix), RouterResultCode::Cancelled,
+             ());
+  for (auto const & row : matrix)
+    for (auto const & cell : row)
+      TEST_EQUAL(cell.m_code, RouterResultCode::Cancelled, ());
+}
+}  // namespace matrix_tests
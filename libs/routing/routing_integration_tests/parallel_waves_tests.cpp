@@ -0,0 +1,67 @@
+#include "testing/testing.hpp"
+
+#include "routing/index_router.hpp"
+#include "routing/routing_callbacks.hpp"
+
+#include "routing/routing_integration_tests/routing_test_tools.hpp"
+
+#include "geometry/latlon.hpp"
+#include "geometry/mercator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace parallel_waves_tests
+{
+using namespace routing;
+using namespace integration;
+using namespace std;
+
+// Checks that the route found with the waves on two threads is as good as the one found with the waves
+// on one thread. The waves may meet at another vertex of the same weight, so the routes are compared
+// by time and distance.
+void TestParallelWaves(VehicleType vehicleType, ms::LatLon const & start, ms::LatLon const & finish)
+{
+  auto & components = GetVehicleComponents(vehicleType);
+  auto & router = dynamic_cast<IndexRouter &>(components.GetRouter());
+  auto const startPoint = mercator::FromLatLon(start);
+  auto const finishPoint = mercator::FromLatLon(finish);
+
+  router.SetParallelWaves(false);
+  auto const [sequentialRoute, sequentialCode] =
+      CalculateRoute(components, startPoint, m2::PointD::Zero(), finishPoint);
+
+  router.SetParallelWaves(true);
+  auto const [parallelRoute, parallelCode] = CalculateRoute(components, startPoint, m2::PointD::Zero(), finishPoint);
+  router.SetParallelWaves(false);
+
+  TEST_EQUAL(sequentialCode, RouterResultCode::NoError, ());
+  TEST_EQUAL(parallelCode, sequentialCode, ());
+
+  double const eta = sequentialRoute->GetTotalTimeSec();
+  TEST_LESS_OR_EQUAL(fabs(parallelRoute->GetTotalTimeSec() - eta), max(1.0, 0.001 * eta), ());
+  double const distance = sequentialRoute->GetTotalDistanceMeters();
+  TEST_LESS_OR_EQUAL(fabs(parallelRoute->GetTotalDistanceMeters() - distance), max(10.0, 0.01 * distance), ());
+}
+
+UNIT_TEST(ParallelWaves_CarMoscow)
+{
+  TestParallelWaves(VehicleType::Car, {55.75100, 37.61790}, {55.87445, 37.43711});
+}
+
+UNIT_TEST(ParallelWaves_CarNearMwms)
+{
+  // Moscow - Moscow Oblast East, the route is in Joints mode over two mwms.
+  TestParallelWaves(VehicleType::Car, {55.75100, 37.61790}, {55.80193, 38.43917});
+}
+
+UNIT_TEST(ParallelWaves_Pedestrian)
+{
+  TestParallelWaves(VehicleType::Pedestrian, {55.75100, 37.61790}, {55.73196, 37.60294});
+}
+
+UNIT_TEST(ParallelWaves_Bicycle)
+{
+  TestParallelWaves(VehicleType::Bicycle, {55.75100, 37.61790}, {55.66216, 37.63259});
+}
+}  // namespace parallel_waves_tests
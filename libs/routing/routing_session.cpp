@@ -222,6 +222,13 @@ bool RoutingSession::IsFollowing() const
   return m_isFollowing;
 }
 
+void RoutingSession::ClearRouterCaches()
+{
+  CHECK_THREAD_CHECKER(m_threadChecker, ());
+  ASSERT(m_router != nullptr, ());
+  m_router->ClearCaches();
+}
+
 void RoutingSession::Reset()
 {
   CHECK_THREAD_CHECKER(m_threadChecker, ());
@@ -79,6 +79,8 @@ public:
   bool IsOnRoute() const;
   bool IsFollowing() const;
   void Reset();
+  /// Clears the data the router keeps between the routes, e.g. when mwms are changed.
+  void ClearRouterCaches();
 
   void SetState(SessionState state);
 
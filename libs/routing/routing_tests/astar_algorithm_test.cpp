@@ -2,12 +2,16 @@
 
 #include "routing/base/astar_algorithm.hpp"
 #include "routing/base/astar_graph.hpp"
+#include "routing/base/astar_queue.hpp"
 #include "routing/base/routing_result.hpp"
 
 #include "routing/routing_tests/routing_algorithm.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -18,6 +22,7 @@ using namespace routing_test;
 using namespace std;
 
 using Algorithm = AStarAlgorithm<uint32_t, SimpleEdge, double>;
+using BinaryHeapAlgorithm = AStarAlgorithm<uint32_t, SimpleEdge, double, astar::BinaryHeapQueue>;
 
 void TestAStar(UndirectedGraph & graph, vector<unsigned> const & expectedRoute, double const & expectedDistance)
 {
@@ -151,4 +156,178 @@ UNIT_TEST(AdjustRouteOutOfLimit)
   TEST_EQUAL(code, Algorithm::Result::NoPath, ());
   TEST(result.m_path.empty(), ());
 }
+
+UNIT_TEST(AdjustRouteLoop)
+{
+  UndirectedGraph graph;
+  graph.AddEdge(0, 1, 1);
+  graph.AddEdge(1, 2, 1);
+  graph.AddEdge(2, 3, 1);
+  graph.AddEdge(3, 1, 1);
+  graph.AddEdge(1, 4, 1);
+  graph.AddEdge(6, 1, 1);
+
+  // The previous route passes vertex 1 twice. The route is adjusted to the last pass, so the loop is dropped.
+  vector<SimpleEdge> const prevRoute = {{0, 0}, {1, 1}, {2, 1}, {3, 1}, {1, 1}, {4, 1}};
+
+  auto checkLength = [](double weight) { return weight <= 1.0; };
+  Algorithm algo;
+  Algorithm::ParamsForTests<decltype(checkLength)> params(graph, 6 /* startVertex */, {} /* finishVertex */,
+                                                          std::move(checkLength));
+
+  RoutingResult<unsigned /* Vertex */, double /* Weight */> result;
+  auto const code = algo.AdjustRoute(params, prevRoute, result);
+
+  vector<unsigned> const expectedRoute = {6, 1, 4};
+  TEST_EQUAL(code, Algorithm::Result::OK, ());
+  TEST_EQUAL(result.m_path, expectedRoute, ());
+  TEST_EQUAL(result.m_distance, 2.0, ());
+}
+
+UNIT_TEST(AdjustRouteToFinishTree)
+{
+  UndirectedGraph graph;
+
+  // The route is long enough for the waves to switch, the backward one goes to the branch 298-1000-1001.
+  unsigned const finish = 300;
+  for (unsigned int i = 0; i < finish; ++i)
+    graph.AddEdge(i /* from */, i + 1 /* to */, 1 /* weight */);
+
+  graph.AddEdge(298, 1000, 1);
+  graph.AddEdge(1000, 1001, 1);
+  graph.AddEdge(1001, 1002, 1);
+
+  Algorithm algo;
+  Algorithm::FinishTree finishTree;
+  {
+    Algorithm::ParamsForTests<> params(graph, 0u /* startVertex */, finish);
+    params.m_backwardParents = &finishTree.m_next;
+    RoutingResult<unsigned /* Vertex */, double /* Weight */> result;
+    TEST_EQUAL(algo.FindPathBidirectional(params, result), Algorithm::Result::OK, ());
+    TEST_EQUAL(result.m_path.size(), finish + 1, ());
+  }
+
+  Algorithm::CalcFinishTreeDistances(graph, finish, finishTree);
+  TEST_EQUAL(finishTree.m_distances.at(1000), 3.0, ());
+
+  auto checkLength = [](double weight) { return weight <= 1.0; };
+  Algorithm::ParamsForTests<decltype(checkLength)> params(graph, 1002 /* startVertex */, {} /* finishVertex */,
+                                                          std::move(checkLength));
+  RoutingResult<unsigned /* Vertex */, double /* Weight */> result;
+  auto const code = algo.AdjustRoute(params, finishTree, result);
+
+  vector<unsigned> const expectedRoute = {1002, 1001, 1000, 298, 299, 300};
+  TEST_EQUAL(code, Algorithm::Result::OK, ());
+  TEST_EQUAL(result.m_path, expectedRoute, ());
+  TEST_EQUAL(result.m_distance, 5.0, ());
+}
+
+UNIT_TEST(FinishTreeDistances)
+{
+  UndirectedGraph graph;
+  graph.AddEdge(1, 2, 1 /* weight */);
+  graph.AddEdge(3, 5, 5 /* weight */);
+  graph.AddEdge(6, 3, 3 /* weight */);
+  graph.AddEdge(4, 9, 1 /* weight */);
+  graph.AddEdge(8, 7, 1 /* weight */);
+
+  Algorithm::FinishTree finishTree;
+  // There's no edge 7-5, so the tree doesn't lead from 7 and 8 to the final vertex.
+  finishTree.m_next = {{1, 2}, {2, 1}, {3, 5}, {4, 9}, {6, 3}, {7, 5}, {8, 7}};
+  Algorithm::CalcFinishTreeDistances(graph, 5u /* finalVertex */, finishTree);
+
+  // Vertices on the cycle and the ones which don't lead to the final vertex get no distance.
+  TEST_EQUAL(finishTree.m_distances.size(), 3, ());
+  TEST_EQUAL(finishTree.m_distances.at(5), 0.0, ());
+  TEST_EQUAL(finishTree.m_distances.at(3), 5.0, ());
+  TEST_EQUAL(finishTree.m_distances.at(6), 8.0, ());
+}
+
+UNIT_TEST(AStarAlgorithm_BidirectionalParallel)
+{
+  mt19937 rng(2);
+  UndirectedGraph graph;
+  for (uint32_t i = 0; i < 5000; ++i)
+    graph.AddEdge(rng() % 1000, rng() % 1000, 1 + rng() % 100);
+  // An isolated vertex.
+  graph.AddEdge(1000, 1000, 1);
+
+  // UndirectedGraph isn't changed by the waves, so both of them may use it.
+  Algorithm algo;
+  for (uint32_t finish = 1; finish <= 1000; finish += 13)
+  {
+    Algorithm::ParamsForTests<> params(graph, 0u /* startVertex */, finish);
+    RoutingResult<unsigned /* Vertex */, double /* Weight */> expected;
+    auto const expectedCode = algo.FindPathBidirectional(params, expected);
+
+    Algorithm::ParamsForTests<> forwardParams(graph, 0u /* startVertex */, finish);
+    Algorithm::ParamsForTests<> backwardParams(graph, 0u /* startVertex */, finish);
+    RoutingResult<unsigned /* Vertex */, double /* Weight */> actual;
+    auto const code = algo.FindPathBidirectionalParallel(forwardParams, backwardParams, actual);
+    TEST_EQUAL(static_cast<int>(code), static_cast<int>(expectedCode), (finish));
+    if (code != Algorithm::Result::OK)
+      continue;
+
+    TEST_ALMOST_EQUAL_ULPS(actual.m_distance, expected.m_distance, (finish));
+    TEST_EQUAL(actual.m_path.front(), 0, ());
+    TEST_EQUAL(actual.m_path.back(), finish, ());
+  }
+}
+
+UNIT_TEST(DAryHeap_Order)
+{
+  mt19937 rng(0);
+  astar::DAryHeap<uint32_t, 4> heap;
+  vector<uint32_t> values;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    // Pushes and pops are interleaved as in a wave.
+    if (!heap.empty() && rng() % 3 == 0)
+    {
+      auto const minIt = min_element(values.begin(), values.end());
+      TEST_EQUAL(heap.top(), *minIt, ());
+      values.erase(minIt);
+      heap.pop();
+    }
+
+    values.push_back(rng() % 100);
+    heap.push(values.back());
+    TEST_EQUAL(heap.size(), values.size(), ());
+  }
+
+  sort(values.begin(), values.end());
+  for (auto const value : values)
+  {
+    TEST_EQUAL(heap.top(), value, ());
+    heap.pop();
+  }
+  TEST(heap.empty(), ());
+}
+
+UNIT_TEST(AStarAlgorithm_QueuePolicies)
+{
+  mt19937 rng(1);
+  UndirectedGraph graph;
+  for (uint32_t i = 0; i < 3000; ++i)
+    graph.AddEdge(rng() % 500, rng() % 500, 1 + rng() % 100);
+
+  Algorithm algo;
+  BinaryHeapAlgorithm binaryHeapAlgo;
+  for (uint32_t finish = 1; finish < 500; finish += 7)
+  {
+    Algorithm::ParamsForTests<> params(graph, 0u /* startVertex */, finish);
+    BinaryHeapAlgorithm::ParamsForTests<> binaryHeapParams(graph, 0u /* startVertex */, finish);
+
+    RoutingResult<unsigned /* Vertex */, double /* Weight */> expected;
+    auto const expectedCode = binaryHeapAlgo.FindPath(binaryHeapParams, expected);
+
+    RoutingResult<unsigned /* Vertex */, double /* Weight */> actual;
+    TEST_EQUAL(static_cast<int>(algo.FindPath(params, actual)), static_cast<int>(expectedCode), (finish));
+    TEST_ALMOST_EQUAL_ULPS(actual.m_distance, expected.m_distance, (finish));
+
+    actual = {};
+    TEST_EQUAL(static_cast<int>(algo.FindPathBidirectional(params, actual)), static_cast<int>(expectedCode), (finish));
+    TEST_ALMOST_EQUAL_ULPS(actual.m_distance, expected.m_distance, (finish));
+  }
+}
 }  // namespace astar_algorithm_test
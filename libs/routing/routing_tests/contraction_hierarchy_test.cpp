@@ -0,0 +1,297 @@
+#include "testing/testing.hpp"
+
+#include "routing/routing_tests/index_graph_tools.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+#include "routing/contraction_hierarchy_builder.hpp"
+#include "routing/index_graph.hpp"
+#include "routing/index_graph_starter.hpp"
+
+#include "traffic/traffic_cache.hpp"
+
+#include "coding/reader.hpp"
+#include "coding/writer.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace contraction_hierarchy_test
+{
+using namespace routing;
+using namespace routing_test;
+using namespace std;
+
+using NodeId = ContractionHierarchy::NodeId;
+using Endpoint = ContractionHierarchy::Endpoint;
+
+// Edges in milliseconds, as the hierarchy keeps them.
+using Graph = vector<map<NodeId, uint64_t>>;
+
+vector<uint32_t> MakeNumeration(vector<uint32_t> const & pointsCounts)
+{
+  vector<uint32_t> featureFirstNode = {0};
+  for (auto const pointsCount : pointsCounts)
+    featureFirstNode.push_back(featureFirstNode.back() + ContractionHierarchy::GetNumNodesForFeature(pointsCount));
+  return featureFirstNode;
+}
+
+Graph MakeRandomGraph(uint32_t numNodes, uint32_t numEdges, uint32_t seed)
+{
+  mt19937 rng(seed);
+  Graph graph(numNodes);
+  for (uint32_t i = 0; i < numEdges; ++i)
+  {
+    NodeId const from = rng() % numNodes;
+    NodeId const to = rng() % numNodes;
+    if (from == to)
+      continue;
+
+    uint64_t const weight = 1 + rng() % 100000;
+    auto const [it, inserted] = graph[from].emplace(to, weight);
+    if (!inserted)
+      it->second = min(it->second, weight);
+  }
+  return graph;
+}
+
+ContractionHierarchy Build(Graph const & graph, vector<uint32_t> featureFirstNode)
+{
+  ContractionHierarchyBuilder builder(std::move(featureFirstNode));
+  for (NodeId from = 0; from < graph.size(); ++from)
+    for (auto const & [to, weight] : graph[from])
+      builder.AddEdge(from, to, weight / 1000.0);
+  return builder.Build();
+}
+
+// Builds the hierarchy over the segments of |graph| the same way the generator does.
+ContractionHierarchy Build(IndexGraph & graph, vector<uint32_t> const & pointsCounts)
+{
+  auto featureFirstNode = MakeNumeration(pointsCounts);
+  ContractionHierarchy const numeration(vector<uint32_t>(featureFirstNode),
+                                        vector<uint32_t>(featureFirstNode.back() + 1, 0), {});
+  ContractionHierarchyBuilder builder(std::move(featureFirstNode));
+
+  IndexGraph::SegmentEdgeListT edges;
+  for (NodeId node = 0; node < builder.GetNumNodes(); ++node)
+  {
+    edges.clear();
+    graph.GetEdgeList(numeration.GetSegment(node, kTestNumMwmId), true /* isOutgoing */,
+                      false /* useRoutingOptions */, edges);
+    for (auto const & edge : edges)
+      if (auto const target = numeration.GetNode(edge.GetTarget()))
+        builder.AddEdge(node, *target, edge.GetWeight().GetIntegratedWeight());
+  }
+  return builder.Build();
+}
+
+uint64_t Dijkstra(Graph const & graph, NodeId source, NodeId target)
+{
+  vector<uint64_t> weights(graph.size(), numeric_limits<uint64_t>::max());
+  using State = pair<uint64_t, NodeId>;
+  priority_queue<State, vector<State>, greater<State>> queue;
+  weights[source] = 0;
+  queue.emplace(0, source);
+  while (!queue.empty())
+  {
+    auto const [weight, node] = queue.top();
+    queue.pop();
+    if (node == target)
+      return weight;
+    if (weight > weights[node])
+      continue;
+
+    for (auto const & [to, edgeWeight] : graph[node])
+    {
+      if (weight + edgeWeight < weights[to])
+      {
+        weights[to] = weight + edgeWeight;
+        queue.emplace(weights[to], to);
+      }
+    }
+  }
+  return numeric_limits<uint64_t>::max();
+}
+
+void CheckPaths(Graph const & graph, ContractionHierarchy const & ch, uint32_t seed)
+{
+  mt19937 rng(seed);
+  for (size_t i = 0; i < 300; ++i)
+  {
+    NodeId const source = rng() % graph.size();
+    NodeId const target = rng() % graph.size();
+    uint64_t const expected = Dijkstra(graph, source, target);
+
+    ContractionHierarchy::Path path;
+    bool const found = ch.FindPath({{source, 0.0}}, {{target, 0.0}}, path);
+    TEST_EQUAL(found, expected != numeric_limits<uint64_t>::max(), (source, target));
+    if (!found)
+      continue;
+
+    TEST_ALMOST_EQUAL_ABS(path.m_weight, expected / 1000.0, 1e-6, (source, target));
+    TEST_EQUAL(path.m_nodes.front(), source, ());
+    TEST_EQUAL(path.m_nodes.back(), target, ());
+
+    // The unpacked path consists of the original edges.
+    uint64_t weight = 0;
+    for (size_t j = 0; j + 1 < path.m_nodes.size(); ++j)
+    {
+      auto const it = graph[path.m_nodes[j]].find(path.m_nodes[j + 1]);
+      TEST(it != graph[path.m_nodes[j]].end(), (path.m_nodes));
+      weight += it->second;
+    }
+    TEST_EQUAL(weight, expected, (path.m_nodes));
+  }
+}
+
+UNIT_TEST(ContractionHierarchy_Numeration)
+{
+  ContractionHierarchyBuilder builder(MakeNumeration({3, 0, 1, 2}));
+  TEST_EQUAL(builder.GetNumNodes(), 6, ());
+  auto const ch = builder.Build();
+
+  NumMwmId constexpr kMwmId = 7;
+  TEST_EQUAL(ch.GetNode(Segment(kMwmId, 0, 1, false /* forward */)), 3, ());
+  TEST_EQUAL(ch.GetNode(Segment(kMwmId, 3, 0, true /* forward */)), 4, ());
+  TEST(!ch.GetNode(Segment(kMwmId, 0, 2, true /* forward */)), ());
+  TEST(!ch.GetNode(Segment(kMwmId, 1, 0, true /* forward */)), ());
+  TEST(!ch.GetNode(Segment(kMwmId, 4, 0, true /* forward */)), ());
+
+  for (NodeId node = 0; node < ch.GetNumNodes(); ++node)
+    TEST_EQUAL(ch.GetNode(ch.GetSegment(node, kMwmId)), node, ());
+  TEST_EQUAL(ch.GetSegment(5, kMwmId), Segment(kMwmId, 3, 0, false /* forward */), ());
+}
+
+UNIT_TEST(ContractionHierarchy_RandomGraphs)
+{
+  for (uint32_t seed = 0; seed < 5; ++seed)
+  {
+    // 300 features of 2 points, i.e. 600 nodes.
+    auto const graph = MakeRandomGraph(600 /* numNodes */, 600 + seed * 500 /* numEdges */, seed);
+    CheckPaths(graph, Build(graph, MakeNumeration(vector<uint32_t>(300, 2))), seed);
+  }
+}
+
+UNIT_TEST(ContractionHierarchy_Grid)
+{
+  // A bidirectional grid with equal weights has many equal paths, witnesses are found for most of them.
+  uint32_t constexpr kSide = 20;
+  Graph graph(kSide * kSide);
+  for (uint32_t x = 0; x < kSide; ++x)
+  {
+    for (uint32_t y = 0; y < kSide; ++y)
+    {
+      NodeId const node = x * kSide + y;
+      if (x + 1 < kSide)
+      {
+        graph[node][node + kSide] = 1000;
+        graph[node + kSide][node] = 1000;
+      }
+      if (y + 1 < kSide)
+      {
+        graph[node][node + 1] = 1000;
+        graph[node + 1][node] = 1000;
+      }
+    }
+  }
+
+  auto const ch = Build(graph, MakeNumeration(vector<uint32_t>(kSide * kSide / 2, 2)));
+  CheckPaths(graph, ch, 0 /* seed */);
+}
+
+UNIT_TEST(ContractionHierarchy_SeveralEndpoints)
+{
+  // 0 -> 1 -> 2 -> 3, 4 -> 3.
+  Graph graph(6);
+  graph[0][1] = 1000;
+  graph[1][2] = 1000;
+  graph[2][3] = 1000;
+  graph[4][3] = 5000;
+  auto const ch = Build(graph, MakeNumeration({2, 2, 2}));
+
+  ContractionHierarchy::Path path;
+  TEST(ch.FindPath({{0, 10.0}, {4, 0.0}}, {{3, 1.0}}, path), ());
+  TEST_EQUAL(path.m_nodes, vector<NodeId>({4, 3}), ());
+  TEST_ALMOST_EQUAL_ABS(path.m_weight, 6.0, 1e-6, ());
+
+  TEST(ch.FindPath({{0, 1.0}, {4, 0.0}}, {{3, 1.0}, {2, 0.5}}, path), ());
+  TEST_EQUAL(path.m_nodes, vector<NodeId>({0, 1, 2}), ());
+  TEST_ALMOST_EQUAL_ABS(path.m_weight, 3.5, 1e-6, ());
+
+  // A node which is a source and a target at the same time.
+  TEST(ch.FindPath({{1, 1.0}}, {{1, 2.0}}, path), ());
+  TEST_EQUAL(path.m_nodes, vector<NodeId>({1}), ());
+
+  TEST(!ch.FindPath({{3, 0.0}}, {{0, 0.0}}, path), ());
+  TEST(!ch.FindPath({{5, 0.0}}, {{0, 0.0}}, path), ());
+}
+
+UNIT_TEST(ContractionHierarchy_Serialization)
+{
+  auto const graph = MakeRandomGraph(400 /* numNodes */, 1500 /* numEdges */, 42 /* seed */);
+  auto const ch = Build(graph, MakeNumeration(vector<uint32_t>(100, 3)));
+
+  vector<uint8_t> buffer;
+  {
+    MemWriter<vector<uint8_t>> writer(buffer);
+    ch.Serialize(writer);
+  }
+
+  ContractionHierarchy deserialized;
+  MemReader reader(buffer.data(), buffer.size());
+  ReaderSource<MemReader> src(reader);
+  deserialized.Deserialize(src);
+
+  TEST_EQUAL(deserialized.GetNumNodes(), ch.GetNumNodes(), ());
+  TEST_EQUAL(deserialized.GetNumEdges(), ch.GetNumEdges(), ());
+  CheckPaths(graph, deserialized, 42 /* seed */);
+}
+
+// Roads                             y:
+//
+//    R0  * - - - - - - - - - - - *      0
+//              ^           ^
+//          start/finish finish/start
+//
+//    x:  0     1     2     3
+//
+UNIT_TEST(ContractionHierarchy_RouteOnOneSegment)
+{
+  auto loader = make_unique<TestGeometryLoader>();
+  loader->AddRoad(0 /* featureId */, false /* oneWay */, 1.0 /* speed */,
+                  RoadGeometry::Points({{0.0, 0.0}, {3.0, 0.0}}));
+
+  traffic::TrafficCache const trafficCache;
+  auto worldGraph = BuildWorldGraph(std::move(loader), CreateEstimatorForCar(trafficCache), {} /* joints */);
+  auto const ch = Build(worldGraph->GetIndexGraphForTests(kTestNumMwmId), {2} /* pointsCounts */);
+
+  vector<Segment> const segments = {Segment(kTestNumMwmId, 0, 0, true /* forward */),
+                                    Segment(kTestNumMwmId, 0, 0, false /* forward */)};
+  vector<pair<m2::PointD, m2::PointD>> const endings = {{{1.0, 0.0}, {2.0, 0.0}}, {{2.0, 0.0}, {1.0, 0.0}}};
+  for (auto const & [from, to] : endings)
+  {
+    auto starter = MakeStarter(MakeFakeEnding(segments, from, *worldGraph), MakeFakeEnding(segments, to, *worldGraph),
+                               *worldGraph);
+
+    vector<Segment> route;
+    TEST(FindContractionHierarchyRoute(ch, kTestNumMwmId, *starter, route), (from, to));
+
+    // The route goes between the points right along the segment and doesn't loop through its ends.
+    for (auto const & segment : route)
+      TEST(IndexGraphStarter::IsFakeSegment(segment), (from, to, route));
+
+    vector<Segment> expectedRoute;
+    double expectedWeight = 0.0;
+    TEST_EQUAL(CalculateRoute(*starter, expectedRoute, expectedWeight), AlgorithmForWorldGraph::Result::OK, ());
+    auto const weight = CalcPathWeight(*starter, route);
+    TEST(weight, (from, to, route));
+    TEST_ALMOST_EQUAL_ABS(weight->GetWeight(), expectedWeight, 1e-6, (from, to));
+  }
+}
+}  // namespace contraction_hierarchy_test
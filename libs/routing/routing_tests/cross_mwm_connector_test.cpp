@@ -221,7 +221,7 @@ void GetCrossMwmId(uint32_t i, TransitId & id)
 }
 
 template <typename CrossMwmId>
-void TestWeightsSerialization()
+void TestWeightsSerialization(bool eager = false)
 {
   size_t constexpr kNumTransitions = 3;
   uint32_t constexpr segmentIdx = 1;
@@ -269,7 +269,10 @@ void TestWeightsSerialization()
   TEST(!test.connector.WeightsWereLoaded(), ());
   TEST(!test.connector.HasWeights(), ());
 
-  test.builder.DeserializeWeights(reader);
+  if (eager)
+    test.builder.DeserializeWeightsEager(reader);
+  else
+    test.builder.DeserializeWeights(reader);
 
   TEST(test.connector.WeightsWereLoaded(), ());
   TEST(test.connector.HasWeights(), ());
@@ -345,4 +348,10 @@ UNIT_TEST(CMWMC_WeightsSerialization)
   TestWeightsSerialization<base::GeoObjectId>();
   TestWeightsSerialization<TransitId>();
 }
+
+UNIT_TEST(CMWMC_WeightsSerializationEager)
+{
+  TestWeightsSerialization<base::GeoObjectId>(true /* eager */);
+  TestWeightsSerialization<TransitId>(true /* eager */);
+}
 }  // namespace cross_mwm_connector_test
@@ -8,6 +8,7 @@
 #include "routing/edge_estimator.hpp"
 #include "routing/fake_ending.hpp"
 #include "routing/index_graph.hpp"
+#include "routing/index_graph_loader.hpp"
 #include "routing/index_graph_serialization.hpp"
 #include "routing/index_graph_starter.hpp"
 #include "routing/index_router.hpp"
@@ -173,6 +174,96 @@ UNIT_TEST(EdgesTest)
                    {{kTestNumMwmId, 4, 0, true}, {kTestNumMwmId, 0, 2, true}, {kTestNumMwmId, 0, 3, false}});
 }
 
+// Two roads: a two-way road 0 and a one-way road 1 which starts at the end of road 0.
+unique_ptr<TestGeometryLoader> MakeTwoRoadsLoader()
+{
+  auto loader = make_unique<TestGeometryLoader>();
+  loader->AddRoad(0 /* featureId */, false, 1.0 /* speed */, RoadGeometry::Points({{0.0, 0.0}, {1.0, 0.0}}));
+  loader->AddRoad(1 /* featureId */, true, 1.0 /* speed */, RoadGeometry::Points({{1.0, 0.0}, {1.0, 1.0}}));
+  return loader;
+}
+
+// Graphs of different threads share the loaded data but keep their own geometry.
+UNIT_TEST(IndexGraph_SharedData)
+{
+  traffic::TrafficCache const trafficCache;
+  IndexGraphDataCache cache;
+  size_t loadsCount = 0;
+  auto const load = [&]()
+  {
+    ++loadsCount;
+    IndexGraph graph(make_shared<Geometry>(MakeTwoRoadsLoader()), CreateEstimatorForCar(trafficCache));
+    graph.Import({MakeJoint({{0, 1}, {1, 0}})});
+    return graph.GetData();
+  };
+
+  auto const data = cache.GetOrLoad(VehicleType::Car, kTestNumMwmId, load);
+  TEST_EQUAL(cache.GetOrLoad(VehicleType::Car, kTestNumMwmId, load), data, ());
+  TEST_EQUAL(loadsCount, 1, ());
+
+  IndexGraph graph1(make_shared<Geometry>(MakeTwoRoadsLoader()), CreateEstimatorForCar(trafficCache), data);
+  IndexGraph graph2(make_shared<Geometry>(MakeTwoRoadsLoader()), CreateEstimatorForCar(trafficCache), data);
+  for (auto * graph : {&graph1, &graph2})
+  {
+    TestOutgoingEdges(*graph, {kTestNumMwmId, 0 /* featureId */, 0 /* segmentIdx */, true /* forward */},
+                      {{kTestNumMwmId, 0, 0, false}, {kTestNumMwmId, 1, 0, true}});
+    TestIngoingEdges(*graph, {kTestNumMwmId, 1, 0, true}, {{kTestNumMwmId, 0, 0, true}});
+  }
+
+  cache.GetOrLoad(VehicleType::Pedestrian, kTestNumMwmId, load);
+  TEST_EQUAL(loadsCount, 2, ());
+  cache.Clear();
+  cache.GetOrLoad(VehicleType::Car, kTestNumMwmId, load);
+  TEST_EQUAL(loadsCount, 3, ());
+}
+
+UNIT_TEST(RoadGeometryCache_SizeBytes)
+{
+  size_t constexpr kMaxSizeBytes = 16 * 1024;
+  RoadGeometryCache cache(kMaxSizeBytes);
+  size_t loadsCount = 0;
+  auto const load = [&loadsCount](RoadGeometry & road)
+  {
+    ++loadsCount;
+    road = RoadGeometry(false /* oneWay */, 1.0 /* weightSpeedKMpH */, 1.0 /* etaSpeedKMpH */,
+                        RoadGeometry::Points({{0.0, 0.0}, {0.0, 1.0}, {1.0, 1.0}}));
+  };
+
+  uint32_t constexpr kRoadsCount = 1000;
+  for (uint32_t featureId = 0; featureId < kRoadsCount; ++featureId)
+    cache.GetOrLoad(0 /* sourceId */, featureId, load);
+  TEST_EQUAL(loadsCount, kRoadsCount, ());
+  TEST_LESS_OR_EQUAL(cache.GetSizeBytes(), kMaxSizeBytes, ());
+
+  // The most recently used road is kept and the least recently used one is evicted.
+  auto const road = cache.GetOrLoad(0 /* sourceId */, kRoadsCount - 1, load);
+  TEST_EQUAL(loadsCount, kRoadsCount, ());
+  TEST_EQUAL(road->GetPointsCount(), 3, ());
+  TEST_ALMOST_EQUAL_ABS(road->GetRoadLengthM(), road->GetDistance(0) + road->GetDistance(1), 1e-9, ());
+  cache.GetOrLoad(0 /* sourceId */, 0 /* featureId */, load);
+  TEST_EQUAL(loadsCount, kRoadsCount + 1, ());
+
+  cache.GetOrLoad(1 /* sourceId */, kRoadsCount - 1, load);
+  TEST_EQUAL(loadsCount, kRoadsCount + 2, ());
+
+  cache.Clear();
+  TEST_EQUAL(cache.GetSizeBytes(), 0, ());
+}
+
+// Geometries of the same mwm share the roads.
+UNIT_TEST(Geometry_SharedRoads)
+{
+  auto cache = make_shared<RoadGeometryCache>();
+  Geometry geometry1(MakeTwoRoadsLoader(), cache, 0 /* sourceId */);
+  Geometry geometry2(MakeTwoRoadsLoader(), cache, 0 /* sourceId */);
+  Geometry geometry3(MakeTwoRoadsLoader(), cache, 1 /* sourceId */);
+
+  TEST_EQUAL(&geometry1.GetRoad(0), &geometry2.GetRoad(0), ());
+  TEST_NOT_EQUAL(&geometry1.GetRoad(0), &geometry3.GetRoad(0), ());
+  TEST_EQUAL(geometry1.GetRoad(0).GetPointsCount(), 2, ());
+  TEST_GREATER(geometry1.GetRoad(0).GetDistance(0), 0.0, ());
+}
+
 //  Roads     R1:
 //
 //            -2
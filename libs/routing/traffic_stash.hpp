@@ -39,11 +39,15 @@ public:
     std::shared_ptr<TrafficStash> m_stash;
   };
 
+  using MwmToTraffic = std::unordered_map<NumMwmId, std::shared_ptr<traffic::TrafficInfo::Coloring const>>;
+
   TrafficStash(traffic::TrafficCache const & source, std::shared_ptr<NumMwmIds> numMwmIds);
 
   traffic::SpeedGroup GetSpeedGroup(Segment const & segment) const;
   void SetColoring(NumMwmId numMwmId, std::shared_ptr<traffic::TrafficInfo::Coloring const> coloring);
   bool Has(NumMwmId numMwmId) const;
+  /// \returns the traffic copied by the guard. The coloring of an mwm is replaced when traffic is updated.
+  MwmToTraffic const & GetTraffic() const { return m_mwmToTraffic; }
 
 private:
   void CopyTraffic();
@@ -52,6 +56,6 @@ private:
 
   traffic::TrafficCache const & m_source;
   std::shared_ptr<NumMwmIds> m_numMwmIds;
-  std::unordered_map<NumMwmId, std::shared_ptr<traffic::TrafficInfo::Coloring const>> m_mwmToTraffic;
+  MwmToTraffic m_mwmToTraffic;
 };
 }  // namespace routing
@@ -19,7 +19,8 @@ CBV CategoriesCache::Get(MwmContext const & context)
   if (it != m_cache.cend())
     return it->second;
 
-  auto cbv = Load(context);
+  // Categories are intersected with the features of every token and rect of the mwm.
+  auto cbv = Load(context).ToRoaring();
   m_cache[id] = cbv;
   return cbv;
 }
@@ -115,6 +115,13 @@ CBV CBV::Take(uint64_t n) const
   return CBV(m_p->LeaveFirstSetNBits(n));
 }
 
+CBV CBV::ToRoaring() const
+{
+  if (IsEmpty() || IsFull())
+    return *this;
+  return CBV(coding::RoaringCBV::BuildFromCBV(*m_p));
+}
+
 uint64_t CBV::Hash() const
 {
   if (IsEmpty())
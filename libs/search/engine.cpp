@@ -5,8 +5,10 @@
 #include "storage/country_info_getter.hpp"
 
 #include "indexer/categories_holder.hpp"
+#include "indexer/data_source.hpp"
 #include "indexer/search_string_utils.hpp"
 
+#include "base/logging.hpp"
 #include "base/scope_guard.hpp"
 #include "base/timer.hpp"
 
@@ -79,17 +81,26 @@ Engine::Params::Params(string const & locale, size_t numThreads) : m_locale(loca
 // Engine ------------------------------------------------------------------------------------------
 Engine::Engine(DataSource & dataSource, CategoriesHolder const & categories,
                storage::CountryInfoGetter const & infoGetter, Params const & params)
-  : m_shutdown(false)
+  : m_dataSource(dataSource)
+  , m_shutdown(false)
 {
   InitSuggestions doInit;
   categories.ForEachName(doInit);
   doInit.GetSuggests(m_suggests);
 
+  if (params.m_retrievalCacheBytes != 0)
+  {
+    m_retrievalCache = make_unique<RetrievalCache>(params.m_retrievalCacheBytes);
+    m_dataSource.AddObserver(*m_retrievalCache);
+  }
+
   m_contexts.resize(params.m_numThreads);
   for (size_t i = 0; i < params.m_numThreads; ++i)
   {
     auto processor = make_unique<Processor>(dataSource, categories, m_suggests, infoGetter);
     processor->SetPreferredLocale(params.m_locale);
+    processor->SetNumGeocoderThreads(params.m_numGeocoderThreads);
+    processor->SetRetrievalCache(m_retrievalCache.get());
     m_contexts[i].m_processor = std::move(processor);
   }
 
@@ -112,6 +123,12 @@ Engine::~Engine()
 
   for (auto & thread : m_threads)
     thread.join();
+
+  if (m_retrievalCache)
+  {
+    LOG(LINFO, (m_retrievalCache->GetStats()));
+    m_dataSource.RemoveObserver(*m_retrievalCache);
+  }
 }
 
 weak_ptr<ProcessorHandle> Engine::Search(SearchParams params)
@@ -134,9 +151,17 @@ size_t Engine::GetNumThreads() const
 
 void Engine::ClearCaches()
 {
+  if (m_retrievalCache)
+    m_retrievalCache->Clear();
+
   PostMessage(Message::TYPE_BROADCAST, [](Processor & processor) { processor.ClearCaches(); });
 }
 
+RetrievalCache::Stats Engine::GetRetrievalCacheStats() const
+{
+  return m_retrievalCache ? m_retrievalCache->GetStats() : RetrievalCache::Stats();
+}
+
 void Engine::CacheWorldLocalities()
 {
   PostMessage(Message::TYPE_BROADCAST, [](Processor & processor) { processor.CacheWorldLocalities(); });
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "search/retrieval_cache.hpp"
 #include "search/search_params.hpp"
 #include "search/suggest.hpp"
 
@@ -80,6 +81,16 @@ public:
     // to process queries. Use this field wisely as large values may
     // negatively affect performance due to false sharing.
     size_t m_numThreads;
+
+    // Number of threads every processor uses to geocode a single everywhere
+    // query in several mwms at once. Useful on servers with many cores and
+    // few concurrent queries. 1 means that mwms are processed one by one.
+    size_t m_numGeocoderThreads = 1;
+
+    // Memory limit of the address features cache which is shared by all
+    // processors. Useful when the same tokens are searched again and again.
+    // 0 disables the cache.
+    size_t m_retrievalCacheBytes = 0;
   };
 
   // Doesn't take ownership of dataSource and categories.
@@ -99,6 +110,9 @@ public:
   // Posts request to clear caches to the queue.
   void ClearCaches();
 
+  // Returns hit rate and memory usage of the shared retrieval cache, all zeroes if it's disabled.
+  RetrievalCache::Stats GetRetrievalCacheStats() const;
+
   // Posts requests to load and cache localities from World.mwm.
   void CacheWorldLocalities();
 
@@ -170,6 +184,9 @@ private:
 
   std::vector<Suggest> m_suggests;
 
+  DataSource & m_dataSource;
+  std::unique_ptr<RetrievalCache> m_retrievalCache;
+
   bool m_shutdown;
   std::mutex m_mu;
   std::condition_variable m_cv;
@@ -9,8 +9,10 @@
 #include "search/locality_scorer.hpp"
 #include "search/pre_ranker.hpp"
 #include "search/retrieval.hpp"
+#include "search/retrieval_cache.hpp"
 #include "search/token_slice.hpp"
 #include "search/tracer.hpp"
+#include "search/type_ahead_session.hpp"
 #include "search/utils.hpp"
 
 #include "storage/country_info_getter.hpp"
@@ -36,8 +38,13 @@
 #include "base/macros.hpp"
 #include "base/scope_guard.hpp"
 #include "base/stl_helpers.hpp"
+#include "base/thread_pool_computational.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
 
 #include "defines.hpp"
 
@@ -342,10 +349,59 @@ Geocoder::Geocoder(DataSource const & dataSource, storage::CountryInfoGetter con
   , m_preRanker(preRanker)
 {}
 
+// Geocoder::Worker --------------------------------------------------------------------------------
+struct Geocoder::Worker
+{
+  explicit Worker(Geocoder const & geocoder)
+    : m_localitiesCaches(geocoder.m_cancellable)
+    , m_geocoder(geocoder.m_dataSource, geocoder.m_infoGetter, geocoder.m_categories, geocoder.m_citiesBoundaries,
+                 geocoder.m_preRanker, m_localitiesCaches, geocoder.m_cancellable)
+  {}
+
+  LocalitiesCaches m_localitiesCaches;
+  Geocoder m_geocoder;
+};
+
+// Geocoder ----------------------------------------------------------------------------------------
 Geocoder::~Geocoder() {}
 
+void Geocoder::SetNumThreads(size_t numThreads)
+{
+  CHECK_GREATER(numThreads, 0, ());
+
+  m_threadPool.reset();
+  m_workers.clear();
+  if (numThreads == 1)
+    return;
+
+  m_threadPool = make_unique<base::ComputationalThreadPool>(numThreads);
+  for (size_t i = 0; i < numThreads; ++i)
+  {
+    m_workers.push_back(make_unique<Worker>(*this));
+    m_workers.back()->m_geocoder.SetRetrievalCache(m_retrievalCache);
+    m_workers.back()->m_geocoder.SetTypeAheadSession(m_typeAheadSession);
+  }
+}
+
+void Geocoder::SetRetrievalCache(RetrievalCache * cache)
+{
+  m_retrievalCache = cache;
+  for (auto & worker : m_workers)
+    worker->m_geocoder.SetRetrievalCache(cache);
+}
+
+void Geocoder::SetTypeAheadSession(TypeAheadSession * session)
+{
+  m_typeAheadSession = session;
+  for (auto & worker : m_workers)
+    worker->m_geocoder.SetTypeAheadSession(session);
+}
+
 void Geocoder::SetParams(Params const & params)
 {
+  for (auto & worker : m_workers)
+    worker->m_geocoder.SetParams(params);
+
   if (params.IsCategorialRequest())
   {
     SetParamsForCategorialSearch(params);
@@ -424,6 +480,12 @@ void Geocoder::Finish(bool cancelled)
 
 void Geocoder::ClearCaches()
 {
+  for (auto & worker : m_workers)
+  {
+    worker->m_geocoder.ClearCaches();
+    worker->m_localitiesCaches.Clear();
+  }
+
   m_pivotRectsCache.Clear();
   m_localityRectsCache.Clear();
 
@@ -562,79 +624,185 @@ void Geocoder::GoImpl(vector<MwmInfoPtr> const & infos, bool inViewport)
   // found.
   auto const infosWithType = OrderCountries(inViewport, infos);
 
-  // MatchAroundPivot() should always be matched in mwms
-  // intersecting with position and viewport.
-  auto processCountry = [&](unique_ptr<MwmContext> context, bool updatePreranker)
+  // The tracer sees the results in the order of emitting, so it's possible only with one thread.
+  if (!m_workers.empty() && !inViewport && !m_params.m_tracer)
   {
-    ASSERT(context, ());
-    m_context = std::move(context);
+    GoInParallel(infosWithType);
+    return;
+  }
 
-    SCOPE_GUARD(cleanup, [&]()
-    {
-      LOG(LDEBUG, (m_context->GetName(), "geocoding complete."));
-      m_matcher->OnQueryFinished();
-      m_matcher = nullptr;
-      m_context.reset();
-    });
+  // Iterates through all alive mwms and performs geocoding.
+  ForEachCountry(infosWithType, [&](unique_ptr<MwmContext> context, bool updatePreranker)
+  {
+    ProcessCountry(std::move(context), inViewport);
 
-    auto it = m_matchersCache.find(m_context->GetId());
-    if (it == m_matchersCache.end())
-    {
-      it = m_matchersCache
-               .insert(
-                   make_pair(m_context->GetId(), std::make_unique<FeaturesLayerMatcher>(m_dataSource, m_cancellable)))
-               .first;
-    }
-    m_matcher = it->second.get();
-    m_matcher->SetContext(m_context.get());
+    if (updatePreranker)
+      m_preRanker.UpdateResults(false /* lastUpdate */);
 
-    BaseContext ctx;
-    InitBaseContext(ctx);
+    if (m_preRanker.IsFull())
+      return base::ControlFlow::Break;
 
-    if (inViewport)
-    {
-      auto const viewportCBV = RetrieveGeometryFeatures(*m_context, m_params.m_pivot, RectId::Pivot);
-      for (auto & features : ctx.m_features)
-        features = features.Intersect(viewportCBV);
-    }
+    return base::ControlFlow::Continue;
+  });
+}
 
-    ctx.m_villages = m_localitiesCaches.m_villages.Get(*m_context);
+void Geocoder::GoInParallel(ExtendedMwmInfos const & infos)
+{
+  for (auto & worker : m_workers)
+    worker->m_geocoder.CopyLocalities(*this);
 
-    auto const citiesFromWorld = m_cities;
-    FillVillageLocalities(ctx);
-    SCOPE_GUARD(remove_villages, [&]() { m_cities = citiesFromWorld; });
+  atomic<size_t> nextMwm = 0;
+  atomic<bool> stop = false;
 
-    if (m_params.IsCategorialRequest())
-    {
-      MatchCategories(ctx, m_context->GetType().m_viewportIntersected /* aroundPivot */);
-    }
-    else
+  mutex mu;
+  condition_variable cv;
+  size_t numProcessed = 0;
+  size_t numFinished = 0;
+
+  vector<future<void>> results;
+  results.reserve(m_workers.size());
+  for (auto & worker : m_workers)
+  {
+    results.push_back(m_threadPool->Submit([&, &geocoder = worker->m_geocoder]()
     {
-      MatchRegions(ctx, Region::TYPE_COUNTRY);
+      SCOPE_GUARD(finish, [&]()
+      {
+        lock_guard<mutex> lock(mu);
+        ++numFinished;
+        cv.notify_one();
+      });
+
+      for (size_t i = nextMwm++; i < infos.m_infos.size() && !stop; i = nextMwm++)
+      {
+        if (m_preRanker.IsFull())
+          break;
+
+        if (auto context = GetCountryContext(infos.m_infos[i]))
+          geocoder.ProcessCountry(std::move(context), false /* inViewport */);
+
+        lock_guard<mutex> lock(mu);
+        ++numProcessed;
+        cv.notify_one();
+      }
+    }));
+  }
 
-      // Probably, we should process all MWMs "until the end" but I left some _better-than-before_
-      // reasonable criteria (ContinueSearch) not to hang a lot.
-      auto const & mwmType = m_context->GetType();
-      if (mwmType.m_viewportIntersected || mwmType.m_containsUserPosition || m_preRanker.ContinueSearch())
-        MatchAroundPivot(ctx);
+  // The tasks reference the locals above, so they must be finished even if UpdateResults() throws.
+  SCOPE_GUARD(waitWorkers, [&]()
+  {
+    stop = true;
+    for (auto & result : results)
+      result.wait();
+  });
+
+  // Pre-ranker updates are done on this thread only, as in the sequential mode: the ranker
+  // emits results to the client.
+  size_t numUpdated = 0;
+  while (true)
+  {
+    {
+      unique_lock<mutex> lock(mu);
+      cv.wait(lock, [&]() { return numProcessed != numUpdated || numFinished == m_workers.size(); });
+      if (numFinished == m_workers.size())
+        break;
+      numUpdated = numProcessed;
     }
 
-    if (updatePreranker)
+    if (numUpdated >= infos.m_firstBatchSize)
       m_preRanker.UpdateResults(false /* lastUpdate */);
+  }
 
-    if (m_preRanker.IsFull())
-      return base::ControlFlow::Break;
+  // Rethrows CancelException or any other exception of the workers.
+  for (auto & result : results)
+    result.get();
+}
 
-    return base::ControlFlow::Continue;
-  };
+void Geocoder::CopyLocalities(Geocoder const & geocoder)
+{
+  m_worldId = geocoder.m_worldId;
+  m_cities = geocoder.m_cities;
+  for (size_t i = 0; i < Region::TYPE_COUNT; ++i)
+    m_regions[i] = geocoder.m_regions[i];
+}
 
-  // Iterates through all alive mwms and performs geocoding.
-  ForEachCountry(infosWithType, processCountry);
+void Geocoder::ProcessCountry(unique_ptr<MwmContext> context, bool inViewport)
+{
+  ASSERT(context, ());
+  m_context = std::move(context);
+
+  SCOPE_GUARD(cleanup, [&]()
+  {
+    LOG(LDEBUG, (m_context->GetName(), "geocoding complete."));
+    m_matcher->OnQueryFinished();
+    m_matcher = nullptr;
+    m_context.reset();
+  });
+
+  auto it = m_matchersCache.find(m_context->GetId());
+  if (it == m_matchersCache.end())
+  {
+    it = m_matchersCache
+             .insert(make_pair(m_context->GetId(), std::make_unique<FeaturesLayerMatcher>(m_dataSource, m_cancellable)))
+             .first;
+  }
+  m_matcher = it->second.get();
+  m_matcher->SetContext(m_context.get());
+
+  BaseContext ctx;
+  InitBaseContext(ctx);
+
+  if (inViewport)
+  {
+    auto const viewportCBV = RetrieveGeometryFeatures(*m_context, m_params.m_pivot, RectId::Pivot);
+    for (auto & features : ctx.m_features)
+      features = features.Intersect(viewportCBV);
+  }
+
+  ctx.m_villages = m_localitiesCaches.m_villages.Get(*m_context);
+
+  auto const citiesFromWorld = m_cities;
+  FillVillageLocalities(ctx);
+  SCOPE_GUARD(remove_villages, [&]() { m_cities = citiesFromWorld; });
+
+  if (m_params.IsCategorialRequest())
+  {
+    MatchCategories(ctx, m_context->GetType().m_viewportIntersected /* aroundPivot */);
+  }
+  else
+  {
+    MatchRegions(ctx, Region::TYPE_COUNTRY);
+
+    // MatchAroundPivot() should always be matched in mwms intersecting with position and viewport.
+    // Probably, we should process all MWMs "until the end" but I left some _better-than-before_
+    // reasonable criteria (ContinueSearch) not to hang a lot.
+    auto const & mwmType = m_context->GetType();
+    if (mwmType.m_viewportIntersected || mwmType.m_containsUserPosition || m_preRanker.ContinueSearch())
+      MatchAroundPivot(ctx);
+  }
+}
+
+unique_ptr<MwmContext> Geocoder::GetCountryContext(ExtendedMwmInfos::ExtendedMwmInfo const & extendedInfo) const
+{
+  auto const & info = extendedInfo.m_info;
+  if (info->GetType() != MwmInfo::COUNTRY && info->GetType() != MwmInfo::WORLD)
+    return {};
+  if (info->GetType() == MwmInfo::COUNTRY && m_params.m_mode == Mode::Downloader)
+    return {};
+
+  auto handle = m_dataSource.GetMwmHandleById(MwmSet::MwmId(info));
+  if (!handle.IsAlive())
+    return {};
+  auto & value = *handle.GetValue();
+  if (!value.HasSearchIndex() || !value.HasGeometryIndex())
+    return {};
+  return make_unique<MwmContext>(std::move(handle), extendedInfo.m_type);
 }
 
 void Geocoder::InitBaseContext(BaseContext & ctx)
 {
   Retrieval retrieval(*m_context, m_cancellable);
+  // The editor is asked once per mwm, not per token.
+  bool const useRetrievalCache = m_retrievalCache && RetrievalCache::CanCache(*m_context);
 
   size_t const numTokens = m_params.GetNumTokens();
   ctx.m_tokens.assign(numTokens, BaseContext::TOKEN_TYPE_COUNT);
@@ -648,13 +816,9 @@ void Geocoder::InitBaseContext(BaseContext & ctx)
       CategoriesCache cache(m_params.m_preferredTypes, m_cancellable);
       ctx.m_features[i] = Retrieval::ExtendedFeatures(cache.Get(*m_context));
     }
-    else if (m_params.IsPrefixToken(i))
-    {
-      ctx.m_features[i] = retrieval.RetrieveAddressFeatures(m_prefixTokenRequest);
-    }
     else
     {
-      ctx.m_features[i] = retrieval.RetrieveAddressFeatures(m_tokenRequests[i]);
+      ctx.m_features[i] = RetrieveAddressFeatures(retrieval, i, useRetrievalCache);
     }
   }
 
@@ -872,21 +1036,11 @@ void Geocoder::ForEachCountry(ExtendedMwmInfos const & extendedInfos, Fn && fn)
 {
   for (size_t i = 0; i < extendedInfos.m_infos.size(); ++i)
   {
-    auto const & info = extendedInfos.m_infos[i].m_info;
-    if (info->GetType() != MwmInfo::COUNTRY && info->GetType() != MwmInfo::WORLD)
-      continue;
-    if (info->GetType() == MwmInfo::COUNTRY && m_params.m_mode == Mode::Downloader)
-      continue;
-
-    auto handle = m_dataSource.GetMwmHandleById(MwmSet::MwmId(info));
-    if (!handle.IsAlive())
-      continue;
-    auto & value = *handle.GetValue();
-    if (!value.HasSearchIndex() || !value.HasGeometryIndex())
+    auto context = GetCountryContext(extendedInfos.m_infos[i]);
+    if (!context)
       continue;
     bool const updatePreranker = i + 1 >= extendedInfos.m_firstBatchSize;
-    auto const & mwmType = extendedInfos.m_infos[i].m_type;
-    if (fn(make_unique<MwmContext>(std::move(handle), mwmType), updatePreranker) == base::ControlFlow::Break)
+    if (fn(std::move(context), updatePreranker) == base::ControlFlow::Break)
       break;
   }
 }
@@ -1900,6 +2054,32 @@ void Geocoder::MatchUnclassified(BaseContext & ctx, size_t curToken)
   allFeatures.ForEach(emitUnclassified);
 }
 
+Retrieval::ExtendedFeatures Geocoder::RetrieveAddressFeatures(Retrieval const & retrieval, size_t tokenIndex,
+                                                              bool useRetrievalCache)
+{
+  auto const retrieve = [&]()
+  {
+    if (m_params.IsPrefixToken(tokenIndex))
+      return retrieval.RetrieveAddressFeatures(m_prefixTokenRequest);
+    return retrieval.RetrieveAddressFeatures(m_tokenRequests[tokenIndex]);
+  };
+
+  if (!useRetrievalCache)
+    return retrieve();
+
+  auto key = RetrievalCache::MakeKey(*m_context, m_params, tokenIndex);
+  Retrieval::ExtendedFeatures features;
+  bool const found = m_typeAheadSession && m_params.IsPrefixToken(tokenIndex)
+                         ? m_retrievalCache->FindNarrowed(key, m_typeAheadSession->GetWiderPrefixRequest(), features)
+                         : m_retrievalCache->Find(key, features);
+  if (found)
+    return features;
+
+  features = retrieve();
+  m_retrievalCache->Insert(std::move(key), features);
+  return features;
+}
+
 CBV Geocoder::RetrievePostcodeFeatures(MwmContext const & context, TokenSlice const & slice)
 {
   Retrieval retrieval(context, m_cancellable);
@@ -39,6 +39,11 @@ class CategoriesHolder;
 class DataSource;
 class MwmValue;
 
+namespace base
+{
+class ComputationalThreadPool;
+}  // namespace base
+
 namespace storage
 {
 class CountryInfoGetter;
@@ -49,7 +54,9 @@ namespace search
 class FeaturesFilter;
 class FeaturesLayerMatcher;
 class PreRanker;
+class RetrievalCache;
 class TokenSlice;
+class TypeAheadSession;
 
 // This class is used to retrieve all features corresponding to a
 // search query.  Search query is represented as a sequence of tokens
@@ -102,6 +109,18 @@ public:
            LocalitiesCaches & localitiesCaches, base::Cancellable const & cancellable);
   ~Geocoder();
 
+  // Sets the number of threads which geocode a single everywhere query in several mwms at once.
+  // Every thread has its own mwm caches. 1 means that mwms are processed one by one on the
+  // caller's thread.
+  void SetNumThreads(size_t numThreads);
+
+  // Sets the cache of address features which is shared with other geocoders, may be nullptr.
+  void SetRetrievalCache(RetrievalCache * cache);
+
+  // Sets the session of queries typed by the user which is shared with the geocoder threads, may be nullptr.
+  // The session is used only with the retrieval cache.
+  void SetTypeAheadSession(TypeAheadSession * session);
+
   // Sets search query params.
   void SetParams(Params const & params);
 
@@ -127,6 +146,9 @@ public:
   void ClearCaches();
 
 private:
+  // Geocoder of a single thread of the parallel geocoding with its own localities caches.
+  struct Worker;
+
   enum class RectId
   {
     Pivot,
@@ -183,6 +205,19 @@ private:
 
   void GoImpl(std::vector<MwmInfoPtr> const & infos, bool inViewport);
 
+  // Geocodes countries from |infos| on |m_workers|. Countries are taken in the order of |infos|
+  // while the pre-ranker is not full.
+  void GoInParallel(ExtendedMwmInfos const & infos);
+
+  // Copies the localities of the query which are matched in World.mwm by |geocoder|.
+  void CopyLocalities(Geocoder const & geocoder);
+
+  // Performs geocoding in the mwm of |context| and emits results to |m_preRanker|.
+  void ProcessCountry(std::unique_ptr<MwmContext> context, bool inViewport);
+
+  // Returns nullptr when the mwm of |extendedInfo| can't be searched.
+  std::unique_ptr<MwmContext> GetCountryContext(ExtendedMwmInfos::ExtendedMwmInfo const & extendedInfo) const;
+
   template <typename Locality>
   using TokenToLocalities = std::map<TokenRange, std::vector<Locality>>;
 
@@ -286,6 +321,11 @@ private:
   // UNCLASSIFIED objects that match to all currently unused tokens.
   void MatchUnclassified(BaseContext & ctx, size_t curToken);
 
+  // A caching wrapper around Retrieval::RetrieveAddressFeatures for the |tokenIndex|-th token.
+  // |useRetrievalCache| is false when there is no cache or the mwm can't be cached, see RetrievalCache::CanCache().
+  Retrieval::ExtendedFeatures RetrieveAddressFeatures(Retrieval const & retrieval, size_t tokenIndex,
+                                                      bool useRetrievalCache);
+
   // A wrapper around RetrievePostcodeFeatures.
   CBV RetrievePostcodeFeatures(MwmContext const & context, TokenSlice const & slice);
 
@@ -370,5 +410,12 @@ private:
   ResultTracer m_resultTracer;
 
   PreRanker & m_preRanker;
+
+  RetrievalCache * m_retrievalCache = nullptr;
+  TypeAheadSession * m_typeAheadSession = nullptr;
+
+  // Parallel geocoding of everywhere queries, empty when mwms are processed one by one.
+  std::unique_ptr<base::ComputationalThreadPool> m_threadPool;
+  std::vector<std::unique_ptr<Worker>> m_workers;
 };
 }  // namespace search
@@ -78,6 +78,9 @@ void PreRanker::Init(Params const & params)
 {
   m_numSentResults = 0;
   m_haveFullyMatchedResult = false;
+  m_rankerIsFull = false;
+  m_numTakenResults = 0;
+  m_newResults.clear();
   m_results.clear();
   m_relaxedResults.clear();
   m_params = params;
@@ -249,14 +252,28 @@ void PreRanker::Filter()
 
 void PreRanker::UpdateResults(bool lastUpdate)
 {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    ASSERT(m_results.empty(), ());
+    m_results.swap(m_newResults);
+    m_numTakenResults = m_results.size() + m_relaxedResults.size();
+  }
+
   FilterRelaxedResults(lastUpdate);
   FillMissingFieldsInPreResults();
   Filter();
-  m_numSentResults += m_results.size();
+  size_t const numResults = m_results.size();
   m_ranker.AddPreRankerResults(std::move(m_results));
   m_results.clear();
   m_ranker.UpdateResults(lastUpdate);
 
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_numSentResults += numResults;
+    m_numTakenResults = m_relaxedResults.size();
+    m_rankerIsFull = m_ranker.IsFull();
+  }
+
   if (lastUpdate && !m_currEmit.empty())
     m_currEmit.swap(m_prevEmit);
 }
@@ -10,6 +10,7 @@
 #include "base/macros.hpp"
 
 #include <limits>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <unordered_set>
@@ -20,6 +21,8 @@ class DataSource;
 namespace search
 {
 // Fast and simple pre-ranker for search results.
+// Results may be emplaced from several geocoder threads at once, see Geocoder::SetNumThreads(),
+// but UpdateResults() and the rest of the pipeline run on the query thread only.
 class PreRanker
 {
 public:
@@ -64,16 +67,21 @@ public:
 
   void Finish(bool cancelled);
 
-  bool IsFull() const { return m_numSentResults >= Limit() || m_ranker.IsFull(); }
+  bool IsFull() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return IsFullImpl();
+  }
 
   template <typename... Args>
   void Emplace(Args &&... args)
   {
-    if (IsFull())
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (IsFullImpl())
       return;
 
-    m_results.emplace_back(std::forward<Args>(args)...);
-    if (m_results.back().GetInfo().m_allTokensUsed)
+    m_newResults.emplace_back(std::forward<Args>(args)...);
+    if (m_newResults.back().GetInfo().m_allTokensUsed)
       m_haveFullyMatchedResult = true;
   }
 
@@ -81,13 +89,25 @@ public:
   // Use |lastUpdate| to indicate that no more results will be added.
   void UpdateResults(bool lastUpdate);
 
-  size_t Size() const { return m_results.size() + m_relaxedResults.size(); }
+  size_t Size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return SizeImpl();
+  }
   size_t BatchSize() const
   {
     return m_params.m_viewportSearch ? std::numeric_limits<size_t>::max() : m_params.m_everywhereBatchSize;
   }
-  size_t NumSentResults() const { return m_numSentResults; }
-  bool ContinueSearch() const { return !m_haveFullyMatchedResult || Size() < BatchSize(); }
+  size_t NumSentResults() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numSentResults;
+  }
+  bool ContinueSearch() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_haveFullyMatchedResult || SizeImpl() < BatchSize();
+  }
   size_t Limit() const { return m_params.m_limit; }
 
   // Iterate results per-MWM clusters.
@@ -133,6 +153,10 @@ public:
   void ClearCaches();
 
 private:
+  // Following methods must be called with |m_mutex| locked.
+  bool IsFullImpl() const { return m_numSentResults >= Limit() || m_rankerIsFull; }
+  size_t SizeImpl() const { return m_newResults.size() + m_numTakenResults; }
+
   // Computes missing fields for all pre-results.
   void FillMissingFieldsInPreResults();
   void DbgFindAndLog(std::set<uint32_t> const & ids) const;
@@ -145,7 +169,12 @@ private:
   Ranker & m_ranker;
 
   using PreResultsContainerT = std::vector<PreRankerResult>;
+  // Results emplaced since the last UpdateResults(), guarded by |m_mutex|.
+  PreResultsContainerT m_newResults;
+  // Results of the current update and relaxed results, used on the query thread only.
   PreResultsContainerT m_results, m_relaxedResults;
+  // Size of |m_results| and |m_relaxedResults| for the other threads, guarded by |m_mutex|.
+  size_t m_numTakenResults = 0;
 
   Params m_params;
 
@@ -155,6 +184,9 @@ private:
   // True iff there is at least one result with all tokens used (not relaxed).
   bool m_haveFullyMatchedResult = false;
 
+  // Ranker::IsFull() after the last update, the geocoder threads don't touch the ranker.
+  bool m_rankerIsFull = false;
+
   // Cache of nested rects used to estimate distance from a feature to the pivot.
   NestedRectsCache m_pivotFeatures;
 
@@ -168,6 +200,10 @@ private:
 
   unsigned m_rndSeed;
 
+  // Guards the new results and the counters checked by the geocoder threads. It's never held while
+  // the results are filtered and ranked, so the threads go on with the next mwms meanwhile.
+  mutable std::mutex m_mutex;
+
   DISALLOW_COPY_AND_MOVE(PreRanker);
 };
 }  // namespace search
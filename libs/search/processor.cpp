@@ -210,6 +210,17 @@ void Processor::SetInputLocale(string const & locale)
   m_inputLocaleCode = CategoriesHolder::MapLocaleToInteger(locale);
 }
 
+void Processor::SetNumGeocoderThreads(size_t numThreads)
+{
+  LOG(LINFO, ("Geocoder threads:", numThreads));
+  m_geocoder.SetNumThreads(numThreads);
+}
+
+void Processor::SetRetrievalCache(RetrievalCache * cache)
+{
+  m_geocoder.SetRetrievalCache(cache);
+}
+
 void Processor::SetQuery(string const & query, bool categorialRequest /* = false */)
 {
   LOG(LDEBUG, ("query:", query, "isCategorial:", categorialRequest));
@@ -848,6 +859,18 @@ void Processor::InitGeocoder(Geocoder::Params & geocoderParams, SearchParams con
   geocoderParams.m_filteringParams = searchParams.m_filteringParams;
   geocoderParams.m_useDebugInfo = searchParams.m_useDebugInfo;
 
+  if (searchParams.m_typeAhead)
+  {
+    if (!m_typeAheadSession.StartQuery(geocoderParams))
+      LOG(LDEBUG, ("Type-ahead session is restarted."));
+    m_geocoder.SetTypeAheadSession(&m_typeAheadSession);
+  }
+  else
+  {
+    // Searches which are not typed, e.g. repeated on map moves, don't break the session.
+    m_geocoder.SetTypeAheadSession(nullptr);
+  }
+
   m_geocoder.SetParams(geocoderParams);
 }
 
@@ -923,6 +946,7 @@ void Processor::InitRanker(Geocoder::Params const & geocoderParams, SearchParams
 void Processor::ClearCaches()
 {
   m_geocoder.ClearCaches();
+  m_typeAheadSession.Clear();
   m_localitiesCaches.Clear();
   m_preRanker.ClearCaches();
   m_ranker.ClearCaches();
@@ -10,6 +10,7 @@
 #include "search/ranker.hpp"
 #include "search/search_params.hpp"
 #include "search/suggest.hpp"
+#include "search/type_ahead_session.hpp"
 
 #include "ge0/geo_url_parser.hpp"
 
@@ -48,6 +49,7 @@ namespace search
 class Geocoder;
 class QueryParams;
 class Ranker;
+class RetrievalCache;
 class ReverseGeocoder;
 
 class Processor : public base::Cancellable
@@ -63,6 +65,10 @@ public:
   void SetPreferredLocale(std::string const & locale);
   void SetInputLocale(std::string const & locale);
   void SetQuery(std::string const & query, bool categorialRequest = false);
+  // See Geocoder::SetNumThreads().
+  void SetNumGeocoderThreads(size_t numThreads);
+  // See Geocoder::SetRetrievalCache().
+  void SetRetrievalCache(RetrievalCache * cache);
 
   inline bool IsEmptyQuery() const { return m_query.IsEmpty(); }
 
@@ -169,6 +175,8 @@ protected:
   Emitter m_emitter;
   Ranker m_ranker;
   PreRanker m_preRanker;
+  // The last type-ahead query, see SearchParams::m_typeAhead.
+  TypeAheadSession m_typeAheadSession;
   Geocoder m_geocoder;
 
   bookmarks::Processor m_bookmarksProcessor;
@@ -0,0 +1,273 @@
+#include "search/retrieval_cache.hpp"
+
+#include "search/mwm_context.hpp"
+#include "search/query_params.hpp"
+
+#include "editor/osm_editor.hpp"
+
+#include "platform/local_country_file.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/string_utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <utility>
+
+namespace search
+{
+using namespace std;
+
+namespace
+{
+// Rough size of a cache entry without bit vectors: the key, the list node and the index node.
+size_t constexpr kEntryOverheadBytes = 128;
+
+void AppendString(strings::UniString const & s, string & out)
+{
+  out += strings::ToUtf8(s);
+  out += '\0';
+}
+
+// An upper estimate: dense bit vectors are smaller than sparse ones for the same number of features.
+size_t EstimateCBVBytes(CBV const & cbv)
+{
+  if (cbv.IsFull())
+    return 0;
+  return static_cast<size_t>(cbv.PopCount()) * sizeof(uint64_t);
+}
+}  // namespace
+
+// RetrievalCache::Key -----------------------------------------------------------------------------
+size_t RetrievalCache::Key::Hash::operator()(Key const & key) const
+{
+  hash<string> const stringHash;
+  size_t seed = stringHash(key.m_countryName);
+  seed ^= hash<int64_t>()(key.m_version) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  seed ^= stringHash(key.m_request) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+// RetrievalCache ----------------------------------------------------------------------------------
+RetrievalCache::RetrievalCache(size_t maxBytes, size_t shardsCount)
+  : m_maxShardBytes(maxBytes / max<size_t>(shardsCount, 1))
+  , m_shards(max<size_t>(shardsCount, 1))
+{}
+
+// static
+RetrievalCache::Key RetrievalCache::MakeKey(MwmContext const & context, QueryParams const & params,
+                                            size_t tokenIndex)
+{
+  Key key;
+  key.m_countryName = context.GetName();
+  key.m_version = context.GetInfo()->GetVersion();
+  key.m_request = MakeRequest(params, tokenIndex);
+  return key;
+}
+
+// static
+string RetrievalCache::MakeRequest(QueryParams const & params, size_t tokenIndex)
+{
+  string request;
+  request += params.IsPrefixToken(tokenIndex) ? 'p' : 'f';
+
+  auto const & token = params.GetToken(tokenIndex);
+  AppendString(token.GetOriginal(), request);
+  token.ForEachSynonym([&request](strings::UniString const & s) { AppendString(s, request); });
+
+  request += '\1';
+  for (auto const index : params.GetTypeIndices(tokenIndex))
+  {
+    request += strings::to_string(index);
+    request += ',';
+  }
+
+  request += '\1';
+  for (auto const lang : params.GetLangs())
+  {
+    request += strings::to_string(static_cast<int>(lang));
+    request += ',';
+  }
+  return request;
+}
+
+// static
+size_t RetrievalCache::EstimateBytes(Key const & key, Retrieval::ExtendedFeatures const & features)
+{
+  return kEntryOverheadBytes + key.m_countryName.size() + key.m_request.size() +
+         EstimateCBVBytes(features.m_features) + EstimateCBVBytes(features.m_exactMatchingFeatures);
+}
+
+// static
+bool RetrievalCache::CanCache(MwmContext const & context)
+{
+  auto const & editor = osm::Editor::Instance();
+  auto const & id = context.GetId();
+  return editor.GetFeaturesByStatus(id, FeatureStatus::Deleted).empty() &&
+         editor.GetFeaturesByStatus(id, FeatureStatus::Modified).empty() &&
+         editor.GetFeaturesByStatus(id, FeatureStatus::Created).empty();
+}
+
+bool RetrievalCache::Find(Key const & key, Retrieval::ExtendedFeatures & features)
+{
+  auto & shard = GetShard(key);
+  lock_guard<mutex> lock(shard.m_mutex);
+  if (FindLocked(shard, key, features))
+  {
+    ++shard.m_stats.m_hits;
+    return true;
+  }
+  ++shard.m_stats.m_misses;
+  return false;
+}
+
+bool RetrievalCache::FindNarrowed(Key const & key, string const & widerRequest, Retrieval::ExtendedFeatures & features)
+{
+  auto & shard = GetShard(key);
+  {
+    lock_guard<mutex> lock(shard.m_mutex);
+    if (FindLocked(shard, key, features))
+    {
+      ++shard.m_stats.m_hits;
+      return true;
+    }
+  }
+
+  // The wider request may be in another shard, the locks are not nested.
+  bool narrowed = false;
+  if (!widerRequest.empty())
+  {
+    Key widerKey;
+    widerKey.m_countryName = key.m_countryName;
+    widerKey.m_version = key.m_version;
+    widerKey.m_request = widerRequest;
+
+    auto & widerShard = GetShard(widerKey);
+    Retrieval::ExtendedFeatures widerFeatures;
+    lock_guard<mutex> lock(widerShard.m_mutex);
+    if (FindLocked(widerShard, widerKey, widerFeatures) && widerFeatures.m_features.IsEmpty())
+    {
+      narrowed = true;
+      features = std::move(widerFeatures);
+    }
+  }
+
+  lock_guard<mutex> lock(shard.m_mutex);
+  if (!narrowed)
+  {
+    ++shard.m_stats.m_misses;
+    return false;
+  }
+
+  ++shard.m_stats.m_narrowed;
+  // The narrowed request is the wider one of the next keystroke.
+  InsertLocked(shard, Key(key), features, EstimateBytes(key, features));
+  return true;
+}
+
+void RetrievalCache::Insert(Key && key, Retrieval::ExtendedFeatures const & features)
+{
+  size_t const bytes = EstimateBytes(key, features);
+  if (bytes > m_maxShardBytes)
+    return;
+
+  auto & shard = GetShard(key);
+  lock_guard<mutex> lock(shard.m_mutex);
+  InsertLocked(shard, std::move(key), features, bytes);
+}
+
+void RetrievalCache::Clear()
+{
+  for (auto & shard : m_shards)
+  {
+    lock_guard<mutex> lock(shard.m_mutex);
+    shard.m_entries.clear();
+    shard.m_index.clear();
+    shard.m_bytes = 0;
+  }
+}
+
+RetrievalCache::Stats RetrievalCache::GetStats() const
+{
+  Stats stats;
+  for (auto const & shard : m_shards)
+  {
+    lock_guard<mutex> lock(shard.m_mutex);
+    stats.m_hits += shard.m_stats.m_hits;
+    stats.m_misses += shard.m_stats.m_misses;
+    stats.m_evictions += shard.m_stats.m_evictions;
+    stats.m_narrowed += shard.m_stats.m_narrowed;
+    stats.m_numEntries += shard.m_entries.size();
+    stats.m_bytes += shard.m_bytes;
+  }
+  return stats;
+}
+
+void RetrievalCache::OnMapDeregistered(platform::LocalCountryFile const & localFile)
+{
+  auto const & countryName = localFile.GetCountryName();
+  for (auto & shard : m_shards)
+  {
+    lock_guard<mutex> lock(shard.m_mutex);
+    for (auto it = shard.m_entries.begin(); it != shard.m_entries.end();)
+    {
+      auto const next = std::next(it);
+      if (it->m_key.m_countryName == countryName)
+        Erase(shard, it);
+      it = next;
+    }
+  }
+}
+
+// static
+bool RetrievalCache::FindLocked(Shard & shard, Key const & key, Retrieval::ExtendedFeatures & features)
+{
+  auto const it = shard.m_index.find(key);
+  if (it == shard.m_index.end())
+    return false;
+
+  shard.m_entries.splice(shard.m_entries.begin(), shard.m_entries, it->second);
+  features = it->second->m_features;
+  return true;
+}
+
+void RetrievalCache::InsertLocked(Shard & shard, Key && key, Retrieval::ExtendedFeatures const & features,
+                                  size_t bytes) const
+{
+  // The same request may be retrieved on several threads at once.
+  if (bytes > m_maxShardBytes || shard.m_index.count(key) != 0)
+    return;
+
+  while (!shard.m_entries.empty() && shard.m_bytes + bytes > m_maxShardBytes)
+  {
+    Erase(shard, prev(shard.m_entries.end()));
+    ++shard.m_stats.m_evictions;
+  }
+
+  shard.m_entries.push_front({std::move(key), features, bytes});
+  shard.m_index.emplace(shard.m_entries.front().m_key, shard.m_entries.begin());
+  shard.m_bytes += bytes;
+}
+
+// static
+void RetrievalCache::Erase(Shard & shard, Entries::iterator it)
+{
+  ASSERT_GREATER_OR_EQUAL(shard.m_bytes, it->m_bytes, ());
+  shard.m_bytes -= it->m_bytes;
+  shard.m_index.erase(it->m_key);
+  shard.m_entries.erase(it);
+}
+
+string DebugPrint(RetrievalCache::Stats const & stats)
+{
+  uint64_t const lookups = stats.m_hits + stats.m_misses;
+  ostringstream os;
+  os << "RetrievalCache::Stats [ hits: " << stats.m_hits << ", misses: " << stats.m_misses
+     << ", hit rate: " << (lookups == 0 ? 0.0 : static_cast<double>(stats.m_hits) / lookups)
+     << ", narrowed: " << stats.m_narrowed << ", evictions: " << stats.m_evictions << ", entries: " << stats.m_numEntries << ", bytes: " << stats.m_bytes
+     << " ]";
+  return os.str();
+}
+}  // namespace search
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "search/retrieval.hpp"
+
+#include "indexer/mwm_set.hpp"
+
+#include "base/macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace search
+{
+class MwmContext;
+class QueryParams;
+
+// Thread-safe cache of the address features retrieved from the search index. It's shared by all
+// processors of the search engine, so popular tokens are retrieved once for all threads and queries.
+// Cached bit vectors are shared via reference counting. Memory is bounded by an upper estimate of
+// the bit vectors size, the least recently used entries are evicted first.
+// The cache is sharded by key, every shard has its own lock, LRU and an equal part of the memory limit.
+class RetrievalCache : public MwmSet::Observer
+{
+public:
+  struct Key
+  {
+    bool operator==(Key const & rhs) const
+    {
+      return m_version == rhs.m_version && m_countryName == rhs.m_countryName && m_request == rhs.m_request;
+    }
+
+    struct Hash
+    {
+      size_t operator()(Key const & key) const;
+    };
+
+    std::string m_countryName;
+    int64_t m_version = 0;
+    // Serialized token (original string, synonyms and categories), langs and prefix flag, i.e. everything
+    // the search trie request is built from.
+    std::string m_request;
+  };
+
+  struct Stats
+  {
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    // Lookups answered by an empty retrieval of a wider request, see FindNarrowed().
+    uint64_t m_narrowed = 0;
+    size_t m_numEntries = 0;
+    size_t m_bytes = 0;
+  };
+
+  static size_t constexpr kDefaultShardsCount = 16;
+
+  explicit RetrievalCache(size_t maxBytes, size_t shardsCount = kDefaultShardsCount);
+
+  // Returns the key of the request for the |tokenIndex|-th token of |params| in the mwm of |context|.
+  static Key MakeKey(MwmContext const & context, QueryParams const & params, size_t tokenIndex);
+
+  // Returns Key::m_request for the |tokenIndex|-th token of |params|.
+  static std::string MakeRequest(QueryParams const & params, size_t tokenIndex);
+
+  // Returns an upper estimate of the memory taken by an entry.
+  static size_t EstimateBytes(Key const & key, Retrieval::ExtendedFeatures const & features);
+
+  // Returns false when results of the mwm of |context| depend on the map edits and can't be cached.
+  static bool CanCache(MwmContext const & context);
+
+  bool Find(Key const & key, Retrieval::ExtendedFeatures & features);
+
+  // The same as Find() but when |key| is not cached, it's answered by the request |widerRequest| in the
+  // same mwm, whose features must be a superset of the features of |key|, e.g. a shorter prefix of a
+  // type-ahead query. When the wider request is cached and has matched nothing, |features| are empty
+  // too and are cached for |key|.
+  bool FindNarrowed(Key const & key, std::string const & widerRequest, Retrieval::ExtendedFeatures & features);
+
+  void Insert(Key && key, Retrieval::ExtendedFeatures const & features);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+  // MwmSet::Observer overrides:
+  void OnMapDeregistered(platform::LocalCountryFile const & localFile) override;
+
+private:
+  struct Entry
+  {
+    Key m_key;
+    Retrieval::ExtendedFeatures m_features;
+    size_t m_bytes = 0;
+  };
+
+  using Entries = std::list<Entry>;
+
+  struct Shard
+  {
+    mutable std::mutex m_mutex;
+    // Most recently used entries are at the front.
+    Entries m_entries;
+    std::unordered_map<Key, Entries::iterator, Key::Hash> m_index;
+    size_t m_bytes = 0;
+    // Only the counters of lookups and evictions are used.
+    Stats m_stats;
+  };
+
+  Shard & GetShard(Key const & key) { return m_shards[Key::Hash()(key) % m_shards.size()]; }
+
+  static bool FindLocked(Shard & shard, Key const & key, Retrieval::ExtendedFeatures & features);
+  void InsertLocked(Shard & shard, Key && key, Retrieval::ExtendedFeatures const & features, size_t bytes) const;
+  static void Erase(Shard & shard, Entries::iterator it);
+
+  // Memory limit of a shard.
+  size_t const m_maxShardBytes;
+  std::vector<Shard> m_shards;
+
+  DISALLOW_COPY_AND_MOVE(RetrievalCache);
+};
+
+std::string DebugPrint(RetrievalCache::Stats const & stats);
+}  // namespace search
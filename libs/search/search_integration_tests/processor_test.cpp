@@ -496,6 +496,91 @@ UNIT_CLASS_TEST(ProcessorTest, SearchByName)
   }
 }
 
+class ParallelGeocoderTest : public SearchTest
+{
+public:
+  ParallelGeocoderTest() : SearchTest(base::LDEBUG, 4 /* numGeocoderThreads */) {}
+};
+
+UNIT_CLASS_TEST(ParallelGeocoderTest, SearchInSeveralCountries)
+{
+  TestCity london({1, 1}, "London", "en", 100 /* rank */);
+  auto worldId = BuildWorld([&](TestMwmBuilder & builder) { builder.Add(london); });
+
+  size_t constexpr kNumCountries = 10;
+  vector<TestCafe> cafes;
+  for (size_t i = 0; i < kNumCountries; ++i)
+    cafes.emplace_back(m2::PointD(10.0 * i, 10.0), "Lermontov", "en");
+
+  Rules cafeRules;
+  for (size_t i = 0; i < kNumCountries; ++i)
+  {
+    auto const countryId = BuildCountry("Country" + strings::to_string(i), [&](TestMwmBuilder & builder)
+    {
+      builder.Add(cafes[i]);
+      builder.Add(TestPOI(m2::PointD(10.0 * i, 11.0), "Pushkin", "en"));
+    });
+    cafeRules.push_back(ExactMatch(countryId, cafes[i]));
+  }
+
+  SetViewport(m2::RectD(-1.0, -1.0, 1.0, 1.0));
+  TEST(ResultsMatch("Lermontov", cafeRules), ());
+  TEST(ResultsMatch("London", {ExactMatch(worldId, london)}), ());
+  TEST(ResultsMatch("Tolstoy", {}), ());
+}
+
+// Type-ahead queries skip retrievals of the extended prefixes and must return the same results as
+// queries processed from scratch.
+UNIT_CLASS_TEST(ProcessorTest, TypeAhead)
+{
+  TestCity lermontovo({1, 1}, "Lermontovo", "en", 100 /* rank */);
+  BuildWorld([&](TestMwmBuilder & builder) { builder.Add(lermontovo); });
+
+  TestStreet street({{0.0, 0.0}, {0.5, 0.5}}, "Lermontov street", "en");
+  TestCafe cafe({0.5, 0.5}, "Lermontov", "en");
+  BuildCountry("Wonderland", [&](TestMwmBuilder & builder)
+  {
+    builder.Add(street);
+    builder.Add(cafe);
+  });
+  BuildCountry("Neverland", [&](TestMwmBuilder & builder)
+  { builder.Add(TestPOI(m2::PointD(10.0, 10.0), "Pushkin", "en")); });
+
+  SetViewport(m2::RectD(-1.0, -1.0, 1.0, 1.0));
+
+  // Type-ahead sessions work with the retrieval cache only.
+  Engine::Params engineParams;
+  engineParams.m_retrievalCacheBytes = 1024 * 1024;
+  TestSearchEngine typeAheadEngine(m_dataSource, engineParams, true /* mockCountryInfo */);
+
+  auto const search = [&](string const & query, bool typeAhead)
+  {
+    auto params = GetDefaultSearchParams(query);
+    params.m_typeAhead = typeAhead;
+    TestSearchRequest request(typeAhead ? typeAheadEngine : m_engine, params);
+    request.Run();
+
+    vector<FeatureID> ids;
+    for (auto const & result : request.Results())
+      if (result.GetResultType() == Result::Type::Feature)
+        ids.push_back(result.GetFeatureID());
+    sort(ids.begin(), ids.end());
+    return ids;
+  };
+
+  vector<string> const queries = {"L", "Le", "Lerm", "Lermontov", "Lermontov ", "Lermontov s",
+                                  "Lermontov str", "Lermontov st", "Lermontov street", "Pu"};
+  vector<vector<FeatureID>> typeAheadResults;
+  for (auto const & query : queries)
+    typeAheadResults.push_back(search(query, true /* typeAhead */));
+
+  for (size_t i = 0; i < queries.size(); ++i)
+    TEST_EQUAL(typeAheadResults[i], search(queries[i], false /* typeAhead */), (queries[i]));
+  TEST(!typeAheadResults[3].empty(), ());
+  // E.g. "Le" in Neverland, where "L" has matched nothing.
+  TEST_GREATER(typeAheadEngine.GetRetrievalCacheStats().m_narrowed, 0, ());
+}
+
 UNIT_CLASS_TEST(ProcessorTest, DisableSuggests)
 {
   TestCity london1({1, 1}, "London", "en", 100 /* rank */);
@@ -94,6 +94,10 @@ struct SearchParams
   // True if you need *pure* category results only, without names/addresses/etc matching.
   bool m_categorialRequest = false;
 
+  // True if the query is typed by the user and is posted on every keystroke. The extended prefix
+  // token is not retrieved where the previous prefix has matched nothing, see TypeAheadSession.
+  bool m_typeAhead = false;
+
   // Set to true for debug logs and tests.
 #ifdef DEBUG
   bool m_useDebugInfo = true;
@@ -0,0 +1,302 @@
+#include "search/search_quality/bulk_geocoder.hpp"
+
+#include "search/search_tests_support/test_search_engine.hpp"
+
+#include "indexer/data_source.hpp"
+#include "indexer/feature_algo.hpp"
+#include "indexer/ftypes_matcher.hpp"
+#include "indexer/search_string_utils.hpp"
+#include "indexer/utils.hpp"
+
+#include "storage/country_info_getter.hpp"
+
+#include "geometry/mercator.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/string_utils.hpp"
+#include "base/timer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+#include "cppjansson/cppjansson.hpp"
+
+namespace search
+{
+namespace search_quality
+{
+using namespace std;
+
+namespace
+{
+template <typename It>
+string JoinTokens(It begin, It end)
+{
+  string result;
+  for (auto it = begin; it != end; ++it)
+  {
+    if (it != begin)
+      result += ' ';
+    result += strings::ToUtf8(*it);
+  }
+  return result;
+}
+}  // namespace
+
+// BulkGeocoder::Stats -----------------------------------------------------------------------------
+double BulkGeocoder::Stats::GetQueriesPerSecond() const
+{
+  return m_seconds > 0 ? static_cast<double>(m_numQueries) / m_seconds : 0.0;
+}
+
+// BulkGeocoder::Region ----------------------------------------------------------------------------
+bool BulkGeocoder::Region::operator<(Region const & rhs) const
+{
+  return tie(m_countryId, m_locality) < tie(rhs.m_countryId, rhs.m_locality);
+}
+
+// BulkGeocoder ------------------------------------------------------------------------------------
+BulkGeocoder::BulkGeocoder(DataSource const & dataSource, tests_support::TestSearchEngine & engine,
+                           Params const & params)
+  : m_engine(engine)
+  , m_params(params)
+  , m_villagesCache(m_cancellable)
+  , m_citiesBoundaries(dataSource)
+  , m_localityFinder(dataSource, m_citiesBoundaries, m_villagesCache)
+{
+  m_citiesBoundaries.Load();
+  LoadLocalities(dataSource);
+}
+
+// static
+bool BulkGeocoder::ParseQuery(string const & line, size_t lineNumber, string const & defaultLocale, Query & query)
+{
+  query.m_id = strings::to_string(lineNumber);
+  query.m_locale = defaultLocale;
+
+  if (!line.starts_with('{'))
+  {
+    query.m_query = line;
+    return true;
+  }
+
+  try
+  {
+    base::Json root(line.c_str());
+    FromJSONObject(root.get(), "query", query.m_query);
+    if (auto id = FromJSONObjectOptional<string>(root.get(), "id"))
+      query.m_id = std::move(*id);
+    if (auto locale = FromJSONObjectOptional<string>(root.get(), "locale"))
+      query.m_locale = std::move(*locale);
+    if (base::GetJSONOptionalField(root.get(), "lat") || base::GetJSONOptionalField(root.get(), "lon"))
+    {
+      double lat;
+      double lon;
+      FromJSONObject(root.get(), "lat", lat);
+      FromJSONObject(root.get(), "lon", lon);
+      query.m_position = mercator::FromLatLon(lat, lon);
+    }
+  }
+  catch (base::Json::Exception const & e)
+  {
+    LOG(LWARNING, ("Can't parse query on line", lineNumber, ":", e.Msg()));
+    return false;
+  }
+  return true;
+}
+
+vector<size_t> BulkGeocoder::Schedule(vector<Query> const & queries)
+{
+  // Sort keys are made once: a locality lookup is much more expensive than a comparison.
+  struct Key
+  {
+    bool m_hasRegion = false;
+    Region m_region;
+    strings::UniString m_query;
+  };
+
+  vector<Key> keys(queries.size());
+  for (size_t i = 0; i < queries.size(); ++i)
+  {
+    auto const & query = queries[i];
+    auto & key = keys[i];
+    if (query.m_position)
+    {
+      key.m_hasRegion = true;
+      key.m_region = GetRegion(*query.m_position);
+    }
+    else if (auto region = InferRegion(query))
+    {
+      key.m_hasRegion = true;
+      key.m_region = std::move(*region);
+    }
+    key.m_query = NormalizeAndSimplifyString(query.m_query);
+  }
+
+  vector<size_t> order(queries.size());
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [&keys](size_t lhs, size_t rhs)
+  {
+    auto const & l = keys[lhs];
+    auto const & r = keys[rhs];
+    if (l.m_hasRegion != r.m_hasRegion)
+      return l.m_hasRegion;
+    if (l.m_region < r.m_region || r.m_region < l.m_region)
+      return l.m_region < r.m_region;
+    return l.m_query < r.m_query;
+  });
+  return order;
+}
+
+BulkGeocoder::Stats BulkGeocoder::Run(vector<Query> const & queries, OnResponse const & onResponse)
+{
+  Stats stats;
+  stats.m_numQueries = queries.size();
+
+  auto const order = Schedule(queries);
+
+  // Only a few queries are posted to the engine ahead of the processed ones: the engine takes
+  // queries in FIFO order, so the schedule is kept, and the queue does not grow with the batch.
+  size_t const maxNumPending = 2 * max<size_t>(m_engine.GetNumThreads(), 1);
+
+  mutex mu;
+  condition_variable cv;
+  size_t numPending = 0;
+
+  base::Timer timer;
+  for (auto const i : order)
+  {
+    {
+      unique_lock<mutex> lock(mu);
+      cv.wait(lock, [&]() { return numPending < maxNumPending; });
+      ++numPending;
+    }
+
+    auto params = MakeSearchParams(queries[i]);
+    params.m_onResults = [&, i](Results const & results)
+    {
+      if (!results.IsEndMarker())
+        return;
+
+      onResponse(queries[i], results);
+
+      lock_guard<mutex> lock(mu);
+      if (results.IsEndedCancelled())
+        ++stats.m_numCancelled;
+      --numPending;
+      // |cv| is notified under the lock: it's destroyed as soon as the last query is processed.
+      cv.notify_one();
+    };
+    m_engine.Search(params);
+  }
+
+  {
+    unique_lock<mutex> lock(mu);
+    cv.wait(lock, [&]() { return numPending == 0; });
+  }
+  stats.m_seconds = timer.ElapsedSeconds();
+  return stats;
+}
+
+void BulkGeocoder::LoadLocalities(DataSource const & dataSource)
+{
+  auto const handle = indexer::FindWorld(dataSource);
+  if (!handle.IsAlive())
+  {
+    LOG(LWARNING, ("No World mwm, regions of queries without a position are not guessed."));
+    return;
+  }
+
+  auto const & checker = ftypes::IsLocalityChecker::Instance();
+  FeaturesLoaderGuard const guard(dataSource, handle.GetId());
+  for (uint32_t index = 0; index < guard.GetNumFeatures(); ++index)
+  {
+    auto ft = guard.GetFeatureByIndex(index);
+    if (!ft)
+      continue;
+
+    auto const type = checker.GetType(*ft);
+    if (type != ftypes::LocalityType::City && type != ftypes::LocalityType::Town)
+      continue;
+
+    Locality locality;
+    locality.m_id = ft->GetID();
+    locality.m_center = feature::GetCenter(*ft);
+    locality.m_population = ftypes::GetPopulation(*ft);
+
+    ft->ForEachName([&](int8_t /* lang */, string_view name)
+    {
+      auto const tokens = NormalizeAndTokenizeString(name);
+      auto const key = JoinTokens(tokens.begin(), tokens.end());
+      if (key.empty())
+        return;
+      auto const it = m_localities.find(key);
+      if (it == m_localities.end() || it->second.m_population < locality.m_population)
+        m_localities[key] = locality;
+    });
+  }
+}
+
+BulkGeocoder::Region BulkGeocoder::GetRegion(m2::PointD const & position)
+{
+  Region region;
+  region.m_countryId = m_engine.GetCountryInfoGetter().GetRegionCountryId(position);
+  m_localityFinder.GetLocality(position, [&region](LocalityItem const & item) { region.m_locality = item.m_id; });
+  return region;
+}
+
+optional<BulkGeocoder::Region> BulkGeocoder::InferRegion(Query const & query)
+{
+  // Most of locality names have a few tokens.
+  size_t constexpr kMaxNameTokens = 3;
+
+  auto const tokens = NormalizeAndTokenizeString(query.m_query);
+  Locality const * best = nullptr;
+  for (size_t i = 0; i < tokens.size(); ++i)
+  {
+    for (size_t j = i + 1; j <= min(tokens.size(), i + kMaxNameTokens); ++j)
+    {
+      auto const it = m_localities.find(JoinTokens(tokens.begin() + i, tokens.begin() + j));
+      if (it != m_localities.end() && (!best || best->m_population < it->second.m_population))
+        best = &it->second;
+    }
+  }
+
+  if (!best)
+    return {};
+
+  Region region;
+  region.m_countryId = m_engine.GetCountryInfoGetter().GetRegionCountryId(best->m_center);
+  region.m_locality = best->m_id;
+  return region;
+}
+
+SearchParams BulkGeocoder::MakeSearchParams(Query const & query) const
+{
+  SearchParams params;
+  params.m_query = query.m_query;
+  params.m_inputLocale = query.m_locale;
+  params.m_mode = Mode::Everywhere;
+  params.m_position = query.m_position;
+  if (query.m_position)
+    params.m_viewport = mercator::RectByCenterXYAndSizeInMeters(*query.m_position, m_params.m_viewportSizeMeters);
+  else
+    params.m_viewport = m_params.m_viewport;
+
+  // Results are reported once per query, and nothing but the results themselves is needed.
+  params.m_maxNumResults = m_params.m_maxNumResults;
+  params.m_batchSize = m_params.m_maxNumResults;
+  params.m_timeout = m_params.m_timeout;
+  params.m_needAddress = m_params.m_needAddress;
+  params.m_suggestsEnabled = false;
+  params.m_needHighlighting = false;
+  params.m_useDebugInfo = false;
+  return params;
+}
+}  // namespace search_quality
+}  // namespace search
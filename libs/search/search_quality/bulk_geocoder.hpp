@@ -0,0 +1,143 @@
+#pragma once
+
+#include "search/categories_cache.hpp"
+#include "search/cities_boundaries_table.hpp"
+#include "search/locality_finder.hpp"
+#include "search/result.hpp"
+#include "search/search_params.hpp"
+
+#include "storage/storage_defines.hpp"
+
+#include "indexer/feature_decl.hpp"
+
+#include "geometry/point2d.hpp"
+#include "geometry/rect2d.hpp"
+
+#include "base/cancellable.hpp"
+#include "base/macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DataSource;
+
+namespace search
+{
+namespace tests_support
+{
+class TestSearchEngine;
+}  // namespace tests_support
+
+namespace search_quality
+{
+// Geocodes large batches of address strings offline, e.g. millions of queries at once.
+//
+// Throughput matters here rather than the latency of a single query, so queries are not processed
+// in the input order. They are grouped by the region they most likely belong to: the country
+// containing the query position and the locality near it. For queries without a position the region
+// is guessed by the names of the World cities and towns mentioned in the query text. Groups are geocoded one after another,
+// so the same mwms, their search indexes and the per-processor caches are used by consecutive
+// queries. All search engine threads are kept busy, and the results are reported as soon as a
+// query is processed, in the processing order.
+//
+// NOTE: this class is not thread-safe, but the |onResponse| callback of Run() is called
+// concurrently from the search engine threads.
+class BulkGeocoder
+{
+public:
+  struct Query
+  {
+    // Arbitrary id which is reported back with the results.
+    std::string m_id;
+    std::string m_query;
+    std::string m_locale = "en";
+    // Position of the user or a rough location of the address, when it's known.
+    std::optional<m2::PointD> m_position;
+  };
+
+  struct Params
+  {
+    size_t m_maxNumResults = 1;
+    bool m_needAddress = true;
+    SearchParams::TimeDurationT m_timeout = SearchParams::kDefaultTimeout;
+    // Viewport of queries without a position, must be valid.
+    m2::RectD m_viewport;
+    // Size of the viewport around the position of a query.
+    double m_viewportSizeMeters = 5000.0;
+  };
+
+  struct Stats
+  {
+    double GetQueriesPerSecond() const;
+
+    size_t m_numQueries = 0;
+    size_t m_numCancelled = 0;
+    double m_seconds = 0.0;
+  };
+
+  // |results| are the final results of |query|. They are cancelled when the query has
+  // exceeded the timeout, and contain the best results found so far.
+  using OnResponse = std::function<void(Query const & query, Results const & results)>;
+
+  BulkGeocoder(DataSource const & dataSource, tests_support::TestSearchEngine & engine, Params const & params);
+
+  // Parses the line |lineNumber| of the input. The line is either a query or a JSON object like
+  //   {"id": "42", "query": "Berlin Unter den Linden 1", "locale": "de", "lat": 52.51, "lon": 13.39}
+  // where all fields but the query are optional. The line number is the default id and |defaultLocale|
+  // is the default locale. Returns false when the line is not a valid query.
+  static bool ParseQuery(std::string const & line, size_t lineNumber, std::string const & defaultLocale,
+                         Query & query);
+
+  // Returns the order in which |queries| are geocoded: queries with a known or guessed region go
+  // first, grouped by country and then by locality. The rest of queries are ordered by their text,
+  // so the queries which start with the same city or street name go together.
+  std::vector<size_t> Schedule(std::vector<Query> const & queries);
+
+  // Geocodes all |queries| and blocks until the last one is processed.
+  Stats Run(std::vector<Query> const & queries, OnResponse const & onResponse);
+
+private:
+  struct Region
+  {
+    bool operator<(Region const & rhs) const;
+
+    storage::CountryId m_countryId;
+    FeatureID m_locality;
+  };
+
+  struct Locality
+  {
+    FeatureID m_id;
+    m2::PointD m_center;
+    uint64_t m_population = 0;
+  };
+
+  // Fills |m_localities| with the cities and towns of the World mwm.
+  void LoadLocalities(DataSource const & dataSource);
+
+  Region GetRegion(m2::PointD const & position);
+  // Guesses the region of a query without a position by the most populated locality whose
+  // name is a sequence of the query tokens.
+  std::optional<Region> InferRegion(Query const & query);
+
+  SearchParams MakeSearchParams(Query const & query) const;
+
+  tests_support::TestSearchEngine & m_engine;
+  Params const m_params;
+
+  base::Cancellable m_cancellable;
+  VillagesCache m_villagesCache;
+  CitiesBoundariesTable m_citiesBoundaries;
+  LocalityFinder m_localityFinder;
+  // Normalized locality names, tokens are separated by spaces.
+  std::unordered_map<std::string, Locality> m_localities;
+
+  DISALLOW_COPY_AND_MOVE(BulkGeocoder);
+};
+}  // namespace search_quality
+}  // namespace search
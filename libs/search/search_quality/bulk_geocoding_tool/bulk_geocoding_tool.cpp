@@ -0,0 +1,227 @@
+#include "search/search_quality/bulk_geocoder.hpp"
+#include "search/search_quality/helpers.hpp"
+
+#include "search/search_tests_support/test_search_engine.hpp"
+
+#include "search/result.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
+#include "indexer/data_source.hpp"
+
+#include "platform/platform_tests_support/helpers.hpp"
+
+#include "geometry/mercator.hpp"
+
+#include "base/logging.hpp"
+#include "base/string_utils.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cppjansson/cppjansson.hpp"
+
+#include <gflags/gflags.h>
+
+using namespace search::search_quality;
+using namespace search;
+using namespace std;
+
+DEFINE_string(data_path, "", "Path to data directory (resources dir)");
+DEFINE_string(mwm_path, "", "Path to mwm files (writable dir)");
+DEFINE_string(mwm_list_path, "", "Path to a file containing the names of available mwms, one per line");
+DEFINE_string(locale, "en", "Locale of the queries which do not specify it");
+DEFINE_int32(num_threads, 0, "Number of search engine threads, 0 to use all cores");
+DEFINE_int32(geocoder_threads, 1, "Number of threads which process mwms of a single query");
+DEFINE_int32(retrieval_cache_mb, 256, "Size of the retrieval cache shared by the search threads, 0 to disable");
+DEFINE_string(queries_path, "", "Path to the file with queries (default: stdin)");
+DEFINE_string(json_out, "", "Path to the JSON lines file with results (default: stdout)");
+DEFINE_int32(chunk_size, 100000, "Number of queries which are read and scheduled at once");
+DEFINE_int32(top, 1, "Number of top results to write for every query");
+DEFINE_bool(need_address, true, "Write addresses of results");
+DEFINE_int32(timeout_ms, 8000, "Timeout of a single query");
+DEFINE_string(viewport, "", "Viewport of the queries without a position (default, moscow, london, zurich)");
+
+bool ValidateNonNegative(char const * flagname, int32_t value)
+{
+  if (value < 0)
+  {
+    LOG(LINFO, ("Valid value for --", string(flagname), ":", value, "must be greater or equal to 0."));
+    return false;
+  }
+  return true;
+}
+
+bool ValidatePositive(char const * flagname, int32_t value)
+{
+  if (value <= 0)
+  {
+    LOG(LINFO, ("Valid value for --", string(flagname), ":", value, "must be greater than 0."));
+    return false;
+  }
+  return true;
+}
+
+bool const g_numThreadsDummy = gflags::RegisterFlagValidator(&FLAGS_num_threads, &ValidateNonNegative);
+bool const g_retrievalCacheMbDummy = gflags::RegisterFlagValidator(&FLAGS_retrieval_cache_mb, &ValidateNonNegative);
+bool const g_chunkSizeDummy = gflags::RegisterFlagValidator(&FLAGS_chunk_size, &ValidatePositive);
+
+// Reads at most |maxNumQueries| non-empty lines, returns false when the input is over.
+bool ReadQueries(istream & is, size_t maxNumQueries, size_t & lineNumber, vector<BulkGeocoder::Query> & queries)
+{
+  queries.clear();
+  string line;
+  while (queries.size() < maxNumQueries && getline(is, line))
+  {
+    ++lineNumber;
+    strings::Trim(line);
+    if (line.empty())
+      continue;
+
+    BulkGeocoder::Query query;
+    if (BulkGeocoder::ParseQuery(line, lineNumber, FLAGS_locale, query))
+      queries.push_back(std::move(query));
+  }
+  return !queries.empty();
+}
+
+base::JSONPtr ToJSON(Result const & result)
+{
+  auto root = base::NewJSONObject();
+  ToJSONObject(*root, "name", result.GetString());
+  if (FLAGS_need_address)
+    ToJSONObject(*root, "address", result.GetAddress());
+
+  if (result.HasPoint())
+  {
+    auto const latLon = mercator::ToLatLon(result.GetFeatureCenter());
+    ToJSONObject(*root, "lat", latLon.m_lat);
+    ToJSONObject(*root, "lon", latLon.m_lon);
+  }
+
+  if (result.GetResultType() == Result::Type::Feature)
+  {
+    ToJSONObject(*root, "type", classif().GetReadableObjectName(result.GetFeatureType()));
+    ToJSONObject(*root, "mwm", result.GetFeatureID().GetMwmName());
+    ToJSONObject(*root, "feature_id", result.GetFeatureID().m_index);
+  }
+  return root;
+}
+
+string ToJSONLine(BulkGeocoder::Query const & query, Results const & results)
+{
+  auto root = base::NewJSONObject();
+  ToJSONObject(*root, "id", query.m_id);
+  ToJSONObject(*root, "query", query.m_query);
+  ToJSONObject(*root, "cancelled", results.IsEndedCancelled());
+
+  auto array = base::NewJSONArray();
+  size_t const top = static_cast<size_t>(FLAGS_top);
+  for (size_t i = 0; i < results.GetCount() && i < top; ++i)
+    json_array_append_new(array.get(), ToJSON(results[i]).release());
+  ToJSONObject(*root, "results", array);
+
+  unique_ptr<char, JSONFreeDeleter> buffer(json_dumps(root.get(), JSON_COMPACT));
+  return buffer.get();
+}
+
+int main(int argc, char * argv[])
+{
+  platform::tests_support::ChangeMaxNumberOfOpenFiles(kMaxOpenFiles);
+  CheckLocale();
+
+  gflags::SetUsageMessage("Geocodes queries in bulk and writes the results as JSON lines.");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  SetPlatformDirs(FLAGS_data_path, FLAGS_mwm_path);
+
+  classificator::Load();
+
+  FrozenDataSource dataSource;
+  InitDataSource(dataSource, FLAGS_mwm_list_path);
+
+  size_t const numCores = max<size_t>(thread::hardware_concurrency(), 1);
+  size_t numThreads = static_cast<size_t>(FLAGS_num_threads);
+  if (numThreads == 0)
+    numThreads = numCores;
+  size_t const numGeocoderThreads = static_cast<size_t>(max(FLAGS_geocoder_threads, 1));
+
+  auto engine = InitSearchEngine(dataSource, FLAGS_locale, numThreads, numGeocoderThreads,
+                                 static_cast<size_t>(FLAGS_retrieval_cache_mb) * 1024 * 1024);
+  engine->InitAffiliations();
+
+  BulkGeocoder::Params params;
+  params.m_maxNumResults = static_cast<size_t>(max(FLAGS_top, 1));
+  params.m_needAddress = FLAGS_need_address;
+  params.m_timeout = chrono::milliseconds(FLAGS_timeout_ms);
+  InitViewport(FLAGS_viewport, params.m_viewport);
+
+  BulkGeocoder geocoder(dataSource, *engine, params);
+
+  ifstream queriesFile;
+  if (!FLAGS_queries_path.empty())
+  {
+    queriesFile.open(FLAGS_queries_path);
+    CHECK(queriesFile.is_open(), ("Can't open", FLAGS_queries_path));
+  }
+  istream & in = FLAGS_queries_path.empty() ? cin : queriesFile;
+
+  ofstream jsonFile;
+  if (!FLAGS_json_out.empty())
+  {
+    jsonFile.open(FLAGS_json_out);
+    CHECK(jsonFile.is_open(), ("Can't open", FLAGS_json_out));
+  }
+  ostream & out = FLAGS_json_out.empty() ? cout : jsonFile;
+
+  ios_base::sync_with_stdio(false);
+
+  mutex outMutex;
+  auto const onResponse = [&](BulkGeocoder::Query const & query, Results const & results)
+  {
+    auto const line = ToJSONLine(query, results);
+    lock_guard<mutex> lock(outMutex);
+    out << line << '\n';
+  };
+
+  BulkGeocoder::Stats total;
+  {
+    // Every query is logged by the search engine otherwise.
+    base::ScopedLogLevelChanger const logLevel(base::LWARNING);
+
+    size_t const chunkSize = static_cast<size_t>(FLAGS_chunk_size);
+    size_t lineNumber = 0;
+    vector<BulkGeocoder::Query> queries;
+    while (ReadQueries(in, chunkSize, lineNumber, queries))
+    {
+      auto const stats = geocoder.Run(queries, onResponse);
+      out.flush();
+
+      total.m_numQueries += stats.m_numQueries;
+      total.m_numCancelled += stats.m_numCancelled;
+      total.m_seconds += stats.m_seconds;
+      cerr << "Geocoded " << total.m_numQueries << " queries, " << stats.GetQueriesPerSecond() << " queries per second"
+           << endl;
+    }
+  }
+
+  // Geocoder threads of a processor take their cores too, as long as there are free ones.
+  size_t const numUsedCores = min(numThreads * numGeocoderThreads, numCores);
+  cerr << fixed << setprecision(3);
+  cerr << "Queries: " << total.m_numQueries << " (cancelled by timeout: " << total.m_numCancelled << ")" << endl;
+  cerr << "Geocoding time: " << total.m_seconds << "s" << endl;
+  cerr << "Queries per second: " << total.GetQueriesPerSecond() << endl;
+  cerr << "Queries per second per core: " << total.GetQueriesPerSecond() / numUsedCores << " (" << numUsedCores
+       << " cores)" << endl;
+  if (FLAGS_retrieval_cache_mb > 0)
+    cerr << DebugPrint(engine->GetRetrievalCacheStats()) << endl;
+  return 0;
+}
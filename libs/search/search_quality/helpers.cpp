@@ -145,11 +145,14 @@ void InitDataSource(FrozenDataSource & dataSource, string const & mwmListPath)
 }
 
 unique_ptr<search::tests_support::TestSearchEngine> InitSearchEngine(DataSource & dataSource, string const & locale,
-                                                                     size_t numThreads)
+                                                                     size_t numThreads, size_t numGeocoderThreads,
+                                                                     size_t retrievalCacheBytes)
 {
   search::Engine::Params params;
   params.m_locale = locale;
   params.m_numThreads = base::checked_cast<size_t>(numThreads);
+  params.m_numGeocoderThreads = numGeocoderThreads;
+  params.m_retrievalCacheBytes = retrievalCacheBytes;
 
   return make_unique<search::tests_support::TestSearchEngine>(dataSource, params);
 }
@@ -30,6 +30,8 @@ void InitDataSource(FrozenDataSource & dataSource, std::string const & mwmListPa
 
 std::unique_ptr<search::tests_support::TestSearchEngine> InitSearchEngine(DataSource & dataSource,
                                                                           std::string const & locale,
-                                                                          size_t numThreads);
+                                                                          size_t numThreads,
+                                                                          size_t numGeocoderThreads = 1,
+                                                                          size_t retrievalCacheBytes = 0);
 }  // namespace search_quality
 }  // namespace search
@@ -0,0 +1,169 @@
+#include "testing/testing.hpp"
+
+#include "generator/generator_tests_support/test_feature.hpp"
+#include "generator/generator_tests_support/test_mwm_builder.hpp"
+
+#include "search/search_quality/bulk_geocoder.hpp"
+
+#include "search/search_tests_support/helpers.hpp"
+#include "search/search_tests_support/test_results_matching.hpp"
+
+#include "search/result.hpp"
+
+#include "geometry/mercator.hpp"
+#include "geometry/point2d.hpp"
+#include "geometry/rect2d.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bulk_geocoder_test
+{
+using namespace generator::tests_support;
+using namespace search::search_quality;
+using namespace search::tests_support;
+using namespace search;
+using namespace std;
+
+class BulkGeocoderTest : public SearchTest
+{
+public:
+  BulkGeocoderTest()
+  {
+    TestCity lermontovo({0.5, 0.5}, "Lermontovo", "en", 100 /* rank */);
+    TestCity pushkino({10, 10}, "Pushkino", "en", 100 /* rank */);
+    BuildWorld([&](TestMwmBuilder & builder)
+    {
+      builder.Add(lermontovo);
+      builder.Add(pushkino);
+    });
+
+    m_wonderlandId = BuildCountry("Wonderland", [&](TestMwmBuilder & builder)
+    {
+      builder.Add(m_street);
+      builder.Add(m_cafe);
+    });
+    m_neverlandId = BuildCountry("Neverland", [&](TestMwmBuilder & builder)
+    {
+      builder.Add(m_pushkin);
+      builder.Add(TestPOI({11, 11}, "Pushkin", "en"));
+    });
+
+    m_params.m_maxNumResults = 10;
+    m_params.m_viewport = m2::RectD(-1.0, -1.0, 1.0, 1.0);
+  }
+
+  vector<BulkGeocoder::Query> MakeQueries() const
+  {
+    vector<BulkGeocoder::Query> queries(5);
+    queries[0] = {"0", "Pushkin", "en", m2::PointD(10, 10)};
+    queries[1] = {"1", "Lermontov street", "en", {}};
+    queries[2] = {"2", "Pushkin", "en", m2::PointD(0.5, 0.5)};
+    queries[3] = {"3", "Lermontov street", "en", m2::PointD(0.5, 0.5)};
+    queries[4] = {"4", "Lermontov", "en", {}};
+    return queries;
+  }
+
+protected:
+  TestStreet m_street{vector<m2::PointD>{{0.0, 0.0}, {1.0, 1.0}}, "Lermontov street", "en"};
+  TestCafe m_cafe{m2::PointD(0.5, 0.5), "Lermontov", "en"};
+  TestPOI m_pushkin{m2::PointD(9, 9), "Pushkin", "en"};
+
+  MwmSet::MwmId m_wonderlandId;
+  MwmSet::MwmId m_neverlandId;
+
+  BulkGeocoder::Params m_params;
+};
+
+UNIT_CLASS_TEST(BulkGeocoderTest, Schedule)
+{
+  BulkGeocoder geocoder(m_dataSource, m_engine, m_params);
+
+  // Neverland, then Wonderland ordered by the query, then the queries without a position.
+  TEST_EQUAL(geocoder.Schedule(MakeQueries()), vector<size_t>({0, 3, 2, 4, 1}), ());
+  TEST(geocoder.Schedule({}).empty(), ());
+}
+
+UNIT_CLASS_TEST(BulkGeocoderTest, ScheduleInferredRegion)
+{
+  BulkGeocoder geocoder(m_dataSource, m_engine, m_params);
+
+  auto queries = MakeQueries();
+  queries.push_back({"5", "Pushkin Pushkino", "en", {}});
+  queries.push_back({"6", "Pushkin lermontovo street", "en", {}});
+
+  // The queries without a position which mention a city go with the queries near it.
+  TEST_EQUAL(geocoder.Schedule(queries), vector<size_t>({0, 5, 3, 2, 6, 4, 1}), ());
+}
+
+UNIT_CLASS_TEST(BulkGeocoderTest, Run)
+{
+  BulkGeocoder geocoder(m_dataSource, m_engine, m_params);
+  auto const queries = MakeQueries();
+
+  mutex mu;
+  map<string, vector<Result>> responses;
+  size_t numResponses = 0;
+  auto const stats = geocoder.Run(queries, [&](BulkGeocoder::Query const & query, Results const & results)
+  {
+    TEST(results.IsEndMarker(), ());
+    lock_guard<mutex> lock(mu);
+    ++numResponses;
+    responses[query.m_id].assign(results.begin(), results.end());
+  });
+
+  TEST_EQUAL(numResponses, queries.size(), ());
+  TEST_EQUAL(responses.size(), queries.size(), ());
+  TEST_EQUAL(stats.m_numQueries, queries.size(), ());
+  TEST_EQUAL(stats.m_numCancelled, 0, ());
+
+  auto const found = [&](string const & id, Rule const & rule)
+  {
+    for (auto const & result : responses[id])
+      if (IsResultMatches(result, rule))
+        return true;
+    return false;
+  };
+
+  TEST(found("0", ExactMatch(m_neverlandId, m_pushkin)), ());
+  TEST(found("1", ExactMatch(m_wonderlandId, m_street)), ());
+  TEST(found("2", ExactMatch(m_neverlandId, m_pushkin)), ());
+  TEST(found("3", ExactMatch(m_wonderlandId, m_street)), ());
+  TEST(found("4", ExactMatch(m_wonderlandId, m_cafe)), ());
+
+  // The geocoder is reusable.
+  TEST_EQUAL(geocoder.Run({}, [](BulkGeocoder::Query const &, Results const &) {}).m_numQueries, 0, ());
+}
+
+UNIT_TEST(BulkGeocoder_ParseQuery)
+{
+  BulkGeocoder::Query query;
+  TEST(BulkGeocoder::ParseQuery("Berlin Unter den Linden 1", 7 /* lineNumber */, "de", query), ());
+  TEST_EQUAL(query.m_id, "7", ());
+  TEST_EQUAL(query.m_query, "Berlin Unter den Linden 1", ());
+  TEST_EQUAL(query.m_locale, "de", ());
+  TEST(!query.m_position, ());
+
+  string const full = R"({"id": "42", "query": "Pushkin", "locale": "ru", "lat": 55.75, "lon": 37.61})";
+  TEST(BulkGeocoder::ParseQuery(full, 8 /* lineNumber */, "de", query), ());
+  TEST_EQUAL(query.m_id, "42", ());
+  TEST_EQUAL(query.m_query, "Pushkin", ());
+  TEST_EQUAL(query.m_locale, "ru", ());
+  TEST(query.m_position, ());
+  TEST(query.m_position->EqualDxDy(mercator::FromLatLon(55.75, 37.61), 1e-9), ());
+
+  // The line number and the default locale are kept when the id and the locale are missing.
+  query = {};
+  TEST(BulkGeocoder::ParseQuery(R"({"query": "Pushkin"})", 9 /* lineNumber */, "de", query), ());
+  TEST_EQUAL(query.m_id, "9", ());
+  TEST_EQUAL(query.m_query, "Pushkin", ());
+  TEST_EQUAL(query.m_locale, "de", ());
+  TEST(!query.m_position, ());
+
+  TEST(!BulkGeocoder::ParseQuery(R"({"id": "1"})", 10 /* lineNumber */, "de", query), ());
+  TEST(!BulkGeocoder::ParseQuery(R"({"query": "Pushkin", "lat": 55.75})", 11 /* lineNumber */, "de", query), ());
+  TEST(!BulkGeocoder::ParseQuery(R"({"query": )", 12 /* lineNumber */, "de", query), ());
+}
+}  // namespace bulk_geocoder_test
@@ -50,6 +50,8 @@ using namespace std;
 DEFINE_string(data_path, "", "Path to data directory (resources dir)");
 DEFINE_string(locale, "en", "Locale of all the search queries");
 DEFINE_int32(num_threads, 1, "Number of search engine threads");
+DEFINE_int32(geocoder_threads, 1, "Number of threads which process mwms of a single query");
+DEFINE_int32(retrieval_cache_mb, 0, "Size of the retrieval cache shared by the search threads, 0 to disable");
 DEFINE_string(mwm_list_path, "", "Path to a file containing the names of available mwms, one per line");
 DEFINE_string(mwm_path, "", "Path to mwm files (writable dir)");
 DEFINE_string(queries_path, "", "Path to the file with queries");
@@ -357,7 +359,8 @@ int main(int argc, char * argv[])
   FrozenDataSource dataSource;
   InitDataSource(dataSource, FLAGS_mwm_list_path);
 
-  auto engine = InitSearchEngine(dataSource, FLAGS_locale, FLAGS_num_threads);
+  auto engine = InitSearchEngine(dataSource, FLAGS_locale, FLAGS_num_threads, FLAGS_geocoder_threads,
+                                 static_cast<size_t>(FLAGS_retrieval_cache_mb) * 1024 * 1024);
   engine->InitAffiliations();
 
   m2::RectD viewport;
@@ -373,5 +376,7 @@ int main(int argc, char * argv[])
 
   RunRequests(*engine, viewport, FLAGS_queries_path, FLAGS_locale, FLAGS_ranking_csv_file,
               static_cast<size_t>(FLAGS_top));
+  if (FLAGS_retrieval_cache_mb > 0)
+    cout << DebugPrint(engine->GetRetrievalCacheStats()) << endl;
   return 0;
 }
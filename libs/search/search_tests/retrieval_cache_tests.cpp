@@ -0,0 +1,151 @@
+#include "testing/testing.hpp"
+
+#include "search/retrieval.hpp"
+#include "search/retrieval_cache.hpp"
+
+#include "search/search_tests/retrieval_tools.hpp"
+
+#include "platform/country_file.hpp"
+#include "platform/local_country_file.hpp"
+
+#include "base/string_utils.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace retrieval_cache_tests
+{
+using namespace search;
+using namespace std;
+
+UNIT_TEST(RetrievalCache_Smoke)
+{
+  RetrievalCache cache(1024 * 1024 /* maxBytes */);
+
+  Retrieval::ExtendedFeatures features;
+  TEST(!cache.Find(MakeKey(kWonderland, "cafe"), features), ());
+
+  cache.Insert(MakeKey(kWonderland, "cafe"), MakeFeatures({1, 5, 10}));
+  TEST(cache.Find(MakeKey(kWonderland, "cafe"), features), ());
+  TEST_EQUAL(GetIds(features), vector<uint64_t>({1, 5, 10}), ());
+
+  // Other mwm, version or request.
+  TEST(!cache.Find(MakeKey(kNeverland, "cafe"), features), ());
+  TEST(!cache.Find(MakeKey(kWonderland, "caf"), features), ());
+  auto key = MakeKey(kWonderland, "cafe");
+  key.m_version = 2;
+  TEST(!cache.Find(key, features), ());
+
+  auto const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hits, 1, ());
+  TEST_EQUAL(stats.m_misses, 4, ());
+  TEST_EQUAL(stats.m_numEntries, 1, ());
+  TEST_GREATER(stats.m_bytes, 0, ());
+
+  cache.Clear();
+  TEST(!cache.Find(MakeKey(kWonderland, "cafe"), features), ());
+  TEST_EQUAL(cache.GetStats().m_bytes, 0, ());
+}
+
+UNIT_TEST(RetrievalCache_Eviction)
+{
+  vector<uint64_t> ids(100);
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = i * 1000;
+
+  // A single shard, so all the entries are in the same LRU.
+  RetrievalCache cache(4000 /* maxBytes */, 1 /* shardsCount */);
+  cache.Insert(MakeKey(kWonderland, "a"), MakeFeatures(ids));
+  cache.Insert(MakeKey(kWonderland, "b"), MakeFeatures(ids));
+
+  Retrieval::ExtendedFeatures features;
+  TEST(cache.Find(MakeKey(kWonderland, "a"), features), ());
+  TEST(cache.Find(MakeKey(kWonderland, "b"), features), ());
+
+  // "a" is the least recently used one.
+  cache.Insert(MakeKey(kWonderland, "c"), MakeFeatures(ids));
+  TEST(!cache.Find(MakeKey(kWonderland, "a"), features), ());
+  TEST(cache.Find(MakeKey(kWonderland, "b"), features), ());
+  TEST(cache.Find(MakeKey(kWonderland, "c"), features), ());
+  TEST_EQUAL(cache.GetStats().m_evictions, 1, ());
+  TEST_LESS_OR_EQUAL(cache.GetStats().m_bytes, 4000, ());
+
+  // Too big to be cached at all.
+  ids.resize(1000);
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = i * 1000;
+  cache.Insert(MakeKey(kWonderland, "d"), MakeFeatures(ids));
+  TEST(!cache.Find(MakeKey(kWonderland, "d"), features), ());
+  TEST(cache.Find(MakeKey(kWonderland, "c"), features), ());
+}
+
+UNIT_TEST(RetrievalCache_Shards)
+{
+  auto const features = MakeFeatures({1, 2, 3});
+  size_t const entryBytes = RetrievalCache::EstimateBytes(MakeKey(kWonderland, "0"), features);
+  size_t constexpr kNumKeys = 100;
+
+  RetrievalCache big(kNumKeys * entryBytes * 4 /* maxBytes */, 4 /* shardsCount */);
+  for (size_t i = 0; i < kNumKeys; ++i)
+    big.Insert(MakeKey(kWonderland, strings::to_string(i)), features);
+  TEST_EQUAL(big.GetStats().m_numEntries, kNumKeys, ());
+  Retrieval::ExtendedFeatures found;
+  for (size_t i = 0; i < kNumKeys; ++i)
+    TEST(big.Find(MakeKey(kWonderland, strings::to_string(i)), found), (i));
+  TEST_EQUAL(big.GetStats().m_hits, kNumKeys, ());
+
+  // Every shard keeps its part of the limit.
+  RetrievalCache small(10 * entryBytes /* maxBytes */, 4 /* shardsCount */);
+  for (size_t i = 0; i < kNumKeys; ++i)
+    small.Insert(MakeKey(kWonderland, strings::to_string(i)), features);
+  auto const stats = small.GetStats();
+  TEST_LESS_OR_EQUAL(stats.m_bytes, 10 * entryBytes, ());
+  TEST_GREATER(stats.m_numEntries, 0, ());
+  TEST_EQUAL(stats.m_numEntries + stats.m_evictions, kNumKeys, ());
+}
+
+UNIT_TEST(RetrievalCache_FindNarrowed)
+{
+  RetrievalCache cache(1024 * 1024 /* maxBytes */);
+  cache.Insert(MakeKey(kWonderland, "caf"), MakeFeatures({1}));
+  cache.Insert(MakeKey(kNeverland, "caf"), MakeFeatures({}));
+
+  Retrieval::ExtendedFeatures features;
+  // The wider request has matched something, so the narrowed one must be retrieved.
+  TEST(!cache.FindNarrowed(MakeKey(kWonderland, "cafe"), "caf", features), ());
+  // The wider request is unknown.
+  TEST(!cache.FindNarrowed(MakeKey(kNeverland, "cafe"), "ca", features), ());
+  TEST(!cache.FindNarrowed(MakeKey(kNeverland, "cafe"), "", features), ());
+
+  features = MakeFeatures({1});
+  TEST(cache.FindNarrowed(MakeKey(kNeverland, "cafe"), "caf", features), ());
+  TEST(features.m_features.IsEmpty(), ());
+  // The narrowed retrieval is cached.
+  TEST(cache.Find(MakeKey(kNeverland, "cafe"), features), ());
+  TEST(features.m_features.IsEmpty(), ());
+
+  auto const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hits, 1, ());
+  TEST_EQUAL(stats.m_misses, 3, ());
+  TEST_EQUAL(stats.m_narrowed, 1, ());
+  TEST_EQUAL(stats.m_numEntries, 3, ());
+}
+
+UNIT_TEST(RetrievalCache_MapDeregistered)
+{
+  RetrievalCache cache(1024 * 1024 /* maxBytes */);
+  cache.Insert(MakeKey(kWonderland, "cafe"), MakeFeatures({1}));
+  cache.Insert(MakeKey(kWonderland, "bar"), MakeFeatures({2}));
+  cache.Insert(MakeKey(kNeverland, "cafe"), MakeFeatures({3}));
+
+  cache.OnMapDeregistered(platform::LocalCountryFile("", platform::CountryFile(kWonderland), 1 /* version */));
+
+  Retrieval::ExtendedFeatures features;
+  TEST(!cache.Find(MakeKey(kWonderland, "cafe"), features), ());
+  TEST(!cache.Find(MakeKey(kWonderland, "bar"), features), ());
+  TEST(cache.Find(MakeKey(kNeverland, "cafe"), features), ());
+  TEST_EQUAL(GetIds(features), vector<uint64_t>({3}), ());
+  TEST_EQUAL(cache.GetStats().m_numEntries, 1, ());
+}
+}  // namespace retrieval_cache_tests
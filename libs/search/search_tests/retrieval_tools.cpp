@@ -0,0 +1,50 @@
+#include "search/search_tests/retrieval_tools.hpp"
+
+#include "search/cbv.hpp"
+
+#include "indexer/search_string_utils.hpp"
+
+#include "coding/compressed_bit_vector.hpp"
+
+namespace search
+{
+using namespace std;
+
+QueryParams MakeParams(string const & query)
+{
+  auto const tokens = NormalizeAndTokenizeString(query);
+  bool const lastTokenIsPrefix = !query.empty() && query.back() != ' ';
+
+  QueryParams params;
+  params.Init(query, tokens, lastTokenIsPrefix);
+  params.GetLangs().Insert(0);
+  return params;
+}
+
+RetrievalCache::Key MakeKey(string const & countryName, string const & request)
+{
+  RetrievalCache::Key key;
+  key.m_countryName = countryName;
+  key.m_version = 1;
+  key.m_request = request;
+  return key;
+}
+
+RetrievalCache::Key MakeKey(string const & countryName, QueryParams const & params, size_t tokenIndex)
+{
+  return MakeKey(countryName, RetrievalCache::MakeRequest(params, tokenIndex));
+}
+
+Retrieval::ExtendedFeatures MakeFeatures(vector<uint64_t> const & ids)
+{
+  CBV const cbv(coding::CompressedBitVectorBuilder::FromBitPositions(ids));
+  return Retrieval::ExtendedFeatures(cbv);
+}
+
+vector<uint64_t> GetIds(Retrieval::ExtendedFeatures const & features)
+{
+  vector<uint64_t> ids;
+  features.m_features.ForEach([&ids](uint64_t id) { ids.push_back(id); });
+  return ids;
+}
+}  // namespace search
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "search/query_params.hpp"
+#include "search/retrieval.hpp"
+#include "search/retrieval_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace search
+{
+inline std::string const kWonderland = "Wonderland";
+inline std::string const kNeverland = "Neverland";
+
+QueryParams MakeParams(std::string const & query);
+
+RetrievalCache::Key MakeKey(std::string const & countryName, std::string const & request);
+RetrievalCache::Key MakeKey(std::string const & countryName, QueryParams const & params, size_t tokenIndex);
+
+Retrieval::ExtendedFeatures MakeFeatures(std::vector<uint64_t> const & ids);
+
+std::vector<uint64_t> GetIds(Retrieval::ExtendedFeatures const & features);
+
+// Fixture of two mwms: Wonderland has features {1, 2, 3} for every request and Neverland has none.
+class TwoMwmsRetrievalTest
+{
+public:
+  // Calls |fn| with the name of every mwm and the features retrieved for a request in it.
+  template <typename Fn>
+  static void ForEachMwm(Fn && fn)
+  {
+    fn(kWonderland, MakeFeatures({1, 2, 3}));
+    fn(kNeverland, MakeFeatures({}));
+  }
+};
+}  // namespace search
@@ -0,0 +1,133 @@
+#include "testing/testing.hpp"
+
+#include "search/query_params.hpp"
+#include "search/retrieval.hpp"
+#include "search/retrieval_cache.hpp"
+#include "search/type_ahead_session.hpp"
+
+#include "search/search_tests/retrieval_tools.hpp"
+
+#include "indexer/search_string_utils.hpp"
+
+#include <string>
+
+namespace type_ahead_session_tests
+{
+using namespace search;
+using namespace std;
+
+class TypeAheadSessionTest : public TwoMwmsRetrievalTest
+{
+public:
+  TypeAheadSessionTest() : m_cache(1024 * 1024 /* maxBytes */) {}
+
+  // Emulates retrieval of all tokens of |query| in every mwm, like Geocoder does.
+  bool Search(string const & query)
+  {
+    m_params = MakeParams(query);
+    bool const extends = m_session.StartQuery(m_params);
+    for (size_t i = 0; i < m_params.GetNumTokens(); ++i)
+    {
+      ForEachMwm([&](string const & countryName, Retrieval::ExtendedFeatures const & features)
+      { Retrieve(countryName, i, features); });
+    }
+    return extends;
+  }
+
+  bool IsNarrowed() const { return !m_session.GetWiderPrefixRequest().empty(); }
+
+  RetrievalCache::Stats GetStats() const { return m_cache.GetStats(); }
+
+  RetrievalCache m_cache;
+  TypeAheadSession m_session;
+  QueryParams m_params;
+
+private:
+  void Retrieve(string const & countryName, size_t tokenIndex, Retrieval::ExtendedFeatures const & features)
+  {
+    auto key = MakeKey(countryName, m_params, tokenIndex);
+    Retrieval::ExtendedFeatures found;
+    bool const cached = m_params.IsPrefixToken(tokenIndex)
+                            ? m_cache.FindNarrowed(key, m_session.GetWiderPrefixRequest(), found)
+                            : m_cache.Find(key, found);
+    if (!cached)
+      m_cache.Insert(std::move(key), features);
+  }
+};
+
+UNIT_CLASS_TEST(TypeAheadSessionTest, ExtendedPrefix)
+{
+  TEST(!Search("berl"), ());
+  TEST(!IsNarrowed(), ());
+
+  // Neverland has no features for "berl", so it has none for "berli" too.
+  TEST(Search("berli"), ());
+  TEST(IsNarrowed(), ());
+  TEST_EQUAL(GetStats().m_hits, 0, ());
+  TEST_EQUAL(GetStats().m_narrowed, 1, ());
+
+  // The same query is served by the cache, including the narrowed retrieval.
+  TEST(Search("berli"), ());
+  TEST_EQUAL(GetStats().m_hits, 2, ());
+  TEST_EQUAL(GetStats().m_narrowed, 1, ());
+
+  // The narrowed retrieval narrows further.
+  TEST(Search("berlin"), ());
+  TEST_EQUAL(GetStats().m_narrowed, 2, ());
+
+  // Backspace restarts the session.
+  TEST(!Search("berl"), ());
+  TEST(!IsNarrowed(), ());
+}
+
+UNIT_CLASS_TEST(TypeAheadSessionTest, FullTokens)
+{
+  TEST(!Search("berlin zo"), ());
+  TEST(Search("berlin zoo"), ());
+  // "berlin" in both mwms is cached and "zoo" in Neverland is narrowed.
+  TEST_EQUAL(GetStats().m_hits, 2, ());
+  TEST_EQUAL(GetStats().m_narrowed, 1, ());
+
+  // The prefix becomes a full token.
+  TEST(Search("berlin zoo "), ());
+  TEST(!IsNarrowed(), ());
+
+  // A new prefix token.
+  TEST(Search("berlin zoo g"), ());
+  TEST(!IsNarrowed(), ());
+
+  // Other first token.
+  TEST(!Search("bern zoo g"), ());
+  TEST(!IsNarrowed(), ());
+}
+
+UNIT_CLASS_TEST(TypeAheadSessionTest, Synonyms)
+{
+  // "al" has synonyms ("alley", "allee", ...) and they are not checked against the previous prefix.
+  TEST(!Search("berlin a"), ());
+  TEST(Search("berlin al"), ());
+  TEST(!IsNarrowed(), ());
+  TEST_EQUAL(GetStats().m_hits, 2, ());
+  TEST_EQUAL(GetStats().m_narrowed, 0, ());
+}
+
+UNIT_CLASS_TEST(TypeAheadSessionTest, MoreMisprints)
+{
+  // "berlinxy" may have two misprints and "berlinx" only one.
+  TEST_LESS(GetMaxErrorsForToken(MakeParams("berlinx").GetToken(0).GetOriginal()),
+            GetMaxErrorsForToken(MakeParams("berlinxy").GetToken(0).GetOriginal()), ());
+
+  TEST(!Search("berlinx"), ());
+  TEST(Search("berlinxy"), ());
+  TEST(!IsNarrowed(), ());
+  TEST_EQUAL(GetStats().m_narrowed, 0, ());
+}
+
+UNIT_CLASS_TEST(TypeAheadSessionTest, Clear)
+{
+  TEST(!Search("berl"), ());
+  m_session.Clear();
+  TEST(!m_session.StartQuery(MakeParams("berli")), ());
+  TEST(!IsNarrowed(), ());
+}
+}  // namespace type_ahead_session_tests
@@ -13,9 +13,19 @@ namespace tests_support
 {
 using namespace std;
 
-SearchTestBase::SearchTestBase(base::LogLevel logLevel, bool mockCountryInfo)
+namespace
+{
+Engine::Params MakeEngineParams(size_t numGeocoderThreads)
+{
+  Engine::Params params;
+  params.m_numGeocoderThreads = numGeocoderThreads;
+  return params;
+}
+}  // namespace
+
+SearchTestBase::SearchTestBase(base::LogLevel logLevel, bool mockCountryInfo, size_t numGeocoderThreads)
   : m_scopedLog(logLevel)
-  , m_engine(m_dataSource, {}, mockCountryInfo)
+  , m_engine(m_dataSource, MakeEngineParams(numGeocoderThreads), mockCountryInfo)
 {
   SetViewport(mercator::Bounds::FullRect());
 
@@ -24,7 +24,7 @@ public:
   using Rule = std::shared_ptr<MatchingRule>;
   using Rules = std::vector<Rule>;
 
-  SearchTestBase(base::LogLevel logLevel, bool mockCountryInfo);
+  SearchTestBase(base::LogLevel logLevel, bool mockCountryInfo, size_t numGeocoderThreads = 1);
 
   inline void SetViewport(m2::RectD const & viewport) { m_viewport = viewport; }
   void SetViewport(ms::LatLon const & ll, double radiusM);
@@ -66,7 +66,9 @@ protected:
 class SearchTest : public SearchTestBase
 {
 public:
-  explicit SearchTest(base::LogLevel logLevel = base::LDEBUG) : SearchTestBase(logLevel, true /* mockCountryInfo*/) {}
+  explicit SearchTest(base::LogLevel logLevel = base::LDEBUG, size_t numGeocoderThreads = 1)
+    : SearchTestBase(logLevel, true /* mockCountryInfo*/, numGeocoderThreads)
+  {}
 
   // Registers country in internal records. Note that physical country file may be absent.
   void RegisterCountry(std::string const & name, m2::RectD const & rect);
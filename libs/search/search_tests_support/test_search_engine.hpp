@@ -27,6 +27,10 @@ public:
 
   void LoadCitiesBoundaries() { m_engine.LoadCitiesBoundaries(); }
 
+  size_t GetNumThreads() const { return m_engine.GetNumThreads(); }
+
+  RetrievalCache::Stats GetRetrievalCacheStats() const { return m_engine.GetRetrievalCacheStats(); }
+
   std::weak_ptr<ProcessorHandle> Search(SearchParams const & params);
 
   storage::CountryInfoGetter & GetCountryInfoGetter() { return *m_infoGetter; }
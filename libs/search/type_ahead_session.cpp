@@ -0,0 +1,93 @@
+#include "search/type_ahead_session.hpp"
+
+#include "search/retrieval_cache.hpp"
+
+#include "indexer/search_string_utils.hpp"
+
+#include "base/stl_helpers.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace search
+{
+using namespace std;
+
+bool TypeAheadSession::StartQuery(QueryParams const & params)
+{
+  auto query = MakeQuery(params);
+
+  bool const extends = m_active && Extends(query, m_query);
+  if (extends && NarrowsPrefix(params, query, m_query))
+    m_widerPrefixRequest = std::move(m_query.m_prefixRequest);
+  else
+    m_widerPrefixRequest.clear();
+
+  m_query = std::move(query);
+  m_active = true;
+  return extends;
+}
+
+void TypeAheadSession::Clear()
+{
+  m_active = false;
+  m_query = {};
+  m_widerPrefixRequest.clear();
+}
+
+// static
+TypeAheadSession::Query TypeAheadSession::MakeQuery(QueryParams const & params)
+{
+  Query query;
+  size_t const numTokens = params.GetNumTokens();
+  for (size_t i = 0; i < numTokens; ++i)
+    query.m_tokens.push_back(params.GetToken(i).GetOriginal());
+
+  query.m_lastTokenIsPrefix = params.LastTokenIsPrefix();
+  for (auto const lang : params.GetLangs())
+    query.m_langs.push_back(lang);
+
+  if (query.m_lastTokenIsPrefix)
+  {
+    query.m_prefixTypes = params.GetTypeIndices(numTokens - 1);
+    base::SortUnique(query.m_prefixTypes);
+    query.m_prefixRequest = RetrievalCache::MakeRequest(params, numTokens - 1);
+  }
+  return query;
+}
+
+// static
+bool TypeAheadSession::Extends(Query const & query, Query const & prev)
+{
+  if (query.m_langs != prev.m_langs || prev.m_tokens.empty() || query.m_tokens.size() < prev.m_tokens.size())
+    return false;
+
+  size_t const last = prev.m_tokens.size() - 1;
+  for (size_t i = 0; i < last; ++i)
+  {
+    if (query.m_tokens[i] != prev.m_tokens[i])
+      return false;
+  }
+  return strings::StartsWith(query.m_tokens[last], prev.m_tokens[last]);
+}
+
+// static
+bool TypeAheadSession::NarrowsPrefix(QueryParams const & params, Query const & query, Query const & prev)
+{
+  if (!query.m_lastTokenIsPrefix || !prev.m_lastTokenIsPrefix || query.m_tokens.size() != prev.m_tokens.size())
+    return false;
+
+  // Synonyms of the prefix token are arbitrary strings which the previous prefix does not cover.
+  auto const & token = params.GetToken(params.GetNumTokens() - 1);
+  if (token.AnyOfSynonyms([](strings::UniString const &) { return true; }))
+    return false;
+
+  // When a name has a prefix within k misprints of the longer token, it has a prefix within k misprints
+  // of the shorter token too. But the longer token may be allowed to have more misprints.
+  if (GetMaxErrorsForToken(query.m_tokens.back()) > GetMaxErrorsForToken(prev.m_tokens.back()))
+    return false;
+
+  return includes(prev.m_prefixTypes.begin(), prev.m_prefixTypes.end(), query.m_prefixTypes.begin(),
+                  query.m_prefixTypes.end());
+}
+}  // namespace search
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "search/query_params.hpp"
+
+#include "base/macros.hpp"
+#include "base/string_utils.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace search
+{
+// The last query of a type-ahead session, i.e. of the queries posted on every keystroke while the
+// user types "Berl", "Berli", "Berlin". Retrievals of the unchanged tokens are served by the shared
+// RetrievalCache. When a query extends the previous one, the session also tells which request of
+// the previous query covers the extended prefix token: its features are a superset of the features
+// of the extended prefix, so the extended prefix is not retrieved in mwms where the shorter prefix
+// has matched nothing, see RetrievalCache::FindNarrowed().
+//
+// The session is changed by the processor before the query is geocoded and is only read by the
+// geocoder threads, so it's not synchronized.
+class TypeAheadSession
+{
+public:
+  TypeAheadSession() = default;
+
+  // Starts the next query of the session. Returns true when |params| extends the previous query:
+  // all tokens but the last one of the previous query are the same and its last token is a prefix of
+  // the corresponding token of |params|. Otherwise the session is restarted.
+  bool StartQuery(QueryParams const & params);
+
+  // Finishes the session, the next query starts a new one.
+  void Clear();
+
+  // Returns RetrievalCache::Key::m_request of the prefix token of the previous query when every feature
+  // matching the prefix token of the current query also matches it. Otherwise returns an empty string.
+  std::string const & GetWiderPrefixRequest() const { return m_widerPrefixRequest; }
+
+private:
+  struct Query
+  {
+    std::vector<strings::UniString> m_tokens;
+    bool m_lastTokenIsPrefix = false;
+    std::vector<uint64_t> m_langs;
+    QueryParams::TypeIndices m_prefixTypes;
+    std::string m_prefixRequest;
+  };
+
+  static Query MakeQuery(QueryParams const & params);
+
+  static bool Extends(Query const & query, Query const & prev);
+
+  // Returns true when every feature matching the prefix token of |query| also matches the prefix
+  // token of |prev|.
+  static bool NarrowsPrefix(QueryParams const & params, Query const & query, Query const & prev);
+
+  bool m_active = false;
+  Query m_query;
+  std::string m_widerPrefixRequest;
+
+  DISALLOW_COPY_AND_MOVE(TypeAheadSession);
+};
+}  // namespace search
@@ -12,6 +12,8 @@
 #include "geometry/angles.hpp"
 #include "geometry/point_with_altitude.hpp"
 
+#include "base/timer.hpp"
+
 #include <algorithm>
 #include <iterator>
 #include <queue>
@@ -78,9 +80,14 @@ bool CandidatePathsGetter::GetLineCandidatesForPoints(vector<LocationReferencePo
     auto const isLastPoint = i == points.size() - 1;
     double const distanceToNextPointM = (isLastPoint ? points[i - 1] : points[i]).m_distanceToNextPoint;
 
+    base::Timer timer;
     vector<m2::PointD> pointCandidates;
     m_pointsGetter.GetCandidatePoints(mercator::FromLatLon(points[i].m_latLon), pointCandidates);
+    m_stats.m_candidatePointsSeconds += timer.ElapsedSeconds();
+
+    timer.Reset();
     GetLineCandidates(points[i], isLastPoint, distanceToNextPointM, pointCandidates, lineCandidates.back());
+    m_stats.m_candidatePathsSeconds += timer.ElapsedSeconds();
 
     if (lineCandidates.back().empty())
     {
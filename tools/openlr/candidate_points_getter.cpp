@@ -19,6 +19,23 @@ using namespace routing;
 namespace openlr
 {
 void CandidatePointsGetter::FillJunctionPointCandidates(m2::PointD const & p, std::vector<m2::PointD> & candidates)
+{
+  if (!m_sharedCache)
+  {
+    FindJunctionPointCandidates(p, candidates);
+    return;
+  }
+
+  auto const cached = m_sharedCache->GetOrLoad(PointKey(p), [this, &p]()
+  {
+    std::vector<m2::PointD> junctions;
+    FindJunctionPointCandidates(p, junctions);
+    return junctions;
+  });
+  candidates.insert(candidates.end(), cached.cbegin(), cached.cend());
+}
+
+void CandidatePointsGetter::FindJunctionPointCandidates(m2::PointD const & p, std::vector<m2::PointD> & candidates)
 {
   // TODO(mgsergio): Get optimal value using experiments on a sample.
   // Or start with small radius and scale it up when there are too few points.
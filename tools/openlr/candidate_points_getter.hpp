@@ -1,5 +1,6 @@
 #pragma once
 
+#include "openlr/concurrent_cache.hpp"
 #include "openlr/graph.hpp"
 #include "openlr/stats.hpp"
 
@@ -16,12 +17,17 @@ namespace openlr
 class CandidatePointsGetter
 {
 public:
+  /// Junction candidates of a point, they don't depend on the graph fakes.
+  using SharedCache = ConcurrentCache<PointKey, std::vector<m2::PointD>, PointKey::Hash>;
+
+  /// \param sharedCache may be shared with the getters of other threads, may be nullptr.
   CandidatePointsGetter(size_t const maxJunctionCandidates, size_t const maxProjectionCandidates,
-                        DataSource const & dataSource, Graph & graph)
+                        DataSource const & dataSource, Graph & graph, SharedCache * sharedCache = nullptr)
     : m_maxJunctionCandidates(maxJunctionCandidates)
     , m_maxProjectionCandidates(maxProjectionCandidates)
     , m_dataSource(dataSource)
     , m_graph(graph)
+    , m_sharedCache(sharedCache)
   {}
 
   void GetCandidatePoints(m2::PointD const & p, std::vector<m2::PointD> & candidates)
@@ -32,6 +38,7 @@ public:
 
 private:
   void FillJunctionPointCandidates(m2::PointD const & p, std::vector<m2::PointD> & candidates);
+  void FindJunctionPointCandidates(m2::PointD const & p, std::vector<m2::PointD> & candidates);
   void EnrichWithProjectionPoints(m2::PointD const & p, std::vector<m2::PointD> & candidates);
 
   size_t const m_maxJunctionCandidates;
@@ -39,5 +46,6 @@ private:
 
   DataSource const & m_dataSource;
   Graph & m_graph;
+  SharedCache * m_sharedCache;
 };
 }  // namespace openlr
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "geometry/point2d.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace openlr
+{
+/// \brief Key of a point by the exact bits of its coordinates. Candidates are computed for the exact point,
+/// so only the location reference points of different segments with the same coordinates share them.
+class PointKey
+{
+public:
+  struct Hash
+  {
+    size_t operator()(PointKey const & p) const
+    {
+      return std::hash<uint64_t>()(p.m_x * 0x9E3779B97F4A7C15ULL ^ p.m_y);
+    }
+  };
+
+  explicit PointKey(m2::PointD const & mercator)
+    : m_x(std::bit_cast<uint64_t>(mercator.x))
+    , m_y(std::bit_cast<uint64_t>(mercator.y))
+  {}
+
+  bool operator==(PointKey const & rhs) const { return m_x == rhs.m_x && m_y == rhs.m_y; }
+
+private:
+  uint64_t m_x;
+  uint64_t m_y;
+};
+
+/// \brief Cache which is shared by the decoders of several threads. It's split into shards with separate locks.
+/// The cache is limited by the number of values, a shard is cleared when it's full. It's thread-safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentCache
+{
+public:
+  explicit ConcurrentCache(size_t maxSize) : m_shardMaxSize(std::max(maxSize / kShardsCount, size_t{1})) {}
+
+  /// \returns the cached value or the value made by |load|, which is called without the lock.
+  template <typename Load>
+  Value GetOrLoad(Key const & key, Load && load)
+  {
+    auto & shard = m_shards[Hash()(key) % kShardsCount];
+    {
+      std::lock_guard lock(shard.m_mutex);
+      auto const it = shard.m_values.find(key);
+      if (it != shard.m_values.cend())
+      {
+        ++shard.m_hits;
+        return it->second;
+      }
+      ++shard.m_misses;
+    }
+
+    Value value = load();
+
+    std::lock_guard lock(shard.m_mutex);
+    if (shard.m_values.size() >= m_shardMaxSize)
+      shard.m_values.clear();
+    shard.m_values.emplace(key, value);
+    return value;
+  }
+
+  /// \returns the number of found and not found values.
+  std::pair<uint64_t, uint64_t> GetHitsAndMisses() const
+  {
+    std::pair<uint64_t, uint64_t> result;
+    for (auto const & shard : m_shards)
+    {
+      std::lock_guard lock(shard.m_mutex);
+      result.first += shard.m_hits;
+      result.second += shard.m_misses;
+    }
+    return result;
+  }
+
+private:
+  static size_t constexpr kShardsCount = 16;
+
+  struct Shard
+  {
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, Value, Hash> m_values;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+  };
+
+  size_t const m_shardMaxSize;
+  std::array<Shard, kShardsCount> m_shards;
+};
+}  // namespace openlr
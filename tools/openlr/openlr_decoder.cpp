@@ -3,6 +3,7 @@
 #include "openlr/cache_line_size.hpp"
 #include "openlr/candidate_paths_getter.hpp"
 #include "openlr/candidate_points_getter.hpp"
+#include "openlr/concurrent_cache.hpp"
 #include "openlr/decoded_path.hpp"
 #include "openlr/graph.hpp"
 #include "openlr/helpers.hpp"
@@ -35,6 +36,7 @@
 
 #include "base/logging.hpp"
 #include "base/math.hpp"
+#include "base/scope_guard.hpp"
 #include "base/stl_helpers.hpp"
 #include "base/timer.hpp"
 
@@ -53,6 +55,19 @@ using namespace std;
 
 namespace openlr
 {
+/// Candidates and road info which are shared by the threads of the decoder. The segments of a feed often
+/// share locations, e.g. the last point of a segment is the first point of the next one.
+struct DecoderCaches
+{
+  // The limits are the numbers of points and features. They are big enough for a feed of a country.
+  static size_t constexpr kMaxPoints = 1000000;
+  static size_t constexpr kMaxRoads = 1000000;
+
+  CandidatePointsGetter::SharedCache m_points{kMaxPoints};
+  ScoreCandidatePointsGetter::SharedCache m_scorePoints{kMaxPoints};
+  RoadInfoGetter::SharedCache m_roadInfo{kMaxRoads};
+};
+
 namespace
 {
 struct alignas(kCacheLineSize) Stats
@@ -219,10 +234,11 @@ void CopyWithoutOffsets(InputIterator start, InputIterator stop, OutputIterator
 class SegmentsDecoderV2
 {
 public:
-  SegmentsDecoderV2(DataSource & dataSource, unique_ptr<CarModelFactory> cmf)
+  SegmentsDecoderV2(DataSource & dataSource, unique_ptr<CarModelFactory> cmf, DecoderCaches & caches)
     : m_dataSource(dataSource)
     , m_graph(dataSource, std::move(cmf))
-    , m_infoGetter(dataSource)
+    , m_infoGetter(dataSource, &caches.m_roadInfo)
+    , m_caches(caches)
   {}
 
   bool DecodeSegment(LinearSegment const & segment, DecodedPath & path, v2::Stats & stat)
@@ -241,17 +257,24 @@ public:
     lineCandidates.reserve(points.size());
     LOG(LDEBUG, ("Decoding segment:", segment.m_segmentId, "with", points.size(), "points"));
 
-    CandidatePointsGetter pointsGetter(kMaxJunctionCandidates, kMaxProjectionCandidates, m_dataSource, m_graph);
+    CandidatePointsGetter pointsGetter(kMaxJunctionCandidates, kMaxProjectionCandidates, m_dataSource, m_graph,
+                                       &m_caches.m_points);
     CandidatePathsGetter pathsGetter(pointsGetter, m_graph, m_infoGetter, stat);
 
     if (!pathsGetter.GetLineCandidatesForPoints(points, lineCandidates))
       return false;
 
+    base::Timer timer;
     vector<Graph::EdgeVector> resultPath;
     PathsConnector connector(kPathLengthTolerance, m_graph, m_infoGetter, stat);
-    if (!connector.ConnectCandidates(points, lineCandidates, resultPath))
+    bool const connected = connector.ConnectCandidates(points, lineCandidates, resultPath);
+    stat.m_connectionSeconds += timer.ElapsedSeconds();
+    if (!connected)
       return false;
 
+    timer.Reset();
+    SCOPE_GUARD(offsetsTimeGuard, ([&]() { stat.m_offsetsSeconds += timer.ElapsedSeconds(); }));
+
     Graph::EdgeVector route;
     for (auto const & part : resultPath)
       route.insert(end(route), begin(part), end(part));
@@ -300,6 +323,7 @@ private:
   DataSource const & m_dataSource;
   Graph m_graph;
   RoadInfoGetter m_infoGetter;
+  DecoderCaches & m_caches;
 };
 
 // The idea behind the third version of matching algorithm is to collect a lot of candidates (paths)
@@ -308,10 +332,11 @@ private:
 class SegmentsDecoderV3
 {
 public:
-  SegmentsDecoderV3(DataSource & dataSource, unique_ptr<CarModelFactory> carModelFactory)
+  SegmentsDecoderV3(DataSource & dataSource, unique_ptr<CarModelFactory> carModelFactory, DecoderCaches & caches)
     : m_dataSource(dataSource)
     , m_graph(dataSource, std::move(carModelFactory))
-    , m_infoGetter(dataSource)
+    , m_infoGetter(dataSource, &caches.m_roadInfo)
+    , m_caches(caches)
   {}
 
   bool DecodeSegment(LinearSegment const & segment, DecodedPath & path, v2::Stats & stat)
@@ -329,15 +354,19 @@ public:
     lineCandidates.reserve(points.size());
     LOG(LINFO, ("Decoding segment:", segment.m_segmentId, "with", points.size(), "points"));
 
-    ScoreCandidatePointsGetter pointsGetter(kMaxJunctionCandidates, kMaxProjectionCandidates, m_dataSource, m_graph);
+    ScoreCandidatePointsGetter pointsGetter(kMaxJunctionCandidates, kMaxProjectionCandidates, m_dataSource, m_graph,
+                                            &m_caches.m_scorePoints);
     ScoreCandidatePathsGetter pathsGetter(pointsGetter, m_graph, m_infoGetter, stat);
 
     if (!pathsGetter.GetLineCandidatesForPoints(points, segment.m_source, lineCandidates))
       return false;
 
+    base::Timer timer;
     vector<Graph::EdgeVector> resultPath;
     ScorePathsConnector connector(m_graph, m_infoGetter, stat);
-    if (!connector.FindBestPath(points, lineCandidates, segment.m_source, resultPath))
+    bool const connected = connector.FindBestPath(points, lineCandidates, segment.m_source, resultPath);
+    stat.m_connectionSeconds += timer.ElapsedSeconds();
+    if (!connected)
     {
       LOG(LINFO, ("Connections not found:", segment.m_segmentId));
       auto const mercatorPoints = segment.GetMercatorPoints();
@@ -346,6 +375,9 @@ public:
       return false;
     }
 
+    timer.Reset();
+    SCOPE_GUARD(offsetsTimeGuard, ([&]() { stat.m_offsetsSeconds += timer.ElapsedSeconds(); }));
+
     Graph::EdgeVector route;
     for (auto const & part : resultPath)
       route.insert(route.end(), part.begin(), part.end());
@@ -394,8 +426,16 @@ private:
   DataSource const & m_dataSource;
   Graph m_graph;
   RoadInfoGetter m_infoGetter;
+  DecoderCaches & m_caches;
 };
 
+void LogHitRate(string const & name, pair<uint64_t, uint64_t> const & hitsAndMisses)
+{
+  auto const [hits, misses] = hitsAndMisses;
+  LOG(LINFO, (name, "cache hits:", hits, "misses:", misses, "hit rate:",
+              hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses)));
+}
+
 size_t constexpr GetOptimalBatchSize()
 {
   // This code computes the most optimal (in the sense of cache lines
@@ -436,8 +476,11 @@ OpenLRDecoder::OpenLRDecoder(vector<FrozenDataSource> & dataSources,
                              CountryParentNameGetter const & countryParentNameGetter)
   : m_dataSources(dataSources)
   , m_countryParentNameGetter(countryParentNameGetter)
+  , m_caches(make_unique<DecoderCaches>())
 {}
 
+OpenLRDecoder::~OpenLRDecoder() = default;
+
 void OpenLRDecoder::DecodeV2(vector<LinearSegment> const & segments, uint32_t const numThreads,
                              vector<DecodedPath> & paths)
 {
@@ -460,7 +503,7 @@ void OpenLRDecoder::Decode(vector<LinearSegment> const & segments, uint32_t cons
 
     size_t const numSegments = segments.size();
 
-    Decoder decoder(dataSource, make_unique<CarModelFactory>(m_countryParentNameGetter));
+    Decoder decoder(dataSource, make_unique<CarModelFactory>(m_countryParentNameGetter), *m_caches);
     base::Timer timer;
     for (size_t i = threadNum * kBatchSize; i < numSegments; i += numThreads * kBatchSize)
     {
@@ -494,6 +537,20 @@ void OpenLRDecoder::Decode(vector<LinearSegment> const & segments, uint32_t cons
     allStats.Add(s);
 
   allStats.Report();
-  LOG(LINFO, ("Matching tool:", timer.ElapsedSeconds(), "seconds."));
+  double const seconds = timer.ElapsedSeconds();
+  LOG(LINFO, ("Matching tool:", seconds, "seconds."));
+
+  m_stats.Add(allStats);
+  m_decodingSeconds += seconds;
+}
+
+void OpenLRDecoder::ReportStats() const
+{
+  m_stats.Report();
+  LOG(LINFO, ("Decoding time:", m_decodingSeconds, "seconds, segments per second:",
+              m_decodingSeconds == 0.0 ? 0.0 : m_stats.m_routesHandled / m_decodingSeconds));
+  LogHitRate("Candidate points", m_caches->m_points.GetHitsAndMisses());
+  LogHitRate("Scored candidate points", m_caches->m_scorePoints.GetHitsAndMisses());
+  LogHitRate("Road info", m_caches->m_roadInfo.GetHitsAndMisses());
 }
 }  // namespace openlr
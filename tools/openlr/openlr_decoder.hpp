@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -21,6 +22,7 @@ DECLARE_EXCEPTION(DecoderError, RootException);
 
 class Graph;
 class RoadInfoGetter;
+struct DecoderCaches;
 
 class OpenLRDecoder
 {
@@ -41,6 +43,7 @@ public:
   };
 
   OpenLRDecoder(std::vector<FrozenDataSource> & dataSources, CountryParentNameGetter const & countryParentNameGetter);
+  ~OpenLRDecoder();
 
   // Maps partner segments to mwm paths. |segments| should be sorted by partner id.
   void DecodeV2(std::vector<LinearSegment> const & segments, uint32_t const numThreads,
@@ -48,11 +51,18 @@ public:
 
   void DecodeV3(std::vector<LinearSegment> const & segments, uint32_t numThreads, std::vector<DecodedPath> & paths);
 
+  /// Logs the stats of all the segments decoded by the decoder and the hit rates of the caches which are
+  /// shared by the threads and kept between Decode calls.
+  void ReportStats() const;
+
 private:
   template <typename Decoder, typename Stats>
   void Decode(std::vector<LinearSegment> const & segments, uint32_t const numThreads, std::vector<DecodedPath> & paths);
 
   std::vector<FrozenDataSource> & m_dataSources;
   CountryParentNameGetter m_countryParentNameGetter;
+  std::unique_ptr<DecoderCaches> m_caches;
+  v2::Stats m_stats;
+  double m_decodingSeconds = 0.0;
 };
 }  // namespace openlr
@@ -5,6 +5,8 @@
 
 #include "base/logging.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <optional>
 #include <type_traits>
@@ -289,23 +291,35 @@ bool CoordinatesFromXML(pugi::xml_node const & coordsNode, openlr::LinearLocatio
 
 namespace openlr
 {
-bool ParseOpenlr(pugi::xml_document const & document, vector<LinearSegment> & segments)
+namespace
+{
+char constexpr kSegmentTag[] = "reportSegments";
+
+// Appends the segment of <reportSegments> |node| to |segments|. Returns false if the segment can't be parsed.
+bool AppendSegment(pugi::xml_node const & node, vector<LinearSegment> & segments)
 {
-  for (auto const segmentXpathNode : document.select_nodes("//reportSegments"))
+  if (!IsLocationReferenceTag(node) && !IsCoordinatesTag(node))
   {
-    LinearSegment segment;
-    auto const & node = segmentXpathNode.node();
-    if (!IsLocationReferenceTag(node) && !IsCoordinatesTag(node))
-    {
-      LOG(LWARNING, ("A segment with a strange tag. It is not <coordinates>"
-                     " or <optionLinearLocationReference>, skipping..."));
-      continue;
-    }
+    LOG(LWARNING, ("A segment with a strange tag. It is not <coordinates>"
+                   " or <optionLinearLocationReference>, skipping..."));
+    return true;
+  }
 
-    if (!SegmentFromXML(node, segment))
-      return false;
+  LinearSegment segment;
+  if (!SegmentFromXML(node, segment))
+    return false;
+
+  segments.push_back(segment);
+  return true;
+}
+}  // namespace
 
-    segments.push_back(segment);
+bool ParseOpenlr(pugi::xml_document const & document, vector<LinearSegment> & segments)
+{
+  for (auto const segmentXpathNode : document.select_nodes((string("//") + kSegmentTag).c_str()))
+  {
+    if (!AppendSegment(segmentXpathNode.node(), segments))
+      return false;
   }
   return true;
 }
@@ -345,4 +359,109 @@ bool SegmentFromXML(pugi::xml_node const & segmentNode, LinearSegment & segment)
   segment.m_source = LinearSegmentSource::FromCoordinatesTag;
   return true;
 }
+
+// SegmentsStreamReader ----------------------------------------------------------------------------
+SegmentsStreamReader::SegmentsStreamReader(string const & fileName) : m_input(fileName, ios::binary) {}
+
+bool SegmentsStreamReader::Read(size_t maxCount, vector<LinearSegment> & segments)
+{
+  string element;
+  for (size_t count = 0; count < maxCount && NextElement(element); ++count)
+  {
+    pugi::xml_document document;
+    auto const result = document.load_buffer(element.data(), element.size());
+    if (!result)
+    {
+      LOG(LERROR, ("Can't parse segment:", result.description()));
+      return false;
+    }
+
+    if (!AppendSegment(document.child(kSegmentTag), segments))
+      return false;
+  }
+  return true;
+}
+
+bool SegmentsStreamReader::NextElement(string & element)
+{
+  string const openTag = string("<") + kSegmentTag;
+  string const closeTag = string("</") + kSegmentTag + ">";
+
+  // Looking for the open tag which is not a prefix of another tag.
+  size_t begin = string::npos;
+  while (true)
+  {
+    begin = m_buffer.find(openTag, m_pos);
+    if (begin != string::npos && begin + openTag.size() < m_buffer.size())
+    {
+      char const next = m_buffer[begin + openTag.size()];
+      if (next == '>' || next == '/' || isspace(static_cast<unsigned char>(next)))
+        break;
+
+      m_pos = begin + 1;
+      continue;
+    }
+
+    // The tail may contain a part of the tag.
+    if (begin == string::npos)
+      m_pos = max(m_pos, m_buffer.size() >= openTag.size() ? m_buffer.size() - openTag.size() : 0);
+    if (!ReadChunk())
+    {
+      m_end = true;
+      return false;
+    }
+  }
+
+  // The buffer is shifted by the reading, so the element begins at |m_pos|.
+  m_pos = begin;
+  auto const findInElement = [this, &openTag](auto const & pattern, size_t & found)
+  {
+    while ((found = m_buffer.find(pattern, m_pos)) == string::npos)
+    {
+      if (!ReadChunk())
+      {
+        LOG(LWARNING, ("Unclosed", openTag, "at the end of the file."));
+        m_end = true;
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // A self-closing element like <reportSegments/> ends with its open tag.
+  size_t end = string::npos;
+  if (!findInElement('>', end))
+    return false;
+
+  if (m_buffer[end - 1] == '/')
+  {
+    ++end;
+  }
+  else
+  {
+    if (!findInElement(closeTag, end))
+      return false;
+    end += closeTag.size();
+  }
+
+  element.assign(m_buffer, m_pos, end - m_pos);
+  m_pos = end;
+  return true;
+}
+
+bool SegmentsStreamReader::ReadChunk()
+{
+  // Drops the processed part of the buffer.
+  m_buffer.erase(0, m_pos);
+  m_pos = 0;
+
+  if (!m_input)
+    return false;
+
+  size_t const size = m_buffer.size();
+  m_buffer.resize(size + kChunkSize);
+  m_input.read(&m_buffer[size], kChunkSize);
+  m_buffer.resize(size + static_cast<size_t>(m_input.gcount()));
+  return m_input.gcount() > 0;
+}
 }  // namespace openlr
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <fstream>
+#include <string>
 #include <vector>
 
 namespace pugi
@@ -15,4 +18,34 @@ struct LinearSegment;
 bool SegmentFromXML(pugi::xml_node const & segmentNode, LinearSegment & segment);
 
 bool ParseOpenlr(pugi::xml_document const & document, std::vector<LinearSegment> & segments);
+
+/// \brief Reads segments from an OpenLR xml file by batches, the file isn't loaded to memory as a whole.
+/// Every <reportSegments> element is parsed separately, so a big feed may be decoded batch by batch.
+class SegmentsStreamReader
+{
+public:
+  /// The file is read by chunks of this size.
+  static size_t constexpr kChunkSize = 1 << 20;
+
+  explicit SegmentsStreamReader(std::string const & fileName);
+
+  bool IsOpened() const { return m_input.is_open(); }
+  /// \returns true if all the segments are read.
+  bool IsEnd() const { return m_end; }
+
+  /// Appends no more than |maxCount| next segments to |segments|.
+  /// \returns false if a segment can't be parsed.
+  bool Read(size_t maxCount, std::vector<LinearSegment> & segments);
+
+private:
+  /// Moves the next <reportSegments> element to |element|. \returns false if there are no more elements.
+  bool NextElement(std::string & element);
+  /// \returns false if the file is over.
+  bool ReadChunk();
+
+  std::ifstream m_input;
+  std::string m_buffer;
+  size_t m_pos = 0;
+  bool m_end = false;
+};
 }  // namespace openlr
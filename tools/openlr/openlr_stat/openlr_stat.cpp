@@ -48,6 +48,9 @@ DEFINE_string(countries_filename, "",
               "Name of countries file which describes mwm tree. Used to get country specific "
               "routing restrictions.");
 DEFINE_int32(algo_version, 0, "Use new decoding algorithm");
+DEFINE_int32(batch_size, 0,
+             "Number of segments which are read and decoded at once. If it's positive the input is read by batches "
+             "and isn't kept in memory as a whole. 0 to read all segments at once.");
 
 using namespace openlr;
 
@@ -152,10 +155,29 @@ bool ValidateVersion(char const * flagname, int32_t value)
   return true;
 }
 
+bool ValidateBatchSize(char const * flagname, int32_t value)
+{
+  if (value < 0)
+  {
+    LOG(LINFO, ("Valid value for --", std::string(flagname), ":", value, "must be greater or equal to 0."));
+    return false;
+  }
+
+  return true;
+}
+
 bool const g_limitDummy = gflags::RegisterFlagValidator(&FLAGS_limit, &ValidateLimit);
 bool const g_numThreadsDummy = gflags::RegisterFlagValidator(&FLAGS_num_threads, &ValidateNumThreads);
 bool const g_mwmsPathDummy = gflags::RegisterFlagValidator(&FLAGS_mwms_path, &ValidateMwmPath);
 bool const g_algoVersion = gflags::RegisterFlagValidator(&FLAGS_algo_version, &ValidateVersion);
+bool const g_batchSizeDummy = gflags::RegisterFlagValidator(&FLAGS_batch_size, &ValidateBatchSize);
+
+void SaveNonMatchedIds(std::ostream & ost, std::vector<DecodedPath> const & paths)
+{
+  for (auto const & p : paths)
+    if (p.m_path.empty())
+      ost << p.m_segmentId << std::endl;
+}
 
 void SaveNonMatchedIds(std::string const & filename, std::vector<DecodedPath> const & paths)
 {
@@ -163,9 +185,14 @@ void SaveNonMatchedIds(std::string const & filename, std::vector<DecodedPath> co
     return;
 
   std::ofstream ofs(filename);
-  for (auto const & p : paths)
-    if (p.m_path.empty())
-      ofs << p.m_segmentId << std::endl;
+  SaveNonMatchedIds(ofs, paths);
+}
+
+void FilterAndSortSegments(OpenLRDecoder::SegmentsFilter const & filter, std::vector<LinearSegment> & segments)
+{
+  base::EraseIf(segments, [&filter](LinearSegment const & segment) { return !filter.Matches(segment); });
+
+  std::sort(segments.begin(), segments.end(), base::LessBy(&LinearSegment::m_segmentId));
 }
 
 std::vector<LinearSegment> LoadSegments(pugi::xml_document & document)
@@ -181,11 +208,75 @@ std::vector<LinearSegment> LoadSegments(pugi::xml_document & document)
   if (FLAGS_limit != kHandleAllSegments && FLAGS_limit >= 0 && static_cast<size_t>(FLAGS_limit) < segments.size())
     segments.resize(FLAGS_limit);
 
-  base::EraseIf(segments, [&filter](LinearSegment const & segment) { return !filter.Matches(segment); });
+  FilterAndSortSegments(filter, segments);
+  return segments;
+}
 
-  std::sort(segments.begin(), segments.end(), base::LessBy(&LinearSegment::m_segmentId));
+void Decode(OpenLRDecoder & decoder, std::vector<LinearSegment> const & segments, uint32_t numThreads,
+            std::vector<DecodedPath> & paths)
+{
+  switch (FLAGS_algo_version)
+  {
+  case 2: decoder.DecodeV2(segments, numThreads, paths); break;
+  case 3: decoder.DecodeV3(segments, numThreads, paths); break;
+  default: CHECK(false, ("Wrong algorithm version."));
+  }
+}
 
-  return segments;
+// Reads, decodes and saves the segments by batches of |FLAGS_batch_size|, so only one batch is kept in memory.
+void DecodeByBatches(OpenLRDecoder & decoder, uint32_t numThreads)
+{
+  if (!FLAGS_assessment_output.empty())
+  {
+    LOG(LERROR, ("Assessment output needs the whole input document, it can't be used with --batch_size."));
+    exit(-1);
+  }
+
+  SegmentsStreamReader reader(FLAGS_input);
+  if (!reader.IsOpened())
+  {
+    LOG(LERROR, ("Can't open file", FLAGS_input));
+    exit(-1);
+  }
+
+  std::ofstream nonMatchedIds;
+  if (!FLAGS_non_matched_ids.empty())
+    nonMatchedIds.open(FLAGS_non_matched_ids);
+  std::ofstream sparkOutput;
+  if (!FLAGS_spark_output.empty())
+    sparkOutput.open(FLAGS_spark_output);
+
+  OpenLRDecoder::SegmentsFilter filter(FLAGS_ids_path, FLAGS_multipoints_only);
+  size_t segmentsCount = 0;
+  while (!reader.IsEnd())
+  {
+    size_t batchSize = static_cast<size_t>(FLAGS_batch_size);
+    if (FLAGS_limit != kHandleAllSegments)
+    {
+      CHECK_LESS_OR_EQUAL(segmentsCount, static_cast<size_t>(FLAGS_limit), ());
+      batchSize = std::min(batchSize, static_cast<size_t>(FLAGS_limit) - segmentsCount);
+      if (batchSize == 0)
+        break;
+    }
+
+    std::vector<LinearSegment> segments;
+    if (!reader.Read(batchSize, segments))
+    {
+      LOG(LERROR, ("Can't parse data."));
+      exit(-1);
+    }
+
+    segmentsCount += segments.size();
+    FilterAndSortSegments(filter, segments);
+
+    std::vector<DecodedPath> paths(segments.size());
+    Decode(decoder, segments, numThreads, paths);
+
+    if (nonMatchedIds.is_open())
+      SaveNonMatchedIds(nonMatchedIds, paths);
+    if (sparkOutput.is_open())
+      WriteAsMappingForSpark(sparkOutput, paths);
+  }
 }
 
 void WriteAssessmentFile(std::string const fileName, pugi::xml_document const & doc,
@@ -253,6 +344,14 @@ int main(int argc, char * argv[])
   OpenLRDecoder decoder(dataSources,
                         storage::CountryParentGetter(FLAGS_countries_filename, GetPlatform().ResourcesDir()));
 
+  std::setlocale(LC_ALL, "en_US.UTF-8");
+  if (FLAGS_batch_size > 0)
+  {
+    DecodeByBatches(decoder, numThreads);
+    decoder.ReportStats();
+    return 0;
+  }
+
   pugi::xml_document document;
   auto const load_result = document.load_file(FLAGS_input.data());
   if (!load_result)
@@ -261,16 +360,11 @@ int main(int argc, char * argv[])
     exit(-1);
   }
 
-  std::setlocale(LC_ALL, "en_US.UTF-8");
   auto const segments = LoadSegments(document);
 
   std::vector<DecodedPath> paths(segments.size());
-  switch (FLAGS_algo_version)
-  {
-  case 2: decoder.DecodeV2(segments, numThreads, paths); break;
-  case 3: decoder.DecodeV3(segments, numThreads, paths); break;
-  default: CHECK(false, ("Wrong algorithm version."));
-  }
+  Decode(decoder, segments, numThreads, paths);
+  decoder.ReportStats();
 
   SaveNonMatchedIds(FLAGS_non_matched_ids, paths);
   if (!FLAGS_assessment_output.empty())
@@ -0,0 +1,113 @@
+#include "testing/testing.hpp"
+
+#include "openlr/concurrent_cache.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace openlr;
+using namespace std;
+
+namespace
+{
+// The shard of a key is the key itself modulo the number of shards.
+struct IdentityHash
+{
+  size_t operator()(uint32_t key) const { return key; }
+};
+
+using Cache = ConcurrentCache<uint32_t, uint32_t, IdentityHash>;
+
+UNIT_TEST(ConcurrentCache_HitsAndMisses)
+{
+  Cache cache(1000 /* maxSize */);
+  size_t loads = 0;
+  auto const load = [&loads](uint32_t value)
+  {
+    return [&loads, value]()
+    {
+      ++loads;
+      return value;
+    };
+  };
+
+  TEST_EQUAL(cache.GetOrLoad(1, load(10)), 10, ());
+  TEST_EQUAL(cache.GetOrLoad(2, load(20)), 20, ());
+  // The cached value is returned, |load| isn't called.
+  TEST_EQUAL(cache.GetOrLoad(1, load(30)), 10, ());
+  TEST_EQUAL(loads, 2, ());
+  TEST_EQUAL(cache.GetHitsAndMisses(), make_pair(uint64_t{1}, uint64_t{2}), ());
+}
+
+UNIT_TEST(ConcurrentCache_FullShard)
+{
+  // Every shard keeps one value, keys 1 and 17 are in the same shard.
+  Cache cache(16 /* maxSize */);
+  TEST_EQUAL(cache.GetOrLoad(1, [] { return 10u; }), 10, ());
+  TEST_EQUAL(cache.GetOrLoad(2, [] { return 20u; }), 20, ());
+  TEST_EQUAL(cache.GetOrLoad(17, [] { return 170u; }), 170, ());
+
+  // Key 1 is dropped with its shard, key 2 is in another shard.
+  TEST_EQUAL(cache.GetOrLoad(1, [] { return 11u; }), 11, ());
+  TEST_EQUAL(cache.GetOrLoad(2, [] { return 21u; }), 20, ());
+  TEST_EQUAL(cache.GetHitsAndMisses(), make_pair(uint64_t{1}, uint64_t{4}), ());
+}
+
+UNIT_TEST(ConcurrentCache_Threads)
+{
+  uint32_t constexpr kKeysCount = 1000;
+  size_t constexpr kThreadsCount = 8;
+  size_t constexpr kRounds = 10;
+
+  // Keys aren't split evenly by the shards, so there is room for more of them.
+  Cache cache(2 * kKeysCount);
+  atomic<bool> wrongValue = false;
+  vector<thread> threads;
+  for (size_t i = 0; i < kThreadsCount; ++i)
+  {
+    threads.emplace_back([&cache, &wrongValue]()
+    {
+      for (size_t round = 0; round < kRounds; ++round)
+      {
+        for (uint32_t key = 0; key < kKeysCount; ++key)
+        {
+          if (cache.GetOrLoad(key, [key] { return key * 2; }) != key * 2)
+            wrongValue = true;
+        }
+      }
+    });
+  }
+
+  for (auto & t : threads)
+    t.join();
+
+  TEST(!wrongValue, ());
+  auto const [hits, misses] = cache.GetHitsAndMisses();
+  TEST_EQUAL(hits + misses, kThreadsCount * kRounds * kKeysCount, ());
+  // A value may be loaded by several threads at once, but most of the values are found.
+  TEST_GREATER_OR_EQUAL(misses, kKeysCount, ());
+  TEST_GREATER(hits, misses, ());
+}
+
+UNIT_TEST(ConcurrentCache_PointKey)
+{
+  // Only the same coordinates are the same key, candidates of near points differ.
+  m2::PointD const p(37.61, 55.75);
+  PointKey const a(p);
+  PointKey const b(m2::PointD(37.61, 55.75));
+  PointKey const c(m2::PointD(37.6100001, 55.75));
+  TEST(a == b, ());
+  TEST_EQUAL(PointKey::Hash()(a), PointKey::Hash()(b), ());
+  TEST(!(a == c), ());
+
+  ConcurrentCache<PointKey, uint32_t, PointKey::Hash> cache(100 /* maxSize */);
+  TEST_EQUAL(cache.GetOrLoad(a, [] { return 1u; }), 1, ());
+  TEST_EQUAL(cache.GetOrLoad(b, [] { return 2u; }), 1, ());
+  TEST_EQUAL(cache.GetOrLoad(c, [] { return 3u; }), 3, ());
+}
+}  // namespace
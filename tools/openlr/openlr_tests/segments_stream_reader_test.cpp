@@ -0,0 +1,132 @@
+#include "testing/testing.hpp"
+
+#include "openlr/openlr_model.hpp"
+#include "openlr/openlr_model_xml.hpp"
+
+#include "platform/platform_tests_support/scoped_file.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace openlr;
+using namespace platform::tests_support;
+using namespace std;
+
+namespace
+{
+string const kTestFile = "openlr_segments_stream_reader_test.xml";
+string const kHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<OpenLR>\n";
+string const kFooter = "</OpenLR>\n";
+
+string MakeSegment(uint32_t id)
+{
+  return "<reportSegments>\n"
+         "  <ReportSegmentID>" +
+         to_string(id) +
+         "</ReportSegmentID>\n"
+         "  <segmentLength>100</segmentLength>\n"
+         "  <coordinates>\n"
+         "    <start><latitude>55.75</latitude><longitude>37.61</longitude></start>\n"
+         "    <end><latitude>55.76</latitude><longitude>37.62</longitude></end>\n"
+         "  </coordinates>\n"
+         "</reportSegments>\n";
+}
+
+// An XML comment of |size| bytes.
+string MakePadding(size_t size)
+{
+  TEST_GREATER_OR_EQUAL(size, 8, ());
+  return "<!--" + string(size - 8, ' ') + "-->\n";
+}
+
+vector<uint32_t> ReadSegmentIds(string const & content, size_t batchSize)
+{
+  ScopedFile const file(kTestFile, content);
+  SegmentsStreamReader reader(file.GetFullPath());
+  TEST(reader.IsOpened(), ());
+
+  vector<LinearSegment> segments;
+  while (!reader.IsEnd())
+    TEST(reader.Read(batchSize, segments), ());
+
+  vector<uint32_t> ids;
+  for (auto const & segment : segments)
+    ids.push_back(segment.m_segmentId);
+  return ids;
+}
+
+UNIT_TEST(SegmentsStreamReader_Batches)
+{
+  string content = kHeader;
+  vector<uint32_t> expected;
+  for (uint32_t id = 1; id <= 5; ++id)
+  {
+    content += MakeSegment(id);
+    expected.push_back(id);
+  }
+  content += kFooter;
+
+  for (size_t const batchSize : {1, 2, 5, 10})
+    TEST_EQUAL(ReadSegmentIds(content, batchSize), expected, (batchSize));
+}
+
+UNIT_TEST(SegmentsStreamReader_TagPrefix)
+{
+  // Tags which begin with the name of the segment tag aren't taken as segments.
+  string const content = kHeader + "<reportSegmentsInfo>info</reportSegmentsInfo>\n" + MakeSegment(1) +
+                         "<reportSegmentsCount count=\"2\"/>\n" + MakeSegment(2) + kFooter;
+  TEST_EQUAL(ReadSegmentIds(content, 10 /* batchSize */), vector<uint32_t>({1, 2}), ());
+}
+
+UNIT_TEST(SegmentsStreamReader_SelfClosingElement)
+{
+  // Empty segments are skipped and don't take the next segment with them.
+  string const content =
+      kHeader + "<reportSegments/>\n" + MakeSegment(1) + "<reportSegments />\n" + MakeSegment(2) + kFooter;
+  TEST_EQUAL(ReadSegmentIds(content, 1 /* batchSize */), vector<uint32_t>({1, 2}), ());
+  TEST_EQUAL(ReadSegmentIds(content, 10 /* batchSize */), vector<uint32_t>({1, 2}), ());
+
+  string const onlyEmpty = kHeader + "<reportSegments/>\n" + kFooter;
+  TEST(ReadSegmentIds(onlyEmpty, 10 /* batchSize */).empty(), ());
+}
+
+UNIT_TEST(SegmentsStreamReader_ChunkBoundary)
+{
+  size_t constexpr kChunkSize = SegmentsStreamReader::kChunkSize;
+  string const openTag = "<reportSegments>";
+  string const closeTag = "</reportSegments>";
+  string const segment = MakeSegment(2);
+  size_t const closeTagPos = segment.find(closeTag);
+
+  // Every split of the open tag, the close tag and a self-closing element by the chunk boundary.
+  for (size_t split = 1; split < closeTag.size(); ++split)
+  {
+    string const begin = kHeader + MakeSegment(1);
+
+    string const openSplit = begin + MakePadding(kChunkSize - begin.size() - split) + segment + kFooter;
+    TEST_EQUAL(openSplit.find(openTag, begin.size()), kChunkSize - split, ());
+    TEST_EQUAL(ReadSegmentIds(openSplit, 10 /* batchSize */), vector<uint32_t>({1, 2}), (split));
+
+    string const closeSplit =
+        begin + MakePadding(kChunkSize - begin.size() - closeTagPos - split) + segment + kFooter;
+    TEST_EQUAL(closeSplit.find(closeTag, kChunkSize - closeTag.size()), kChunkSize - split, ());
+    TEST_EQUAL(ReadSegmentIds(closeSplit, 10 /* batchSize */), vector<uint32_t>({1, 2}), (split));
+
+    string const selfClosingSplit =
+        begin + MakePadding(kChunkSize - begin.size() - split) + "<reportSegments/>\n" + segment + kFooter;
+    TEST_EQUAL(ReadSegmentIds(selfClosingSplit, 10 /* batchSize */), vector<uint32_t>({1, 2}), (split));
+
+    // The prefix of the segment tag is split by the chunk boundary.
+    string const prefixSplit = begin + MakePadding(kChunkSize - begin.size() - split) +
+                               "<reportSegmentsInfo>info</reportSegmentsInfo>\n" + segment + kFooter;
+    TEST_EQUAL(ReadSegmentIds(prefixSplit, 10 /* batchSize */), vector<uint32_t>({1, 2}), (split));
+  }
+}
+
+UNIT_TEST(SegmentsStreamReader_UnclosedElement)
+{
+  string const content = kHeader + MakeSegment(1) + "<reportSegments>\n  <ReportSegmentID>2</ReportSegmentID>\n";
+  TEST_EQUAL(ReadSegmentIds(content, 10 /* batchSize */), vector<uint32_t>({1}), ());
+}
+}  // namespace
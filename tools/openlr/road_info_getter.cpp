@@ -17,7 +17,10 @@ RoadInfoGetter::RoadInfo::RoadInfo(FeatureType & ft)
 {}
 
 // RoadInfoGetter ----------------------------------------------------------------------------------
-RoadInfoGetter::RoadInfoGetter(DataSource const & dataSource) : m_dataSource(dataSource) {}
+RoadInfoGetter::RoadInfoGetter(DataSource const & dataSource, SharedCache * sharedCache)
+  : m_dataSource(dataSource)
+  , m_sharedCache(sharedCache)
+{}
 
 RoadInfoGetter::RoadInfo RoadInfoGetter::Get(FeatureID const & fid)
 {
@@ -25,13 +28,25 @@ RoadInfoGetter::RoadInfo RoadInfoGetter::Get(FeatureID const & fid)
   if (it != end(m_cache))
     return it->second;
 
+  if (m_sharedCache)
+  {
+    FeatureKey key{fid.m_mwmId.GetInfo()->GetCountryName(), fid.m_index};
+    it = m_cache.emplace(fid, m_sharedCache->GetOrLoad(key, [this, &fid]() { return Load(fid); })).first;
+  }
+  else
+  {
+    it = m_cache.emplace(fid, Load(fid)).first;
+  }
+
+  return it->second;
+}
+
+RoadInfoGetter::RoadInfo RoadInfoGetter::Load(FeatureID const & fid)
+{
   FeaturesLoaderGuard g(m_dataSource, fid.m_mwmId);
   auto ft = g.GetOriginalFeatureByIndex(fid.m_index);
   CHECK(ft, ());
 
-  RoadInfo info(*ft);
-  it = m_cache.emplace(fid, info).first;
-
-  return it->second;
+  return RoadInfo(*ft);
 }
 }  // namespace openlr
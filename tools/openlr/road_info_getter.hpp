@@ -1,11 +1,15 @@
 #pragma once
 
+#include "openlr/concurrent_cache.hpp"
 #include "openlr/openlr_model.hpp"
 
 #include "indexer/feature_data.hpp"
 #include "indexer/ftypes_matcher.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <string>
 
 class Classificator;
 class DataSource;
@@ -30,12 +34,38 @@ public:
     bool m_isRoundabout = false;
   };
 
-  explicit RoadInfoGetter(DataSource const & dataSource);
+  /// Feature of an mwm which doesn't depend on the data source, so it's the same for all threads.
+  struct FeatureKey
+  {
+    struct Hash
+    {
+      size_t operator()(FeatureKey const & key) const
+      {
+        return std::hash<std::string>()(key.m_countryName) ^ std::hash<uint32_t>()(key.m_index);
+      }
+    };
+
+    bool operator==(FeatureKey const & rhs) const
+    {
+      return m_index == rhs.m_index && m_countryName == rhs.m_countryName;
+    }
+
+    std::string m_countryName;
+    uint32_t m_index = 0;
+  };
+
+  using SharedCache = ConcurrentCache<FeatureKey, RoadInfo, FeatureKey::Hash>;
+
+  /// \param sharedCache may be shared with the getters of other threads, may be nullptr.
+  explicit RoadInfoGetter(DataSource const & dataSource, SharedCache * sharedCache = nullptr);
 
   RoadInfo Get(FeatureID const & fid);
 
 private:
+  RoadInfo Load(FeatureID const & fid);
+
   DataSource const & m_dataSource;
+  SharedCache * m_sharedCache;
   std::map<FeatureID, RoadInfo> m_cache;
 };
 }  // namespace openlr
@@ -14,6 +14,7 @@
 
 #include "base/logging.hpp"
 #include "base/stl_helpers.hpp"
+#include "base/timer.hpp"
 
 #include <algorithm>
 #include <functional>
@@ -110,10 +111,14 @@ bool ScoreCandidatePathsGetter::GetLineCandidatesForPoints(vector<LocationRefere
     auto const isLastPoint = i == points.size() - 1;
     double const distanceToNextPointM = (isLastPoint ? points[i - 1] : points[i]).m_distanceToNextPoint;
 
+    base::Timer timer;
     ScoreEdgeVec edgesCandidates;
     m_pointsGetter.GetEdgeCandidates(mercator::FromLatLon(points[i].m_latLon), isLastPoint, edgesCandidates);
+    m_stats.m_candidatePointsSeconds += timer.ElapsedSeconds();
 
+    timer.Reset();
     GetLineCandidates(points[i], source, isLastPoint, distanceToNextPointM, edgesCandidates, lineCandidates.back());
+    m_stats.m_candidatePathsSeconds += timer.ElapsedSeconds();
 
     if (lineCandidates.back().empty())
     {
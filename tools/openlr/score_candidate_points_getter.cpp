@@ -36,6 +36,35 @@ void ScoreCandidatePointsGetter::GetJunctionPointCandidates(m2::PointD const & p
                                                             ScoreEdgeVec & edgeCandidates)
 {
   ScorePointVec pointCandidates;
+  if (m_sharedCache)
+  {
+    pointCandidates = m_sharedCache->GetOrLoad(PointKey(p), [this, &p]()
+    {
+      ScorePointVec junctions;
+      FindJunctionPoints(p, junctions);
+      return junctions;
+    });
+  }
+  else
+  {
+    FindJunctionPoints(p, pointCandidates);
+  }
+
+  for (auto const & pc : pointCandidates)
+  {
+    Graph::EdgeListT edges;
+    if (!isLastPoint)
+      m_graph.GetOutgoingEdges(geometry::PointWithAltitude(pc.m_point, 0 /* altitude */), edges);
+    else
+      m_graph.GetIngoingEdges(geometry::PointWithAltitude(pc.m_point, 0 /* altitude */), edges);
+
+    for (auto const & e : edges)
+      edgeCandidates.emplace_back(pc.m_score, e);
+  }
+}
+
+void ScoreCandidatePointsGetter::FindJunctionPoints(m2::PointD const & p, ScorePointVec & pointCandidates)
+{
   auto const selectCandidates = [&p, &pointCandidates, this](FeatureType & ft)
   {
     ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
@@ -56,18 +85,6 @@ void ScoreCandidatePointsGetter::GetJunctionPointCandidates(m2::PointD const & p
   std::reverse(pointCandidates.begin(), pointCandidates.end());
 
   pointCandidates.resize(std::min(m_maxJunctionCandidates, pointCandidates.size()));
-
-  for (auto const & pc : pointCandidates)
-  {
-    Graph::EdgeListT edges;
-    if (!isLastPoint)
-      m_graph.GetOutgoingEdges(geometry::PointWithAltitude(pc.m_point, 0 /* altitude */), edges);
-    else
-      m_graph.GetIngoingEdges(geometry::PointWithAltitude(pc.m_point, 0 /* altitude */), edges);
-
-    for (auto const & e : edges)
-      edgeCandidates.emplace_back(pc.m_score, e);
-  }
 }
 
 void ScoreCandidatePointsGetter::EnrichWithProjectionPoints(m2::PointD const & p, ScoreEdgeVec & edgeCandidates)
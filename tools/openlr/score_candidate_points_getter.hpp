@@ -1,5 +1,6 @@
 #pragma once
 
+#include "openlr/concurrent_cache.hpp"
 #include "openlr/graph.hpp"
 #include "openlr/score_types.hpp"
 #include "openlr/stats.hpp"
@@ -17,12 +18,17 @@ namespace openlr
 class ScoreCandidatePointsGetter
 {
 public:
+  /// Scored junction candidates of a point, they don't depend on the graph fakes.
+  using SharedCache = ConcurrentCache<PointKey, ScorePointVec, PointKey::Hash>;
+
+  /// \param sharedCache may be shared with the getters of other threads, may be nullptr.
   ScoreCandidatePointsGetter(size_t maxJunctionCandidates, size_t maxProjectionCandidates,
-                             DataSource const & dataSource, Graph & graph)
+                             DataSource const & dataSource, Graph & graph, SharedCache * sharedCache = nullptr)
     : m_maxJunctionCandidates(maxJunctionCandidates)
     , m_maxProjectionCandidates(maxProjectionCandidates)
     , m_dataSource(dataSource)
     , m_graph(graph)
+    , m_sharedCache(sharedCache)
   {}
 
   void GetEdgeCandidates(m2::PointD const & p, bool isLastPoint, ScoreEdgeVec & edges)
@@ -33,6 +39,7 @@ public:
 
 private:
   void GetJunctionPointCandidates(m2::PointD const & p, bool isLastPoint, ScoreEdgeVec & edgeCandidates);
+  void FindJunctionPoints(m2::PointD const & p, ScorePointVec & pointCandidates);
   void EnrichWithProjectionPoints(m2::PointD const & p, ScoreEdgeVec & edgeCandidates);
 
   /// \returns true if |p| is a junction and false otherwise.
@@ -44,5 +51,6 @@ private:
 
   DataSource const & m_dataSource;
   Graph & m_graph;
+  SharedCache * m_sharedCache;
 };
 }  // namespace openlr
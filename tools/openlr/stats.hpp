@@ -4,7 +4,6 @@
 
 #include "base/logging.hpp"
 
-#include <chrono>
 #include <cstdint>
 
 namespace openlr
@@ -22,6 +21,10 @@ struct alignas(kCacheLineSize) Stats
     m_notEnoughScore += s.m_notEnoughScore;
     m_wrongOffsets += s.m_wrongOffsets;
     m_zeroDistToNextPointCount += s.m_zeroDistToNextPointCount;
+    m_candidatePointsSeconds += s.m_candidatePointsSeconds;
+    m_candidatePathsSeconds += s.m_candidatePathsSeconds;
+    m_connectionSeconds += s.m_connectionSeconds;
+    m_offsetsSeconds += s.m_offsetsSeconds;
   }
 
   void Report() const
@@ -33,6 +36,9 @@ struct alignas(kCacheLineSize) Stats
     LOG(LINFO, ("Not enough score for shortest path:", m_notEnoughScore));
     LOG(LINFO, ("Wrong offsets:", m_wrongOffsets));
     LOG(LINFO, ("No shortest path:", m_noShortestPathFound));
+    LOG(LINFO, ("Stages time in seconds summed over threads. Candidate points:", m_candidatePointsSeconds,
+                "candidate paths:", m_candidatePathsSeconds, "connection:", m_connectionSeconds,
+                "offsets:", m_offsetsSeconds));
   }
 
   uint32_t m_routesHandled = 0;
@@ -43,6 +49,11 @@ struct alignas(kCacheLineSize) Stats
   uint32_t m_wrongOffsets = 0;
   // Number of zeroed distance-to-next point values in the input.
   uint32_t m_zeroDistToNextPointCount = 0;
+  // Time of the decoding stages in seconds.
+  double m_candidatePointsSeconds = 0.0;
+  double m_candidatePathsSeconds = 0.0;
+  double m_connectionSeconds = 0.0;
+  double m_offsetsSeconds = 0.0;
 };
 }  // namespace v2
 }  // namespace openlr
@@ -0,0 +1,151 @@
+#include "track_analyzing/batch_track_matcher.hpp"
+
+#include "track_analyzing/track_matcher.hpp"
+#include "track_analyzing/utils.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace track_analyzing
+{
+using namespace routing;
+using namespace std;
+
+namespace
+{
+// Matched tracks and counters of a thread.
+struct ThreadResult
+{
+  vector<pair<string const *, vector<MatchedTrack>>> m_userTracks;
+  uint64_t m_tracksCount = 0;
+  uint64_t m_pointsCount = 0;
+  uint64_t m_nonMatchedPointsCount = 0;
+};
+}  // namespace
+
+BatchTrackMatcher::BatchTrackMatcher(storage::Storage const & storage, shared_ptr<NumMwmIds> numMwmIds,
+                                     size_t threadsCount)
+  : m_storage(storage)
+  , m_numMwmIds(std::move(numMwmIds))
+  , m_threadsCount(threadsCount)
+  , m_threadPool(threadsCount)
+{
+  CHECK(m_numMwmIds, ());
+}
+
+void BatchTrackMatcher::MatchTracks(MwmToTracks const & mwmToTracks, OnMwmMatched const & onMwmMatched)
+{
+  ForTracksSortedByMwmName(mwmToTracks, *m_numMwmIds, [&](string const & mwmName, UserToTrack const & userToTrack)
+  { MatchMwmTracks(m_numMwmIds->GetId(platform::CountryFile(mwmName)), userToTrack, onMwmMatched); });
+}
+
+void BatchTrackMatcher::MatchMwmTracks(NumMwmId mwmId, UserToTrack const & userToTrack,
+                                       OnMwmMatched const & onMwmMatched)
+{
+  base::Timer timer;
+
+  UserToMatchedTracks userToMatchedTracks;
+  MatchMwm(m_numMwmIds->GetFile(mwmId).GetName(), userToTrack, userToMatchedTracks);
+  if (!userToMatchedTracks.empty())
+    onMwmMatched(mwmId, userToMatchedTracks);
+
+  m_elapsedSeconds += timer.ElapsedSeconds();
+}
+
+double BatchTrackMatcher::GetMatchedPointsPerSecond() const
+{
+  if (m_elapsedSeconds == 0.0)
+    return 0.0;
+  return static_cast<double>(m_pointsCount - m_nonMatchedPointsCount) / m_elapsedSeconds;
+}
+
+void BatchTrackMatcher::MatchMwm(string const & mwmName, UserToTrack const & userToTrack,
+                                 UserToMatchedTracks & userToMatchedTracks)
+{
+  base::Timer timer;
+
+  auto const countryFile = platform::CountryFile(mwmName);
+  shared_ptr<MatchingMwmData> data;
+  try
+  {
+    data = make_shared<MatchingMwmData>(m_storage, m_numMwmIds->GetId(countryFile), countryFile);
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't load mwm", mwmName, "for matching, tracks of", userToTrack.size(), "users are skipped:",
+                 e.Msg()));
+    return;
+  }
+
+  vector<UserToTrack::value_type const *> users;
+  users.reserve(userToTrack.size());
+  for (auto const & userTrack : userToTrack)
+    users.push_back(&userTrack);
+
+  // The tracks are taken by the threads one by one, so a long track doesn't hold up the others.
+  atomic<size_t> nextUser(0);
+  auto const matchUsers = [&]()
+  {
+    ThreadResult result;
+    TrackMatcher matcher(data);
+    for (size_t i = nextUser++; i < users.size(); i = nextUser++)
+    {
+      string const & user = users[i]->first;
+      vector<MatchedTrack> matchedTracks;
+      try
+      {
+        matcher.MatchTrack(users[i]->second, matchedTracks);
+      }
+      catch (RootException const & e)
+      {
+        LOG(LERROR, ("Can't match track for mwm:", mwmName, ", user:", user));
+        LOG(LERROR, ("  ", e.what()));
+      }
+
+      if (!matchedTracks.empty())
+        result.m_userTracks.emplace_back(&user, std::move(matchedTracks));
+    }
+
+    result.m_tracksCount = matcher.GetTracksCount();
+    result.m_pointsCount = matcher.GetPointsCount();
+    result.m_nonMatchedPointsCount = matcher.GetNonMatchedPointsCount();
+    return result;
+  };
+
+  vector<future<ThreadResult>> futures;
+  size_t const threadsCount = min(m_threadsCount, users.size());
+  futures.reserve(threadsCount);
+  for (size_t i = 0; i < threadsCount; ++i)
+    futures.push_back(m_threadPool.Submit(matchUsers));
+
+  uint64_t tracksCount = 0;
+  uint64_t pointsCount = 0;
+  uint64_t nonMatchedPointsCount = 0;
+  for (auto & f : futures)
+  {
+    ThreadResult result = f.get();
+    for (auto & [user, matchedTracks] : result.m_userTracks)
+      userToMatchedTracks.emplace(*user, std::move(matchedTracks));
+
+    tracksCount += result.m_tracksCount;
+    pointsCount += result.m_pointsCount;
+    nonMatchedPointsCount += result.m_nonMatchedPointsCount;
+  }
+
+  m_tracksCount += tracksCount;
+  m_pointsCount += pointsCount;
+  m_nonMatchedPointsCount += nonMatchedPointsCount;
+
+  double const seconds = timer.ElapsedSeconds();
+  LOG(LINFO, (mwmName, ", users:", userToTrack.size(), ", tracks:", tracksCount, ", points:", pointsCount,
+              ", non matched points:", nonMatchedPointsCount, ", matched points per second:",
+              seconds == 0.0 ? 0.0 : (pointsCount - nonMatchedPointsCount) / seconds));
+}
+}  // namespace track_analyzing
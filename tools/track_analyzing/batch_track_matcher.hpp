@@ -0,0 +1,58 @@
+#pragma once
+
+#include "track_analyzing/track.hpp"
+
+#include "routing_common/num_mwm_id.hpp"
+
+#include "storage/storage.hpp"
+
+#include "base/thread_pool_computational.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace track_analyzing
+{
+/// \brief Matches the tracks of many users in several threads. The tracks of an mwm are sharded between
+/// the threads, which share the data of the mwm, see MatchingMwmData. The mwms are matched one by one and
+/// the matched tracks of an mwm are passed to the callback right after it, so they may be written to disk
+/// without keeping the tracks of all mwms in memory.
+class BatchTrackMatcher final
+{
+public:
+  using OnMwmMatched = std::function<void(routing::NumMwmId mwmId, UserToMatchedTracks const & userToMatchedTracks)>;
+
+  BatchTrackMatcher(storage::Storage const & storage, std::shared_ptr<routing::NumMwmIds> numMwmIds,
+                    size_t threadsCount);
+
+  /// \param onMwmMatched is called from the calling thread for every mwm with matched tracks.
+  /// The mwms which can't be loaded are logged and skipped.
+  void MatchTracks(MwmToTracks const & mwmToTracks, OnMwmMatched const & onMwmMatched);
+
+  /// \brief Matches the tracks of one mwm, so the tracks of the mwms may be loaded one by one.
+  void MatchMwmTracks(routing::NumMwmId mwmId, UserToTrack const & userToTrack, OnMwmMatched const & onMwmMatched);
+
+  uint64_t GetTracksCount() const { return m_tracksCount; }
+  uint64_t GetPointsCount() const { return m_pointsCount; }
+  uint64_t GetNonMatchedPointsCount() const { return m_nonMatchedPointsCount; }
+  /// \returns the time spent in MatchTracks() and MatchMwmTracks() calls, including the loading of the mwm data.
+  double GetElapsedSeconds() const { return m_elapsedSeconds; }
+  double GetMatchedPointsPerSecond() const;
+
+private:
+  void MatchMwm(std::string const & mwmName, UserToTrack const & userToTrack,
+                UserToMatchedTracks & userToMatchedTracks);
+
+  storage::Storage const & m_storage;
+  std::shared_ptr<routing::NumMwmIds> m_numMwmIds;
+  size_t const m_threadsCount;
+  base::ComputationalThreadPool m_threadPool;
+
+  uint64_t m_tracksCount = 0;
+  uint64_t m_pointsCount = 0;
+  uint64_t m_nonMatchedPointsCount = 0;
+  double m_elapsedSeconds = 0.0;
+};
+}  // namespace track_analyzing
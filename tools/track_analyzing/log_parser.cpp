@@ -1,22 +1,27 @@
 #include "track_analyzing/log_parser.hpp"
 
 #include "track_analyzing/exceptions.hpp"
+#include "track_analyzing/serialization.hpp"
 
 #include "generator/borders.hpp"
 
 #include "platform/platform.hpp"
 
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
 #include "coding/hex.hpp"
 #include "coding/traffic.hpp"
 
 #include "geometry/mercator.hpp"
 
 #include "base/file_name_utils.hpp"
+#include "base/string_utils.hpp"
 #include "base/timer.hpp"
 
 #include <cstdint>
 #include <fstream>
 #include <regex>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace std;
@@ -107,7 +112,7 @@ void LogParser::Parse(string const & logFile, MwmToTracks & mwmToTracks) const
   SplitIntoMwms(userToTrack, mwmToTracks);
 }
 
-void LogParser::ParseUserTracks(string const & logFile, UserToTrack & userToTrack) const
+void LogParser::ForEachPacket(string const & logFile, OnPacket const & onPacket) const
 {
   base::Timer timer;
 
@@ -117,6 +122,7 @@ void LogParser::ParseUserTracks(string const & logFile, UserToTrack & userToTrac
 
   std::regex const base_regex(R"(.*(DataV0|CurrentData)\s+aloha_id\s*:\s*(\S+)\s+.*\|(\w+)\|)");
   std::unordered_set<string> usersWithOldVersion;
+  std::unordered_set<string> usersWithCurrentVersion;
   uint64_t linesCount = 0;
   size_t pointsCount = 0;
 
@@ -141,8 +147,8 @@ void LogParser::ParseUserTracks(string const & logFile, UserToTrack & userToTrac
     auto const packet = ReadDataPoints(data);
     if (!packet.empty())
     {
-      Track & track = userToTrack[userId];
-      track.insert(track.end(), packet.cbegin(), packet.cend());
+      usersWithCurrentVersion.insert(userId);
+      onPacket(userId, packet);
     }
 
     pointsCount += packet.size();
@@ -150,7 +156,81 @@ void LogParser::ParseUserTracks(string const & logFile, UserToTrack & userToTrac
 
   LOG(LINFO, ("Tracks parsing finished, elapsed:", timer.ElapsedSeconds(), "seconds, lines:", linesCount, ", points",
               pointsCount));
-  LOG(LINFO, ("Users with current version:", userToTrack.size(), ", old version:", usersWithOldVersion.size()));
+  LOG(LINFO, ("Users with current version:", usersWithCurrentVersion.size(), ", old version:",
+              usersWithOldVersion.size()));
+}
+
+void LogParser::ParseUserTracks(string const & logFile, UserToTrack & userToTrack) const
+{
+  ForEachPacket(logFile, [&](string const & userId, Track const & packet)
+  {
+    Track & track = userToTrack[userId];
+    track.insert(track.end(), packet.cbegin(), packet.cend());
+  });
+}
+
+vector<routing::NumMwmId> LogParser::SplitIntoMwmFiles(string const & logFile, string const & dir,
+                                                       size_t maxBufferedPoints) const
+{
+  PointToMwmId const pointToMwmId(m_mwmTree, *m_numMwmIds, m_dataDir);
+
+  // The last mwm of every user is the first candidate for the next point of the user.
+  unordered_map<string, routing::NumMwmId> userToLastMwm;
+  unordered_set<routing::NumMwmId> savedMwms;
+  MwmToTracks buffer;
+  size_t bufferedPoints = 0;
+
+  auto const flush = [&]()
+  {
+    for (auto const & [mwmId, userToTrack] : buffer)
+    {
+      // The file of an mwm is rewritten on the first flush, so the files of a previous run are not appended to.
+      bool const isNew = savedMwms.insert(mwmId).second;
+      FileWriter writer(GetMwmTracksFile(dir, mwmId),
+                        isNew ? FileWriter::OP_WRITE_TRUNCATE : FileWriter::OP_APPEND);
+      UserToTrackSerializer::Serialize(userToTrack, writer);
+    }
+    buffer.clear();
+    bufferedPoints = 0;
+  };
+
+  ForEachPacket(logFile, [&](string const & userId, Track const & packet)
+  {
+    auto & mwmId = userToLastMwm.emplace(userId, routing::kFakeNumMwmId).first->second;
+    for (DataPoint const & point : packet)
+    {
+      mwmId = pointToMwmId.FindMwmId(mercator::FromLatLon(point.m_latLon), mwmId);
+      if (mwmId == routing::kFakeNumMwmId)
+      {
+        LOG(LERROR, ("Can't match mwm region for", point.m_latLon, ", user:", userId));
+        continue;
+      }
+
+      buffer[mwmId][userId].push_back(point);
+      ++bufferedPoints;
+    }
+
+    if (bufferedPoints > maxBufferedPoints)
+      flush();
+  });
+  flush();
+
+  LOG(LINFO, ("Data was split into", savedMwms.size(), "mwms in", dir));
+  return vector<routing::NumMwmId>(savedMwms.cbegin(), savedMwms.cend());
+}
+
+// static
+string LogParser::GetMwmTracksFile(string const & dir, routing::NumMwmId mwmId)
+{
+  return base::JoinPath(dir, strings::to_string(mwmId) + ".tracks");
+}
+
+// static
+void LogParser::ReadMwmTracks(string const & file, UserToTrack & userToTrack)
+{
+  FileReader reader(file);
+  ReaderSource<FileReader> src(reader);
+  UserToTrackSerializer::Deserialize(userToTrack, src);
 }
 
 void LogParser::SplitIntoMwms(UserToTrack const & userToTrack, MwmToTracks & mwmToTracks) const
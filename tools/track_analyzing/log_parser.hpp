@@ -6,8 +6,10 @@
 
 #include "geometry/tree4d.hpp"
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace track_analyzing
 {
@@ -19,7 +21,22 @@ public:
 
   void Parse(std::string const & logFile, MwmToTracks & mwmToTracks) const;
 
+  /// \brief Splits the tracks of |logFile| into mwms and saves the tracks of every mwm to
+  /// GetMwmTracksFile(|dir|, mwmId). The points are flushed to the files as soon as more than
+  /// |maxBufferedPoints| points are parsed, so the memory doesn't grow with the size of the log.
+  /// \returns the mwms with tracks.
+  std::vector<routing::NumMwmId> SplitIntoMwmFiles(std::string const & logFile, std::string const & dir,
+                                                   size_t maxBufferedPoints) const;
+
+  static std::string GetMwmTracksFile(std::string const & dir, routing::NumMwmId mwmId);
+
+  /// \brief Reads the tracks which were saved by SplitIntoMwmFiles() to |file|.
+  static void ReadMwmTracks(std::string const & file, UserToTrack & userToTrack);
+
 private:
+  using OnPacket = std::function<void(std::string const & userId, Track const & packet)>;
+
+  void ForEachPacket(std::string const & logFile, OnPacket const & onPacket) const;
   void ParseUserTracks(std::string const & logFile, UserToTrack & userToTrack) const;
   void SplitIntoMwms(UserToTrack const & userToTrack, MwmToTracks & mwmToTracks) const;
 
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace track_analyzing
@@ -35,44 +36,16 @@ public:
     WriteSize(sink, mwmToMatchedTracks.size());
 
     for (auto const & mwmIt : mwmToMatchedTracks)
-    {
-      rw::Write(sink, m_numMwmIds->GetFile(mwmIt.first).GetName());
-
-      UserToMatchedTracks const & userToMatchedTracks = mwmIt.second;
-      CHECK(!userToMatchedTracks.empty(), ());
-      WriteSize(sink, userToMatchedTracks.size());
-
-      for (auto const & userIt : userToMatchedTracks)
-      {
-        rw::Write(sink, userIt.first);
-
-        std::vector<MatchedTrack> const & tracks = userIt.second;
-        CHECK(!tracks.empty(), ());
-        WriteSize(sink, tracks.size());
-
-        for (MatchedTrack const & track : tracks)
-        {
-          CHECK(!track.empty(), ());
-          WriteSize(sink, track.size());
-
-          std::vector<DataPoint> dataPoints;
-          dataPoints.reserve(track.size());
-          for (MatchedTrackPoint const & point : track)
-          {
-            Serialize(point.GetSegment(), sink);
-            dataPoints.emplace_back(point.GetDataPoint());
-          }
-
-          std::vector<uint8_t> buffer;
-          MemWriter<decltype(buffer)> memWriter(buffer);
-          coding::TrafficGPSEncoder::SerializeDataPoints(coding::TrafficGPSEncoder::kLatestVersion, memWriter,
-                                                         dataPoints);
+      SerializeMwmTracks(mwmIt.first, mwmIt.second, sink);
+  }
 
-          WriteSize(sink, buffer.size());
-          sink.Write(buffer.data(), buffer.size());
-        }
-      }
-    }
+  /// \brief Serializes the tracks of one mwm in the same format as Serialize() does. The tracks of different mwms
+  /// may be written one after another to the same sink, so they may be saved as soon as they are matched.
+  template <typename Sink>
+  void SerializeMwm(routing::NumMwmId mwmId, UserToMatchedTracks const & userToMatchedTracks, Sink & sink)
+  {
+    WriteSize(sink, 1 /* mwms number */);
+    SerializeMwmTracks(mwmId, userToMatchedTracks, sink);
   }
 
   template <typename Source>
@@ -80,6 +53,18 @@ public:
   {
     mwmToMatchedTracks.clear();
 
+    // The source may contain several records written by Serialize() or SerializeMwm().
+    while (src.Size() > 0)
+      DeserializeRecord(mwmToMatchedTracks, src);
+  }
+
+private:
+  static uint8_t constexpr kForward = 0;
+  static uint8_t constexpr kBackward = 1;
+
+  template <typename Source>
+  void DeserializeRecord(MwmToMatchedTracks & mwmToMatchedTracks, Source & src)
+  {
     auto const numMmws = ReadSize(src);
     for (size_t iMwm = 0; iMwm < numMmws; ++iMwm)
     {
@@ -99,9 +84,10 @@ public:
         std::vector<MatchedTrack> & tracks = userToMatchedTracks[user];
         auto const numTracks = ReadSize(src);
         CHECK_NOT_EQUAL(numTracks, 0, ());
-        tracks.resize(numTracks);
+        size_t const firstTrack = tracks.size();
+        tracks.resize(firstTrack + numTracks);
 
-        for (size_t iTrack = 0; iTrack < numTracks; ++iTrack)
+        for (size_t iTrack = firstTrack; iTrack < tracks.size(); ++iTrack)
         {
           auto const numSegments = ReadSize(src);
           CHECK_NOT_EQUAL(numSegments, 0, ());
@@ -134,9 +120,45 @@ public:
     }
   }
 
-private:
-  static uint8_t constexpr kForward = 0;
-  static uint8_t constexpr kBackward = 1;
+  template <typename Sink>
+  void SerializeMwmTracks(routing::NumMwmId mwmId, UserToMatchedTracks const & userToMatchedTracks, Sink & sink)
+  {
+    rw::Write(sink, m_numMwmIds->GetFile(mwmId).GetName());
+
+    CHECK(!userToMatchedTracks.empty(), ());
+    WriteSize(sink, userToMatchedTracks.size());
+
+    for (auto const & userIt : userToMatchedTracks)
+    {
+      rw::Write(sink, userIt.first);
+
+      std::vector<MatchedTrack> const & tracks = userIt.second;
+      CHECK(!tracks.empty(), ());
+      WriteSize(sink, tracks.size());
+
+      for (MatchedTrack const & track : tracks)
+      {
+        CHECK(!track.empty(), ());
+        WriteSize(sink, track.size());
+
+        std::vector<DataPoint> dataPoints;
+        dataPoints.reserve(track.size());
+        for (MatchedTrackPoint const & point : track)
+        {
+          Serialize(point.GetSegment(), sink);
+          dataPoints.emplace_back(point.GetDataPoint());
+        }
+
+        std::vector<uint8_t> buffer;
+        MemWriter<decltype(buffer)> memWriter(buffer);
+        coding::TrafficGPSEncoder::SerializeDataPoints(coding::TrafficGPSEncoder::kLatestVersion, memWriter,
+                                                       dataPoints);
+
+        WriteSize(sink, buffer.size());
+        sink.Write(buffer.data(), buffer.size());
+      }
+    }
+  }
 
   template <typename Sink>
   static void WriteSize(Sink & sink, size_t size)
@@ -170,4 +192,54 @@ private:
 
   std::shared_ptr<routing::NumMwmIds> m_numMwmIds;
 };
+
+/// \brief Saves not matched tracks of users without loss of precision. It's used for the temporary files
+/// with the tracks of an mwm, so the tracks of a big log may be split into mwms without keeping them in memory.
+class UserToTrackSerializer final
+{
+public:
+  template <typename Sink>
+  static void Serialize(UserToTrack const & userToTrack, Sink & sink)
+  {
+    for (auto const & userIt : userToTrack)
+    {
+      rw::Write(sink, userIt.first);
+
+      Track const & track = userIt.second;
+      WriteVarUint(sink, base::checked_cast<uint64_t>(track.size()));
+      for (DataPoint const & point : track)
+      {
+        WriteToSink(sink, point.m_timestamp);
+        sink.Write(&point.m_latLon.m_lat, sizeof(point.m_latLon.m_lat));
+        sink.Write(&point.m_latLon.m_lon, sizeof(point.m_latLon.m_lon));
+        WriteToSink(sink, point.m_traffic);
+      }
+    }
+  }
+
+  /// \brief Reads all the records of |src| and appends the points of every user to |userToTrack|
+  /// in the order they were written.
+  template <typename Source>
+  static void Deserialize(UserToTrack & userToTrack, Source & src)
+  {
+    while (src.Size() > 0)
+    {
+      std::string user;
+      rw::Read(src, user);
+
+      Track & track = userToTrack[user];
+      auto const numPoints = base::checked_cast<size_t>(ReadVarUint<uint64_t>(src));
+      track.reserve(track.size() + numPoints);
+      for (size_t i = 0; i < numPoints; ++i)
+      {
+        DataPoint point;
+        point.m_timestamp = ReadPrimitiveFromSource<uint64_t>(src);
+        point.m_latLon.m_lat = ReadPrimitiveFromSource<double>(src);
+        point.m_latLon.m_lon = ReadPrimitiveFromSource<double>(src);
+        point.m_traffic = ReadPrimitiveFromSource<uint8_t>(src);
+        track.push_back(point);
+      }
+    }
+  }
+};
 }  // namespace track_analyzing
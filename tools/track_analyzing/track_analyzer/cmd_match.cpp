@@ -1,5 +1,6 @@
 #include "track_analyzing/track_analyzer/utils.hpp"
 
+#include "track_analyzing/batch_track_matcher.hpp"
 #include "track_analyzing/serialization.hpp"
 #include "track_analyzing/track.hpp"
 #include "track_analyzing/track_analyzer/utils.hpp"
@@ -27,6 +28,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 using namespace routing;
 using namespace std;
@@ -37,8 +39,19 @@ namespace
 {
 using Iter = typename vector<string>::iterator;
 
-void MatchTracks(MwmToTracks const & mwmToTracks, storage::Storage const & storage, NumMwmIds const & numMwmIds,
-                 MwmToMatchedTracks & mwmToMatchedTracks)
+uint64_t GetPointsCount(UserToTrack const & userToTrack)
+{
+  uint64_t pointsCount = 0;
+  for (auto const & userTrack : userToTrack)
+    pointsCount += userTrack.second.size();
+  return pointsCount;
+}
+}  // namespace
+
+namespace track_analyzing
+{
+void CmdMatch(string const & logFile, string const & trackFile, shared_ptr<NumMwmIds> const & numMwmIds,
+              Storage const & storage, Stats & stats)
 {
   base::Timer timer;
 
@@ -46,18 +59,20 @@ void MatchTracks(MwmToTracks const & mwmToTracks, storage::Storage const & stora
   uint64_t pointsCount = 0;
   uint64_t nonMatchedPointsCount = 0;
 
-  auto processMwm = [&](string const & mwmName, UserToTrack const & userToTrack)
+  // The tracks of every mwm are written as soon as they are matched.
+  FileWriter writer(trackFile, FileWriter::OP_WRITE_TRUNCATE);
+  MwmToMatchedTracksSerializer serializer(numMwmIds);
+  ForEachMwmTracks(logFile, numMwmIds, [&](NumMwmId mwmId, UserToTrack const & userToTrack)
   {
-    auto const countryFile = platform::CountryFile(mwmName);
-    auto const mwmId = numMwmIds.GetId(countryFile);
-    TrackMatcher matcher(storage, mwmId, countryFile);
-
-    auto & userToMatchedTracks = mwmToMatchedTracks[mwmId];
+    string const & mwmName = numMwmIds->GetFile(mwmId).GetName();
+    stats.AddDataPoints(mwmName, storage, GetPointsCount(userToTrack));
 
+    TrackMatcher matcher(storage, mwmId, platform::CountryFile(mwmName));
+    UserToMatchedTracks userToMatchedTracks;
     for (auto const & it : userToTrack)
     {
       string const & user = it.first;
-      auto & matchedTracks = userToMatchedTracks[user];
+      vector<MatchedTrack> matchedTracks;
       try
       {
         matcher.MatchTrack(it.second, matchedTracks);
@@ -68,44 +83,23 @@ void MatchTracks(MwmToTracks const & mwmToTracks, storage::Storage const & stora
         LOG(LERROR, ("  ", e.what()));
       }
 
-      if (matchedTracks.empty())
-        userToMatchedTracks.erase(user);
+      if (!matchedTracks.empty())
+        userToMatchedTracks.emplace(user, std::move(matchedTracks));
     }
 
-    if (userToMatchedTracks.empty())
-      mwmToMatchedTracks.erase(mwmId);
+    if (!userToMatchedTracks.empty())
+      serializer.SerializeMwm(mwmId, userToMatchedTracks, writer);
 
     tracksCount += matcher.GetTracksCount();
     pointsCount += matcher.GetPointsCount();
     nonMatchedPointsCount += matcher.GetNonMatchedPointsCount();
 
-    LOG(LINFO,
-        (numMwmIds.GetFile(mwmId).GetName(), ", users:", userToTrack.size(), ", tracks:", matcher.GetTracksCount(),
-         ", points:", matcher.GetPointsCount(), ", non matched points:", matcher.GetNonMatchedPointsCount()));
-  };
-
-  ForTracksSortedByMwmName(mwmToTracks, numMwmIds, processMwm);
+    LOG(LINFO, (mwmName, ", users:", userToTrack.size(), ", tracks:", matcher.GetTracksCount(), ", points:",
+                matcher.GetPointsCount(), ", non matched points:", matcher.GetNonMatchedPointsCount()));
+  });
 
   LOG(LINFO, ("Matching finished, elapsed:", timer.ElapsedSeconds(), "seconds, tracks:", tracksCount,
               ", points:", pointsCount, ", non matched points:", nonMatchedPointsCount));
-}
-}  // namespace
-
-namespace track_analyzing
-{
-void CmdMatch(string const & logFile, string const & trackFile, shared_ptr<NumMwmIds> const & numMwmIds,
-              Storage const & storage, Stats & stats)
-{
-  MwmToTracks mwmToTracks;
-  ParseTracks(logFile, numMwmIds, mwmToTracks);
-  stats.AddTracksStats(mwmToTracks, *numMwmIds, storage);
-
-  MwmToMatchedTracks mwmToMatchedTracks;
-  MatchTracks(mwmToTracks, storage, *numMwmIds, mwmToMatchedTracks);
-
-  FileWriter writer(trackFile, FileWriter::OP_WRITE_TRUNCATE);
-  MwmToMatchedTracksSerializer serializer(numMwmIds);
-  serializer.Serialize(mwmToMatchedTracks, writer);
   LOG(LINFO, ("Matched tracks were saved to", trackFile));
 }
 
@@ -122,6 +116,42 @@ void CmdMatch(string const & logFile, string const & trackFile, string const & i
   stats.Log();
 }
 
+void CmdMatchBatch(string const & logFile, string const & trackFile, size_t threadsCount,
+                   string const & inputDistribution)
+{
+  if (threadsCount == 0)
+    threadsCount = max(static_cast<size_t>(thread::hardware_concurrency()), size_t{1});
+  LOG(LINFO, ("Matching", logFile, "in", threadsCount, "threads"));
+
+  Storage storage;
+  storage.RegisterAllLocalMaps();
+  shared_ptr<NumMwmIds> numMwmIds = CreateNumMwmIds(storage);
+
+  Stats stats;
+
+  // The tracks of every mwm are written as soon as they are matched.
+  FileWriter writer(trackFile, FileWriter::OP_WRITE_TRUNCATE);
+  MwmToMatchedTracksSerializer serializer(numMwmIds);
+  BatchTrackMatcher matcher(storage, numMwmIds, threadsCount);
+  ForEachMwmTracks(logFile, numMwmIds, [&](NumMwmId mwmId, UserToTrack const & userToTrack)
+  {
+    stats.AddDataPoints(numMwmIds->GetFile(mwmId).GetName(), storage, GetPointsCount(userToTrack));
+    matcher.MatchMwmTracks(mwmId, userToTrack, [&](NumMwmId matchedMwmId, UserToMatchedTracks const & matchedTracks)
+    {
+      serializer.SerializeMwm(matchedMwmId, matchedTracks, writer);
+      writer.Flush();
+    });
+  });
+
+  LOG(LINFO, ("Matching finished, elapsed:", matcher.GetElapsedSeconds(), "seconds, tracks:",
+              matcher.GetTracksCount(), ", points:", matcher.GetPointsCount(), ", non matched points:",
+              matcher.GetNonMatchedPointsCount(), ", matched points per second:", matcher.GetMatchedPointsPerSecond()));
+  LOG(LINFO, ("Matched tracks were saved to", trackFile));
+
+  stats.SaveMwmDistributionToCsv(inputDistribution);
+  stats.Log();
+}
+
 void UnzipAndMatch(Iter begin, Iter end, string const & trackExt, Stats & stats)
 {
   Storage storage;
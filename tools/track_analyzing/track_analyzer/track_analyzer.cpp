@@ -36,6 +36,8 @@ DEFINE_string_ext(cmd, "",
                   "project in gz files and extracted.\n"
                   "match_dir - the same as match but applies to the directory with raw logs in gz format."
                   "Process files in several threads.\n"
+                  "match_batch - the same as match but matches the tracks in several threads and writes them "
+                  "to the output file mwm by mwm. Use threads param to set the number of threads.\n"
                   "unmatched_tracks - based on raw logs gathers points to tracks\n"
                   "and save tracks to csv. Track points save as lat, log, timestamp in seconds\n"
                   "tracks - prints track statistics\n"
@@ -63,6 +65,8 @@ DEFINE_uint64(ignore_datapoints_number, 100,
               "of datapoints or less number is in an mwm after matching and tabling, the mwm will not used "
               "for balancing. This param should be used with balance_csv command.");
 
+DEFINE_uint64(threads, 0, "number of matching threads for match_batch command, 0 means hardware concurrency");
+
 DEFINE_string(track_extension, ".track", "track files extension");
 DEFINE_bool(no_world_logs, false, "don't print world summary logs");
 DEFINE_bool(no_mwm_logs, false, "don't print logs per mwm");
@@ -99,6 +103,9 @@ namespace track_analyzing
 void CmdCppTrack(string const & trackFile, string const & mwmName, string const & user, size_t trackIdx);
 // Match raw gps logs to tracks.
 void CmdMatch(string const & logFile, string const & trackFile, string const & inputDistribution);
+// The same as match but matches in |threadsCount| threads and saves tracks as soon as an mwm is matched.
+void CmdMatchBatch(string const & logFile, string const & trackFile, size_t threadsCount,
+                   string const & inputDistribution);
 // The same as match but applies for the directory with raw logs.
 void CmdMatchDir(string const & logDir, string const & trackExt, string const & inputDistribution);
 // Parse |logFile| and save tracks (mwm name, aloha id, lats, lons, timestamps in seconds in csv).
@@ -129,6 +136,12 @@ int main(int argc, char ** argv)
       string const & logFile = Checked_in();
       CmdMatch(logFile, FLAGS_out.empty() ? logFile + ".track" : FLAGS_out, FLAGS_input_distribution);
     }
+    else if (cmd == "match_batch")
+    {
+      string const & logFile = Checked_in();
+      CmdMatchBatch(logFile, FLAGS_out.empty() ? logFile + ".track" : FLAGS_out,
+                    base::checked_cast<size_t>(FLAGS_threads), FLAGS_input_distribution);
+    }
     else if (cmd == "match_dir")
     {
       string const & logDir = Checked_in();
@@ -1,5 +1,6 @@
 #include "track_analyzing/track_analyzer/utils.hpp"
 
+#include "track_analyzing/exceptions.hpp"
 #include "track_analyzing/log_parser.hpp"
 
 #include "storage/country_info_getter.hpp"
@@ -10,13 +11,16 @@
 #include "platform/platform.hpp"
 
 #include "coding/csv_reader.hpp"
+#include "coding/file_writer.hpp"
 
 #include "base/checked_cast.hpp"
 #include "base/logging.hpp"
+#include "base/scope_guard.hpp"
 #include "base/string_utils.hpp"
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <utility>
@@ -28,6 +32,18 @@ using namespace track_analyzing;
 
 namespace
 {
+// The number of points which are parsed before they are flushed to the files of mwms.
+size_t constexpr kMaxBufferedPoints = 4 * 1000 * 1000;
+
+unique_ptr<LogParser> MakeLogParser(shared_ptr<NumMwmIds> const & numMwmIds)
+{
+  Platform const & platform = GetPlatform();
+  string const dataDir = platform.WritableDir();
+  auto countryInfoGetter = CountryInfoReader::CreateCountryInfoGetter(platform);
+  unique_ptr<m4::Tree<NumMwmId>> mwmTree = MakeNumMwmTree(*numMwmIds, *countryInfoGetter);
+  return make_unique<LogParser>(numMwmIds, std::move(mwmTree), dataDir);
+}
+
 set<string> GetKeys(Stats::NameToCountMapping const & mapping)
 {
   set<string> keys;
@@ -214,14 +230,36 @@ void MappingFromCsv(basic_istream<char> & ss, Stats::NameToCountMapping & mappin
 
 void ParseTracks(string const & logFile, shared_ptr<NumMwmIds> const & numMwmIds, MwmToTracks & mwmToTracks)
 {
-  Platform const & platform = GetPlatform();
-  string const dataDir = platform.WritableDir();
-  auto countryInfoGetter = CountryInfoReader::CreateCountryInfoGetter(platform);
-  unique_ptr<m4::Tree<NumMwmId>> mwmTree = MakeNumMwmTree(*numMwmIds, *countryInfoGetter);
+  auto const parser = MakeLogParser(numMwmIds);
+
+  LOG(LINFO, ("Parsing", logFile));
+  parser->Parse(logFile, mwmToTracks);
+}
+
+void ForEachMwmTracks(string const & logFile, shared_ptr<NumMwmIds> const & numMwmIds,
+                      function<void(NumMwmId mwmId, UserToTrack const & userToTrack)> const & toDo)
+{
+  auto const parser = MakeLogParser(numMwmIds);
+
+  string const dir = logFile + ".mwm_tracks";
+  Platform::RmDirRecursively(dir);
+  if (!Platform::MkDirChecked(dir))
+    MYTHROW(MessageException, ("Can't create directory", dir, "for the tracks of mwms"));
+  SCOPE_GUARD(removeDir, [&dir]() { Platform::RmDirRecursively(dir); });
 
   LOG(LINFO, ("Parsing", logFile));
-  LogParser parser(numMwmIds, std::move(mwmTree), dataDir);
-  parser.Parse(logFile, mwmToTracks);
+  vector<NumMwmId> mwmIds = parser->SplitIntoMwmFiles(logFile, dir, kMaxBufferedPoints);
+  sort(mwmIds.begin(), mwmIds.end(), [&](NumMwmId lhs, NumMwmId rhs)
+  { return numMwmIds->GetFile(lhs).GetName() < numMwmIds->GetFile(rhs).GetName(); });
+
+  for (NumMwmId const mwmId : mwmIds)
+  {
+    string const file = LogParser::GetMwmTracksFile(dir, mwmId);
+    UserToTrack userToTrack;
+    LogParser::ReadMwmTracks(file, userToTrack);
+    FileWriter::DeleteFileX(file);
+    toDo(mwmId, userToTrack);
+  }
 }
 
 void WriteCsvTableHeader(basic_ostream<char> & stream)
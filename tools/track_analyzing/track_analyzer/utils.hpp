@@ -7,6 +7,7 @@
 #include "track_analyzing/track.hpp"
 
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <map>
 #include <memory>
@@ -66,6 +67,12 @@ void MappingFromCsv(std::basic_istream<char> & ss, Stats::NameToCountMapping & m
 void ParseTracks(std::string const & logFile, std::shared_ptr<routing::NumMwmIds> const & numMwmIds,
                  MwmToTracks & mwmToTracks);
 
+/// \brief Parses tracks from |logFile| and calls |toDo| for the tracks of every mwm in the order of mwm names.
+/// The tracks are split into mwms through temporary files next to |logFile|, so only the tracks of one mwm
+/// are kept in memory.
+void ForEachMwmTracks(std::string const & logFile, std::shared_ptr<routing::NumMwmIds> const & numMwmIds,
+                      std::function<void(routing::NumMwmId mwmId, UserToTrack const & userToTrack)> const & toDo);
+
 void WriteCsvTableHeader(std::basic_ostream<char> & stream);
 
 void LogNameToCountMapping(std::string const & keyName, std::string const & descr,
@@ -0,0 +1,136 @@
+#include "testing/testing.hpp"
+
+#include "track_analyzing/serialization.hpp"
+#include "track_analyzing/track.hpp"
+
+#include "routing/segment.hpp"
+
+#include "routing_common/num_mwm_id.hpp"
+
+#include "platform/country_file.hpp"
+
+#include "coding/reader.hpp"
+#include "coding/writer.hpp"
+
+#include "geometry/latlon.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace serialization_tests
+{
+using namespace platform;
+using namespace routing;
+using namespace std;
+using namespace track_analyzing;
+
+// Coordinates are quantized by the serializer.
+double constexpr kAccuracyEps = 1e-4;
+
+UserToMatchedTracks MakeTracks(NumMwmId mwmId, uint32_t featureId)
+{
+  MatchedTrack track;
+  track.emplace_back(DataPoint(1577826000, ms::LatLon(55.270, 37.400), 0 /* G0 speed group */),
+                     Segment(mwmId, featureId, 0 /* segmentIdx */, true /* forward */));
+  track.emplace_back(DataPoint(1577826001, ms::LatLon(55.270, 37.401), 0 /* G0 speed group */),
+                     Segment(mwmId, featureId, 1 /* segmentIdx */, false /* forward */));
+
+  UserToMatchedTracks userToMatchedTracks;
+  userToMatchedTracks["user"].push_back(track);
+  return userToMatchedTracks;
+}
+
+void TestTracksEqual(UserToMatchedTracks const & lhs, UserToMatchedTracks const & rhs)
+{
+  TEST_EQUAL(lhs.size(), rhs.size(), ());
+  for (auto const & [user, tracks] : lhs)
+  {
+    auto const it = rhs.find(user);
+    TEST(it != rhs.cend(), (user));
+    TEST_EQUAL(tracks.size(), it->second.size(), ());
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+      TEST_EQUAL(tracks[i].size(), it->second[i].size(), ());
+      for (size_t j = 0; j < tracks[i].size(); ++j)
+      {
+        TEST_EQUAL(tracks[i][j].GetSegment(), it->second[i][j].GetSegment(), ());
+        auto const & point = tracks[i][j].GetDataPoint();
+        auto const & readPoint = it->second[i][j].GetDataPoint();
+        TEST_EQUAL(point.m_timestamp, readPoint.m_timestamp, ());
+        TEST(point.m_latLon.EqualDxDy(readPoint.m_latLon, kAccuracyEps), (point.m_latLon, readPoint.m_latLon));
+      }
+    }
+  }
+}
+
+// The tracks which are saved mwm by mwm are read as the tracks saved at once.
+UNIT_TEST(MwmToMatchedTracksSerializer_SerializeMwm)
+{
+  auto numMwmIds = make_shared<NumMwmIds>();
+  numMwmIds->RegisterFile(CountryFile("Belarus_Minsk Region"));
+  numMwmIds->RegisterFile(CountryFile("Russia_Moscow"));
+  NumMwmId const minsk = numMwmIds->GetId(CountryFile("Belarus_Minsk Region"));
+  NumMwmId const moscow = numMwmIds->GetId(CountryFile("Russia_Moscow"));
+
+  MwmToMatchedTracks mwmToMatchedTracks;
+  mwmToMatchedTracks[minsk] = MakeTracks(minsk, 1 /* featureId */);
+  mwmToMatchedTracks[moscow] = MakeTracks(moscow, 2 /* featureId */);
+
+  MwmToMatchedTracksSerializer serializer(numMwmIds);
+  vector<uint8_t> buffer;
+  {
+    MemWriter<decltype(buffer)> writer(buffer);
+    serializer.SerializeMwm(minsk, mwmToMatchedTracks[minsk], writer);
+    serializer.SerializeMwm(moscow, mwmToMatchedTracks[moscow], writer);
+  }
+
+  MemReader reader(buffer.data(), buffer.size());
+  ReaderSource<MemReader> src(reader);
+  MwmToMatchedTracks result;
+  serializer.Deserialize(result, src);
+
+  TEST_EQUAL(result.size(), 2, ());
+  TestTracksEqual(result[minsk], mwmToMatchedTracks[minsk]);
+  TestTracksEqual(result[moscow], mwmToMatchedTracks[moscow]);
+}
+
+// The tracks which are flushed several times are read as one track per user, without loss of precision.
+UNIT_TEST(UserToTrackSerializer_Append)
+{
+  UserToTrack first;
+  first["alice"] = {DataPoint(1577826000, ms::LatLon(55.2700001, 37.4000001), 1 /* traffic */),
+                    DataPoint(1577826001, ms::LatLon(55.2700002, 37.4000002), 2 /* traffic */)};
+  first["bob"] = {DataPoint(1577826002, ms::LatLon(53.9, 27.56), 0 /* traffic */)};
+
+  UserToTrack second;
+  second["alice"] = {DataPoint(1577826003, ms::LatLon(55.2700003, 37.4000003), 3 /* traffic */)};
+
+  vector<uint8_t> buffer;
+  {
+    MemWriter<decltype(buffer)> writer(buffer);
+    UserToTrackSerializer::Serialize(first, writer);
+    UserToTrackSerializer::Serialize(second, writer);
+  }
+
+  MemReader reader(buffer.data(), buffer.size());
+  ReaderSource<MemReader> src(reader);
+  UserToTrack result;
+  UserToTrackSerializer::Deserialize(result, src);
+
+  UserToTrack expected = first;
+  expected["alice"].push_back(second["alice"].front());
+  TEST_EQUAL(result.size(), expected.size(), ());
+  for (auto const & [user, track] : expected)
+  {
+    Track const & readTrack = result[user];
+    TEST_EQUAL(readTrack.size(), track.size(), (user));
+    for (size_t i = 0; i < track.size(); ++i)
+    {
+      TEST_EQUAL(readTrack[i].m_timestamp, track[i].m_timestamp, ());
+      TEST_EQUAL(readTrack[i].m_latLon, track[i].m_latLon, ());
+      TEST_EQUAL(readTrack[i].m_traffic, track[i].m_traffic, ());
+    }
+  }
+}
+}  // namespace serialization_tests
@@ -0,0 +1,130 @@
+#include "testing/testing.hpp"
+
+#include "track_analyzing/track.hpp"
+#include "track_analyzing/track_matcher.hpp"
+
+#include "generator/generator_tests_support/routing_helpers.hpp"
+
+#include "routing/geometry.hpp"
+#include "routing/index_graph.hpp"
+#include "routing/segment.hpp"
+
+#include "routing_common/num_mwm_id.hpp"
+
+#include "geometry/latlon.hpp"
+#include "geometry/mercator.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace track_matcher_tests
+{
+using namespace routing;
+using namespace std;
+using namespace track_analyzing;
+
+NumMwmId constexpr kMwmId = 0;
+
+struct TestRoad
+{
+  bool m_oneWay = false;
+  vector<m2::PointD> m_points;
+};
+
+// Road 0 goes to the east to the fork, road 1 goes on to the east and road 2 turns to the north-east.
+// Both roads are within the matching range of a point at the first segments after the fork.
+map<uint32_t, TestRoad> MakeForkRoads()
+{
+  auto const makePoints = [](vector<ms::LatLon> const & latlons)
+  {
+    vector<m2::PointD> points;
+    for (auto const & latlon : latlons)
+      points.push_back(mercator::FromLatLon(latlon));
+    return points;
+  };
+
+  map<uint32_t, TestRoad> roads;
+  roads[0].m_points = makePoints({{55.75, 37.597}, {55.75, 37.598}, {55.75, 37.599}, {55.75, 37.600}});
+  roads[1].m_points = makePoints({{55.75, 37.600}, {55.75, 37.601}, {55.75, 37.602}, {55.75, 37.603}});
+  roads[2].m_points =
+      makePoints({{55.75, 37.600}, {55.7501, 37.601}, {55.7504, 37.602}, {55.7510, 37.603}, {55.7516, 37.604}});
+  return roads;
+}
+
+TrackMatcher MakeMatcher(map<uint32_t, TestRoad> const & roads)
+{
+  auto loader = make_unique<TestGeometryLoader>();
+  for (auto const & [featureId, road] : roads)
+    loader->AddRoad(featureId, road.m_oneWay, 60.0 /* speed */, RoadGeometry::Points(road.m_points));
+
+  // The fork joint is the last point of road 0 and the first points of roads 1 and 2.
+  auto graph = BuildIndexGraph(std::move(loader), CreateEstimatorForCar(nullptr /* trafficStash */),
+                               {MakeJoint({{0 /* featureId */, 3 /* pointId */}, {1, 0}, {2, 0}})});
+
+  return TrackMatcher(kMwmId, std::move(graph),
+                      [roads](m2::RectD const & /* rect */, TrackMatcher::RoadFn const & fn)
+  {
+    for (auto const & [featureId, road] : roads)
+      fn(featureId, road.m_oneWay, road.m_points);
+  });
+}
+
+vector<DataPoint> MakeTrack(vector<ms::LatLon> const & latlons)
+{
+  vector<DataPoint> track;
+  uint64_t timestamp = 1577826000;
+  for (auto const & latlon : latlons)
+    track.emplace_back(timestamp++, latlon, 0 /* G0 speed group */);
+  return track;
+}
+
+// The points after the fork are closer to road 1 because of gps noise, but the next points are on road 2 only.
+// A greedy matcher takes road 1 and breaks the track, Viterbi algorithm takes road 2 for all of them.
+UNIT_TEST(TrackMatcher_NoisyTrackOnFork)
+{
+  auto matcher = MakeMatcher(MakeForkRoads());
+  auto const track = MakeTrack({{55.75001, 37.5975},
+                                {55.74998, 37.5985},
+                                {55.75002, 37.5995},
+                                {55.75001, 37.6005},
+                                {55.75004, 37.6010},
+                                {55.75038, 37.6020},
+                                {55.75102, 37.6030},
+                                {55.75158, 37.6040}});
+
+  vector<MatchedTrack> matchedTracks;
+  matcher.MatchTrack(track, matchedTracks);
+
+  TEST_EQUAL(matchedTracks.size(), 1, ());
+  TEST_EQUAL(matcher.GetNonMatchedPointsCount(), 0, ());
+  auto const & matchedTrack = matchedTracks.front();
+  TEST_EQUAL(matchedTrack.size(), track.size(), ());
+
+  vector<uint32_t> const expectedFeatureIds = {0, 0, 0, 2, 2, 2, 2, 2};
+  for (size_t i = 0; i < matchedTrack.size(); ++i)
+  {
+    Segment const & segment = matchedTrack[i].GetSegment();
+    TEST_EQUAL(segment.GetFeatureId(), expectedFeatureIds[i], (i, segment));
+    TEST(segment.IsForward(), (i, segment));
+  }
+}
+
+// The points which are far from all the roads aren't matched and break the track.
+UNIT_TEST(TrackMatcher_PointFarFromRoads)
+{
+  auto matcher = MakeMatcher(MakeForkRoads());
+  auto const track = MakeTrack({{55.75001, 37.5975}, {55.74999, 37.5985}, {55.7510, 37.5990}, {55.74999, 37.6015},
+                                {55.75001, 37.6025}});
+
+  vector<MatchedTrack> matchedTracks;
+  matcher.MatchTrack(track, matchedTracks);
+
+  TEST_EQUAL(matchedTracks.size(), 2, ());
+  TEST_EQUAL(matcher.GetNonMatchedPointsCount(), 1, ());
+  TEST_EQUAL(matchedTracks[0].size(), 2, ());
+  TEST_EQUAL(matchedTracks[1].size(), 2, ());
+  TEST_EQUAL(matchedTracks[1][0].GetSegment().GetFeatureId(), 1, ());
+}
+}  // namespace track_matcher_tests
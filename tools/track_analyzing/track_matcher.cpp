@@ -12,6 +12,9 @@
 
 #include "base/stl_helpers.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace track_analyzing
 {
 using namespace routing;
@@ -22,50 +25,107 @@ namespace
 {
 // Matching range in meters.
 double constexpr kMatchingRange = 20.0;
-
-// Mercator distance from segment to point in meters.
-double DistanceToSegment(m2::PointD const & segmentBegin, m2::PointD const & segmentEnd, m2::PointD const & point)
+// Maximum number of candidate segments of a track point. It bounds the time of a point matching.
+size_t constexpr kMaxCandidates = 8;
+// Standard deviation of gps error in meters.
+double constexpr kGpsSigmaM = 10.0;
+// Scale of the difference between the distance along the roads and the distance between the points in meters.
+// The more it is, the more likely are the transitions which don't fit the distance between the points.
+double constexpr kTransitionBetaM = 10.0;
+
+// Negative logarithm of the probability to get the point at |distance| meters from the segment,
+// gps error is normally distributed.
+double CalcEmissionCost(double distance)
 {
-  m2::ParametrizedSegment<m2::PointD> const segment(segmentBegin, segmentEnd);
-  m2::PointD const projectionPoint = segment.ClosestPointTo(point);
-  return mercator::DistanceOnEarth(point, projectionPoint);
+  double const normalized = distance / kGpsSigmaM;
+  return 0.5 * normalized * normalized;
 }
 
-double DistanceToSegment(Segment const & segment, m2::PointD const & point, IndexGraph & indexGraph)
+// Negative logarithm of the probability of the transition, the difference between the distance along the roads
+// and the distance between the points is exponentially distributed.
+double CalcTransitionCost(double roadDistance, double pointsDistance)
 {
-  auto const & road = indexGraph.GetRoadGeometry(segment.GetFeatureId());
-  return DistanceToSegment(mercator::FromLatLon(road.GetPoint(segment.GetPointId(false))),
-                           mercator::FromLatLon(road.GetPoint(segment.GetPointId(true))), point);
-}
-
-bool EdgesContain(IndexGraph::SegmentEdgeListT const & edges, Segment const & segment)
-{
-  for (auto const & edge : edges)
-    if (edge.GetTarget() == segment)
-      return true;
-
-  return false;
+  return fabs(roadDistance - pointsDistance) / kTransitionBetaM;
 }
 }  // namespace
 
-// TrackMatcher ------------------------------------------------------------------------------------
-TrackMatcher::TrackMatcher(storage::Storage const & storage, NumMwmId mwmId, platform::CountryFile const & countryFile)
+// MatchingMwmData ---------------------------------------------------------------------------------
+MatchingMwmData::MatchingMwmData(storage::Storage const & storage, NumMwmId mwmId,
+                                 platform::CountryFile const & countryFile)
   : m_mwmId(mwmId)
+  , m_countryFile(countryFile)
   , m_vehicleModel(CarModelFactory({}).GetVehicleModelForCountry(countryFile.GetName()))
 {
   auto localCountryFile = storage.GetLatestLocalFile(countryFile);
-  CHECK(localCountryFile, ("Can't find latest country file for", countryFile.GetName()));
+  if (!localCountryFile)
+    MYTHROW(MessageException, ("Can't find latest country file for", countryFile.GetName()));
   auto registerResult = m_dataSource.Register(*localCountryFile);
-  CHECK_EQUAL(registerResult.second, MwmSet::RegResult::Success, ("Can't register mwm", countryFile.GetName()));
+  if (registerResult.second != MwmSet::RegResult::Success)
+    MYTHROW(MessageException, ("Can't register mwm", countryFile.GetName(), ":", registerResult.second));
 
   MwmSet::MwmHandle handle = m_dataSource.GetMwmHandleByCountryFile(countryFile);
 
+  IndexGraph graph(make_shared<Geometry>(GeometryLoader::Create(handle, m_vehicleModel, false /* loadAltitudes */),
+                                         m_roadsCache, m_mwmId),
+                   EdgeEstimator::Create(VehicleType::Car, *m_vehicleModel, nullptr /* trafficStash */,
+                                         nullptr /* dataSource */, nullptr /* numMvmIds */));
+
+  DeserializeIndexGraph(*handle.GetValue(), VehicleType::Car, graph);
+  m_graphData = graph.GetData();
+}
+
+// TrackMatcher ------------------------------------------------------------------------------------
+TrackMatcher::TrackMatcher(storage::Storage const & storage, NumMwmId mwmId, platform::CountryFile const & countryFile)
+  : TrackMatcher(make_shared<MatchingMwmData>(storage, mwmId, countryFile))
+{}
+
+TrackMatcher::TrackMatcher(shared_ptr<MatchingMwmData> data) : m_data(std::move(data))
+{
+  CHECK(m_data, ());
+  m_mwmId = m_data->GetMwmId();
+  MwmSet::MwmHandle handle = m_data->GetDataSource().GetMwmHandleByCountryFile(m_data->GetCountryFile());
+  auto const & vehicleModel = m_data->GetVehicleModel();
+
   m_graph = make_unique<IndexGraph>(
-      make_shared<Geometry>(GeometryLoader::Create(handle, m_vehicleModel, false /* loadAltitudes */)),
-      EdgeEstimator::Create(VehicleType::Car, *m_vehicleModel, nullptr /* trafficStash */, nullptr /* dataSource */,
-                            nullptr /* numMvmIds */));
+      make_shared<Geometry>(GeometryLoader::Create(handle, vehicleModel, false /* loadAltitudes */),
+                            m_data->GetRoadsCache(), m_data->GetMwmId()),
+      EdgeEstimator::Create(VehicleType::Car, *vehicleModel, nullptr /* trafficStash */, nullptr /* dataSource */,
+                            nullptr /* numMvmIds */),
+      m_data->GetGraphData());
+
+  m_forEachRoad = [data = m_data.get()](m2::RectD const & rect, RoadFn const & fn)
+  {
+    auto const & vehicleModel = *data->GetVehicleModel();
+    vector<m2::PointD> points;
+    data->GetDataSource().ForEachInRect([&](FeatureType & ft)
+    {
+      if (!ft.GetID().IsValid())
+        return;
+
+      if (ft.GetID().m_mwmId.GetInfo()->GetType() != MwmInfo::COUNTRY)
+        return;
+
+      feature::TypesHolder const types(ft);
+      if (!vehicleModel.IsRoad(types))
+        return;
+
+      ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
+      points.clear();
+      for (size_t i = 0; i < ft.GetPointsCount(); ++i)
+        points.push_back(ft.GetPoint(i));
 
-  DeserializeIndexGraph(*handle.GetValue(), VehicleType::Car, *m_graph);
+      fn(ft.GetID().m_index, vehicleModel.IsOneWay(types), points);
+    }, rect, scales::GetUpperScale());
+  };
+}
+
+TrackMatcher::TrackMatcher(NumMwmId mwmId, unique_ptr<IndexGraph> graph, ForEachRoadFn forEachRoad)
+  : m_mwmId(mwmId)
+  , m_graph(std::move(graph))
+  , m_forEachRoad(std::move(forEachRoad))
+{
+  CHECK(m_graph, ());
+  CHECK(m_forEachRoad, ());
 }
 
 void TrackMatcher::MatchTrack(vector<DataPoint> const & track, vector<MatchedTrack> & matchedTracks)
@@ -81,7 +141,7 @@ void TrackMatcher::MatchTrack(vector<DataPoint> const & track, vector<MatchedTra
   {
     for (; trackBegin < steps.size(); ++trackBegin)
     {
-      steps[trackBegin].FillCandidatesWithNearbySegments(m_dataSource, *m_graph, *m_vehicleModel, m_mwmId);
+      steps[trackBegin].FillCandidatesWithNearbySegments(m_forEachRoad, *m_graph, m_mwmId);
       if (steps[trackBegin].HasCandidates())
         break;
 
@@ -101,10 +161,12 @@ void TrackMatcher::MatchTrack(vector<DataPoint> const & track, vector<MatchedTra
         break;
     }
 
-    steps[trackEnd].ChooseNearestSegment();
-
-    for (size_t i = trackEnd; i > trackBegin; --i)
-      steps[i - 1].ChooseSegment(steps[i], *m_graph);
+    // Viterbi backtracking. The candidates are sorted by cost, so the first candidate of the last step
+    // ends the most probable sequence.
+    size_t candidateIdx = 0;
+    for (size_t i = trackEnd + 1; i > trackBegin; --i)
+      candidateIdx = steps[i - 1].ChooseCandidate(candidateIdx);
+    CHECK_EQUAL(candidateIdx, Candidate::kNoPrev, ());
 
     ++m_tracksCount;
 
@@ -120,55 +182,81 @@ void TrackMatcher::MatchTrack(vector<DataPoint> const & track, vector<MatchedTra
   }
 }
 
+// static
+TrackMatcher::Projection TrackMatcher::Project(m2::PointD const & segmentBegin, m2::PointD const & segmentEnd,
+                                               m2::PointD const & point)
+{
+  m2::ParametrizedSegment<m2::PointD> const segment(segmentBegin, segmentEnd);
+  m2::PointD const projectionPoint = segment.ClosestPointTo(point);
+
+  Projection projection;
+  projection.m_distance = mercator::DistanceOnEarth(point, projectionPoint);
+  projection.m_fromBegin = mercator::DistanceOnEarth(segmentBegin, projectionPoint);
+  projection.m_toEnd = mercator::DistanceOnEarth(projectionPoint, segmentEnd);
+  return projection;
+}
+
+// static
+TrackMatcher::Projection TrackMatcher::Project(Segment const & segment, m2::PointD const & point,
+                                               IndexGraph const & graph)
+{
+  auto const & road = graph.GetRoadGeometry(segment.GetFeatureId());
+  return Project(mercator::FromLatLon(road.GetPoint(segment.GetPointId(false /* front */))),
+                 mercator::FromLatLon(road.GetPoint(segment.GetPointId(true /* front */))), point);
+}
+
 // TrackMatcher::Step ------------------------------------------------------------------------------
 TrackMatcher::Step::Step(DataPoint const & dataPoint)
   : m_dataPoint(dataPoint)
   , m_point(mercator::FromLatLon(dataPoint.m_latLon))
 {}
 
-void TrackMatcher::Step::FillCandidatesWithNearbySegments(DataSource const & dataSource, IndexGraph const & graph,
-                                                          VehicleModelInterface const & vehicleModel, NumMwmId mwmId)
+void TrackMatcher::Step::FillCandidatesWithNearbySegments(ForEachRoadFn const & forEachRoad, IndexGraph const & graph,
+                                                          NumMwmId mwmId)
 {
-  dataSource.ForEachInRect([&](FeatureType & ft)
+  forEachRoad(mercator::RectByCenterXYAndSizeInMeters(m_point, kMatchingRange),
+              [&](uint32_t featureId, bool oneWay, vector<m2::PointD> const & points)
   {
-    if (!ft.GetID().IsValid())
-      return;
-
-    if (ft.GetID().m_mwmId.GetInfo()->GetType() != MwmInfo::COUNTRY)
-      return;
-
-    feature::TypesHolder const types(ft);
-    if (!vehicleModel.IsRoad(types))
-      return;
-
-    ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
-
-    for (size_t segIdx = 0; segIdx + 1 < ft.GetPointsCount(); ++segIdx)
+    for (size_t segIdx = 0; segIdx + 1 < points.size(); ++segIdx)
     {
-      double const distance = DistanceToSegment(ft.GetPoint(segIdx), ft.GetPoint(segIdx + 1), m_point);
-      if (distance < kMatchingRange)
+      Projection const forward = Project(points[segIdx], points[segIdx + 1], m_point);
+      if (forward.m_distance < kMatchingRange)
       {
-        AddCandidate(Segment(mwmId, ft.GetID().m_index, static_cast<uint32_t>(segIdx), true /* forward */), distance,
-                     graph);
+        AddCandidate(Segment(mwmId, featureId, static_cast<uint32_t>(segIdx), true /* forward */), forward, graph);
 
-        if (!vehicleModel.IsOneWay(types))
+        if (!oneWay)
         {
-          AddCandidate(Segment(mwmId, ft.GetID().m_index, static_cast<uint32_t>(segIdx), false /* forward */), distance,
+          Projection const backward = {forward.m_distance, forward.m_toEnd, forward.m_fromBegin};
+          AddCandidate(Segment(mwmId, featureId, static_cast<uint32_t>(segIdx), false /* forward */), backward,
                        graph);
         }
       }
     }
-  }, mercator::RectByCenterXYAndSizeInMeters(m_point, kMatchingRange), scales::GetUpperScale());
+  });
+
+  LimitCandidates();
 }
 
 void TrackMatcher::Step::FillCandidates(Step const & previousStep, IndexGraph & graph)
 {
   IndexGraph::SegmentEdgeListT edges;
+  double const pointsDistance = mercator::DistanceOnEarth(previousStep.m_point, m_point);
 
-  for (Candidate const & candidate : previousStep.m_candidates)
+  for (size_t prevIdx = 0; prevIdx < previousStep.m_candidates.size(); ++prevIdx)
   {
+    Candidate const & candidate = previousStep.m_candidates[prevIdx];
     Segment const & segment = candidate.GetSegment();
-    m_candidates.emplace_back(segment, DistanceToSegment(segment, m_point, graph));
+    Projection const & prevProjection = candidate.GetProjection();
+
+    Projection const projection = Project(segment, m_point, graph);
+    if (projection.m_distance <= kMatchingRange)
+    {
+      double const roadDistance = fabs(projection.m_fromBegin - prevProjection.m_fromBegin);
+      m_candidates.emplace_back(segment, projection,
+                                candidate.GetCost() + CalcTransitionCost(roadDistance, pointsDistance) +
+                                    CalcEmissionCost(projection.m_distance),
+                                prevIdx);
+    }
 
     edges.clear();
     graph.GetEdgeList(segment, true /* isOutgoing */, true /* useRoutingOptions */, edges);
@@ -176,60 +264,52 @@ void TrackMatcher::Step::FillCandidates(Step const & previousStep, IndexGraph &
     for (SegmentEdge const & edge : edges)
     {
       Segment const & target = edge.GetTarget();
-      if (!segment.IsInverse(target))
-        m_candidates.emplace_back(target, DistanceToSegment(target, m_point, graph));
+      if (segment.IsInverse(target))
+        continue;
+
+      Projection const targetProjection = Project(target, m_point, graph);
+      if (targetProjection.m_distance > kMatchingRange)
+        continue;
+
+      double const roadDistance = prevProjection.m_toEnd + targetProjection.m_fromBegin;
+      m_candidates.emplace_back(target, targetProjection,
+                                candidate.GetCost() + CalcTransitionCost(roadDistance, pointsDistance) +
+                                    CalcEmissionCost(targetProjection.m_distance),
+                                prevIdx);
     }
   }
 
-  base::SortUnique(m_candidates);
-
-  m_candidates.erase(remove_if(m_candidates.begin(), m_candidates.end(),
-                               [&](Candidate const & candidate) { return candidate.GetDistance() > kMatchingRange; }),
-                     m_candidates.end());
+  LimitCandidates();
 }
 
-void TrackMatcher::Step::ChooseSegment(Step const & nextStep, IndexGraph & indexGraph)
+size_t TrackMatcher::Step::ChooseCandidate(size_t candidateIdx)
 {
-  CHECK(!m_candidates.empty(), ());
-
-  double minDistance = numeric_limits<double>::max();
-
-  IndexGraph::SegmentEdgeListT edges;
-  indexGraph.GetEdgeList(nextStep.m_segment, false /* isOutgoing */, true /* useRoutingOptions */, edges);
-  edges.emplace_back(nextStep.m_segment, GetAStarWeightZero<RouteWeight>());
-
-  for (Candidate const & candidate : m_candidates)
-  {
-    if (candidate.GetDistance() < minDistance && EdgesContain(edges, candidate.GetSegment()))
-    {
-      minDistance = candidate.GetDistance();
-      m_segment = candidate.GetSegment();
-    }
-  }
-
-  if (minDistance == numeric_limits<double>::max())
-    MYTHROW(MessageException, ("Can't find previous step for", nextStep.m_segment));
+  CHECK_LESS(candidateIdx, m_candidates.size(), ());
+  Candidate const & candidate = m_candidates[candidateIdx];
+  m_segment = candidate.GetSegment();
+  return candidate.GetPrevIdx();
 }
 
-void TrackMatcher::Step::ChooseNearestSegment()
+void TrackMatcher::Step::AddCandidate(Segment const & segment, Projection const & projection,
+                                      IndexGraph const & graph)
 {
-  CHECK(!m_candidates.empty(), ());
-
-  double minDistance = numeric_limits<double>::max();
-
-  for (Candidate const & candidate : m_candidates)
-  {
-    if (candidate.GetDistance() < minDistance)
-    {
-      minDistance = candidate.GetDistance();
-      m_segment = candidate.GetSegment();
-    }
-  }
+  if (graph.GetAccessType(segment) == RoadAccess::Type::Yes)
+    m_candidates.emplace_back(segment, projection, CalcEmissionCost(projection.m_distance), Candidate::kNoPrev);
 }
 
-void TrackMatcher::Step::AddCandidate(Segment const & segment, double distance, IndexGraph const & graph)
+void TrackMatcher::Step::LimitCandidates()
 {
-  if (graph.GetAccessType(segment) == RoadAccess::Type::Yes)
-    m_candidates.emplace_back(segment, distance);
+  // The cheapest candidate of a segment goes first and is left by the unique.
+  base::SortUnique(m_candidates, [](Candidate const & lhs, Candidate const & rhs)
+  {
+    if (lhs.GetSegment() != rhs.GetSegment())
+      return lhs.GetSegment() < rhs.GetSegment();
+    return lhs.GetCost() < rhs.GetCost();
+  }, [](Candidate const & lhs, Candidate const & rhs) { return lhs.GetSegment() == rhs.GetSegment(); });
+
+  sort(m_candidates.begin(), m_candidates.end(),
+       [](Candidate const & lhs, Candidate const & rhs) { return lhs.GetCost() < rhs.GetCost(); });
+  if (m_candidates.size() > kMaxCandidates)
+    m_candidates.erase(m_candidates.begin() + kMaxCandidates, m_candidates.end());
 }
 }  // namespace track_analyzing
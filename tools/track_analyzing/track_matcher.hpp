@@ -2,6 +2,7 @@
 
 #include "track_analyzing/track.hpp"
 
+#include "routing/geometry.hpp"
 #include "routing/index_graph.hpp"
 #include "routing/segment.hpp"
 
@@ -13,16 +14,58 @@
 
 #include "geometry/point2d.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace track_analyzing
 {
+/// \brief Data of an mwm which is needed for matching and isn't changed by it: the data source,
+/// the deserialized graph and the road geometry. It's loaded once and shared by the matchers
+/// of several threads. It's thread-safe.
+class MatchingMwmData final
+{
+public:
+  /// \throws MessageException if the mwm can't be registered and RootException if its graph can't be read.
+  MatchingMwmData(storage::Storage const & storage, routing::NumMwmId mwmId,
+                  platform::CountryFile const & countryFile);
+
+  routing::NumMwmId GetMwmId() const { return m_mwmId; }
+  FrozenDataSource & GetDataSource() { return m_dataSource; }
+  platform::CountryFile const & GetCountryFile() const { return m_countryFile; }
+  std::shared_ptr<routing::VehicleModelInterface> const & GetVehicleModel() const { return m_vehicleModel; }
+  std::shared_ptr<routing::IndexGraph::Data const> const & GetGraphData() const { return m_graphData; }
+  std::shared_ptr<routing::RoadGeometryCache> const & GetRoadsCache() const { return m_roadsCache; }
+
+private:
+  routing::NumMwmId const m_mwmId;
+  platform::CountryFile const m_countryFile;
+  FrozenDataSource m_dataSource;
+  std::shared_ptr<routing::VehicleModelInterface> m_vehicleModel;
+  std::shared_ptr<routing::IndexGraph::Data const> m_graphData;
+  std::shared_ptr<routing::RoadGeometryCache> m_roadsCache = std::make_shared<routing::RoadGeometryCache>();
+};
+
+/// \brief Matches gps tracks to the road segments with a hidden Markov model: every point has a bounded
+/// set of candidate segments, the most probable sequence of candidates is found by Viterbi algorithm.
+/// Matching time is linear in the track length.
+/// \note The matcher isn't thread-safe, the threads should have their own matchers with shared MatchingMwmData.
 class TrackMatcher final
 {
 public:
+  /// Is called for a road with its feature id, one way flag and mercator points.
+  using RoadFn = std::function<void(uint32_t featureId, bool oneWay, std::vector<m2::PointD> const & points)>;
+  /// Calls |fn| for the roads which may be within |rect|.
+  using ForEachRoadFn = std::function<void(m2::RectD const & rect, RoadFn const & fn)>;
+
   TrackMatcher(storage::Storage const & storage, routing::NumMwmId mwmId, platform::CountryFile const & countryFile);
+  explicit TrackMatcher(std::shared_ptr<MatchingMwmData> data);
+  /// Matches the tracks to |graph| of the mwm |mwmId|, the candidate segments are taken from |forEachRoad|.
+  TrackMatcher(routing::NumMwmId mwmId, std::unique_ptr<routing::IndexGraph> graph, ForEachRoadFn forEachRoad);
 
   void MatchTrack(std::vector<DataPoint> const & track, std::vector<MatchedTrack> & matchedTracks);
 
@@ -31,19 +74,45 @@ public:
   uint64_t GetNonMatchedPointsCount() const { return m_nonMatchedPointsCount; }
 
 private:
+  /// Position of a point projection on a segment.
+  struct Projection
+  {
+    // Distance from the point to the segment in meters.
+    double m_distance = 0.0;
+    // Distances from the projection to the beginning and to the end of the segment in meters.
+    double m_fromBegin = 0.0;
+    double m_toEnd = 0.0;
+  };
+
+  static Projection Project(m2::PointD const & segmentBegin, m2::PointD const & segmentEnd, m2::PointD const & point);
+  static Projection Project(routing::Segment const & segment, m2::PointD const & point,
+                            routing::IndexGraph const & graph);
+
   class Candidate final
   {
   public:
-    Candidate(routing::Segment segment, double distance) : m_segment(segment), m_distance(distance) {}
+    static size_t constexpr kNoPrev = std::numeric_limits<size_t>::max();
+
+    Candidate(routing::Segment segment, Projection const & projection, double cost, size_t prevIdx)
+      : m_segment(segment)
+      , m_projection(projection)
+      , m_cost(cost)
+      , m_prevIdx(prevIdx)
+    {}
 
     routing::Segment const & GetSegment() const { return m_segment; }
-    double GetDistance() const { return m_distance; }
-    bool operator==(Candidate const & candidate) const { return m_segment == candidate.m_segment; }
-    bool operator<(Candidate const & candidate) const { return m_segment < candidate.m_segment; }
+    Projection const & GetProjection() const { return m_projection; }
+    double GetDistance() const { return m_projection.m_distance; }
+    // Negative logarithm of the probability of the most probable candidates sequence which ends with this one.
+    double GetCost() const { return m_cost; }
+    // Index of the candidate of the previous step in this sequence.
+    size_t GetPrevIdx() const { return m_prevIdx; }
 
   private:
     routing::Segment m_segment;
-    double m_distance;
+    Projection m_projection;
+    double m_cost;
+    size_t m_prevIdx;
   };
 
   class Step final
@@ -54,14 +123,19 @@ private:
     DataPoint const & GetDataPoint() const { return m_dataPoint; }
     routing::Segment const & GetSegment() const { return m_segment; }
     bool HasCandidates() const { return !m_candidates.empty(); }
-    void FillCandidatesWithNearbySegments(DataSource const & dataSource, routing::IndexGraph const & graph,
-                                          routing::VehicleModelInterface const & vehicleModel, routing::NumMwmId mwmId);
+    void FillCandidatesWithNearbySegments(ForEachRoadFn const & forEachRoad, routing::IndexGraph const & graph,
+                                          routing::NumMwmId mwmId);
+    /// Fills the candidates which are reachable from the candidates of |previousStep|.
     void FillCandidates(Step const & previousStep, routing::IndexGraph & graph);
-    void ChooseSegment(Step const & nextStep, routing::IndexGraph & indexGraph);
-    void ChooseNearestSegment();
+    /// Chooses the segment of the candidate |candidateIdx| and \returns the index of its previous candidate.
+    size_t ChooseCandidate(size_t candidateIdx);
 
   private:
-    void AddCandidate(routing::Segment const & segment, double distance, routing::IndexGraph const & graph);
+    void AddCandidate(routing::Segment const & segment, Projection const & projection,
+                      routing::IndexGraph const & graph);
+    /// Leaves the cheapest candidate of each segment and no more than kMaxCandidates candidates at all,
+    /// sorted by cost.
+    void LimitCandidates();
 
     DataPoint m_dataPoint;
     m2::PointD m_point;
@@ -69,10 +143,11 @@ private:
     std::vector<Candidate> m_candidates;
   };
 
-  routing::NumMwmId const m_mwmId;
-  FrozenDataSource m_dataSource;
-  std::shared_ptr<routing::VehicleModelInterface> m_vehicleModel;
+  // May be nullptr, when the graph and the roads are given.
+  std::shared_ptr<MatchingMwmData> m_data;
+  routing::NumMwmId m_mwmId = routing::kFakeNumMwmId;
   std::unique_ptr<routing::IndexGraph> m_graph;
+  ForEachRoadFn m_forEachRoad;
   uint64_t m_tracksCount = 0;
   uint64_t m_pointsCount = 0;
   uint64_t m_nonMatchedPointsCount = 0;